@@ -5,6 +5,7 @@
 * This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
 */
 import { FOR, default as t, IF, ENDIF, ELSE } from "./tte.mjs"
+import { perfectHash } from "./perfecthash.mjs"
 
 const sigs = CS.PuertsIl2cpp.TypeUtils.TypeSignatures;
 
@@ -168,21 +169,21 @@ struct ${valueTypeInfo.Signature}
                     // this '==' is because if a pointer is passed in from external, the content of the pointer is changed and dont need to setback.
                     return `if (!op${index}.IsEmpty() && p${index} == &up${index})
     {
-        auto _unused = op${index}->Set(context, 0, ${val});
+        SetRefValue(context, op${index}, ${val});
     }
             `;    
                 } else if (elementSignature.startsWith(sigs.NullableStructPrefix) && elementSignature.endsWith('_')) {
                     return `if (!op${index}.IsEmpty() && p${index} == &up${index})
     {
-        if (!p${index}->hasValue) auto _unused = op${index}->Set(context, 0, v8::Null(isolate));
-        if (p${index} == &up${index}) auto _unused = op${index}->Set(context, 0, ${val});
+        if (!p${index}->hasValue) SetRefValue(context, op${index}, v8::Null(isolate));
+        if (p${index} == &up${index}) SetRefValue(context, op${index}, ${val});
     }
             `;    
 
                 } else {
                     return `if (!op${index}.IsEmpty())
     {
-        auto _unused = op${index}->Set(context, 0, ${val});
+        SetRefValue(context, op${index}, ${val});
     }
     `;
                 }
@@ -237,7 +238,7 @@ ${CODE_SNIPPETS.JSValToCSVal(signature, 'MaybeRet.ToLocalChecked()', 'ret')}
     v8::Local<v8::Object> o${CSName};
     if (!${JSName}.IsEmpty() && ${JSName}->IsObject()) {
         o${CSName} = ${JSName}->ToObject(context).ToLocalChecked();
-        v8::String::Utf8Value t${CSName}(isolate, o${CSName}->Get(context, 0).ToLocalChecked());
+        v8::String::Utf8Value t${CSName}(isolate, GetRefValue(context, o${CSName}));
         u${CSName} = CStringToCSharpString(*t${CSName});
     }
         `
@@ -252,7 +253,7 @@ ${CODE_SNIPPETS.JSValToCSVal(signature, 'MaybeRet.ToLocalChecked()', 'ret')}
     v8::Local<v8::Object> o${CSName};
     if (!${JSName}.IsEmpty() && ${JSName}->IsObject()) {
         o${CSName} = ${JSName}->ToObject(context).ToLocalChecked();
-        auto t${CSName} = o${CSName}->Get(context, 0).ToLocalChecked();
+        auto t${CSName} = GetRefValue(context, o${CSName});
         u${CSName} = JsValueToCSRef(context, t${CSName}, TI${CSName});
     }
         `
@@ -269,7 +270,7 @@ ${CODE_SNIPPETS.JSValToCSVal(signature, 'MaybeRet.ToLocalChecked()', 'ret')}
     v8::Local<v8::Object> o${CSName};
     if (!${JSName}.IsEmpty() && ${JSName}->IsObject()) {
         o${CSName} = ${JSName}->ToObject(context).ToLocalChecked();
-        auto t${CSName} = o${CSName}->Get(context, 0).ToLocalChecked();
+        auto t${CSName} = GetRefValue(context, o${CSName});
         ${CSName} = DataTransfer::GetPointer<${S}>(context, t${CSName});
     }
     if (!${CSName}) {
@@ -534,6 +535,12 @@ static void ifs_${fieldWrapperInfo.Signature}(const v8::FunctionCallbackInfo<v8:
 }`;
 }
 
+function genPerfectHash(name, infos) {
+    const { seeds, slots } = perfectHash(infos.map(info => info.Signature));
+    return `static const int32_t ${name}Seeds[] = {${seeds.join(', ')}};
+static const int32_t ${name}Slots[] = {${slots.join(', ')}};`;
+}
+
 export default function Gen(genInfos) {
     var valueTypeInfos = listToJsArray(genInfos.ValueTypeInfos)
     var wrapperInfos = listToJsArray(genInfos.WrapperInfos);
@@ -587,5 +594,13 @@ static FieldWrapFuncInfo g_fieldWrapFuncInfos[] = {
     {nullptr, nullptr, nullptr}    
 };
 
+#define PUERTS_SIGNATURE_PERFECT_HASH 1
+
+${genPerfectHash('g_wrapFuncHash', wrapperInfos)}
+
+${genPerfectHash('g_bridgeFuncHash', bridgeInfos)}
+
+${genPerfectHash('g_fieldWrapFuncHash', fieldWrapperInfos)}
+
 `;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// 每个多签名桶最多尝试的seed个数，正常表（每桶约4个签名）几百次以内就能找到
+const MAX_SEED_ATTEMPTS = 1 << 20;
+
+// 必须和native_src_il2cpp/Src/Puerts.cpp里的SignatureHash保持一致：带seed的32位FNV-1a，签名都是ascii。
+// FNV-1a的低位很弱（比如单字符签名的奇偶性和seed无关），取模前用murmur3的fmix32打散
+export function signatureHash(seed, signature) {
+    let h = (2166136261 ^ seed) >>> 0;
+    for (let i = 0; i < signature.length; i++) {
+        h = Math.imul(h ^ signature.charCodeAt(i), 16777619) >>> 0;
+    }
+    h ^= h >>> 16;
+    h = Math.imul(h, 0x85ebca6b) >>> 0;
+    h ^= h >>> 13;
+    h = Math.imul(h, 0xc2b2ae35) >>> 0;
+    h ^= h >>> 16;
+    return h >>> 0;
+}
+
+// hash and displace方式的最小完美哈希：先按seed为0的hash把签名分到n/4个桶里，从大桶开始给每个桶找一个seed，
+// 让桶里所有签名都落到还空着的槽；只有一个签名的桶直接占一个剩下的空槽，seed记为-(槽 + 1)。
+// seeds按桶索引，slots[槽]是签名在（已排序的）数组里的下标。
+// 签名重复或者找不到seed时抛异常并带上冲突的签名，不会死循环
+export function perfectHash(signatures) {
+    const n = signatures.length;
+    const bucketCount = Math.max(1, Math.ceil(n / 4));
+    const buckets = [];
+    for (let i = 0; i < bucketCount; i++) {
+        buckets.push({ index: i, items: [] });
+    }
+    signatures.forEach((signature, i) => buckets[signatureHash(0, signature) % bucketCount].items.push(i));
+    buckets.sort((x, y) => y.items.length - x.items.length || x.index - y.index);
+
+    const seeds = new Array(bucketCount).fill(0);
+    const slots = new Array(Math.max(1, n)).fill(-1);
+    let b = 0;
+    for (; b < bucketCount && buckets[b].items.length > 1; b++) {
+        const items = buckets[b].items;
+        const keys = items.map(i => signatures[i]);
+        // 相同的签名对任何seed都会冲突
+        const duplicated = keys.filter((key, j) => keys.indexOf(key) != j);
+        if (duplicated.length > 0) {
+            throw new Error(`perfect hash: duplicated signatures: ${duplicated.join(', ')}`);
+        }
+        let found = false;
+        for (let seed = 1; seed <= MAX_SEED_ATTEMPTS; seed++) {
+            const used = [];
+            for (const i of items) {
+                const slot = signatureHash(seed, signatures[i]) % n;
+                if (slots[slot] != -1 || used.indexOf(slot) != -1) break;
+                used.push(slot);
+            }
+            if (used.length == items.length) {
+                items.forEach((i, j) => slots[used[j]] = i);
+                seeds[buckets[b].index] = seed;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            throw new Error(`perfect hash: no seed in ${MAX_SEED_ATTEMPTS} attempts places signatures: ${keys.join(', ')}`);
+        }
+    }
+    let free = 0;
+    for (; b < bucketCount && buckets[b].items.length == 1; b++) {
+        while (slots[free] != -1) free++;
+        slots[free] = buckets[b].items[0];
+        seeds[buckets[b].index] = -(free + 1);
+    }
+    return { seeds, slots };
+}
+
+// 和Puerts.cpp里的查找一致，返回签名在数组里的下标，不在表里时返回-1
+export function perfectHashLookup(table, signatures, signature) {
+    const n = signatures.length;
+    if (n == 0) return -1;
+    const seed = table.seeds[signatureHash(0, signature) % table.seeds.length];
+    const index = table.slots[seed < 0 ? -seed - 1 : signatureHash(seed, signature) % n];
+    return signatures[index] === signature ? index : -1;
+}
@@ -226,15 +226,28 @@ void SetGlobalType_TypedValue(Il2CppReflectionType *type)
     g_typeofTypedValue = il2cpp_codegen_class_from_type(type->type);
 }
 
+static puerts::UnityExports g_unityExports;
+
 static void MethodCallback(pesapi_callback_info info) {
     try 
     {
         WrapData** wrapDatas = (WrapData**)pesapi_get_userdata(info);
         bool checkArgument = *wrapDatas && *(wrapDatas + 1);
+#ifdef PUERTS_CALL_STATISTICS
+        // 重载匹配的耗时也算在最终命中的那个重载上
+        // 返回0表示这次调用没被采样，只计数
+        uint64_t startTicks = g_unityExports.CallStatisticsStart ? g_unityExports.CallStatisticsStart() : 0;
+#endif
         while(*wrapDatas)
         {
             if ((*wrapDatas)->Wrap((*wrapDatas)->Method, (*wrapDatas)->MethodPointer, info, checkArgument, *wrapDatas))
             {
+#ifdef PUERTS_CALL_STATISTICS
+                if ((*wrapDatas)->Statistics)
+                {
+                    g_unityExports.RecordCallStatistics((*wrapDatas)->Statistics, startTicks);
+                }
+#endif
                 return;
             }
             ++wrapDatas;
@@ -334,8 +347,6 @@ void* GetDefaultValuePtr(const MethodInfo* method, uint32_t index)
 
 static void* CtorCallback(pesapi_callback_info info);
 
-static puerts::UnityExports g_unityExports;
-
 static void* CtorCallback(pesapi_callback_info info)
 {
     JsClassInfoHeader* classInfo = reinterpret_cast<JsClassInfoHeader*>(pesapi_get_constructor_userdata(info));
@@ -7,8 +7,12 @@
  */
 
 #pragma once
+
 namespace puerts
 {
+// 定义在unreal/Puerts/Source/JsEnv/Private/CallStatistics.h，il2cpp侧只持有指针，计时和记录都通过插件导出的函数完成
+struct CallStatisticsEntry;
+
 #if defined(USE_OUTSIZE_UNITY)
 
 typedef void (*MethodPointer)();
@@ -140,6 +144,10 @@ typedef void* (*GetRuntimeObjectFromPersistentObjectFunc)(pesapi_env env, pesapi
 
 typedef void (*SetRuntimeObjectToPersistentObjectFunc)(pesapi_env env, pesapi_value pvalue, void* runtimeObject);
 
+typedef uint64_t (*CallStatisticsStartFunc)();
+
+typedef void (*RecordCallStatisticsFunc)(CallStatisticsEntry* entry, uint64_t startTicks);
+
 struct WrapData 
 {
     WrapFuncPtr Wrap;
@@ -149,6 +157,7 @@ struct WrapData
     bool IsExtensionMethod;
     bool HasParamArray;
     int OptionalNum;
+    CallStatisticsEntry* Statistics; // 插件未开启PUERTS_CALL_STATISTICS时为nullptr
     void* TypeInfos[0];
 };
 
@@ -212,6 +221,10 @@ struct UnityExports
 
     GetRuntimeObjectFromPersistentObjectFunc GetRuntimeObjectFromPersistentObject = nullptr;
     SetRuntimeObjectToPersistentObjectFunc SetRuntimeObjectToPersistentObject = nullptr;
+
+    // 插件未开启PUERTS_CALL_STATISTICS时为nullptr
+    CallStatisticsStartFunc CallStatisticsStart = nullptr;
+    RecordCallStatisticsFunc RecordCallStatistics = nullptr;
 };
 
 }
\ No newline at end of file
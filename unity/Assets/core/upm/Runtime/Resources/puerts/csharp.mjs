@@ -108,8 +108,21 @@ global.CS = csharpModule;
 
 csharpModule.System.Object.prototype.toString = csharpModule.System.Object.prototype.ToString;
 
+// il2cpp插件提供原生的引用单元，C++读写时不走属性查找；r[0]通过原型上的访问器继续可用。其他后端仍然用数组
+let RefCell = global.__puertsRefCell;
+global.__puertsRefCell = undefined;
+if (RefCell) {
+    Object.defineProperty(RefCell.prototype, 0, {
+        get: function() { return RefCell.get(this); },
+        set: function(val) { RefCell.set(this, val); }
+    });
+    // 和原来$ref返回的单元素数组一样可以取length、展开和解构
+    Object.defineProperty(RefCell.prototype, 'length', { get: function() { return 1; } });
+    RefCell.prototype[Symbol.iterator] = function* () { yield RefCell.get(this); };
+}
+
 function ref(x) {
-    return [x];
+    return RefCell ? new RefCell(x) : [x];
 }
 
 function unref(r) {
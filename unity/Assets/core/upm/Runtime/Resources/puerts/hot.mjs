@@ -0,0 +1,83 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+var global = global || globalThis || (function () { return this; }());
+let puer = global.puer = global.puerts = global.puer || global.puerts || {};
+
+const invalidateModules = global.__puer_invalidate_modules__;
+delete global.__puer_invalidate_modules__;
+const executeModule = global.__puer_execute_module_sync__;
+
+// 当前这份模块实例的import.meta.hot，key是resolve后的路径
+const records = Object.create(null);
+// import.meta.hot.data，跨越重新加载保留
+const moduleData = Object.create(null);
+
+function createHotContext(path) {
+    const data = moduleData[path] || (moduleData[path] = {});
+    const record = { acceptCallbacks: [], disposeCallbacks: [], selfAccepted: false };
+    records[path] = record;
+    return {
+        data: data,
+        // 接受自己的更新：重新执行的范围到此为止，importer不受影响，回调参数是新的module namespace
+        accept(callback) {
+            record.selfAccepted = true;
+            if (typeof callback === 'function') {
+                record.acceptCallbacks.push(callback);
+            }
+        },
+        // 本模块失效时调用，用来清理定时器、事件监听等副作用，可以往data里放东西留给新的实例
+        dispose(callback) {
+            if (typeof callback !== 'function') {
+                throw new Error('dispose expect a function');
+            }
+            record.disposeCallbacks.push(callback);
+        },
+    };
+}
+
+// specifiers可以是数组，也可以是'\n'分隔的字符串（方便C#调用），返回失效并重新执行过的模块路径
+export function reloadModules(specifiers) {
+    if (!invalidateModules) {
+        throw new Error('hot reload is not supported by this plugin');
+    }
+    if (typeof specifiers === 'string') {
+        specifiers = specifiers.split('\n').filter(s => s.length > 0);
+    }
+    const changed = specifiers.map(s => global.__puer_resolve_module_url__(s, ''));
+    const accepted = Object.keys(records).filter(path => records[path].selfAccepted);
+
+    const result = invalidateModules(changed, accepted);
+
+    const previous = Object.create(null);
+    for (const path of result.invalidated) {
+        const record = records[path];
+        if (record) {
+            delete records[path];
+            previous[path] = record;
+            for (const callback of record.disposeCallbacks) {
+                callback(moduleData[path]);
+            }
+        }
+    }
+    // 失效但不是边界的模块会在边界重新执行时作为依赖被重新加载
+    for (const path of result.boundaries) {
+        const ns = executeModule(path);
+        const record = previous[path];
+        if (record) {
+            for (const callback of record.acceptCallbacks) {
+                callback(ns);
+            }
+        }
+    }
+    return result.invalidated;
+}
+
+if (invalidateModules) {
+    global.__puer_create_hot_context__ = createHotContext;
+    puer.hot = { reloadModules };
+}
@@ -26,6 +26,9 @@ delete global.__tgjsEvalScript;
 puer.getLastException = global.__puertsGetLastException
 delete global.__puertsGetLastException;
 
+puer.getMessagePort = global.__puertsGetMessagePort;
+delete global.__puertsGetMessagePort;
+
 let loader = global.__tgjsGetLoader();
 delete global.__tgjsGetLoader;
 
@@ -5,9 +5,43 @@
 * This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
 */
 
+using System.Runtime.InteropServices;
 
 namespace Puerts
 {
+    public enum GcPauseKind
+    {
+        Minor = 0,          // scavenge
+        Major = 1,          // full mark compact
+        Incremental = 2,    // incremental marking steps and weak callback processing
+        All = 3,
+    }
+
+    // same values as v8::MemoryPressureLevel
+    public enum MemoryPressureLevel
+    {
+        None = 0,
+        Moderate = 1,
+        Critical = 2,
+    }
+
+    // 布局和native的puerts::GcPauseStatistics一致
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GcPauseStatistics
+    {
+        public const int HistogramBuckets = 20;
+
+        public ulong Count;
+
+        public ulong TotalMicroseconds;
+
+        public ulong MaxMicroseconds;
+
+        // Histogram[i]是时长在[2^i, 2^(i+1))微秒的停顿次数，最后一个包含所有更长的停顿
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = HistogramBuckets)]
+        public ulong[] Histogram;
+    }
+
     public class Backend
     {
         protected JsEnv env;
@@ -51,6 +85,66 @@ namespace Puerts
 #endif
         }
 
+        // give the remaining time of this frame to the gc, call it at the end of the frame with e.g. targetFrameTime - elapsed.
+        // budgets under 1ms are ignored. returns true if v8 has no more idle-time gc work to do
+        public bool GcIdleNotification(double budgetSeconds)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.GcIdleNotification(env.isolate, budgetSeconds) != 0;
+#else
+            return PuertsIl2cpp.NativeAPI.GcIdleNotification(env.nativeJsEnv, budgetSeconds) != 0;
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // JsEnv already forwards Application.lowMemory as Critical, call this for other platform signals. can be called from any thread
+        public void MemoryPressureNotification(MemoryPressureLevel level)
+        {
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            PuertsDLL.MemoryPressureNotification(env.isolate, (int)level);
+#else
+            PuertsIl2cpp.NativeAPI.MemoryPressureNotification(env.nativeJsEnv, (int)level);
+#endif
+        }
+
+        // gc pause times recorded since the env was created or ResetGcStatistics was called
+        public GcPauseStatistics GetGcStatistics(GcPauseKind kind = GcPauseKind.All)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+            GcPauseStatistics statistics;
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            PuertsDLL.GetGcStatistics(env.isolate, (int)kind, out statistics);
+#else
+            PuertsIl2cpp.NativeAPI.GetGcStatistics(env.nativeJsEnv, (int)kind, out statistics);
+#endif
+            return statistics;
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        public void ResetGcStatistics()
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            PuertsDLL.ResetGcStatistics(env.isolate);
+#else
+            PuertsIl2cpp.NativeAPI.ResetGcStatistics(env.nativeJsEnv);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
         public void RequestMinorGarbageCollectionForTesting()
         {
 #if THREAD_SAFE
@@ -72,6 +166,86 @@ namespace Puerts
 #if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
             PuertsDLL.RequestFullGarbageCollectionForTesting(env.isolate);
 #endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // start a cpu profile, samplingIntervalUs <= 0 means the v8 default interval
+        public bool StartCpuProfile(int samplingIntervalUs = 0)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.StartCpuProfile(env.isolate, samplingIntervalUs);
+#else
+            return PuertsIl2cpp.NativeAPI.StartCpuProfile(env.nativeJsEnv, samplingIntervalUs);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // stop the running cpu profile and write it to path, the .cpuprofile file can be loaded by Chrome DevTools
+        public bool StopCpuProfile(string path)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.StopCpuProfile(env.isolate, path);
+#else
+            return PuertsIl2cpp.NativeAPI.StopCpuProfile(env.nativeJsEnv, path);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // write a .heapsnapshot file to path
+        public bool TakeHeapSnapshot(string path)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.TakeHeapSnapshot(env.isolate, path);
+#else
+            return PuertsIl2cpp.NativeAPI.TakeHeapSnapshot(env.nativeJsEnv, path);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // sampleInterval is the average bytes between samples, 0 means the v8 default
+        public bool StartSamplingHeapProfiler(ulong sampleInterval = 0, int stackDepth = 0)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.StartSamplingHeapProfiler(env.isolate, sampleInterval, stackDepth);
+#else
+            return PuertsIl2cpp.NativeAPI.StartSamplingHeapProfiler(env.nativeJsEnv, sampleInterval, stackDepth);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // stop the sampling heap profiler and write a .heapprofile file to path
+        public bool StopSamplingHeapProfiler(string path)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.StopSamplingHeapProfiler(env.isolate, path);
+#else
+            return PuertsIl2cpp.NativeAPI.StopSamplingHeapProfiler(env.nativeJsEnv, path);
+#endif
 #if THREAD_SAFE
             }
 #endif
@@ -84,6 +258,55 @@ namespace Puerts
         public BackendNodeJS(JsEnv env) : base(env)
         {
         }
+
+        // epoll fd on linux, kqueue fd on mac, -1 on windows. a dedicated server can watch it in its own event loop and only Tick when it is readable
+        public int GetUvBackendFd()
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.GetUvBackendFd(env.isolate);
+#else
+            return PuertsIl2cpp.NativeAPI.GetUvBackendFd(env.nativeJsEnv);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // milliseconds until the next libuv timer fires, 0 means Tick has work to do now, -1 means no timer is pending
+        public int GetUvNextTimeout()
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.GetUvNextTimeout(env.isolate);
+#else
+            return PuertsIl2cpp.NativeAPI.GetUvNextTimeout(env.nativeJsEnv);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // block until libuv has work to do or maxWaitMs elapsed (maxWaitMs < 0 waits for the next timer only), returns true if Tick should be called.
+        // must not be called while another thread is using the JsEnv
+        public bool WaitUvEvents(int maxWaitMs)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+#if !EXPERIMENTAL_IL2CPP_PUERTS || !ENABLE_IL2CPP
+            return PuertsDLL.WaitUvEvents(env.isolate, maxWaitMs);
+#else
+            return PuertsIl2cpp.NativeAPI.WaitUvEvents(env.nativeJsEnv, maxWaitMs);
+#endif
+#if THREAD_SAFE
+            }
+#endif
+        }
     }
 
     public class BackendQuickJS : Backend
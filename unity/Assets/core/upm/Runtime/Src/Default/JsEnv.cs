@@ -56,6 +56,10 @@ namespace Puerts
         public Backend Backend;
 
         private Func<string, JSObject> moduleExecuter;
+        // CreateContext创建的context各自的__puer_execute_module_sync__，主context用moduleExecuter
+        private Dictionary<int, Func<string, JSObject>> contextModuleExecuters = new Dictionary<int, Func<string, JSObject>>();
+        private int currentContextId = 0;
+        private Action<string> moduleReloader;
         private delegate T JSOGetter<T>(JSObject jso, string s);
 
 #if UNITY_EDITOR
@@ -86,9 +90,20 @@ namespace Puerts
         {
         }
 
+        // maxYoungGenerationSizeMB/maxOldGenerationSizeMB limit the v8 heap of this env, 0 means the v8 default. ignored by quickjs
+        public JsEnv(ILoader loader, int debugPort, uint maxYoungGenerationSizeMB, uint maxOldGenerationSizeMB)
+            : this(loader, debugPort, IntPtr.Zero, IntPtr.Zero, maxYoungGenerationSizeMB, maxOldGenerationSizeMB)
+        {
+        }
+
         public JsEnv(ILoader loader, int debugPort, IntPtr externalRuntime, IntPtr externalContext)
+            : this(loader, debugPort, externalRuntime, externalContext, 0, 0)
+        {
+        }
+
+        private JsEnv(ILoader loader, int debugPort, IntPtr externalRuntime, IntPtr externalContext, uint maxYoungGenerationSizeMB, uint maxOldGenerationSizeMB)
         {
-            const int libVersionExpect = 31;
+            const int libVersionExpect = 35;
             int libVersion = PuertsDLL.GetApiLevel();
             if (libVersion != libVersionExpect)
             {
@@ -102,6 +117,10 @@ namespace Puerts
             {
                 isolate = PuertsDLL.CreateJSEngineWithExternalEnv(externalRuntime, externalContext);
             }
+            else if (maxYoungGenerationSizeMB > 0 || maxOldGenerationSizeMB > 0)
+            {
+                isolate = PuertsDLL.CreateJSEngineWithResourceConstraints(maxYoungGenerationSizeMB, maxOldGenerationSizeMB);
+            }
             else
             {
                 isolate = PuertsDLL.CreateJSEngine();
@@ -128,6 +147,13 @@ namespace Puerts
                     Idx = jsEnvs.Count;
                     jsEnvs.Add(this);
                 }
+#if !PUERTS_GENERAL
+                if (!lowMemoryHooked)
+                {
+                    UnityEngine.Application.lowMemory += OnLowMemory;
+                    lowMemoryHooked = true;
+                }
+#endif
             }
 
             objectPool = new ObjectPool();
@@ -222,6 +248,7 @@ namespace Puerts
                 ExecuteModule("puerts/log.mjs");
                 ExecuteModule("puerts/csharp.mjs");
                 ExecuteModule("puerts/events.mjs");
+                ExecuteModule("puerts/hot.mjs");
                 
                 if (externalContext == IntPtr.Zero || externalRuntime == IntPtr.Zero) 
                 {
@@ -300,13 +327,37 @@ namespace Puerts
             if (exportee == "" && typeof(T) != typeof(JSObject)) {
                 throw new Exception("T must be Puerts.JSObject when getting the module namespace");
             }
-            JSObject jso = moduleExecuter(specifier);
+            JSObject jso = CurrentModuleExecuter()(specifier);
             JSOGetter<T> getter = Eval<JSOGetter<T>>("(function (jso, str) { return jso[str]; });");
             return getter(jso, exportee);
         }
         public JSObject ExecuteModule(string specifier)
         {
-            return moduleExecuter(specifier);
+            return CurrentModuleExecuter()(specifier);
+        }
+
+        // 在后台线程预取模块及其静态依赖，不阻塞，结果在之后的Tick里完成编译，之后ExecuteModule时直接使用。
+        // 返回是否还有没完成的预取，可以每帧调用直到返回false；后端不支持时什么都不做，返回false
+        public bool PrefetchModule(string specifier)
+        {
+            return Eval<Func<string, bool>>("(function(s) { return typeof __puer_prefetch_module__ === 'function' ? __puer_prefetch_module__(s) : false; })")(specifier);
+        }
+
+        // 函数调用时进入的是函数自己所属的context，所以每个context要用自己的__puer_execute_module_sync__
+        private Func<string, JSObject> CurrentModuleExecuter()
+        {
+            return currentContextId == 0 ? moduleExecuter : contextModuleExecuters[currentContextId];
+        }
+
+        // 重新加载改动过的模块：只有它们以及依赖它们的模块会失效并重新执行，import.meta.hot.accept()过的模块是传播的边界。
+        // 参数是改动过的模块的specifier，见puerts/hot.mjs
+        public void ReloadModules(params string[] specifiers)
+        {
+            if (moduleReloader == null)
+            {
+                moduleReloader = ExecuteModule<Action<string>>("puerts/hot.mjs", "reloadModules");
+            }
+            moduleReloader(string.Join("\n", specifiers));
         }
 
         public void Eval(string chunk, string chunkName = "chunk")
@@ -355,6 +406,69 @@ namespace Puerts
             PuertsDLL.ClearModuleCache(isolate, "");
         }
 
+        // 建一个双向的channel，两端在js里分别用puer.getMessagePort(name)、other里的puer.getMessagePort(otherName)拿到。
+        // 消息按结构化克隆序列化，不经过C#，在收方的Tick里交给onmessage；other可以是自己，C#对象只能在同一个JsEnv里按引用传递
+        public void ConnectMessagePort(string name, JsEnv other, string otherName, int capacity = 1024)
+        {
+            if (other == this && name == otherName)
+            {
+                throw new ArgumentException("the two ports of the same JsEnv need different names");
+            }
+            PuertsDLL.ConnectMessagePorts(isolate, name, other.isolate, otherName, capacity);
+        }
+
+        // 在同一个isolate上再建一个隔离的context，返回它的id，主context的id是0。新context里只有标准内置对象和Eval/ExecuteModule需要的函数，
+        // 没有puer、CS等绑定；securityToken相同的context之间可以互相访问对象。freezeIntrinsics为true时冻结新context的内置对象和它们的原型
+        public int CreateContext(string securityToken = null, bool freezeIntrinsics = false)
+        {
+#if THREAD_SAFE
+            lock(this) {
+#endif
+            int contextId = PuertsDLL.CreateContext(isolate, securityToken, freezeIntrinsics ? 1 : 0);
+            if (contextId < 0)
+            {
+                string exceptionInfo = PuertsDLL.GetLastExceptionInfo(isolate);
+                throw new Exception(exceptionInfo);
+            }
+            PuertsDLL.EnterContext(isolate, contextId);
+            try
+            {
+                contextModuleExecuters[contextId] = Eval<Func<string, JSObject>>("__puer_execute_module_sync__");
+            }
+            finally
+            {
+                PuertsDLL.EnterContext(isolate, currentContextId);
+            }
+            return contextId;
+#if THREAD_SAFE
+            }
+#endif
+        }
+
+        // 之后的Eval、ExecuteModule都在这个context里执行，传0切回主context
+        public void EnterContext(int contextId)
+        {
+            if (PuertsDLL.EnterContext(isolate, contextId) == 0)
+            {
+                throw new ArgumentException("invalid context id: " + contextId);
+            }
+            currentContextId = contextId;
+        }
+
+        // 销毁前如果正处于这个context，会切回主context
+        public void DestroyContext(int contextId)
+        {
+            if (PuertsDLL.DestroyContext(isolate, contextId) == 0)
+            {
+                throw new ArgumentException("invalid context id: " + contextId);
+            }
+            contextModuleExecuters.Remove(contextId);
+            if (currentContextId == contextId)
+            {
+                currentContextId = 0;
+            }
+        }
+
         public static void ClearAllModuleCaches () 
         {
             lock (jsEnvs)
@@ -389,6 +503,21 @@ namespace Puerts
 #endif
         }
 
+        // install instance methods and properties of types registered after this call on first access instead of at
+        // registration, so startup cost scales with the members actually used. static members are still installed eagerly.
+        // ignored by the quickjs backend
+        public void SetLazyMemberInstallation(bool enable)
+        {
+#if THREAD_SAFE
+            lock (this)
+            {
+#endif
+            PuertsDLL.SetLazyMemberInstallation(isolate, enable);
+#if THREAD_SAFE
+            }
+#endif
+        }
+
         private readonly List<JSFunctionCallback> callbacks = new List<JSFunctionCallback>();
 
         internal void InvokeCallback(IntPtr isolate, int callbackIdx, IntPtr info, IntPtr self, int paramLen)
@@ -801,6 +930,25 @@ namespace Puerts
 
         private bool disposed = false;
 
+#if !PUERTS_GENERAL
+        private static bool lowMemoryHooked = false;
+
+        // 静态处理函数，事件不会引用具体的JsEnv，不影响没Dispose的JsEnv被GC回收
+        private static void OnLowMemory()
+        {
+            lock (jsEnvs)
+            {
+                for (int i = 0; i < jsEnvs.Count; i++)
+                {
+                    if (jsEnvs[i] != null)
+                    {
+                        PuertsDLL.MemoryPressureNotification(jsEnvs[i].isolate, (int)MemoryPressureLevel.Critical);
+                    }
+                }
+            }
+        }
+#endif
+
         protected virtual void Dispose(bool dispose)
         {
             lock (jsEnvs)
@@ -104,6 +104,9 @@ namespace Puerts
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr CreateJSEngineWithExternalEnv(IntPtr externalRuntime, IntPtr externalContext);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr CreateJSEngineWithResourceConstraints(uint maxYoungGenerationSizeMB, uint maxOldGenerationSizeMB);
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void DestroyJSEngine(IntPtr isolate);
 
@@ -172,6 +175,18 @@ namespace Puerts
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern bool IdleNotificationDeadline(IntPtr isolate, double DeadlineInSeconds);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GcIdleNotification(IntPtr isolate, double budgetSeconds);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MemoryPressureNotification(IntPtr isolate, int level);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetGcStatistics(IntPtr isolate, int kind, out GcPauseStatistics statistics);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ResetGcStatistics(IntPtr isolate);
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void RequestMinorGarbageCollectionForTesting(IntPtr isolate);
 
@@ -190,12 +205,27 @@ namespace Puerts
             SetGeneralDestructor(isolate, fn);
         }
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetLazyMemberInstallation(IntPtr isolate, bool enable);
+
         // [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         // public static extern IntPtr ExecuteModule(IntPtr isolate, string path, string exportee);
 
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern bool ClearModuleCache(IntPtr isolate, string path);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ConnectMessagePorts(IntPtr isolateA, string nameA, IntPtr isolateB, string nameB, int capacity);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateContext(IntPtr isolate, string securityToken, int freezeIntrinsics);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int EnterContext(IntPtr isolate, int contextId);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int DestroyContext(IntPtr isolate, int contextId);
+
 #if PUERTS_GENERAL && !PUERTS_GENERAL_OSX
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr Eval(IntPtr isolate, byte[] code, string path);
@@ -586,6 +616,30 @@ namespace Puerts
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void LogicTick(IntPtr isolate);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetUvBackendFd(IntPtr isolate);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetUvNextTimeout(IntPtr isolate);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool WaitUvEvents(IntPtr isolate, int maxWaitMs);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StartCpuProfile(IntPtr isolate, int samplingIntervalUs);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StopCpuProfile(IntPtr isolate, string path);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool TakeHeapSnapshot(IntPtr isolate, string path);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StartSamplingHeapProfiler(IntPtr isolate, ulong sampleInterval, int stackDepth);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StopSamplingHeapProfiler(IntPtr isolate, string path);
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void SetLogCallback(IntPtr log, IntPtr logWarning, IntPtr logError);
 
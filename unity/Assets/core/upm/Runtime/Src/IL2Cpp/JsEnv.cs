@@ -8,6 +8,7 @@
 #if EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP
 
 using System;
+using System.Collections.Generic;
 using System.Reflection;
 #if CSHARP_7_3_OR_NEWER
 using System.Threading.Tasks;
@@ -19,7 +20,7 @@ namespace Puerts
     [UnityEngine.Scripting.Preserve]
     public class JsEnv : IDisposable
     {
-        IntPtr nativeJsEnv;
+        internal IntPtr nativeJsEnv;
         IntPtr nativePesapiEnv;
 
         // TypeRegister TypeRegister;
@@ -32,6 +33,7 @@ namespace Puerts
         PuertsIl2cpp.ObjectPool objectPool = new PuertsIl2cpp.ObjectPool();
 
         private Func<string, JSObject> moduleExecuter;
+        private Action<string> moduleReloader;
         private delegate T JSOGetter<T>(JSObject jso, string s);
 
         ILoader loader;
@@ -54,7 +56,10 @@ namespace Puerts
 
         public JsEnv(): this(new DefaultLoader(), -1) {}
 
-        public JsEnv(ILoader loader, int debugPort = -1)
+        public JsEnv(ILoader loader, int debugPort = -1): this(loader, debugPort, 0, 0) {}
+
+        // maxYoungGenerationSizeMB/maxOldGenerationSizeMB limit the v8 heap of this env, 0 means the v8 default
+        public JsEnv(ILoader loader, int debugPort, uint maxYoungGenerationSizeMB, uint maxOldGenerationSizeMB)
         {
             this.loader = loader;
 
@@ -70,7 +75,23 @@ namespace Puerts
             PuertsIl2cpp.NativeAPI.SetGlobalType_ArrayBuffer(typeof(ArrayBuffer));
             PuertsIl2cpp.NativeAPI.SetGlobalType_JSObject(typeof(JSObject));
 
-            nativeJsEnv = PuertsIl2cpp.NativeAPI.CreateNativeJSEnv();
+            if (maxYoungGenerationSizeMB > 0 || maxOldGenerationSizeMB > 0)
+            {
+                nativeJsEnv = PuertsIl2cpp.NativeAPI.CreateNativeJSEnvWithResourceConstraints(maxYoungGenerationSizeMB, maxOldGenerationSizeMB);
+            }
+            else
+            {
+                nativeJsEnv = PuertsIl2cpp.NativeAPI.CreateNativeJSEnv();
+            }
+            lock (liveNativeJsEnvs)
+            {
+                liveNativeJsEnvs.Add(nativeJsEnv);
+                if (!lowMemoryHooked)
+                {
+                    UnityEngine.Application.lowMemory += OnLowMemory;
+                    lowMemoryHooked = true;
+                }
+            }
             nativePesapiEnv = PuertsIl2cpp.NativeAPI.GetPesapiEnvHolder(nativeJsEnv);
 
             //PuertsIl2cpp.NativeAPI.SetObjectPool(objectPool, typeof(PuertsIl2cpp.ObjectPool).GetMethod("Add")); //TODO: remove....
@@ -153,6 +174,7 @@ namespace Puerts
             ExecuteModule("puerts/csharp.mjs");
             
             ExecuteModule("puerts/events.mjs");
+            ExecuteModule("puerts/hot.mjs");
             ExecuteModule("puerts/timer.mjs");
             ExecuteModule("puerts/promises.mjs");
 
@@ -207,6 +229,53 @@ namespace Puerts
             return moduleExecuter(specifier);
         }
 
+        // 重新加载改动过的模块：只有它们以及依赖它们的模块会失效并重新执行，import.meta.hot.accept()过的模块是传播的边界。
+        // 参数是改动过的模块的specifier，见puerts/hot.mjs
+        public void ReloadModules(params string[] specifiers)
+        {
+            if (moduleReloader == null)
+            {
+                moduleReloader = ExecuteModule<Action<string>>("puerts/hot.mjs", "reloadModules");
+            }
+            moduleReloader(string.Join("\n", specifiers));
+        }
+
+        // max number of js objects released by each Tick after their C# delegates were collected, <= 0 means no limit (the default).
+        // the rest is released by the following Ticks
+        public int PendingReleaseBudget
+        {
+            set
+            {
+                PuertsIl2cpp.NativeAPI.SetPendingReleaseBudget(nativeJsEnv, value);
+            }
+        }
+
+        // number of js objects waiting to be released, readable from any thread
+        public int PendingReleaseBacklog
+        {
+            get
+            {
+                return PuertsIl2cpp.NativeAPI.GetPendingReleaseBacklog(nativeJsEnv);
+            }
+        }
+
+        // install instance methods and properties of types loaded after this is set on first access instead of when the
+        // type is loaded, so startup cost scales with the members actually used. static members are still installed eagerly
+        public bool LazyMemberInstallation
+        {
+            set
+            {
+                PuertsIl2cpp.NativeAPI.SetLazyMemberInstallation(nativeJsEnv, value);
+            }
+        }
+
+        // the same js function converted to the same delegate type returns the cached delegate instance,
+        // size is the number of (function, delegate type) pairs currently cached
+        public void GetDelegateCacheStats(out long hits, out long misses, out int size)
+        {
+            PuertsIl2cpp.NativeAPI.GetDelegateCacheStats(nativeJsEnv, out hits, out misses, out size);
+        }
+
         public Action TickHandler;
         public void Tick()
         {
@@ -250,11 +319,30 @@ namespace Puerts
 
         private bool disposed = false;
 
+        // 只记录native指针，lowMemory事件不会引用具体的JsEnv，不影响没Dispose的JsEnv被GC回收
+        private static readonly List<IntPtr> liveNativeJsEnvs = new List<IntPtr>();
+        private static bool lowMemoryHooked = false;
+
+        private static void OnLowMemory()
+        {
+            lock (liveNativeJsEnvs)
+            {
+                for (int i = 0; i < liveNativeJsEnvs.Count; i++)
+                {
+                    PuertsIl2cpp.NativeAPI.MemoryPressureNotification(liveNativeJsEnvs[i], (int)MemoryPressureLevel.Critical);
+                }
+            }
+        }
+
         protected virtual void Dispose(bool dispose)
         {
             lock (this)
             {
                 if (disposed) return;
+                lock (liveNativeJsEnvs)
+                {
+                    liveNativeJsEnvs.Remove(nativeJsEnv);
+                }
                 // TODO: nativePesapiEnv release
                 PuertsIl2cpp.NativeAPI.DestroyNativeJSEnv(nativeJsEnv);
                 disposed = true;
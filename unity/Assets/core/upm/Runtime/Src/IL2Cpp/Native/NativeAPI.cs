@@ -43,6 +43,9 @@ namespace PuertsIl2cpp
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr CreateNativeJSEnv();
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr CreateNativeJSEnvWithResourceConstraints(uint maxYoungGenerationSizeMB, uint maxOldGenerationSizeMB);
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void DestroyNativeJSEnv(IntPtr jsEnv);
 
@@ -53,7 +56,7 @@ namespace PuertsIl2cpp
         public static extern IntPtr GetPesapiEnvHolder(IntPtr jsEnv);
 
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern IntPtr CreateCSharpTypeInfo(string name, IntPtr type_id, IntPtr super_type_id, IntPtr klass, bool isValueType, bool isDelegate, string delegateSignature);
+        public static extern IntPtr CreateCSharpTypeInfo(string name, IntPtr type_id, IntPtr super_type_id, IntPtr klass, bool isValueType, bool isBlittable, bool isDelegate, string delegateSignature);
 
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void ReleaseCSharpTypeInfo(IntPtr classInfo);
@@ -61,6 +64,9 @@ namespace PuertsIl2cpp
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr FindWrapFunc(string signature);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CheckSignatureLookup();
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr FindFieldWrap(string signature);
 
@@ -94,6 +100,45 @@ namespace PuertsIl2cpp
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void ReleasePendingJsObjects(IntPtr jsEnv);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPendingReleaseBudget(IntPtr jsEnv, int maxPerTick);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetPendingReleaseBacklog(IntPtr jsEnv);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetLazyMemberInstallation(IntPtr jsEnv, bool enable);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetDelegateCacheStats(IntPtr jsEnv, out long hits, out long misses, out int size);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StartCpuProfile(IntPtr jsEnv, int samplingIntervalUs);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StopCpuProfile(IntPtr jsEnv, string path);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool TakeHeapSnapshot(IntPtr jsEnv, string path);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StartSamplingHeapProfiler(IntPtr jsEnv, ulong sampleInterval, int stackDepth);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool StopSamplingHeapProfiler(IntPtr jsEnv, string path);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GcIdleNotification(IntPtr jsEnv, double budgetSeconds);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MemoryPressureNotification(IntPtr jsEnv, int level);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetGcStatistics(IntPtr jsEnv, int kind, out Puerts.GcPauseStatistics statistics);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ResetGcStatistics(IntPtr jsEnv);
+
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void CreateInspector(IntPtr jsEnv, int port);
 
@@ -106,6 +151,15 @@ namespace PuertsIl2cpp
         [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern bool LogicTick(IntPtr jsEnv);
 
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetUvBackendFd(IntPtr jsEnv);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetUvNextTimeout(IntPtr jsEnv);
+
+        [DllImport(DLLNAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool WaitUvEvents(IntPtr jsEnv, int maxWaitMs);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         public static IntPtr GetMethodPointer(MethodBase methodInfo)
         {
@@ -149,6 +149,23 @@ namespace PuertsIl2cpp
             return sb.ToString();
         }
 
+        // 字段签名里没有string、object（s、o、O）说明这个值类型不含托管引用，按值返回时可以放到gc不扫描的内存里
+        public static bool IsBlittableValueType(Type type)
+        {
+            if (!type.IsValueType || type.IsPrimitive || type.IsEnum)
+            {
+                return false;
+            }
+            try
+            {
+                return GetValueTypeFieldsSignature(type).IndexOfAny(new char[] { 's', 'o', 'O' }) < 0;
+            }
+            catch
+            {
+                return false;
+            }
+        }
+
         public static string GetTypeSignature(Type type)
         {
             if (type == typeof(void))
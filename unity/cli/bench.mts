@@ -0,0 +1,53 @@
+import { exec, mkdir } from "@puerts/shell-util";
+import assert from "assert";
+import { existsSync, readFileSync, writeFileSync } from "fs";
+import { join } from "path";
+import downloadBackend from "./backend.mjs";
+import { getBackendCMakeDArgs } from "./make.mjs";
+import type { BuildOptions } from "./make.mjs";
+
+interface BenchOptions {
+    iterations: string,
+    rounds: string,
+    filter: string,
+    output: string
+}
+
+//////////////// bench
+// build the headless harness in native_src/bench once per backend and merge the json reports,
+// so two reports (two commits, or two machines) can be diffed case by case.
+export default async function runBench(cwd: string, backends: string[], benchOptions: BenchOptions) {
+    if (process.platform != 'linux') {
+        console.error("[Puer] bench only supports linux for now");
+        process.exit();
+    }
+    const allBackendConfig = JSON.parse(readFileSync(join(cwd, 'cmake/backends.json'), 'utf-8'));
+    const gitRev = exec('git rev-parse --short HEAD', { silent: true }).stdout.trim();
+
+    const report: any = { commit: gitRev, date: new Date().toISOString(), backends: {} };
+    for (const backend of backends) {
+        const options: BuildOptions = { backend, config: 'Release', platform: 'linux', arch: 'x64' };
+        const BackendConfig = allBackendConfig[backend]?.config;
+        if (!BackendConfig) {
+            throw new Error(`invalid backend: ${backend}`);
+        }
+        if (!existsSync(join(cwd, '.backends', backend))) {
+            await downloadBackend(cwd, backend);
+        }
+
+        const CMAKE_BUILD_PATH = join(cwd, `build_linux_x64_${backend}_bench`);
+        mkdir('-p', CMAKE_BUILD_PATH);
+        assert.equal(0, exec(`cmake ${getBackendCMakeDArgs(BackendConfig, options)} -DJS_ENGINE=${backend} -DCMAKE_BUILD_TYPE=Release -DPUERTS_BUILD_BENCHMARK=ON -H. -B${CMAKE_BUILD_PATH}`).code);
+        assert.equal(0, exec(`cmake --build ${CMAKE_BUILD_PATH} --config Release --target puerts_bench`).code);
+
+        const resultPath = join(CMAKE_BUILD_PATH, 'bench.json');
+        const args = [`--iterations ${benchOptions.iterations}`, `--rounds ${benchOptions.rounds}`, `--output ${resultPath}`];
+        if (benchOptions.filter) args.push(`--filter ${benchOptions.filter}`);
+        assert.equal(0, exec(`${join(CMAKE_BUILD_PATH, 'bench/puerts_bench')} ${args.join(' ')}`).code);
+
+        report.backends[backend] = JSON.parse(readFileSync(resultPath, 'utf-8'));
+    }
+
+    writeFileSync(benchOptions.output, JSON.stringify(report, null, 2));
+    console.log(`[Puer] bench report written to ${benchOptions.output}`);
+}
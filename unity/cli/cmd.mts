@@ -4,6 +4,7 @@ import { join } from "path";
 import downloadBackend from "./backend.mjs";
 import { dotnetTest, unityTest } from "./test.mjs";
 import runPuertsMake, { platformCompileConfig } from "./make.mjs";
+import runBench from "./bench.mjs";
 
 setWinCMDEncodingToUTF8();
 
@@ -140,4 +141,14 @@ program
         unityTest(cwd, options.unity);
     })
 
+program
+    .command("bench [backends...]")
+    .option("--iterations <iterations>", "iterations per round", "200000")
+    .option("--rounds <rounds>", "measured rounds per case", "5")
+    .option("--filter <filter>", "only run the cases whose name contains filter", "")
+    .option("--output <output>", "where the merged json report goes", "bench.json")
+    .action((backends: string[], options: any) => {
+        runBench(cwd, backends.length ? backends : ["v8_9.4", "quickjs", "nodejs_16"], options);
+    });
+
 program.parse(process.argv);
\ No newline at end of file
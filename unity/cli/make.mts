@@ -8,7 +8,7 @@ import { fileURLToPath } from "url";
 
 const glob = createRequire(fileURLToPath(import.meta.url))('glob');
 
-interface BuildOptions {
+export interface BuildOptions {
     config: 'Debug' | 'Release' | "RelWithDebInfo",
     platform: 'osx' | 'win' | 'ios' | 'android' | 'linux',
     arch: 'x64' | 'ia32' | 'armv7' | 'arm64' | 'auto',
@@ -148,6 +148,15 @@ const platformCompileConfig = {
 }
 
 
+function getBackendCMakeDArgs(BackendConfig: any, options: BuildOptions) {
+    const definitionD = (BackendConfig.definition || []).join(';')
+    const linkD = (BackendConfig['link-libraries'][options.platform]?.[options.arch] || []).join(';')
+    const incD = (BackendConfig.include || []).join(';')
+    const DArgsName = ['-DBACKEND_DEFINITIONS=', '-DBACKEND_LIB_NAMES=', '-DBACKEND_INC_NAMES=']
+
+    return [definitionD, linkD, incD].map((r, index) => r ? DArgsName[index] + '"' + r + '"' : null).filter(t => t).join(' ')
+}
+
 /////////////////// make
 async function runPuertsMake(cwd: string, options: BuildOptions) {
     //// 环境与依赖监测 environment and dependencies checking.
@@ -182,19 +191,14 @@ async function runPuertsMake(cwd: string, options: BuildOptions) {
         console.log("=== Puer ===");
         return;
     }
-    const definitionD = (BackendConfig.definition || []).join(';')
-    const linkD = (BackendConfig['link-libraries'][options.platform]?.[options.arch] || []).join(';')
-    const incD = (BackendConfig.include || []).join(';')
-
     mkdir('-p', CMAKE_BUILD_PATH);
     mkdir('-p', OUTPUT_PATH)
-    const DArgsName = ['-DBACKEND_DEFINITIONS=', '-DBACKEND_LIB_NAMES=', '-DBACKEND_INC_NAMES=']
 
     var outputFile = BuildConfig.hook(
         CMAKE_BUILD_PATH,
         options,
         cmakeAddedLibraryName,
-        [definitionD, linkD, incD].map((r, index) => r ? DArgsName[index] + '"' + r + '"' : null).filter(t => t).join(' ')
+        getBackendCMakeDArgs(BackendConfig, options)
     );
     if (!(outputFile instanceof Array)) outputFile = [outputFile];
     const copyConfig = (BackendConfig['copy-libraries'][options.platform]?.[options.arch] || [])
@@ -216,4 +220,4 @@ async function runPuertsMake(cwd: string, options: BuildOptions) {
 }
 
 export default runPuertsMake;
-export { platformCompileConfig }
\ No newline at end of file
+export { platformCompileConfig, getBackendCMakeDArgs }
\ No newline at end of file
@@ -11,15 +11,35 @@
 #pragma warning(pop)
 
 #include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
 #include <algorithm>
 #include "Log.h"
 #include "V8InspectorImpl.h"
+#include "V8ProfilerImpl.h"
 #if WITH_QUICKJS
 #include "quickjs-msvc.h"
 #endif
 
+// 入口模块的依赖在后台线程流式解析，需要支持module的ScriptCompiler::StartStreaming（v8 9.1+），可以定义为0关闭
+#ifndef PUERTS_MODULE_STREAMING
+#if !WITH_QUICKJS && (V8_MAJOR_VERSION > 9 || (V8_MAJOR_VERSION == 9 && V8_MINOR_VERSION >= 1))
+#define PUERTS_MODULE_STREAMING 1
+#else
+#define PUERTS_MODULE_STREAMING 0
+#endif
+#endif
+
 namespace puerts
 {
+#if PUERTS_MODULE_STREAMING
+    struct FModulePrefetch;
+
+    class FModuleStreamingWorkers;
+#endif
+
     class BackendEnv 
     {
     public:
@@ -30,6 +50,7 @@ namespace puerts
         BackendEnv()
         {
             Inspector = nullptr;
+            Profiler = nullptr;
         } 
 
         // Module
@@ -39,6 +60,35 @@ namespace puerts
         std::map<std::string, v8::UniquePersistent<v8::Module>> PathToModuleMap;
 #endif
         std::map<int, std::string> ScriptIdToPathMap;
+#if PUERTS_MODULE_STREAMING
+        // 预取编译好但还没被_ResolveModule请求过的模块
+        std::map<std::string, v8::UniquePersistent<v8::Module>> PrefetchedModules;
+
+        // 后台解析中的预取，TickModulePrefetch在主线程完成编译
+        std::vector<std::shared_ptr<FModulePrefetch>> ModulePrefetches;
+
+        std::shared_ptr<FModuleStreamingWorkers> StreamingWorkers;
+
+        void StartModulePrefetch(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::String> Specifier, v8::Local<v8::String> Referrer);
+
+        bool HasModulePrefetch() const
+        {
+            return !ModulePrefetches.empty();
+        }
+
+        // 宿主每帧调用（见JSEngine::LogicTick），需要已经进入isolate和Context
+        void TickModulePrefetch(v8::Isolate* Isolate, v8::Local<v8::Context> Context);
+
+        // 停掉后台线程并释放所有预取结果，销毁isolate或context之前在isolate里调用
+        void CancelModulePrefetch();
+
+        // Path为空表示全部
+        void DiscardModulePrefetch(const std::string& Path);
+#endif
+
+        // 模块依赖图，resolve import时记录，key和PathToModuleMap一样是resolve后的路径
+        std::map<std::string, std::set<std::string>> ModuleImporters;    // importee -> importers
+        std::map<std::string, std::set<std::string>> ModuleImports;      // importer -> importees
 
         // PromiseCallback
         v8::UniquePersistent<v8::Function> JsPromiseRejectCallback;
@@ -46,10 +96,31 @@ namespace puerts
         // Inspector
         V8Inspector* Inspector;
 
+        // Profiler, created on first use
+        V8Profiler* Profiler;
+
         V8_INLINE static BackendEnv* Get(v8::Isolate* Isolate)
         {
             return (BackendEnv*)Isolate->GetData(1);
         }
+
+        // 模块表按context区分：JSEngine::CreateContext创建的context登记在ContextEnvs里，其它的用isolate上的这份
+        V8_INLINE static BackendEnv* Get(v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+        {
+            BackendEnv* Env = Get(Isolate);
+#if !WITH_QUICKJS
+            for (auto& Item : Env->ContextEnvs)
+            {
+                if (Item.first == Context)
+                {
+                    return Item.second;
+                }
+            }
+#endif
+            return Env;
+        }
+
+        std::vector<std::pair<v8::Global<v8::Context>, BackendEnv*>> ContextEnvs;
         void InitInject(v8::Isolate* Isolate);
         
         void CreateInspector(v8::Isolate* Isolate, const v8::Global<v8::Context>* ContextGlobal, int32_t Port);
@@ -58,7 +129,32 @@ namespace puerts
 
         bool InspectorTick();
 
+        bool StartCpuProfile(v8::Isolate* Isolate, int32_t SamplingIntervalUs);
+
+        bool StopCpuProfile(v8::Isolate* Isolate, const char* Path);
+
+        bool TakeHeapSnapshot(v8::Isolate* Isolate, const char* Path);
+
+        bool StartSamplingHeapProfiler(v8::Isolate* Isolate, uint64_t SampleInterval, int32_t StackDepth);
+
+        bool StopSamplingHeapProfiler(v8::Isolate* Isolate, const char* Path);
+
+        void DestroyProfiler(v8::Isolate* Isolate);
+
         bool ClearModuleCache(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const char* Path);
+
+        void AddModuleEdge(const std::string& Importer, const std::string& Importee);
+
+        // 从Changed出发沿importer向上找出需要失效的模块并移出缓存。Accepted里的模块（import.meta.hot.accept过）以及
+        // 没有importer的模块是边界：自己失效但不再往上传播，重新执行这些边界就能把失效的模块重新加载一遍
+        void InvalidateModules(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const std::vector<std::string>& Changed,
+            const std::set<std::string>& Accepted, std::vector<std::string>& OutInvalidated, std::vector<std::string>& OutBoundaries);
+
+    private:
+        // 删掉Path指向其依赖的边，重新link时会再记录；指向Path的边保留
+        void ForgetModuleImports(const std::string& Path);
+
+        bool RemoveModule(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const std::string& Path);
     };
 
 
@@ -67,6 +163,9 @@ namespace puerts
     {
         void ExecuteModule(const v8::FunctionCallbackInfo<v8::Value>& info);
 
+        // __puer_invalidate_modules__(changed: string[], accepted: string[]): { invalidated: string[], boundaries: string[] }
+        void InvalidateModules(const v8::FunctionCallbackInfo<v8::Value>& info);
+
 #if !WITH_QUICKJS
         v8::MaybeLocal<v8::Module> _ResolveModule(
             v8::Local<v8::Context> Context,
@@ -79,6 +178,11 @@ namespace puerts
 
         bool LinkModule(v8::Local<v8::Context> Context, v8::Local<v8::Module> RefModule);
 
+#if PUERTS_MODULE_STREAMING
+        // __puer_prefetch_module__(specifier)
+        void PrefetchModule(const v8::FunctionCallbackInfo<v8::Value>& info);
+#endif
+
         void HostInitializeImportMetaObject(v8::Local<v8::Context> Context, v8::Local<v8::Module> Module, v8::Local<v8::Object> meta);
 #else 
         JSModuleDef* js_module_loader(JSContext* ctx, const char *name, void *opaque);
@@ -22,12 +22,16 @@
 #include "JSFunction.h"
 #include "V8InspectorImpl.h"
 #include "BackendEnv.h"
+#include "CallStatistics.h"
+#include "GcScheduler.h"
+#include "MessagePort.h"
 
 #if WITH_NODEJS
 #pragma warning(push, 0)
 #include "node.h"
 #include "uv.h"
 #pragma warning(pop)
+#include "UvPump.h"
 #else
 
 #if defined(PLATFORM_WINDOWS)
@@ -74,6 +78,37 @@ struct FCallbackInfo
     bool IsStatic;
     CSharpFunctionCallback Callback;
     int64_t Data;
+#ifdef PUERTS_CALL_STATISTICS
+    CallStatisticsEntry* Statistics = nullptr;
+#endif
+};
+
+// 延迟安装模式下登记的实例成员，第一次被访问时才生成FunctionTemplate和FCallbackInfo
+struct FLazyMember
+{
+    bool IsProperty = false;
+    // MaterializeClass直接装进了模板，所有context里都有
+    bool InTemplate = false;
+    // 已经装到了哪些context的prototype上，主context是0
+    std::vector<int32_t> InstalledContexts;
+    CSharpFunctionCallback Callback = nullptr;    // 方法，或者属性的getter
+    int64_t Data = 0;
+    CSharpFunctionCallback Setter = nullptr;
+    int64_t SetterData = 0;
+};
+
+struct FLazyClassInfo
+{
+    FLazyClassInfo(int InClassID, int InBaseClassID) : ClassID(InClassID), BaseClassID(InBaseClassID) {}
+    int ClassID;
+    int BaseClassID;
+    // 模板第一次实例化前置为true，此后不能再往模板里加东西
+    bool Materialized = false;
+    // 没有装进模板、要等访问时再装的成员数
+    size_t LazyCount = 0;
+    // 所有context加起来还没安装的成员数，整条继承链都为0时拦截器直接返回
+    size_t PendingCount = 0;
+    std::map<std::string, FLazyMember> Members;
 };
 
 struct FLifeCycleInfo
@@ -87,6 +122,23 @@ struct FLifeCycleInfo
     int Size;
 };
 
+// CreateContext创建的context，和主context共享isolate、Templates以及注册的类，
+// 全局对象、模块表、C#对象的包装和JSObjectIdMap各自一份，主context里的对象不会交给它
+struct FContextInfo
+{
+    v8::UniquePersistent<v8::Context> Context;
+
+    std::map<void*, v8::UniquePersistent<v8::Value>> ObjectMap;
+
+    v8::UniquePersistent<v8::Map> JSObjectIdMap;
+
+    // Metadatas在本context里的副本，按需生成
+    std::vector<v8::UniquePersistent<v8::Map>> Metadatas;
+
+    // 只用到其中的模块表，见BackendEnv::Get(Isolate, Context)
+    puerts::BackendEnv ModuleEnv;
+};
+
 static std::unique_ptr<v8::Platform> GPlatform;
 #if defined(WITH_NODEJS)
 static std::vector<std::string>* Args;
@@ -106,13 +158,14 @@ enum JSEngineBackend
 class JSEngine
 {
 private: 
-    void JSEngineWithNode();
-    void JSEngineWithoutNode(void* external_quickjs_runtime, void* external_quickjs_context);
+    void JSEngineWithNode(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB);
+    void JSEngineWithoutNode(void* external_quickjs_runtime, void* external_quickjs_context, uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB);
 #if !WITH_QUICKJS
     static void HostInitializeImportMetaObject(v8::Local<v8::Context> context, v8::Local<v8::Module> module, v8::Local<v8::Object> meta);
 #endif
 public:
-    JSEngine(void* external_quickjs_runtime, void* external_quickjs_context);
+    // MaxYoungGenerationSizeMB/MaxOldGenerationSizeMB为0表示使用v8的默认堆大小，quickjs后端忽略
+    JSEngine(void* external_quickjs_runtime, void* external_quickjs_context, uint32_t MaxYoungGenerationSizeMB = 0, uint32_t MaxOldGenerationSizeMB = 0);
 
     ~JSEngine();
 
@@ -128,13 +181,37 @@ public:
 
     bool RegisterProperty(int ClassID, const char *Name, bool IsStatic, CSharpFunctionCallback Getter, int64_t GetterData, CSharpFunctionCallback Setter, int64_t SetterData, bool DontDelete);
 
+    // 打开后，之后注册的类只登记实例成员，由原型上的拦截器在第一次访问时安装；静态成员仍然立即安装
+    void SetLazyMemberInstallation(bool Enable);
+
+    // 在ClassInfo及其基类里找到名为Property、还没安装的成员，安装到对应类的prototype上，找不到返回nullptr
+    const FLazyMember* InstallLazyMember(v8::Isolate* Isolate, v8::Local<v8::Context> Context, FLazyClassInfo* ClassInfo, v8::Local<v8::Name> Property);
+
     v8::Local<v8::Value> GetClassConstructor(int ClassID);
 
     v8::Local<v8::Value> FindOrAddObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID, void *Ptr);
 
     void BindObject(FLifeCycleInfo* LifeCycleInfo, void* Ptr, v8::Local<v8::Object> JSObject);
 
-    void UnBindObject(FLifeCycleInfo* LifeCycleInfo, void* Ptr);
+    // ContextInfo为nullptr表示主context
+    void UnBindObject(FLifeCycleInfo* LifeCycleInfo, void* Ptr, FContextInfo* ContextInfo = nullptr);
+
+    // 返回context的id，主context是0；quickjs后端不支持，返回-1。
+    // SecurityToken相同的context之间可以互相访问对方的全局对象，为空时用独立的token；
+    // FreezeIntrinsics为true时在执行任何脚本之前冻结新context的内置对象（Object.prototype、Array等），mod改不了它们
+    int CreateContext(const char* SecurityToken, bool FreezeIntrinsics);
+
+    // 之后的Eval、SetGlobalFunction、ClearModuleCache等都作用在这个context上
+    bool EnterContext(int ContextId);
+
+    // 当前进入的是这个context时回到主context。主context不能销毁
+    bool DestroyContext(int ContextId);
+
+    // nullptr表示主context（或者不是这里创建的context）
+    FContextInfo* FindContextInfo(v8::Local<v8::Context> Context);
+
+    // 主context是0，不是这里创建的context返回-1
+    int32_t FindContextId(v8::Local<v8::Context> Context);
 
     v8::UniquePersistent<v8::Value> LastException;
     std::string LastExceptionInfo;
@@ -147,6 +224,8 @@ public:
 
     bool IdleNotificationDeadline(double DeadlineInSeconds);
 
+    puerts::GcScheduler GcScheduler;
+
     void RequestMinorGarbageCollectionForTesting();
 
     void RequestFullGarbageCollectionForTesting();
@@ -165,12 +244,47 @@ public:
 
     bool InspectorTick();
 
+    bool StartCpuProfile(int32_t SamplingIntervalUs);
+
+    bool StopCpuProfile(const char* Path);
+
+    bool TakeHeapSnapshot(const char* Path);
+
+    bool StartSamplingHeapProfiler(uint64_t SampleInterval, int32_t StackDepth);
+
+    bool StopSamplingHeapProfiler(const char* Path);
+
     void LogicTick();
 
+#if PUERTS_MODULE_STREAMING
+    void TickModulePrefetch();
+#endif
+
+    // 以下只对nodejs后端有意义，其它后端分别返回-1、-1、false
+    int GetUvBackendFd();
+
+    int GetUvNextTimeout();
+
+    bool WaitUvEvents(int32_t MaxWaitMs);
+
     v8::Isolate* MainIsolate;
 
     bool ClearModuleCache(const char* Path);
 
+    // js里用puer.getMessagePort(Name)拿到，收到的消息在LogicTick里交给onmessage，同名的端口会被替换
+    void AddMessagePort(const char* Name, std::shared_ptr<MessagePort> Port);
+
+    void DispatchMessages();
+
+    // 主context，ResultInfo.Context是当前进入的context
+    v8::UniquePersistent<v8::Context> MainContext;
+
+    int32_t CurrentContextId = 0;
+
+    std::unique_ptr<MessageHostDelegate> MessageHost;
+
+    std::map<std::string, std::unique_ptr<MessagePortBinding>> MessagePorts;
+
     std::vector<char> StrBuffer;
 
     FResultInfo ResultInfo;
@@ -190,6 +304,8 @@ private:
 #if defined(WITH_NODEJS)
     uv_loop_t* NodeUVLoop;
 
+    std::unique_ptr<UvPump> NodeUVPump;
+
     std::unique_ptr<node::ArrayBufferAllocator> NodeArrayBufferAllocator;
 
     node::IsolateData* NodeIsolateData;
@@ -210,8 +326,41 @@ private:
 
     std::map<std::string, int> NameToTemplateID;
 
+    bool LazyMemberInstallation = false;
+
+    // 与Templates一一对应，非延迟安装的类为nullptr
+    std::vector<FLazyClassInfo*> LazyClassInfos;
+
+    std::set<std::string> ObjectPrototypeNames;
+
+    void MaterializeClass(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID);
+
+    void InstallMemberToTemplate(v8::Isolate* Isolate, int ClassID, const std::string& Name, const FLazyMember& Member);
+
+#ifdef PUERTS_CALL_STATISTICS
+    std::vector<std::string> TemplateNames;
+#endif
+
     std::map<void*, v8::UniquePersistent<v8::Value>> ObjectMap;
 
+    std::map<int32_t, std::unique_ptr<FContextInfo>> Contexts;
+
+    int32_t LastContextId = 0;
+
+    std::map<std::string, v8::UniquePersistent<v8::Value>> SecurityTokens;
+
+    std::map<void*, v8::UniquePersistent<v8::Value>>& ObjectMapOf(FContextInfo* ContextInfo)
+    {
+        return ContextInfo ? ContextInfo->ObjectMap : ObjectMap;
+    }
+
+    // 同一个C#对象可以在多个context里各有一个包装，最后一个包装被回收时才通知C#释放
+    bool IsBoundInAnyContext(void* Ptr);
+
+    v8::Local<v8::Map> GetMetadata(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID);
+
+    void AddReadonlyStaticMember(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Map> Metadata, const char* Name);
+
     std::vector<JSFunction*> JSFunctions;
 
     v8::UniquePersistent<v8::Map> JSObjectIdMap;
@@ -225,6 +374,7 @@ private:
     std::mutex JSObjectsMutex;
 
 public:
-    v8::Local<v8::FunctionTemplate> ToTemplate(v8::Isolate* Isolate, bool IsStatic, CSharpFunctionCallback Callback, int64_t Data);
+    // ClassID/Name/Accessor只用于生成调用统计的条目名
+    v8::Local<v8::FunctionTemplate> ToTemplate(v8::Isolate* Isolate, bool IsStatic, CSharpFunctionCallback Callback, int64_t Data, int ClassID = -1, const char* Name = nullptr, const char* Accessor = "");
 };
 }
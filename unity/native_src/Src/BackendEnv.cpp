@@ -6,6 +6,17 @@
 */
 #include "BackendEnv.h"
 #include "PromiseRejectCallback.hpp"
+#include "CallStatistics.h"
+
+#include <deque>
+
+#if PUERTS_MODULE_STREAMING
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#endif
 
 void puerts::esmodule::ExecuteModule(const v8::FunctionCallbackInfo<v8::Value>& info) 
 {
@@ -34,14 +45,10 @@ void puerts::esmodule::ExecuteModule(const v8::FunctionCallbackInfo<v8::Value>&
     v8::Local<v8::Module> entryModule = v8::ScriptCompiler::CompileModule(Isolate, &source, v8::ScriptCompiler::kNoCompileOptions)
             .ToLocalChecked();
 
-    v8::MaybeLocal<v8::Module> mod = puerts::esmodule::ResolveModule(Context, Specifier_v8, entryModule);
-    if (mod.IsEmpty())
-    {
-        // TODO
-        return;
-    }
-    v8::Local<v8::Module> moduleChecked = mod.ToLocalChecked();
-    if (!puerts::esmodule::LinkModule(Context, moduleChecked))
+    v8::Local<v8::Module> moduleChecked;
+    const bool Linked = puerts::esmodule::ResolveModule(Context, Specifier_v8, entryModule).ToLocal(&moduleChecked) &&
+        puerts::esmodule::LinkModule(Context, moduleChecked);
+    if (!Linked)
     {
         // TODO
         return;
@@ -110,6 +117,46 @@ void puerts::esmodule::ExecuteModule(const v8::FunctionCallbackInfo<v8::Value>&
 #endif
 }
 
+#ifdef PUERTS_CALL_STATISTICS
+// __puertsGetCallStatistics(reset?: boolean): { ticksPerSecond, entries: { name, calls, totalMs, histogram }[] }
+static void GetCallStatisticsCallback(const v8::FunctionCallbackInfo<v8::Value>& info)
+{
+    v8::Isolate* Isolate = info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    double TicksPerSecond = puerts::GetCallStatisticsTicksPerSecond();
+    int Count = 0;
+    const puerts::CallStatisticsEntry* Entries = puerts::GetCallStatistics(&Count);
+
+    v8::Local<v8::Array> EntryArray = v8::Array::New(Isolate);
+    for (int i = 0; i < Count; ++i)
+    {
+        const puerts::CallStatisticsEntry& Entry = Entries[i];
+        v8::Local<v8::Array> Histogram = v8::Array::New(Isolate);
+        for (int j = 0; j < PUERTS_CALL_STATISTICS_BUCKETS; ++j)
+        {
+            Histogram->Set(Context, j, v8::Number::New(Isolate, (double)Entry.Histogram[j].load(std::memory_order_relaxed))).Check();
+        }
+        v8::Local<v8::Object> Item = v8::Object::New(Isolate);
+        Item->Set(Context, v8::String::NewFromUtf8(Isolate, "name").ToLocalChecked(), v8::String::NewFromUtf8(Isolate, Entry.Name).ToLocalChecked()).Check();
+        Item->Set(Context, v8::String::NewFromUtf8(Isolate, "calls").ToLocalChecked(), v8::Number::New(Isolate, (double)puerts::GetCallCount(Entry))).Check();
+        Item->Set(Context, v8::String::NewFromUtf8(Isolate, "totalMs").ToLocalChecked(), v8::Number::New(Isolate, puerts::GetEstimatedTotalTicks(Entry) * 1000.0 / TicksPerSecond)).Check();
+        Item->Set(Context, v8::String::NewFromUtf8(Isolate, "histogram").ToLocalChecked(), Histogram).Check();
+        EntryArray->Set(Context, i, Item).Check();
+    }
+
+    v8::Local<v8::Object> Result = v8::Object::New(Isolate);
+    Result->Set(Context, v8::String::NewFromUtf8(Isolate, "ticksPerSecond").ToLocalChecked(), v8::Number::New(Isolate, TicksPerSecond)).Check();
+    Result->Set(Context, v8::String::NewFromUtf8(Isolate, "entries").ToLocalChecked(), EntryArray).Check();
+    info.GetReturnValue().Set(Result);
+
+    if (info.Length() > 0 && info[0]->BooleanValue(Isolate))
+    {
+        puerts::ResetCallStatistics();
+    }
+}
+#endif
+
 void puerts::BackendEnv::InitInject(v8::Isolate* Isolate)
 {
     Isolate->SetPromiseRejectCallback(&PromiseRejectCallback<puerts::BackendEnv>);
@@ -121,6 +168,13 @@ void puerts::BackendEnv::InitInject(v8::Isolate* Isolate)
 
     Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__tgjsSetPromiseRejectCallback").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, &SetPromiseRejectCallback<puerts::BackendEnv>)->GetFunction(Context).ToLocalChecked()).Check();
     Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__puer_execute_module_sync__").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, puerts::esmodule::ExecuteModule)->GetFunction(Context).ToLocalChecked()).Check();
+    Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__puer_invalidate_modules__").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, puerts::esmodule::InvalidateModules)->GetFunction(Context).ToLocalChecked()).Check();
+#if PUERTS_MODULE_STREAMING
+    Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__puer_prefetch_module__").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, puerts::esmodule::PrefetchModule)->GetFunction(Context).ToLocalChecked()).Check();
+#endif
+#ifdef PUERTS_CALL_STATISTICS
+    Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__puertsGetCallStatistics").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, &GetCallStatisticsCallback)->GetFunction(Context).ToLocalChecked()).Check();
+#endif
 }
 
 void puerts::BackendEnv::CreateInspector(v8::Isolate* Isolate, const v8::Global<v8::Context>* ContextGlobal, int32_t Port)
@@ -165,6 +219,120 @@ bool puerts::BackendEnv::InspectorTick()
     return true;
 }
 
+bool puerts::BackendEnv::StartCpuProfile(v8::Isolate* Isolate, int32_t SamplingIntervalUs)
+{
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+
+    if (Profiler == nullptr)
+    {
+        Profiler = CreateV8Profiler(Isolate);
+    }
+    if (Profiler == nullptr || !Profiler->StartCpuProfile(SamplingIntervalUs))
+    {
+        PLog(Warning, "StartCpuProfile failed, not supported by backend or already started");
+        return false;
+    }
+    return true;
+}
+
+bool puerts::BackendEnv::StopCpuProfile(v8::Isolate* Isolate, const char* Path)
+{
+    if (Profiler == nullptr || !Profiler->IsCpuProfiling())
+    {
+        return false;
+    }
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+
+    if (!Profiler->StopCpuProfile(Path))
+    {
+        PLog(Error, "StopCpuProfile: can not write %s", Path);
+        return false;
+    }
+    return true;
+}
+
+bool puerts::BackendEnv::TakeHeapSnapshot(v8::Isolate* Isolate, const char* Path)
+{
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+
+    if (Profiler == nullptr)
+    {
+        Profiler = CreateV8Profiler(Isolate);
+    }
+    if (Profiler == nullptr)
+    {
+        PLog(Warning, "TakeHeapSnapshot not supported by backend");
+        return false;
+    }
+    if (!Profiler->TakeHeapSnapshot(Path))
+    {
+        PLog(Error, "TakeHeapSnapshot: can not write %s", Path);
+        return false;
+    }
+    return true;
+}
+
+bool puerts::BackendEnv::StartSamplingHeapProfiler(v8::Isolate* Isolate, uint64_t SampleInterval, int32_t StackDepth)
+{
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+
+    if (Profiler == nullptr)
+    {
+        Profiler = CreateV8Profiler(Isolate);
+    }
+    if (Profiler == nullptr || !Profiler->StartSamplingHeapProfiler(SampleInterval, StackDepth))
+    {
+        PLog(Warning, "StartSamplingHeapProfiler failed, not supported by backend or already started");
+        return false;
+    }
+    return true;
+}
+
+bool puerts::BackendEnv::StopSamplingHeapProfiler(v8::Isolate* Isolate, const char* Path)
+{
+    if (Profiler == nullptr || !Profiler->IsSamplingHeapProfiling())
+    {
+        return false;
+    }
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+
+    if (!Profiler->StopSamplingHeapProfiler(Path))
+    {
+        PLog(Error, "StopSamplingHeapProfiler: can not write %s", Path);
+        return false;
+    }
+    return true;
+}
+
+void puerts::BackendEnv::DestroyProfiler(v8::Isolate* Isolate)
+{
+    if (Profiler != nullptr)
+    {
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+
+        delete Profiler;
+        Profiler = nullptr;
+    }
+}
+
 bool puerts::BackendEnv::ClearModuleCache(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const char* Path)
 {
     std::string key(Path);
@@ -178,26 +346,175 @@ bool puerts::BackendEnv::ClearModuleCache(v8::Isolate* Isolate, v8::Local<v8::Co
 #else
 #endif
         PathToModuleMap.clear();
+        ScriptIdToPathMap.clear();
+        ModuleImporters.clear();
+        ModuleImports.clear();
+#if PUERTS_MODULE_STREAMING
+        DiscardModulePrefetch(key);
+#endif
         return true;
     } 
     else 
     {
-        auto finder = PathToModuleMap.find(key);
-        if (finder != PathToModuleMap.end()) 
-        {
-            PathToModuleMap.erase(key);
+        ForgetModuleImports(key);
+        return RemoveModule(Isolate, Context, key);
+    }
+}
+
+bool puerts::BackendEnv::RemoveModule(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const std::string& Path)
+{
+#if PUERTS_MODULE_STREAMING
+    // 预取的是改动前的源码
+    DiscardModulePrefetch(Path);
+#endif
+    auto finder = PathToModuleMap.find(Path);
+    if (finder == PathToModuleMap.end()) 
+    {
+        return false;
+    }
 #if !WITH_QUICKJS
-            finder->second.Reset();
-            return true;
+    finder->second.Reset();
+    PathToModuleMap.erase(finder);
+    // 同一路径重新编译会得到新的ScriptId，旧的映射不删会一直留着
+    for (auto Iter = ScriptIdToPathMap.begin(); Iter != ScriptIdToPathMap.end();)
+    {
+        if (Iter->second == Path)
+        {
+            Iter = ScriptIdToPathMap.erase(Iter);
+        }
+        else
+        {
+            ++Iter;
+        }
+    }
+    return true;
 #else
-            v8::Isolate::Scope IsolateScope(Isolate);
-            v8::HandleScope HandleScope(Isolate);
-            JSContext* ctx = Context->context_;
-            return JS_ReleaseLoadedModule(ctx, Path);
+    PathToModuleMap.erase(finder);
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    JSContext* ctx = Context->context_;
+    return JS_ReleaseLoadedModule(ctx, Path.c_str());
 #endif
+}
+
+void puerts::BackendEnv::AddModuleEdge(const std::string& Importer, const std::string& Importee)
+{
+    if (Importer.empty() || Importer == Importee) 
+    {
+        return;
+    }
+    ModuleImports[Importer].insert(Importee);
+    ModuleImporters[Importee].insert(Importer);
+}
+
+void puerts::BackendEnv::ForgetModuleImports(const std::string& Path)
+{
+    auto Iter = ModuleImports.find(Path);
+    if (Iter == ModuleImports.end()) 
+    {
+        return;
+    }
+    for (auto& Importee : Iter->second)
+    {
+        auto ImporterIter = ModuleImporters.find(Importee);
+        if (ImporterIter != ModuleImporters.end())
+        {
+            ImporterIter->second.erase(Path);
+            if (ImporterIter->second.empty())
+            {
+                ModuleImporters.erase(ImporterIter);
+            }
+        }
+    }
+    ModuleImports.erase(Iter);
+}
+
+void puerts::BackendEnv::InvalidateModules(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const std::vector<std::string>& Changed,
+    const std::set<std::string>& Accepted, std::vector<std::string>& OutInvalidated, std::vector<std::string>& OutBoundaries)
+{
+    std::set<std::string> Visited;
+    std::deque<std::string> Queue(Changed.begin(), Changed.end());
+    while (!Queue.empty())
+    {
+        std::string Path = Queue.front();
+        Queue.pop_front();
+        // 没加载过的模块不用处理，之后import时自然会读新的内容
+        if (!Visited.insert(Path).second || PathToModuleMap.find(Path) == PathToModuleMap.end())
+        {
+            continue;
+        }
+        OutInvalidated.push_back(Path);
+
+        auto ImporterIter = ModuleImporters.find(Path);
+        if (Accepted.find(Path) != Accepted.end() || ImporterIter == ModuleImporters.end())
+        {
+            OutBoundaries.push_back(Path);
+            continue;
+        }
+        for (auto& Importer : ImporterIter->second)
+        {
+            Queue.push_back(Importer);
+        }
+    }
+
+    for (auto& Path : OutInvalidated)
+    {
+        ForgetModuleImports(Path);
+        RemoveModule(Isolate, Context, Path);
+    }
+}
+
+static void ToStringList(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Value> Value, std::vector<std::string>& Out)
+{
+    if (!Value->IsArray())
+    {
+        return;
+    }
+    v8::Local<v8::Array> Array = Value.As<v8::Array>();
+    for (uint32_t i = 0, length = Array->Length(); i < length; i++)
+    {
+        v8::Local<v8::Value> Element;
+        if (Array->Get(Context, i).ToLocal(&Element) && Element->IsString())
+        {
+            v8::String::Utf8Value Element_utf8(Isolate, Element);
+            Out.emplace_back(*Element_utf8, Element_utf8.length());
         }
     }
-    return false;
+}
+
+static v8::Local<v8::Array> ToV8Array(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const std::vector<std::string>& List)
+{
+    v8::Local<v8::Array> Array = v8::Array::New(Isolate, (int)List.size());
+    for (size_t i = 0; i < List.size(); i++)
+    {
+        Array->Set(Context, (uint32_t)i, v8::String::NewFromUtf8(Isolate, List[i].c_str(), v8::NewStringType::kNormal, (int)List[i].size()).ToLocalChecked()).Check();
+    }
+    return Array;
+}
+
+void puerts::esmodule::InvalidateModules(const v8::FunctionCallbackInfo<v8::Value>& info)
+{
+    v8::Isolate* Isolate = info.GetIsolate();
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    v8::Context::Scope ContextScope(Context);
+    BackendEnv* mm = BackendEnv::Get(Isolate, Context);
+
+    std::vector<std::string> Changed;
+    std::vector<std::string> AcceptedList;
+    ToStringList(Isolate, Context, info[0], Changed);
+    ToStringList(Isolate, Context, info[1], AcceptedList);
+    std::set<std::string> Accepted(AcceptedList.begin(), AcceptedList.end());
+
+    std::vector<std::string> Invalidated;
+    std::vector<std::string> Boundaries;
+    mm->InvalidateModules(Isolate, Context, Changed, Accepted, Invalidated, Boundaries);
+
+    v8::Local<v8::Object> Result = v8::Object::New(Isolate);
+    Result->Set(Context, v8::String::NewFromUtf8(Isolate, "invalidated").ToLocalChecked(), ToV8Array(Isolate, Context, Invalidated)).Check();
+    Result->Set(Context, v8::String::NewFromUtf8(Isolate, "boundaries").ToLocalChecked(), ToV8Array(Isolate, Context, Boundaries)).Check();
+    info.GetReturnValue().Set(Result);
 }
 
 static v8::MaybeLocal<v8::Value> CallResolver(
@@ -235,6 +552,23 @@ static v8::MaybeLocal<v8::Value> CallRead(
     return maybeRet;
 }
 
+// import.meta.hot由puerts/hot.mjs注册的__puer_create_hot_context__创建，hot.mjs加载之前的模块没有
+static v8::MaybeLocal<v8::Value> CallCreateHotContext(
+    v8::Isolate* Isolate,
+    v8::Local<v8::Context> Context,
+    const std::string& Path
+)
+{
+    v8::TryCatch TryCatch(Isolate);
+    v8::Local<v8::Value> CreateHotContext;
+    if (!Context->Global()->Get(Context, v8::String::NewFromUtf8(Isolate, "__puer_create_hot_context__").ToLocalChecked()).ToLocal(&CreateHotContext) || !CreateHotContext->IsFunction())
+    {
+        return v8::MaybeLocal<v8::Value> {};
+    }
+    v8::Local<v8::Value> Args[] = { v8::String::NewFromUtf8(Isolate, Path.c_str(), v8::NewStringType::kNormal, (int)Path.size()).ToLocalChecked() };
+    return v8::Local<v8::Function>::Cast(CreateHotContext)->Call(Context, Context->Global(), 1, Args);
+}
+
 #if !WITH_QUICKJS
     v8::MaybeLocal<v8::Module> puerts::esmodule::_ResolveModule(
         v8::Local<v8::Context> Context,
@@ -244,13 +578,14 @@ static v8::MaybeLocal<v8::Value> CallRead(
     )
     {
         v8::Isolate* Isolate = Context->GetIsolate();
-        BackendEnv* mm = (BackendEnv*)Isolate->GetData(1);
+        BackendEnv* mm = BackendEnv::Get(Isolate, Context);
 
         v8::Local<v8::Value> ReferrerName;
+        std::string referPath_std;
         const auto referIter = mm->ScriptIdToPathMap.find(Referrer->ScriptId()); 
         if (referIter != mm->ScriptIdToPathMap.end())
         {
-            std::string referPath_std = referIter->second;
+            referPath_std = referIter->second;
             ReferrerName = v8::String::NewFromUtf8(Isolate, referPath_std.c_str()).ToLocalChecked();
         }
         else
@@ -267,6 +602,7 @@ static v8::MaybeLocal<v8::Value> CallRead(
 
         v8::String::Utf8Value Specifier_utf8(Isolate, Specifier);
         std::string Specifier_std(*Specifier_utf8, Specifier_utf8.length());
+        mm->AddModuleEdge(referPath_std, Specifier_std);
 
         const auto cacheIter = mm->PathToModuleMap.find(Specifier_std);
         if (cacheIter != mm->PathToModuleMap.end())//create and link
@@ -275,6 +611,18 @@ static v8::MaybeLocal<v8::Value> CallRead(
             return v8::Local<v8::Module>::New(Isolate, cacheIter->second);
         }
         
+#if PUERTS_MODULE_STREAMING
+        const auto prefetchedIter = mm->PrefetchedModules.find(Specifier_std);
+        if (prefetchedIter != mm->PrefetchedModules.end())
+        {
+            v8::Local<v8::Module> Module = v8::Local<v8::Module>::New(Isolate, prefetchedIter->second);
+            mm->PrefetchedModules.erase(prefetchedIter);
+            mm->ScriptIdToPathMap[Module->ScriptId()] = Specifier_std;
+            mm->PathToModuleMap[Specifier_std] = v8::UniquePersistent<v8::Module>(Isolate, Module);
+            return Module;
+        }
+#endif
+
         maybeRet = CallRead(Isolate, Context, Specifier);
         if (maybeRet.IsEmpty()) 
         {
@@ -318,6 +666,267 @@ static v8::MaybeLocal<v8::Value> CallRead(
         return _ResolveModule(Context, Specifier, Referrer, isFromCache);
     }
 
+#if PUERTS_MODULE_STREAMING
+namespace puerts
+{
+    // 把整段utf8源码一次交给v8，GetMoreData在后台线程调用，调用者负责delete[]
+    class FModuleSourceStream : public v8::ScriptCompiler::ExternalSourceStream
+    {
+    public:
+        FModuleSourceStream(const char* Data, size_t Length) : Buffer(new uint8_t[Length]), BufferLength(Length)
+        {
+            memcpy(Buffer, Data, Length);
+        }
+
+        ~FModuleSourceStream() override
+        {
+            delete[] Buffer;
+        }
+
+        size_t GetMoreData(const uint8_t** Src) override
+        {
+            size_t Length = BufferLength;
+            *Src = Buffer;
+            Buffer = nullptr;
+            BufferLength = 0;
+            return Length;
+        }
+
+    private:
+        uint8_t* Buffer;
+        size_t BufferLength;
+    };
+
+    struct FModulePrefetch
+    {
+        std::string Path;
+        v8::Global<v8::String> Code;
+        std::unique_ptr<v8::ScriptCompiler::StreamedSource> Source;
+        std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> Task;
+        // 后台线程解析完后置位，主线程在TickModulePrefetch里看到才去完成编译
+        std::atomic<bool> Done{false};
+        // 排队期间这个路径被ClearModuleCache清掉了，完成后直接丢弃
+        bool Discarded = false;
+    };
+
+    // 预取用的后台线程，最多MaxThreads个，有任务时才创建。主线程只投递，从不等待
+    class FModuleStreamingWorkers
+    {
+    public:
+        ~FModuleStreamingWorkers()
+        {
+            Stop();
+        }
+
+        void Post(std::shared_ptr<FModulePrefetch> Module)
+        {
+            {
+                std::lock_guard<std::mutex> Guard(Mutex);
+                Tasks.push_back(std::move(Module));
+            }
+            Cond.notify_one();
+            if (Threads.size() < MaxThreads())
+            {
+                Threads.emplace_back([this]() { Work(); });
+            }
+        }
+
+        // 丢掉还没开始的任务，等正在执行的完成，线程退出。只在销毁env/context时调用，之后还可以继续Post
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> Guard(Mutex);
+                Tasks.clear();
+                Finished = true;
+            }
+            Cond.notify_all();
+            for (auto& Thread : Threads)
+            {
+                Thread.join();
+            }
+            Threads.clear();
+            Finished = false;
+        }
+
+    private:
+        static size_t MaxThreads()
+        {
+            unsigned int Cores = std::thread::hardware_concurrency();
+            return Cores > 2 ? std::min(Cores - 1, 4u) : 1;
+        }
+
+        void Work()
+        {
+            while (true)
+            {
+                std::shared_ptr<FModulePrefetch> Module;
+                {
+                    std::unique_lock<std::mutex> Lock(Mutex);
+                    Cond.wait(Lock, [this]() { return Finished || !Tasks.empty(); });
+                    if (Tasks.empty())
+                    {
+                        return;
+                    }
+                    Module = std::move(Tasks.front());
+                    Tasks.pop_front();
+                }
+                Module->Task->Run();
+                Module->Done.store(true, std::memory_order_release);
+            }
+        }
+
+        std::mutex Mutex;
+        std::condition_variable Cond;
+        std::deque<std::shared_ptr<FModulePrefetch>> Tasks;
+        std::vector<std::thread> Threads;
+        bool Finished = false;
+    };
+}    // namespace puerts
+
+    // 主线程解析路径、读取源码（loader在js/C#里，只能在主线程调用），然后交给后台线程解析，不等待结果。
+    // 已经加载、预取过或者正在预取的路径直接跳过；这里出的错都忽略掉，由之后同步的流程重新加载并报告
+    void puerts::BackendEnv::StartModulePrefetch(
+        v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::String> Specifier, v8::Local<v8::String> Referrer)
+    {
+        v8::TryCatch TryCatch(Isolate);
+        v8::Local<v8::Value> Resolved;
+        if (!CallResolver(Isolate, Context, Specifier, Referrer).ToLocal(&Resolved) || !Resolved->IsString())
+        {
+            return;
+        }
+        v8::String::Utf8Value Path_utf8(Isolate, Resolved);
+        std::string Path_std(*Path_utf8, Path_utf8.length());
+        if (PathToModuleMap.find(Path_std) != PathToModuleMap.end() || PrefetchedModules.find(Path_std) != PrefetchedModules.end())
+        {
+            return;
+        }
+        for (auto& Prefetch : ModulePrefetches)
+        {
+            if (Prefetch->Path == Path_std && !Prefetch->Discarded)
+            {
+                return;
+            }
+        }
+
+        v8::Local<v8::Value> Code;
+        if (!CallRead(Isolate, Context, Resolved).ToLocal(&Code) || !Code->IsString())
+        {
+            return;
+        }
+        v8::String::Utf8Value Code_utf8(Isolate, Code);
+
+        auto Module = std::make_shared<FModulePrefetch>();
+        Module->Path = Path_std;
+        Module->Code.Reset(Isolate, Code.As<v8::String>());
+        Module->Source.reset(new v8::ScriptCompiler::StreamedSource(
+            std::unique_ptr<v8::ScriptCompiler::ExternalSourceStream>(new FModuleSourceStream(*Code_utf8, Code_utf8.length())),
+            v8::ScriptCompiler::StreamedSource::UTF8));
+        Module->Task.reset(v8::ScriptCompiler::StartStreaming(Isolate, Module->Source.get(), v8::ScriptType::kModule));
+        if (!StreamingWorkers)
+        {
+            StreamingWorkers.reset(new FModuleStreamingWorkers());
+        }
+        StreamingWorkers->Post(Module);
+        ModulePrefetches.push_back(std::move(Module));
+    }
+
+    // 在tick里调用：完成已经解析好的模块的编译，放进PrefetchedModules，并用v8给出的module request继续预取下一层。
+    // 之后_ResolveModule真正请求到的模块才转入PathToModuleMap
+    void puerts::BackendEnv::TickModulePrefetch(v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+    {
+        std::vector<std::shared_ptr<FModulePrefetch>> Finished;
+        for (auto Iter = ModulePrefetches.begin(); Iter != ModulePrefetches.end();)
+        {
+            if ((*Iter)->Done.load(std::memory_order_acquire))
+            {
+                Finished.push_back(std::move(*Iter));
+                Iter = ModulePrefetches.erase(Iter);
+            }
+            else
+            {
+                ++Iter;
+            }
+        }
+
+        v8::TryCatch TryCatch(Isolate);
+        for (auto& Module : Finished)
+        {
+            // 预取期间已经被同步的流程加载了，或者被清掉了
+            if (Module->Discarded || PathToModuleMap.find(Module->Path) != PathToModuleMap.end())
+            {
+                continue;
+            }
+            v8::Local<v8::String> Path = v8::String::NewFromUtf8(Isolate, Module->Path.c_str(), v8::NewStringType::kNormal, (int)Module->Path.size()).ToLocalChecked();
+            v8::ScriptOrigin Origin(Path,
+                                v8::Integer::New(Isolate, 0),                      // line offset
+                                v8::Integer::New(Isolate, 0),                    // column offset
+                                v8::True(Isolate),                    // is cross origin
+                                v8::Local<v8::Integer>(),                 // script id
+                                v8::Local<v8::Value>(),                   // source map URL
+                                v8::False(Isolate),                   // is opaque (?)
+                                v8::False(Isolate),                   // is WASM
+                                v8::True(Isolate),                    // is ES Module
+                                v8::PrimitiveArray::New(Isolate, 10));
+            v8::Local<v8::Module> Compiled;
+            if (!v8::ScriptCompiler::CompileModule(Context, Module->Source.get(), Module->Code.Get(Isolate), Origin).ToLocal(&Compiled))
+            {
+                TryCatch.Reset();
+                continue;
+            }
+            PrefetchedModules[Module->Path] = v8::UniquePersistent<v8::Module>(Isolate, Compiled);
+            for (int i = 0, length = Compiled->GetModuleRequestsLength(); i < length; i++)
+            {
+                StartModulePrefetch(Isolate, Context, Compiled->GetModuleRequest(i), Path);
+            }
+        }
+    }
+
+    void puerts::BackendEnv::CancelModulePrefetch()
+    {
+        if (StreamingWorkers)
+        {
+            StreamingWorkers->Stop();
+        }
+        ModulePrefetches.clear();
+        PrefetchedModules.clear();
+    }
+
+    void puerts::BackendEnv::DiscardModulePrefetch(const std::string& Path)
+    {
+        for (auto& Prefetch : ModulePrefetches)
+        {
+            if (Path.empty() || Prefetch->Path == Path)
+            {
+                Prefetch->Discarded = true;
+            }
+        }
+        if (Path.empty())
+        {
+            PrefetchedModules.clear();
+        }
+        else
+        {
+            PrefetchedModules.erase(Path);
+        }
+    }
+
+    // __puer_prefetch_module__(specifier)：开始在后台预取模块及其静态依赖，立即返回，结果在之后的tick里完成编译，
+    // 再执行这个模块时直接用。适合在加载界面之类的地方提前调用，返回是否还有没完成的预取，可以每帧调用直到返回false
+    void puerts::esmodule::PrefetchModule(const v8::FunctionCallbackInfo<v8::Value>& info)
+    {
+        v8::Isolate* Isolate = info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        v8::Local<v8::String> Specifier;
+        if (info.Length() < 1 || !info[0]->ToString(Context).ToLocal(&Specifier))
+        {
+            return;
+        }
+        BackendEnv* Env = BackendEnv::Get(Isolate, Context);
+        Env->StartModulePrefetch(Isolate, Context, Specifier, v8::String::NewFromUtf8(Isolate, "").ToLocalChecked());
+        info.GetReturnValue().Set(Env->HasModulePrefetch());
+    }
+#endif
+
     bool puerts::esmodule::LinkModule(
         v8::Local<v8::Context> Context,
         v8::Local<v8::Module> RefModule
@@ -350,7 +959,7 @@ static v8::MaybeLocal<v8::Value> CallRead(
     void puerts::esmodule::HostInitializeImportMetaObject(v8::Local<v8::Context> Context, v8::Local<v8::Module> Module, v8::Local<v8::Object> meta)
     {
         v8::Isolate* Isolate = Context->GetIsolate();
-        BackendEnv* mm = (BackendEnv*)Isolate->GetData(1);
+        BackendEnv* mm = BackendEnv::Get(Isolate, Context);
 
         auto iter = mm->ScriptIdToPathMap.find(Module->ScriptId());
         if (iter != mm->ScriptIdToPathMap.end()) 
@@ -360,6 +969,12 @@ static v8::MaybeLocal<v8::Value> CallRead(
                 v8::String::NewFromUtf8(Isolate, "url").ToLocalChecked(),
                 v8::String::NewFromUtf8(Isolate, ("puer:" + iter->second).c_str()).ToLocalChecked()
             ).ToChecked();
+
+            v8::Local<v8::Value> Hot;
+            if (CallCreateHotContext(Isolate, Context, iter->second).ToLocal(&Hot))
+            {
+                meta->CreateDataProperty(Context, v8::String::NewFromUtf8(Isolate, "hot").ToLocalChecked(), Hot).ToChecked();
+            }
         }
     }
 
@@ -394,6 +1009,7 @@ static v8::MaybeLocal<v8::Value> CallRead(
         Specifier = maybeRet.ToLocalChecked();
         v8::String::Utf8Value Specifier_utf8(Isolate, Specifier);
         const char* specifier = *Specifier_utf8;
+        mm->AddModuleEdge(base_name, std::string(specifier, Specifier_utf8.length()));
 
         int32_t size = strlen(specifier);
         char* rname = (char*)js_malloc(ctx, strlen(specifier) + 1);
@@ -453,6 +1069,11 @@ static v8::MaybeLocal<v8::Value> CallRead(
 
         auto obj = JS_GetImportMeta(ctx, module_);
         JS_SetProperty(ctx, obj, JS_NewAtom(ctx, "url"), JS_NewString(ctx, ("puer:" + name_std).c_str()));
+        v8::Local<v8::Value> Hot;
+        if (CallCreateHotContext(Isolate, Context, name_std).ToLocal(&Hot))
+        {
+            JS_SetPropertyStr(ctx, obj, "hot", JS_DupValue(ctx, Hot->value_));
+        }
         JS_FreeValue(ctx, obj);
 
         mm->PathToModuleMap[name_std] = module_;
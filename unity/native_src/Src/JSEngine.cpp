@@ -7,6 +7,7 @@
 #include "JSEngine.h"
 #include "V8Utils.h"
 #include "Log.h"
+#include <algorithm>
 #include <memory>
 #include <stdarg.h>
 
@@ -60,6 +61,23 @@ namespace puerts
         Info.GetReturnValue().Set(JsEngine->LastException.Get(Isolate));
     }
 
+    static void GetMessagePort(const v8::FunctionCallbackInfo<v8::Value>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+        if (Info.Length() < 1 || !Info[0]->IsString())
+        {
+            FV8Utils::ThrowException(Isolate, "invalid argument for getMessagePort");
+            return;
+        }
+        auto Iter = JsEngine->MessagePorts.find(*v8::String::Utf8Value(Isolate, Info[0]));
+        if (Iter != JsEngine->MessagePorts.end())
+        {
+            Info.GetReturnValue().Set(Iter->second->GetJsObject(Isolate, Context));
+        }
+    }
+
     void JSEngine::SetLastException(v8::Local<v8::Value> Exception)
     {
         LastException.Reset(MainIsolate, Exception);
@@ -67,7 +85,7 @@ namespace puerts
     }
 
 #if WITH_NODEJS
-    void JSEngine::JSEngineWithNode()
+    void JSEngine::JSEngineWithNode(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
     {
         // PLog(puerts::Log, "[PuertsDLL][JSEngineWithNode]start");
         if (!GPlatform)
@@ -109,13 +127,19 @@ namespace puerts
             printf("uv_loop_init failed\n");
             return;
         }
+        NodeUVPump.reset(new UvPump(NodeUVLoop));
 
         NodeArrayBufferAllocator = node::ArrayBufferAllocator::Create();
         // PLog(puerts::Log, "[PuertsDLL][JSEngineWithNode]isolate");
 
         auto Platform = static_cast<node::MultiIsolatePlatform*>(GPlatform.get());
-        MainIsolate = node::NewIsolate(NodeArrayBufferAllocator.get(), NodeUVLoop,
-            Platform);
+        {
+            // node::NewIsolate不接受CreateParams，堆大小只能在创建期间用flag指定
+            puerts::ScopedHeapSizeFlags HeapSizeFlags(MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
+            MainIsolate = node::NewIsolate(NodeArrayBufferAllocator.get(), NodeUVLoop,
+                Platform);
+        }
+        GcScheduler.Attach(MainIsolate, Platform);
 
         auto Isolate = MainIsolate;
         ResultInfo.Isolate = MainIsolate;
@@ -133,6 +157,7 @@ namespace puerts
 
         v8::Context::Scope ContextScope(Context);
         ResultInfo.Context.Reset(MainIsolate, Context);
+        MainContext.Reset(MainIsolate, Context);
 
         v8::Local<v8::Value> Console = Global->Get(Context, FV8Utils::V8String(MainIsolate, "console")).ToLocalChecked();
 
@@ -162,6 +187,7 @@ namespace puerts
 
         Global->Set(Context, FV8Utils::V8String(MainIsolate, "__tgjsEvalScript"), v8::FunctionTemplate::New(MainIsolate, &EvalWithPath)->GetFunction(Context).ToLocalChecked()).Check();
         Global->Set(Context, FV8Utils::V8String(Isolate, "__puertsGetLastException"), v8::FunctionTemplate::New(Isolate, &GetLastException)->GetFunction(Context).ToLocalChecked()).Check();
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__puertsGetMessagePort"), v8::FunctionTemplate::New(Isolate, &GetMessagePort)->GetFunction(Context).ToLocalChecked()).Check();
 
         JSObjectIdMap.Reset(MainIsolate, v8::Map::New(MainIsolate));
 
@@ -171,7 +197,7 @@ namespace puerts
 #endif        
 
 #if !WITH_NODEJS
-    void JSEngine::JSEngineWithoutNode(void* external_quickjs_runtime, void* external_quickjs_context)
+    void JSEngine::JSEngineWithoutNode(void* external_quickjs_runtime, void* external_quickjs_context, uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
     {
         if (!GPlatform)
         {
@@ -200,11 +226,13 @@ namespace puerts
         // 初始化Isolate和DefaultContext
         CreateParams = new v8::Isolate::CreateParams();
         CreateParams->array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+        puerts::GcScheduler::ApplyResourceConstraints(*CreateParams, MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
 #if WITH_QUICKJS
         MainIsolate = (external_quickjs_runtime == nullptr) ? v8::Isolate::New(*CreateParams) : v8::Isolate::New(external_quickjs_runtime);
 #else
         MainIsolate = v8::Isolate::New(*CreateParams);
 #endif
+        GcScheduler.Attach(MainIsolate, GPlatform.get());
         auto Isolate = MainIsolate;
         ResultInfo.Isolate = MainIsolate;
         MainIsolate->SetData(0, this);
@@ -223,9 +251,11 @@ namespace puerts
 #endif
         v8::Context::Scope ContextScope(Context);
         ResultInfo.Context.Reset(Isolate, Context);
+        MainContext.Reset(Isolate, Context);
         v8::Local<v8::Object> Global = Context->Global();
 
         Global->Set(Context, FV8Utils::V8String(Isolate, "__tgjsEvalScript"), v8::FunctionTemplate::New(Isolate, &EvalWithPath)->GetFunction(Context).ToLocalChecked()).Check();
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__puertsGetMessagePort"), v8::FunctionTemplate::New(Isolate, &GetMessagePort)->GetFunction(Context).ToLocalChecked()).Check();
 
         if (external_quickjs_runtime == nullptr) 
         {
@@ -237,19 +267,26 @@ namespace puerts
     }
 #endif
 
-    JSEngine::JSEngine(void* external_quickjs_runtime, void* external_quickjs_context)
+    JSEngine::JSEngine(void* external_quickjs_runtime, void* external_quickjs_context, uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
     {
         GeneralDestructor = nullptr;
 #if WITH_NODEJS
-        JSEngineWithNode();
+        JSEngineWithNode(MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
 #else
-        JSEngineWithoutNode(external_quickjs_runtime, external_quickjs_context);
+        JSEngineWithoutNode(external_quickjs_runtime, external_quickjs_context, MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
 #endif
     }
 
     JSEngine::~JSEngine()
     {
+        while (!Contexts.empty())
+        {
+            DestroyContext(Contexts.begin()->first);
+        }
+        SecurityTokens.clear();
+
         DestroyInspector();
+        BackendEnv.DestroyProfiler(MainIsolate);
 
         JSObjectIdMap.Reset();
         BackendEnv.JsPromiseRejectCallback.Reset();
@@ -271,9 +308,12 @@ namespace puerts
 #endif
             v8::Isolate::Scope IsolateScope(Isolate);
             v8::HandleScope HandleScope(Isolate);
-            auto Context = ResultInfo.Context.Get(Isolate);
+            auto Context = MainContext.Get(Isolate);
             v8::Context::Scope ContextScope(Context);
 
+            MessagePorts.clear();
+            MessageHost.reset();
+
             for (auto Iter = ObjectMap.begin(); Iter != ObjectMap.end(); ++Iter)
             {
                 auto Value = Iter->second.Get(MainIsolate);
@@ -291,6 +331,9 @@ namespace puerts
             }
             BackendEnv.PathToModuleMap.clear();
             BackendEnv.ScriptIdToPathMap.clear();
+#if PUERTS_MODULE_STREAMING
+            BackendEnv.CancelModulePrefetch();
+#endif
         }
         {
             std::lock_guard<std::mutex> guard(JSFunctionsMutex);
@@ -322,6 +365,8 @@ namespace puerts
 
         ResultInfo.Context.Reset();
         ResultInfo.Result.Reset();
+        MainContext.Reset();
+        GcScheduler.Detach();
         MainIsolate->Dispose();
         MainIsolate = nullptr;
 
@@ -332,6 +377,7 @@ namespace puerts
             uv_run(NodeUVLoop, UV_RUN_ONCE);
         }
 
+        NodeUVPump.reset();
         int err = uv_loop_close(NodeUVLoop);
         assert(err == 0);
         delete NodeUVLoop;
@@ -349,6 +395,11 @@ namespace puerts
         {
             delete LifeCycleInfos[i];
         }
+
+        for (int i = 0; i < LazyClassInfos.size(); ++i)
+        {
+            delete LazyClassInfos[i];
+        }
     }
 
     JSObject *JSEngine::CreateJSObject(v8::Isolate *InIsolate, v8::Local<v8::Context> InContext, v8::Local<v8::Object> InObject)
@@ -365,7 +416,8 @@ namespace puerts
         v8::Context::Scope ContextScope(InContext);
 
         // PLog(puerts::Log, "[PuertsDLL][CreateJSObject]map get");
-        v8::Local<v8::Map> idmap = JSObjectIdMap.Get(InIsolate);
+        FContextInfo* ContextInfo = FindContextInfo(InContext);
+        v8::Local<v8::Map> idmap = (ContextInfo ? ContextInfo->JSObjectIdMap : JSObjectIdMap).Get(InIsolate);
         
         // PLog(puerts::Log, "[PuertsDLL][CreateJSObject]get v8object id");
         // 从idmap尝试取出该jsObject的id
@@ -419,7 +471,9 @@ namespace puerts
         v8::Local<v8::Context> Context = InObject->Context.Get(Isolate);
         v8::Context::Scope ContextScope(Context);
 
-        v8::Local<v8::Map> idmap = JSObjectIdMap.Get(InObject->Isolate);
+        // context已经销毁时它的idmap也没了，FindContextInfo返回nullptr，在主context的idmap里删不到任何东西
+        FContextInfo* ContextInfo = FindContextInfo(Context);
+        v8::Local<v8::Map> idmap = (ContextInfo ? ContextInfo->JSObjectIdMap : JSObjectIdMap).Get(InObject->Isolate);
         idmap->Delete(InObject->Context.Get(Isolate), InObject->GObject.Get(Isolate));
         JSObjectMap.erase(InObject->Index);
 
@@ -469,13 +523,22 @@ namespace puerts
 
         void* Ptr = CallbackInfo->IsStatic ? nullptr : FV8Utils::GetPoninter(Info.Holder());
 
+        PUERTS_CALL_STATISTICS_SCOPE(CallbackInfo->Statistics);
         CallbackInfo->Callback(Isolate, Info, Ptr, Info.Length(), CallbackInfo->Data);
     }
 
-    v8::Local<v8::FunctionTemplate> JSEngine::ToTemplate(v8::Isolate* Isolate, bool IsStatic, CSharpFunctionCallback Callback, int64_t Data)
+    v8::Local<v8::FunctionTemplate> JSEngine::ToTemplate(v8::Isolate* Isolate, bool IsStatic, CSharpFunctionCallback Callback, int64_t Data, int ClassID, const char* Name, const char* Accessor)
     {
         auto Pos = CallbackInfos.size();
         auto CallbackInfo = new FCallbackInfo(IsStatic, Callback, Data);
+#ifdef PUERTS_CALL_STATISTICS
+        std::string StatisticsName = Name ? Name : "<anonymous>";
+        if (ClassID >= 0 && ClassID < TemplateNames.size())
+        {
+            StatisticsName = TemplateNames[ClassID] + "." + Accessor + StatisticsName;
+        }
+        CallbackInfo->Statistics = RegisterCallStatistics(StatisticsName.c_str());
+#endif
         CallbackInfos.push_back(CallbackInfo);
         return v8::FunctionTemplate::New(Isolate, CSharpFunctionCallbackWrap, v8::External::New(Isolate, CallbackInfos[Pos]));
     }
@@ -493,7 +556,7 @@ namespace puerts
 
         v8::Local<v8::Object> Global = Context->Global();
 
-        Global->Set(Context, FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, true, Callback, Data)->GetFunction(Context).ToLocalChecked()).Check();
+        Global->Set(Context, FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, true, Callback, Data, -1, Name)->GetFunction(Context).ToLocalChecked()).Check();
     }
 
     static void NewWrap(const v8::FunctionCallbackInfo<v8::Value>& Info)
@@ -535,6 +598,268 @@ namespace puerts
         FV8Utils::IsolateData<JSEngine>(Data.GetIsolate())->UnBindObject(Data.GetParameter(), Data.GetInternalField(0));
     }
 
+#if !WITH_QUICKJS
+    // CreateContext创建的context里的对象，参数是所属的context，LifeCycleInfo从第二个internal field取
+    static void OnGarbageCollectedInContext(const v8::WeakCallbackInfo<FContextInfo>& Data)
+    {
+        FV8Utils::IsolateData<JSEngine>(Data.GetIsolate())->UnBindObject(
+            static_cast<FLifeCycleInfo*>(Data.GetInternalField(1)), Data.GetInternalField(0), Data.GetParameter());
+    }
+#endif
+
+    void JSEngine::SetLazyMemberInstallation(bool Enable)
+    {
+#ifndef WITH_QUICKJS
+        LazyMemberInstallation = Enable;
+#endif
+    }
+
+    // 成员还没装到这个context的prototype上。所有context共享同一份FLazyClassInfo，但prototype是各自的
+    static bool IsLazyMemberPending(const FLazyMember& Member, int32_t ContextId)
+    {
+        return !Member.InTemplate && std::find(Member.InstalledContexts.begin(), Member.InstalledContexts.end(), ContextId) == Member.InstalledContexts.end();
+    }
+
+#ifndef WITH_QUICKJS
+    // 只在prototype上挂kNonMasking的拦截器：实例上的查找沿原型链走到prototype，整条链上都找不到的名字才会进来，
+    // 已安装的成员走正常的属性查找，不再经过拦截器；赋值时v8先调Query，装好后再按原型链找到setter。
+    // 安装后重新对This做一次Get/Set，这样accessor的receiver、只读属性的行为都和立即安装时一致
+    template <typename T>
+    static FLazyClassInfo* GetLazyClassInfo(const v8::PropertyCallbackInfo<T>& Info)
+    {
+        return static_cast<FLazyClassInfo*>(v8::Local<v8::External>::Cast(Info.Data())->Value());
+    }
+
+    static void LazyMemberGetter(v8::Local<v8::Name> Property, const v8::PropertyCallbackInfo<v8::Value>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        if (JSEngine::Get(Isolate)->InstallLazyMember(Isolate, Context, GetLazyClassInfo(Info), Property))
+        {
+            v8::Local<v8::Value> Value;
+            if (Info.This()->Get(Context, Property).ToLocal(&Value))
+            {
+                Info.GetReturnValue().Set(Value);
+            }
+        }
+    }
+
+    static void LazyMemberSetter(v8::Local<v8::Name> Property, v8::Local<v8::Value> Value, const v8::PropertyCallbackInfo<v8::Value>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        if (JSEngine::Get(Isolate)->InstallLazyMember(Isolate, Context, GetLazyClassInfo(Info), Property))
+        {
+            v8::Maybe<bool> Result = Info.This()->Set(Context, Property, Value);
+            if (Result.IsJust() && !Result.FromJust() && Info.ShouldThrowOnError())
+            {
+                Isolate->ThrowException(v8::Exception::TypeError(FV8Utils::V8String(Isolate, "Cannot assign to read only property")));
+            }
+            Info.GetReturnValue().Set(Value);
+        }
+    }
+
+    static void LazyMemberQuery(v8::Local<v8::Name> Property, const v8::PropertyCallbackInfo<v8::Integer>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        const FLazyMember* Member = JSEngine::Get(Isolate)->InstallLazyMember(Isolate, Isolate->GetCurrentContext(), GetLazyClassInfo(Info), Property);
+        if (Member)
+        {
+            Info.GetReturnValue().Set(static_cast<int32_t>(Member->IsProperty && !Member->Setter ? v8::ReadOnly : v8::None));
+        }
+    }
+
+    // 只挂在prototype上，让Object.keys(prototype)等能看到还没安装的成员
+    static void LazyMemberEnumerator(const v8::PropertyCallbackInfo<v8::Array>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        FLazyClassInfo* ClassInfo = GetLazyClassInfo(Info);
+        v8::Local<v8::Array> Names = v8::Array::New(Isolate);
+        const int32_t ContextId = ClassInfo->PendingCount > 0 ? JSEngine::Get(Isolate)->FindContextId(Context) : -1;
+        uint32_t Index = 0;
+        for (auto& KV : ClassInfo->Members)
+        {
+            if (ContextId >= 0 && IsLazyMemberPending(KV.second, ContextId))
+            {
+                Names->Set(Context, Index++, FV8Utils::V8String(Isolate, KV.first.c_str())).Check();
+            }
+        }
+        Info.GetReturnValue().Set(Names);
+    }
+
+    const FLazyMember* JSEngine::InstallLazyMember(v8::Isolate* Isolate, v8::Local<v8::Context> Context, FLazyClassInfo* ClassInfo, v8::Local<v8::Name> Property)
+    {
+        bool HasPending = false;
+        for (FLazyClassInfo* Iter = ClassInfo; Iter; Iter = Iter->BaseClassID >= 0 ? LazyClassInfos[Iter->BaseClassID] : nullptr)
+        {
+            if (Iter->PendingCount > 0)
+            {
+                HasPending = true;
+                break;
+            }
+        }
+        if (!HasPending || !Property->IsString())
+        {
+            return nullptr;
+        }
+        // 装到了别的context的prototype上的成员，在这个context里还要再装一次
+        const int32_t ContextId = FindContextId(Context);
+        if (ContextId < 0)
+        {
+            return nullptr;
+        }
+
+        v8::String::Utf8Value Utf8Name(Isolate, Property);
+        std::string Name(*Utf8Name, Utf8Name.length());
+        for (FLazyClassInfo* Iter = ClassInfo; Iter; Iter = Iter->BaseClassID >= 0 ? LazyClassInfos[Iter->BaseClassID] : nullptr)
+        {
+            auto MemberIter = Iter->Members.find(Name);
+            if (MemberIter == Iter->Members.end())
+            {
+                continue;
+            }
+            FLazyMember& Member = MemberIter->second;
+            if (!IsLazyMemberPending(Member, ContextId))
+            {
+                return nullptr;
+            }
+
+            v8::Local<v8::Value> PrototypeValue;
+            if (!Templates[Iter->ClassID].Get(Isolate)->GetFunction(Context).ToLocalChecked()
+                ->Get(Context, FV8Utils::V8String(Isolate, "prototype")).ToLocal(&PrototypeValue) || !PrototypeValue->IsObject())
+            {
+                return nullptr;
+            }
+            v8::Local<v8::Object> Prototype = PrototypeValue.As<v8::Object>();
+
+            Member.InstalledContexts.push_back(ContextId);
+            --Iter->PendingCount;
+            if (Member.IsProperty)
+            {
+                Prototype->SetAccessorProperty(Property,
+                    ToTemplate(Isolate, false, Member.Callback, Member.Data, Iter->ClassID, Name.c_str(), "get ")->GetFunction(Context).ToLocalChecked(),
+                    Member.Setter == nullptr ? v8::Local<v8::Function>() : ToTemplate(Isolate, false, Member.Setter, Member.SetterData, Iter->ClassID, Name.c_str(), "set ")->GetFunction(Context).ToLocalChecked(),
+                    Member.Setter == nullptr ? v8::ReadOnly : v8::None);
+            }
+            else
+            {
+                Prototype->DefineOwnProperty(Context, Property, ToTemplate(Isolate, false, Member.Callback, Member.Data, Iter->ClassID, Name.c_str())->GetFunction(Context).ToLocalChecked()).Check();
+            }
+            return &Member;
+        }
+        return nullptr;
+    }
+
+    // 模板第一次GetFunction前调用。kNonMasking的拦截器只在整条原型链都找不到时才触发，如果基类（或者Object.prototype）上
+    // 已经有同名成员，子类的同名成员永远不会被装上，所以这类覆盖/隐藏基类的成员在这里直接装进模板
+    void JSEngine::MaterializeClass(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID)
+    {
+        FLazyClassInfo* ClassInfo = LazyClassInfos[ClassID];
+        if (!ClassInfo || ClassInfo->Materialized)
+        {
+            return;
+        }
+        ClassInfo->Materialized = true;
+
+        if (ObjectPrototypeNames.empty())
+        {
+            v8::Local<v8::Value> ObjectPrototype = v8::Object::New(Isolate)->GetPrototype();
+            v8::Local<v8::Array> Names;
+            if (ObjectPrototype->IsObject() && ObjectPrototype.As<v8::Object>()->GetOwnPropertyNames(Context).ToLocal(&Names))
+            {
+                for (uint32_t i = 0; i < Names->Length(); ++i)
+                {
+                    v8::String::Utf8Value Name(Isolate, Names->Get(Context, i).ToLocalChecked());
+                    ObjectPrototypeNames.insert(std::string(*Name, Name.length()));
+                }
+            }
+        }
+
+        // 开关打开前注册的基类（以及它的所有基类）没有登记成员名，只能到它已经实例化的prototype链上查
+        v8::Local<v8::Object> EagerBasePrototype;
+        for (int BaseClassID = ClassInfo->BaseClassID; BaseClassID >= 0; BaseClassID = LazyClassInfos[BaseClassID] ? LazyClassInfos[BaseClassID]->BaseClassID : -1)
+        {
+            MaterializeClass(Isolate, Context, BaseClassID);
+            if (!LazyClassInfos[BaseClassID])
+            {
+                v8::Local<v8::Value> PrototypeValue = Templates[BaseClassID].Get(Isolate)->GetFunction(Context).ToLocalChecked()
+                    ->Get(Context, FV8Utils::V8String(Isolate, "prototype")).ToLocalChecked();
+                if (PrototypeValue->IsObject())
+                {
+                    EagerBasePrototype = PrototypeValue.As<v8::Object>();
+                }
+            }
+        }
+
+        for (auto& KV : ClassInfo->Members)
+        {
+            if (KV.second.InTemplate || !KV.second.InstalledContexts.empty())
+            {
+                continue;
+            }
+            bool Shadowing = ObjectPrototypeNames.find(KV.first) != ObjectPrototypeNames.end();
+            for (int BaseClassID = ClassInfo->BaseClassID; !Shadowing && BaseClassID >= 0 && LazyClassInfos[BaseClassID]; BaseClassID = LazyClassInfos[BaseClassID]->BaseClassID)
+            {
+                Shadowing = LazyClassInfos[BaseClassID]->Members.find(KV.first) != LazyClassInfos[BaseClassID]->Members.end();
+            }
+            if (!Shadowing && !EagerBasePrototype.IsEmpty())
+            {
+                Shadowing = EagerBasePrototype->GetRealNamedPropertyAttributes(Context, FV8Utils::V8String(Isolate, KV.first.c_str())).IsJust();
+            }
+            if (Shadowing)
+            {
+                InstallMemberToTemplate(Isolate, ClassID, KV.first, KV.second);
+                KV.second.InTemplate = true;
+                --ClassInfo->LazyCount;
+                ClassInfo->PendingCount -= 1 + Contexts.size();
+            }
+        }
+    }
+
+#else
+    const FLazyMember* JSEngine::InstallLazyMember(v8::Isolate* Isolate, v8::Local<v8::Context> Context, FLazyClassInfo* ClassInfo, v8::Local<v8::Name> Property)
+    {
+        return nullptr;
+    }
+
+    void JSEngine::MaterializeClass(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID)
+    {
+    }
+#endif
+
+    void JSEngine::InstallMemberToTemplate(v8::Isolate* Isolate, int ClassID, const std::string& Name, const FLazyMember& Member)
+    {
+        auto PrototypeTemplate = Templates[ClassID].Get(Isolate)->PrototypeTemplate();
+        if (Member.IsProperty)
+        {
+            PrototypeTemplate->SetAccessorProperty(FV8Utils::V8String(Isolate, Name.c_str()),
+                ToTemplate(Isolate, false, Member.Callback, Member.Data, ClassID, Name.c_str(), "get ")
+                , Member.Setter == nullptr ? v8::Local<v8::FunctionTemplate>() : ToTemplate(Isolate, false, Member.Setter, Member.SetterData, ClassID, Name.c_str(), "set ")
+                , Member.Setter == nullptr ? v8::ReadOnly : v8::None);
+        }
+        else
+        {
+            PrototypeTemplate->Set(FV8Utils::V8String(Isolate, Name.c_str()), ToTemplate(Isolate, false, Member.Callback, Member.Data, ClassID, Name.c_str()));
+        }
+    }
+
+    // ContextCount是主context加上CreateContext创建的context数，新成员在每个context里都还没安装
+    static void AddLazyMember(FLazyClassInfo* ClassInfo, const char* Name, const FLazyMember& InMember, size_t ContextCount)
+    {
+        FLazyMember& Member = ClassInfo->Members[Name];
+        if (Member.InTemplate || !Member.InstalledContexts.empty())
+        {
+            return;
+        }
+        if (Member.Callback == nullptr)
+        {
+            ++ClassInfo->LazyCount;
+            ClassInfo->PendingCount += ContextCount;
+        }
+        Member = InMember;
+    }
+
     int JSEngine::RegisterClass(const char *FullName, int BaseClassId, CSharpConstructorCallback Constructor, CSharpDestructorCallback Destructor, int64_t Data, int Size)
     {
         auto Iter = NameToTemplateID.find(FullName);
@@ -549,7 +874,7 @@ namespace puerts
 #endif
         v8::Isolate::Scope IsolateScope(Isolate);
         v8::HandleScope HandleScope(Isolate);
-        v8::Local<v8::Context> Context = ResultInfo.Context.Get(Isolate);
+        v8::Local<v8::Context> Context = MainContext.Get(Isolate);
         v8::Context::Scope ContextScope(Context);
 
         int ClassId = static_cast<int>(Templates.size());
@@ -566,6 +891,9 @@ namespace puerts
         Metadatas.push_back(v8::UniquePersistent<v8::Map>(Isolate, Map));
 
         NameToTemplateID[FullName] = ClassId;
+#ifdef PUERTS_CALL_STATISTICS
+        TemplateNames.push_back(FullName);
+#endif
         Map->Set(Context, FV8Utils::V8String(Isolate, "classid"), v8::Number::New(Isolate, ClassId));
         Template->SetClassName(FV8Utils::V8String(Isolate, FullName));
 
@@ -573,6 +901,17 @@ namespace puerts
         {
             Template->Inherit(Templates[BaseClassId].Get(Isolate));
         }
+
+        FLazyClassInfo* LazyClassInfo = nullptr;
+#ifndef WITH_QUICKJS
+        if (LazyMemberInstallation)
+        {
+            LazyClassInfo = new FLazyClassInfo(ClassId, BaseClassId);
+            Template->PrototypeTemplate()->SetHandler(v8::NamedPropertyHandlerConfiguration(LazyMemberGetter, LazyMemberSetter, LazyMemberQuery,
+                nullptr, LazyMemberEnumerator, v8::External::New(Isolate, LazyClassInfo), v8::PropertyHandlerFlags::kNonMasking));
+        }
+#endif
+        LazyClassInfos.push_back(LazyClassInfo);
         return ClassId;
     }
 
@@ -584,18 +923,25 @@ namespace puerts
 #endif
         v8::Isolate::Scope IsolateScope(Isolate);
         v8::HandleScope HandleScope(Isolate);
-        v8::Local<v8::Context> Context = ResultInfo.Context.Get(Isolate);
+        v8::Local<v8::Context> Context = MainContext.Get(Isolate);
         v8::Context::Scope ContextScope(Context);
 
         if (ClassID >= Templates.size()) return false;
 
         if (IsStatic)
         {
-            Templates[ClassID].Get(Isolate)->Set(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Callback, Data));
+            Templates[ClassID].Get(Isolate)->Set(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Callback, Data, ClassID, Name));
+        }
+        else if (LazyClassInfos[ClassID])
+        {
+            FLazyMember Member;
+            Member.Callback = Callback;
+            Member.Data = Data;
+            AddLazyMember(LazyClassInfos[ClassID], Name, Member, 1 + Contexts.size());
         }
         else
         {
-            Templates[ClassID].Get(Isolate)->PrototypeTemplate()->Set(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Callback, Data));
+            Templates[ClassID].Get(Isolate)->PrototypeTemplate()->Set(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Callback, Data, ClassID, Name));
         }
 
         return true;
@@ -609,7 +955,7 @@ namespace puerts
 #endif
         v8::Isolate::Scope IsolateScope(Isolate);
         v8::HandleScope HandleScope(Isolate);
-        v8::Local<v8::Context> Context = ResultInfo.Context.Get(Isolate);
+        v8::Local<v8::Context> Context = MainContext.Get(Isolate);
         v8::Context::Scope ContextScope(Context);
 
         if (ClassID >= Templates.size()) return false;
@@ -618,32 +964,39 @@ namespace puerts
 
         if (!NotReadonlyStatic) 
         {
-            v8::Local<v8::Map> Metadata = Metadatas[ClassID].Get(Isolate);
-            v8::Local<v8::Set> ReadonlyStaticMembersSet;
-            v8::Local<v8::Value> NameOfTheSet = FV8Utils::V8String(Isolate, "readonlyStaticMembers");
-            v8::Local<v8::Value> ReadonlyStaticMembersSetValue = Metadata->Get(Context, NameOfTheSet).ToLocalChecked();
-            if (ReadonlyStaticMembersSetValue->IsNullOrUndefined())
-            {
-                ReadonlyStaticMembersSet = v8::Set::New(Isolate);
-                Metadata->Set(Context, NameOfTheSet, ReadonlyStaticMembersSet);
-            }
-            else
+            AddReadonlyStaticMember(Isolate, Context, Metadatas[ClassID].Get(Isolate), Name);
+            // 已经生成的副本也要同步，否则那些context里的类看不到后注册的只读静态成员
+            for (auto& KV : Contexts)
             {
-                ReadonlyStaticMembersSet = v8::Local<v8::Set>::Cast(ReadonlyStaticMembersSetValue);
+                if (ClassID < KV.second->Metadatas.size() && !KV.second->Metadatas[ClassID].IsEmpty())
+                {
+                    v8::Local<v8::Context> OtherContext = KV.second->Context.Get(Isolate);
+                    v8::Context::Scope OtherContextScope(OtherContext);
+                    AddReadonlyStaticMember(Isolate, OtherContext, KV.second->Metadatas[ClassID].Get(Isolate), Name);
+                }
             }
-            ReadonlyStaticMembersSet->Add(Context, FV8Utils::V8String(Isolate, Name));
         }
 
         if (IsStatic)
         {
-            Templates[ClassID].Get(Isolate)->SetAccessorProperty(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Getter, GetterData)
-                , Setter == nullptr ? v8::Local<v8::FunctionTemplate>() : ToTemplate(Isolate, IsStatic, Setter, SetterData), Attr);
+            Templates[ClassID].Get(Isolate)->SetAccessorProperty(FV8Utils::V8String(Isolate, Name), ToTemplate(Isolate, IsStatic, Getter, GetterData, ClassID, Name, "get ")
+                , Setter == nullptr ? v8::Local<v8::FunctionTemplate>() : ToTemplate(Isolate, IsStatic, Setter, SetterData, ClassID, Name, "set "), Attr);
+        }
+        else if (LazyClassInfos[ClassID])
+        {
+            FLazyMember Member;
+            Member.IsProperty = true;
+            Member.Callback = Getter;
+            Member.Data = GetterData;
+            Member.Setter = Setter;
+            Member.SetterData = SetterData;
+            AddLazyMember(LazyClassInfos[ClassID], Name, Member, 1 + Contexts.size());
         }
         else
         {
             Templates[ClassID].Get(Isolate)->PrototypeTemplate()->SetAccessorProperty(FV8Utils::V8String(Isolate, Name),
-                ToTemplate(Isolate, IsStatic, Getter, GetterData)
-                , Setter == nullptr ? v8::Local<v8::FunctionTemplate>() : ToTemplate(Isolate, IsStatic, Setter, SetterData), Attr);
+                ToTemplate(Isolate, IsStatic, Getter, GetterData, ClassID, Name, "get ")
+                , Setter == nullptr ? v8::Local<v8::FunctionTemplate>() : ToTemplate(Isolate, IsStatic, Setter, SetterData, ClassID, Name, "set "), Attr);
         }
 
         return true;
@@ -656,11 +1009,68 @@ namespace puerts
 
         auto Context = Isolate->GetCurrentContext();
 
+        MaterializeClass(Isolate, Context, ClassID);
         auto Result = Templates[ClassID].Get(Isolate)->GetFunction(Context).ToLocalChecked();
-        Result->Set(Context, FV8Utils::V8String(Isolate, "__puertsMetadata"), Metadatas[ClassID].Get(Isolate));
+        Result->Set(Context, FV8Utils::V8String(Isolate, "__puertsMetadata"), GetMetadata(Isolate, Context, ClassID));
         return Result;
     }
 
+    void JSEngine::AddReadonlyStaticMember(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Map> Metadata, const char* Name)
+    {
+        v8::Local<v8::Set> ReadonlyStaticMembersSet;
+        v8::Local<v8::Value> NameOfTheSet = FV8Utils::V8String(Isolate, "readonlyStaticMembers");
+        v8::Local<v8::Value> ReadonlyStaticMembersSetValue = Metadata->Get(Context, NameOfTheSet).ToLocalChecked();
+        if (ReadonlyStaticMembersSetValue->IsNullOrUndefined())
+        {
+            ReadonlyStaticMembersSet = v8::Set::New(Isolate);
+            Metadata->Set(Context, NameOfTheSet, ReadonlyStaticMembersSet);
+        }
+        else
+        {
+            ReadonlyStaticMembersSet = v8::Local<v8::Set>::Cast(ReadonlyStaticMembersSetValue);
+        }
+        ReadonlyStaticMembersSet->Add(Context, FV8Utils::V8String(Isolate, Name));
+    }
+
+    v8::Local<v8::Map> JSEngine::GetMetadata(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID)
+    {
+        FContextInfo* ContextInfo = FindContextInfo(Context);
+        if (!ContextInfo)
+        {
+            return Metadatas[ClassID].Get(Isolate);
+        }
+        if (ContextInfo->Metadatas.size() <= ClassID)
+        {
+            ContextInfo->Metadatas.resize(Templates.size());
+        }
+        auto& Copy = ContextInfo->Metadatas[ClassID];
+        if (Copy.IsEmpty())
+        {
+            // 主context里的Map不能交给别的context，顺着它的原型链就能改到主context的内置对象，所以逐项复制一份。
+            // key都是字符串，value是数字或者字符串的Set
+            v8::Local<v8::Array> Entries = Metadatas[ClassID].Get(Isolate)->AsArray();
+            v8::Local<v8::Map> Map = v8::Map::New(Isolate);
+            for (uint32_t i = 0; i + 1 < Entries->Length(); i += 2)
+            {
+                v8::Local<v8::Value> Key = Entries->Get(Context, i).ToLocalChecked();
+                v8::Local<v8::Value> Value = Entries->Get(Context, i + 1).ToLocalChecked();
+                if (Value->IsSet())
+                {
+                    v8::Local<v8::Array> Members = Value.As<v8::Set>()->AsArray();
+                    v8::Local<v8::Set> Set = v8::Set::New(Isolate);
+                    for (uint32_t j = 0; j < Members->Length(); ++j)
+                    {
+                        Set->Add(Context, Members->Get(Context, j).ToLocalChecked()).ToLocalChecked();
+                    }
+                    Value = Set;
+                }
+                Map->Set(Context, Key, Value).ToLocalChecked();
+            }
+            Copy.Reset(Isolate, Map);
+        }
+        return Copy.Get(Isolate);
+    }
+
     v8::Local<v8::Value> JSEngine::FindOrAddObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int ClassID, void *Ptr)
     {
         if (!Ptr)
@@ -668,11 +1078,13 @@ namespace puerts
             return v8::Undefined(Isolate);
         }
 
-        auto Iter = ObjectMap.find(Ptr);
-        if (Iter == ObjectMap.end())//create and link
+        auto& Map = ObjectMapOf(FindContextInfo(Context));
+        auto Iter = Map.find(Ptr);
+        if (Iter == Map.end())//create and link
         {
             auto BindTo = v8::External::New(Context->GetIsolate(), Ptr);
             v8::Local<v8::Value> Args[] = { BindTo };
+            MaterializeClass(Isolate, Context, ClassID);
             return Templates[ClassID].Get(Isolate)->GetFunction(Context).ToLocalChecked()->NewInstance(Context, 1, Args).ToLocalChecked();
         }
         else
@@ -701,19 +1113,29 @@ namespace puerts
         JSObject->SetAlignedPointerInInternalField(1, LifeCycleInfo);
         JSObject->SetAlignedPointerInInternalField(2, reinterpret_cast<void *>(OBJECT_MAGIC));
         v8::UniquePersistent<v8::Value> persistent(MainIsolate, JSObject);
-        persistent.SetWeak<FLifeCycleInfo>(LifeCycleInfo, OnGarbageCollected, v8::WeakCallbackType::kInternalFields);
-        ObjectMap[Ptr] = std::move(persistent);
+        FContextInfo* ContextInfo = FindContextInfo(MainIsolate->GetCurrentContext());
+#if !WITH_QUICKJS
+        if (ContextInfo)
+        {
+            persistent.SetWeak<FContextInfo>(ContextInfo, OnGarbageCollectedInContext, v8::WeakCallbackType::kInternalFields);
+        }
+        else
+#endif
+        {
+            persistent.SetWeak<FLifeCycleInfo>(LifeCycleInfo, OnGarbageCollected, v8::WeakCallbackType::kInternalFields);
+        }
+        ObjectMapOf(ContextInfo)[Ptr] = std::move(persistent);
     }
 
-    void JSEngine::UnBindObject(FLifeCycleInfo* LifeCycleInfo, void* Ptr)
+    void JSEngine::UnBindObject(FLifeCycleInfo* LifeCycleInfo, void* Ptr, FContextInfo* ContextInfo)
     {
-        ObjectMap.erase(Ptr);
+        ObjectMapOf(ContextInfo).erase(Ptr);
 
         if (LifeCycleInfo->Size > 0)
         {
             free(Ptr);
         }
-        else
+        else if (!IsBoundInAnyContext(Ptr))
         {
             if (LifeCycleInfo->Destructor)
             {
@@ -722,6 +1144,332 @@ namespace puerts
         }
     }
 
+    bool JSEngine::IsBoundInAnyContext(void* Ptr)
+    {
+        if (Contexts.empty())
+        {
+            return false;
+        }
+        if (ObjectMap.find(Ptr) != ObjectMap.end())
+        {
+            return true;
+        }
+        for (auto& KV : Contexts)
+        {
+            if (KV.second->ObjectMap.find(Ptr) != KV.second->ObjectMap.end())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    FContextInfo* JSEngine::FindContextInfo(v8::Local<v8::Context> Context)
+    {
+#if !WITH_QUICKJS
+        for (auto& KV : Contexts)
+        {
+            if (KV.second->Context == Context)
+            {
+                return KV.second.get();
+            }
+        }
+#endif
+        return nullptr;
+    }
+
+    int32_t JSEngine::FindContextId(v8::Local<v8::Context> Context)
+    {
+#if !WITH_QUICKJS
+        if (MainContext == Context)
+        {
+            return 0;
+        }
+        for (auto& KV : Contexts)
+        {
+            if (KV.second->Context == Context)
+            {
+                return KV.first;
+            }
+        }
+#endif
+        return -1;
+    }
+
+#if !WITH_QUICKJS
+    // 在新context里、任何其它脚本之前执行：从全局对象上的内置对象以及几个没有全局名字的内置原型（生成器、迭代器、%TypedArray%等）出发，
+    // 沿着属性、accessor和原型链把能到达的对象都冻结掉。全局对象本身不冻结，之后仍然可以往上加全局变量
+    static const char* FreezeIntrinsicsScript =
+        "(function () {"
+        "    const seen = new Set();"
+        "    const pending = [];"
+        "    const add = (o) => {"
+        "        if (((typeof o === 'object' && o !== null) || typeof o === 'function') && !seen.has(o)) {"
+        "            seen.add(o);"
+        "            pending.push(o);"
+        "        }"
+        "    };"
+        "    const addProperties = (o) => {"
+        "        for (const key of Reflect.ownKeys(o)) {"
+        "            const desc = Reflect.getOwnPropertyDescriptor(o, key);"
+        "            if (desc) {"
+        "                add(desc.value);"
+        "                add(desc.get);"
+        "                add(desc.set);"
+        "            }"
+        "        }"
+        "    };"
+        "    seen.add(globalThis);"
+        "    addProperties(globalThis);"
+        "    add(Reflect.getPrototypeOf(function* () {}));"
+        "    add(Reflect.getPrototypeOf(async function () {}));"
+        "    add(Reflect.getPrototypeOf(async function* () {}));"
+        "    add(Reflect.getPrototypeOf([][Symbol.iterator]()));"
+        "    add(Reflect.getPrototypeOf(''[Symbol.iterator]()));"
+        "    add(Reflect.getPrototypeOf(new Map()[Symbol.iterator]()));"
+        "    add(Reflect.getPrototypeOf(new Set()[Symbol.iterator]()));"
+        "    add(Reflect.getPrototypeOf(/a/[Symbol.matchAll]('')));"
+        "    add(Reflect.getPrototypeOf(Int8Array));"
+        "    while (pending.length > 0) {"
+        "        const o = pending.pop();"
+        "        Object.freeze(o);"
+        "        add(Reflect.getPrototypeOf(o));"
+        "        addProperties(o);"
+        "    }"
+        "})();";
+
+    // 新context里的__puer_resolve_module_url__、__puer_resolve_module_content__，Data是hook的名字。
+    // 转调主context里JsEnv.cs装的同名函数，只传原始值（对象参数先转成字符串），返回值必须是字符串，异常只带出消息，
+    // 两个context之间不会互相拿到对方的对象
+    static void ForwardModuleHook(const v8::FunctionCallbackInfo<v8::Value>& Info)
+    {
+        v8::Isolate* Isolate = Info.GetIsolate();
+        v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+        auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+
+        std::vector<v8::Local<v8::Value>> Args;
+        for (int i = 0; i < Info.Length(); ++i)
+        {
+            v8::Local<v8::Value> Arg = Info[i];
+            if (Arg->IsObject() && !Arg->ToString(Context).ToLocal(&Arg))
+            {
+                return;
+            }
+            Args.push_back(Arg);
+        }
+
+        v8::Local<v8::Value> Result;
+        std::string Error;
+        {
+            v8::Local<v8::Context> MainContext = JsEngine->MainContext.Get(Isolate);
+            v8::Context::Scope ContextScope(MainContext);
+            v8::TryCatch TryCatch(Isolate);
+            v8::Local<v8::Value> Hook;
+            if (!MainContext->Global()->Get(MainContext, Info.Data()).ToLocal(&Hook) || !Hook->IsFunction())
+            {
+                Error = "module loader hook is not installed in main context";
+            }
+            else if (!Hook.As<v8::Function>()->Call(MainContext, MainContext->Global(), static_cast<int>(Args.size()), Args.data()).ToLocal(&Result))
+            {
+                v8::String::Utf8Value Message(Isolate, TryCatch.Exception());
+                Error = *Message ? *Message : "unknown exception in module loader hook";
+            }
+            else if (!Result->IsString())
+            {
+                Error = "module loader hook should return a string";
+            }
+        }
+        if (!Error.empty())
+        {
+            FV8Utils::ThrowException(Isolate, Error.c_str());
+            return;
+        }
+        Info.GetReturnValue().Set(Result);
+    }
+#endif
+
+    int JSEngine::CreateContext(const char* SecurityToken, bool FreezeIntrinsics)
+    {
+#if WITH_QUICKJS
+        LastExceptionInfo = "multiple contexts is not supported by quickjs backend";
+        return -1;
+#else
+        v8::Isolate* Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+
+        // nodejs后端也是不带node环境的裸context，没有require、process等
+        v8::Local<v8::Context> Context = v8::Context::New(Isolate);
+        v8::Context::Scope ContextScope(Context);
+
+        if (SecurityToken && *SecurityToken)
+        {
+            auto& Token = SecurityTokens[SecurityToken];
+            if (Token.IsEmpty())
+            {
+                Token.Reset(Isolate, v8::Symbol::New(Isolate, FV8Utils::V8String(Isolate, SecurityToken)));
+            }
+            Context->SetSecurityToken(Token.Get(Isolate));
+        }
+
+        if (FreezeIntrinsics)
+        {
+            v8::TryCatch TryCatch(Isolate);
+            v8::Local<v8::Script> Script;
+            if (!v8::Script::Compile(Context, FV8Utils::V8String(Isolate, FreezeIntrinsicsScript)).ToLocal(&Script) || Script->Run(Context).IsEmpty())
+            {
+                SetLastException(TryCatch.Exception());
+                return -1;
+            }
+        }
+
+        // 不注入__tgjsSetPromiseRejectCallback、__puertsGetLastException、__puertsGetMessagePort：它们是isolate级别的，会把主context的对象交出来
+        v8::Local<v8::Object> Global = Context->Global();
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__tgjsEvalScript"), v8::FunctionTemplate::New(Isolate, &EvalWithPath)->GetFunction(Context).ToLocalChecked()).Check();
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__puer_execute_module_sync__"), v8::FunctionTemplate::New(Isolate, puerts::esmodule::ExecuteModule)->GetFunction(Context).ToLocalChecked()).Check();
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__puer_invalidate_modules__"), v8::FunctionTemplate::New(Isolate, puerts::esmodule::InvalidateModules)->GetFunction(Context).ToLocalChecked()).Check();
+#if PUERTS_MODULE_STREAMING
+        Global->Set(Context, FV8Utils::V8String(Isolate, "__puer_prefetch_module__"), v8::FunctionTemplate::New(Isolate, puerts::esmodule::PrefetchModule)->GetFunction(Context).ToLocalChecked()).Check();
+#endif
+        // esmodule::ExecuteModule按当前context的全局对象找resolve/read，每个context都要有自己的一份
+        for (const char* HookName : { "__puer_resolve_module_url__", "__puer_resolve_module_content__" })
+        {
+            auto Name = FV8Utils::V8String(Isolate, HookName);
+            Global->Set(Context, Name, v8::FunctionTemplate::New(Isolate, &ForwardModuleHook, Name)->GetFunction(Context).ToLocalChecked()).Check();
+        }
+
+        std::unique_ptr<FContextInfo> ContextInfo(new FContextInfo());
+        ContextInfo->Context.Reset(Isolate, Context);
+        ContextInfo->JSObjectIdMap.Reset(Isolate, v8::Map::New(Isolate));
+        BackendEnv.ContextEnvs.emplace_back(v8::Global<v8::Context>(Isolate, Context), &ContextInfo->ModuleEnv);
+
+        int32_t ContextId = ++LastContextId;
+        Contexts[ContextId] = std::move(ContextInfo);
+        // 新context里的prototype是新生成的，延迟安装的成员在这里都还没装
+        for (FLazyClassInfo* LazyClassInfo : LazyClassInfos)
+        {
+            if (LazyClassInfo)
+            {
+                LazyClassInfo->PendingCount += LazyClassInfo->LazyCount;
+            }
+        }
+        return ContextId;
+#endif
+    }
+
+    bool JSEngine::EnterContext(int ContextId)
+    {
+        v8::Isolate* Isolate = MainIsolate;
+        if (ContextId != 0 && Contexts.find(ContextId) == Contexts.end())
+        {
+            return false;
+        }
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        ResultInfo.Context.Reset(Isolate, ContextId == 0 ? MainContext.Get(Isolate) : Contexts[ContextId]->Context.Get(Isolate));
+        CurrentContextId = ContextId;
+        return true;
+    }
+
+    bool JSEngine::DestroyContext(int ContextId)
+    {
+        auto Iter = Contexts.find(ContextId);
+        if (Iter == Contexts.end())
+        {
+            return false;
+        }
+        if (CurrentContextId == ContextId)
+        {
+            EnterContext(0);
+        }
+
+        v8::Isolate* Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        FContextInfo* ContextInfo = Iter->second.get();
+        v8::Local<v8::Context> Context = ContextInfo->Context.Get(Isolate);
+        v8::Context::Scope ContextScope(Context);
+
+        // 先整个摘下来，IsBoundInAnyContext就不会再算上这个context。
+        // 包装对象可能还被C#持有的JSFunction/JSObject间接引用着，清掉它们的指针，以免之后访问到已经释放的对象
+        std::map<void*, v8::UniquePersistent<v8::Value>> Objects;
+        Objects.swap(ContextInfo->ObjectMap);
+        for (auto& KV : Objects)
+        {
+            auto Object = KV.second.Get(Isolate).As<v8::Object>();
+            auto LifeCycleInfo = static_cast<FLifeCycleInfo*>(FV8Utils::GetPoninter(Object, 1));
+            KV.second.Reset();
+            Object->SetAlignedPointerInInternalField(0, nullptr);
+            if (!LifeCycleInfo)
+            {
+                continue;
+            }
+            if (LifeCycleInfo->Size > 0)
+            {
+                free(KV.first);
+            }
+            else if (!IsBoundInAnyContext(KV.first) && LifeCycleInfo->Destructor)
+            {
+                LifeCycleInfo->Destructor(KV.first, LifeCycleInfo->Data);
+            }
+        }
+
+        for (auto EnvIter = BackendEnv.ContextEnvs.begin(); EnvIter != BackendEnv.ContextEnvs.end(); ++EnvIter)
+        {
+            if (EnvIter->second == &ContextInfo->ModuleEnv)
+            {
+                BackendEnv.ContextEnvs.erase(EnvIter);
+                break;
+            }
+        }
+
+        ContextInfo->Metadatas.clear();
+        ContextInfo->JSObjectIdMap.Reset();
+        ContextInfo->ModuleEnv.PathToModuleMap.clear();
+        ContextInfo->ModuleEnv.ScriptIdToPathMap.clear();
+#if PUERTS_MODULE_STREAMING
+        ContextInfo->ModuleEnv.CancelModulePrefetch();
+#endif
+        ContextInfo->Context.Reset();
+        Contexts.erase(Iter);
+
+        // 这个context里还没装的成员不再算进PendingCount，已经装过的从记录里去掉
+        for (FLazyClassInfo* LazyClassInfo : LazyClassInfos)
+        {
+            if (!LazyClassInfo)
+            {
+                continue;
+            }
+            for (auto& KV : LazyClassInfo->Members)
+            {
+                if (KV.second.InTemplate)
+                {
+                    continue;
+                }
+                auto& Installed = KV.second.InstalledContexts;
+                auto InstalledIter = std::find(Installed.begin(), Installed.end(), ContextId);
+                if (InstalledIter != Installed.end())
+                {
+                    Installed.erase(InstalledIter);
+                }
+                else
+                {
+                    --LazyClassInfo->PendingCount;
+                }
+            }
+        }
+        return true;
+    }
+
     void JSEngine::LowMemoryNotification()
     {
         MainIsolate->LowMemoryNotification();
@@ -752,16 +1500,147 @@ namespace puerts
 
     void JSEngine::CreateInspector(int32_t Port)
     {    
-        BackendEnv.CreateInspector(MainIsolate, &ResultInfo.Context, Port);
+        BackendEnv.CreateInspector(MainIsolate, &MainContext, Port);
     }
 
     void JSEngine::DestroyInspector()
     {
-        BackendEnv.DestroyInspector(MainIsolate, &ResultInfo.Context);
+        BackendEnv.DestroyInspector(MainIsolate, &MainContext);
+    }
+
+#if !WITH_QUICKJS
+    // C#对象的id只在本JsEnv的对象池里有效，所以只能在同一个JsEnv的两个端口之间传递，按引用传递。
+    // 发送时把js对象暂存起来，收到时原样取回，这样对象在消息路上不会被回收
+    class CSharpObjectMessageHost : public MessageHostDelegate
+    {
+    public:
+        explicit CSharpObjectMessageHost(JSEngine* InEngine) : Engine(InEngine), NextId(0), Dropped(std::make_shared<DroppedIds>()) {}
+
+        virtual bool WriteHostObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Object> Object, v8::ValueSerializer& Serializer, Message& Msg) override
+        {
+            if (Object->InternalFieldCount() != 3 || (intptr_t)Object->GetAlignedPointerFromInternalField(2) != OBJECT_MAGIC)
+            {
+                return false;
+            }
+            uint32_t Id = ++NextId;
+            Posted[Id].Reset(Isolate, Object);
+            Serializer.WriteUint64(reinterpret_cast<uint64_t>(Engine));
+            Serializer.WriteUint32(Id);
+            // 消息销毁时（被读走、发送失败、端口关闭后没人收）把Id交回来，由ReleaseDropped放掉Posted里的引用。
+            // 消息可能在另一个线程、甚至这个host销毁之后才析构，所以只留弱引用
+            std::weak_ptr<DroppedIds> WeakDropped = Dropped;
+            Msg.HostObjects.push_back(std::shared_ptr<void>(nullptr, [WeakDropped, Id](void*)
+            {
+                if (auto Ids = WeakDropped.lock())
+                {
+                    std::lock_guard<std::mutex> Guard(Ids->Mutex);
+                    Ids->Ids.push_back(Id);
+                }
+            }));
+            return true;
+        }
+
+        virtual v8::MaybeLocal<v8::Object> ReadHostObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::ValueDeserializer& Deserializer) override
+        {
+            uint64_t Sender;
+            uint32_t Id;
+            if (!Deserializer.ReadUint64(&Sender) || !Deserializer.ReadUint32(&Id) || Sender != reinterpret_cast<uint64_t>(Engine))
+            {
+                FV8Utils::ThrowException(Isolate, "DataCloneError: C# object can only be posted between ports of the same JsEnv");
+                return v8::MaybeLocal<v8::Object>();
+            }
+            auto Iter = Posted.find(Id);
+            if (Iter == Posted.end())
+            {
+                FV8Utils::ThrowException(Isolate, "DataCloneError: C# object in message has been received");
+                return v8::MaybeLocal<v8::Object>();
+            }
+            v8::Local<v8::Object> Result = Iter->second.Get(Isolate);
+            Posted.erase(Iter);
+            return Result;
+        }
+
+        // 需要在isolate里调用
+        void ReleaseDropped()
+        {
+            std::vector<uint32_t> Ids;
+            {
+                std::lock_guard<std::mutex> Guard(Dropped->Mutex);
+                Ids.swap(Dropped->Ids);
+            }
+            for (uint32_t Id : Ids)
+            {
+                Posted.erase(Id);
+            }
+        }
+
+        struct DroppedIds
+        {
+            std::mutex Mutex;
+
+            std::vector<uint32_t> Ids;
+        };
+
+        JSEngine* Engine;
+
+        uint32_t NextId;
+
+        std::map<uint32_t, v8::Global<v8::Object>> Posted;
+
+        std::shared_ptr<DroppedIds> Dropped;
+    };
+#endif
+
+    void JSEngine::AddMessagePort(const char* Name, std::shared_ptr<MessagePort> Port)
+    {
+#if !WITH_QUICKJS
+        if (!MessageHost)
+        {
+            MessageHost.reset(new CSharpObjectMessageHost(this));
+        }
+#endif
+#ifdef THREAD_SAFE
+        v8::Locker Locker(MainIsolate);
+#endif
+        v8::Isolate::Scope IsolateScope(MainIsolate);
+        MessagePorts[Name].reset(new MessagePortBinding(Port, MessageHost.get()));
+    }
+
+    void JSEngine::DispatchMessages()
+    {
+        if (MessagePorts.empty())
+        {
+            return;
+        }
+        v8::Isolate* Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        v8::Local<v8::Context> Context = MainContext.Get(Isolate);
+        v8::Context::Scope ContextScope(Context);
+
+#if !WITH_QUICKJS
+        static_cast<CSharpObjectMessageHost*>(MessageHost.get())->ReleaseDropped();
+#endif
+        for (auto& KV : MessagePorts)
+        {
+            std::string Error;
+            KV.second->Dispatch(Isolate, Context, Error);
+            if (!Error.empty())
+            {
+                PLog(puerts::Error, "exception in onmessage of port %s: %s", KV.first.c_str(), Error.c_str());
+            }
+        }
     }
 
     void JSEngine::LogicTick()
     {
+        DispatchMessages();
+#if PUERTS_MODULE_STREAMING
+        TickModulePrefetch();
+#endif
 #if WITH_NODEJS
         v8::Isolate* Isolate = MainIsolate;
 #ifdef THREAD_SAFE
@@ -769,21 +1648,118 @@ namespace puerts
 #endif
         v8::Isolate::Scope IsolateScope(Isolate);
         v8::HandleScope HandleScope(Isolate);
-        v8::Local<v8::Context> Context = ResultInfo.Context.Get(Isolate);
+        v8::Local<v8::Context> Context = MainContext.Get(Isolate);
         v8::Context::Scope ContextScope(Context);
 
-        uv_run(NodeUVLoop, UV_RUN_NOWAIT);
+        // 没有活跃handle也没有就绪事件时跳过uv_run；v8的前台任务和延时任务不走uv loop，DrainTasks每帧都要执行
+        NodeUVPump->RunIfReady();
         static_cast<node::MultiIsolatePlatform*>(GPlatform.get())->DrainTasks(Isolate);
 #endif
     }
 
+#if PUERTS_MODULE_STREAMING
+    // 后台解析完的预取模块在这里完成编译，没有进行中的预取时不进isolate
+    void JSEngine::TickModulePrefetch()
+    {
+        bool Pending = BackendEnv.HasModulePrefetch();
+        for (auto& KV : Contexts)
+        {
+            Pending = Pending || KV.second->ModuleEnv.HasModulePrefetch();
+        }
+        if (!Pending)
+        {
+            return;
+        }
+
+        v8::Isolate* Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        if (BackendEnv.HasModulePrefetch())
+        {
+            v8::Local<v8::Context> Context = MainContext.Get(Isolate);
+            v8::Context::Scope ContextScope(Context);
+            BackendEnv.TickModulePrefetch(Isolate, Context);
+        }
+        for (auto& KV : Contexts)
+        {
+            if (KV.second->ModuleEnv.HasModulePrefetch())
+            {
+                v8::Local<v8::Context> Context = KV.second->Context.Get(Isolate);
+                v8::Context::Scope ContextScope(Context);
+                KV.second->ModuleEnv.TickModulePrefetch(Isolate, Context);
+            }
+        }
+    }
+#endif
+
+    int JSEngine::GetUvBackendFd()
+    {
+#if WITH_NODEJS
+        return NodeUVPump->BackendFd();
+#else
+        return -1;
+#endif
+    }
+
+    int JSEngine::GetUvNextTimeout()
+    {
+#if WITH_NODEJS
+        return NodeUVPump->NextTimeout();
+#else
+        return -1;
+#endif
+    }
+
+    bool JSEngine::WaitUvEvents(int32_t MaxWaitMs)
+    {
+#if WITH_NODEJS
+        return NodeUVPump->Wait(MaxWaitMs);
+#else
+        return false;
+#endif
+    }
+
     bool JSEngine::InspectorTick()
     {
         return BackendEnv.InspectorTick() ? 1 : 0;
     }
+
+    bool JSEngine::StartCpuProfile(int32_t SamplingIntervalUs)
+    {
+        return BackendEnv.StartCpuProfile(MainIsolate, SamplingIntervalUs);
+    }
+
+    bool JSEngine::StopCpuProfile(const char* Path)
+    {
+        return BackendEnv.StopCpuProfile(MainIsolate, Path);
+    }
+
+    bool JSEngine::TakeHeapSnapshot(const char* Path)
+    {
+        return BackendEnv.TakeHeapSnapshot(MainIsolate, Path);
+    }
+
+    bool JSEngine::StartSamplingHeapProfiler(uint64_t SampleInterval, int32_t StackDepth)
+    {
+        return BackendEnv.StartSamplingHeapProfiler(MainIsolate, SampleInterval, StackDepth);
+    }
+
+    bool JSEngine::StopSamplingHeapProfiler(const char* Path)
+    {
+        return BackendEnv.StopSamplingHeapProfiler(MainIsolate, Path);
+    }
     
     bool JSEngine::ClearModuleCache(const char* Path)
     {
-        return BackendEnv.ClearModuleCache(MainIsolate, ResultInfo.Context.Get(MainIsolate), Path);
+#ifdef THREAD_SAFE
+        v8::Locker Locker(MainIsolate);
+#endif
+        v8::Isolate::Scope IsolateScope(MainIsolate);
+        v8::HandleScope HandleScope(MainIsolate);
+        v8::Local<v8::Context> Context = ResultInfo.Context.Get(MainIsolate);
+        return BackendEnv::Get(MainIsolate, Context)->ClearModuleCache(MainIsolate, Context, Path);
     }
 }
@@ -8,7 +8,7 @@
 #include <cstring>
 #include "V8Utils.h"
 
-#define API_LEVEL 31
+#define API_LEVEL 35
 
 using puerts::JSEngine;
 using puerts::FValue;
@@ -49,6 +49,13 @@ V8_EXPORT v8::Isolate *CreateJSEngine()
     return JsEngine->MainIsolate;
 }
 
+// 0表示使用v8的默认值，quickjs后端忽略
+V8_EXPORT v8::Isolate *CreateJSEngineWithResourceConstraints(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
+{
+    auto JsEngine = new JSEngine(nullptr, nullptr, MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
+    return JsEngine->MainIsolate;
+}
+
 V8_EXPORT v8::Isolate *CreateJSEngineWithExternalEnv(void* external_quickjs_runtime, void* external_quickjs_context)
 {
 #if WITH_QUICKJS
@@ -108,8 +115,37 @@ V8_EXPORT bool ClearModuleCache(v8::Isolate *Isolate, const char* Path)
 {
     auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
     return JsEngine->ClearModuleCache(Path);
+}
+
+// IsolateA和IsolateB可以是同一个，这时NameA和NameB不能相同
+V8_EXPORT void ConnectMessagePorts(v8::Isolate *IsolateA, const char* NameA, v8::Isolate *IsolateB, const char* NameB, int Capacity)
+{
+    std::shared_ptr<puerts::MessagePort> PortA;
+    std::shared_ptr<puerts::MessagePort> PortB;
+    puerts::MessagePort::CreatePair(PortA, PortB, Capacity > 0 ? static_cast<size_t>(Capacity) : PUERTS_MESSAGE_PORT_CAPACITY);
+    FV8Utils::IsolateData<JSEngine>(IsolateA)->AddMessagePort(NameA, PortA);
+    FV8Utils::IsolateData<JSEngine>(IsolateB)->AddMessagePort(NameB, PortB);
 }   
 
+// 在同一个isolate上再建一个context，返回id（主context是0），失败返回-1，见JSEngine::CreateContext
+V8_EXPORT int CreateContext(v8::Isolate *Isolate, const char* SecurityToken, int FreezeIntrinsics)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->CreateContext(SecurityToken, FreezeIntrinsics != 0);
+}
+
+V8_EXPORT int EnterContext(v8::Isolate *Isolate, int ContextId)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->EnterContext(ContextId) ? 1 : 0;
+}
+
+V8_EXPORT int DestroyContext(v8::Isolate *Isolate, int ContextId)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->DestroyContext(ContextId) ? 1 : 0;
+}
+
 V8_EXPORT int _RegisterClass(v8::Isolate *Isolate, int BaseTypeId, const char *FullName, CSharpConstructorCallback Constructor, CSharpDestructorCallback Destructor, int64_t Data)
 {
     auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
@@ -151,6 +187,27 @@ V8_EXPORT bool IdleNotificationDeadline(v8::Isolate *Isolate, double DeadlineInS
     auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
     return JsEngine->IdleNotificationDeadline(DeadlineInSeconds);
 }
+// BudgetSeconds是这一帧剩余的时间，不是绝对的deadline
+V8_EXPORT int GcIdleNotification(v8::Isolate *Isolate, double BudgetSeconds)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->GcScheduler.NotifyIdle(BudgetSeconds) ? 1 : 0;
+}
+V8_EXPORT void MemoryPressureNotification(v8::Isolate *Isolate, int Level)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    JsEngine->GcScheduler.MemoryPressure(Level);
+}
+V8_EXPORT void GetGcStatistics(v8::Isolate *Isolate, int Kind, puerts::GcPauseStatistics* Statistics)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    *Statistics = JsEngine->GcScheduler.GetStatistics(Kind);
+}
+V8_EXPORT void ResetGcStatistics(v8::Isolate *Isolate)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    JsEngine->GcScheduler.ResetStatistics();
+}
 V8_EXPORT void RequestMinorGarbageCollectionForTesting(v8::Isolate *Isolate)
 {
     auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
@@ -169,6 +226,13 @@ V8_EXPORT void SetGeneralDestructor(v8::Isolate *Isolate, CSharpDestructorCallba
     JsEngine->GeneralDestructor = GeneralDestructor;
 }
 
+// 只影响之后注册的类，quickjs后端忽略
+V8_EXPORT void SetLazyMemberInstallation(v8::Isolate *Isolate, int Enable)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    JsEngine->SetLazyMemberInstallation(Enable != 0);
+}
+
 //-------------------------- begin js call cs --------------------------
 V8_EXPORT const v8::Value *GetArgumentValue(const v8::FunctionCallbackInfo<v8::Value>& Info, int Index)
 {
@@ -971,6 +1035,81 @@ V8_EXPORT void LogicTick(v8::Isolate *Isolate)
     return JsEngine->LogicTick();
 }
 
+V8_EXPORT int GetUvBackendFd(v8::Isolate *Isolate)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->GetUvBackendFd();
+}
+
+V8_EXPORT int GetUvNextTimeout(v8::Isolate *Isolate)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->GetUvNextTimeout();
+}
+
+V8_EXPORT int WaitUvEvents(v8::Isolate *Isolate, int32_t MaxWaitMs)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->WaitUvEvents(MaxWaitMs) ? 1 : 0;
+}
+
+V8_EXPORT int StartCpuProfile(v8::Isolate *Isolate, int32_t SamplingIntervalUs)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->StartCpuProfile(SamplingIntervalUs) ? 1 : 0;
+}
+
+V8_EXPORT int StopCpuProfile(v8::Isolate *Isolate, const char* Path)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->StopCpuProfile(Path) ? 1 : 0;
+}
+
+V8_EXPORT int TakeHeapSnapshot(v8::Isolate *Isolate, const char* Path)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->TakeHeapSnapshot(Path) ? 1 : 0;
+}
+
+V8_EXPORT int StartSamplingHeapProfiler(v8::Isolate *Isolate, uint64_t SampleInterval, int32_t StackDepth)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->StartSamplingHeapProfiler(SampleInterval, StackDepth) ? 1 : 0;
+}
+
+V8_EXPORT int StopSamplingHeapProfiler(v8::Isolate *Isolate, const char* Path)
+{
+    auto JsEngine = FV8Utils::IsolateData<JSEngine>(Isolate);
+    return JsEngine->StopSamplingHeapProfiler(Path) ? 1 : 0;
+}
+
+// 返回调用统计条目组成的平坦数组（布局见CallStatistics.h），未开启PUERTS_CALL_STATISTICS时返回nullptr，Count为0
+V8_EXPORT const void* GetCallStatistics(int* Count)
+{
+#ifdef PUERTS_CALL_STATISTICS
+    return puerts::GetCallStatistics(Count);
+#else
+    *Count = 0;
+    return nullptr;
+#endif
+}
+
+V8_EXPORT double GetCallStatisticsTicksPerSecond()
+{
+#ifdef PUERTS_CALL_STATISTICS
+    return puerts::GetCallStatisticsTicksPerSecond();
+#else
+    return 0;
+#endif
+}
+
+V8_EXPORT void ResetCallStatistics()
+{
+#ifdef PUERTS_CALL_STATISTICS
+    puerts::ResetCallStatistics();
+#endif
+}
+
 //-------------------------- end debug --------------------------
 
 #ifdef __cplusplus
@@ -0,0 +1,389 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// Headless microbenchmark for the cross-language call paths of libpuerts.
+// It only talks to the exported C API (Src/Puerts.cpp), the same way PuertsDLL.cs does,
+// so the numbers are comparable between the v8, quickjs and nodejs backends.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// The engine handles are opaque here, exactly like IntPtr on the C# side.
+typedef void* IsolatePtr;
+typedef void* ResultInfoPtr;
+typedef void* JSFunctionPtr;
+typedef const void* CallbackInfoPtr;
+typedef const void* ValuePtr;
+
+typedef void (*BenchFunctionCallback)(IsolatePtr Isolate, CallbackInfoPtr Info, void* Self, int ParamLen, int64_t UserData);
+
+extern "C" {
+int GetApiLevel();
+int GetLibBackend();
+IsolatePtr CreateJSEngine();
+void DestroyJSEngine(IsolatePtr Isolate);
+void SetGlobalFunction(IsolatePtr Isolate, const char* Name, BenchFunctionCallback Callback, int64_t Data);
+ResultInfoPtr Eval(IsolatePtr Isolate, const char* Code, const char* Path);
+const char* GetLastExceptionInfo(IsolatePtr Isolate, int* Length);
+
+ValuePtr GetArgumentValue(CallbackInfoPtr Info, int Index);
+double GetNumberFromValue(IsolatePtr Isolate, ValuePtr Value, int IsOut);
+const char* GetStringFromValue(IsolatePtr Isolate, ValuePtr Value, int* Length, int IsOut);
+void ReturnNumber(IsolatePtr Isolate, CallbackInfoPtr Info, double Number);
+void ReturnString(IsolatePtr Isolate, CallbackInfoPtr Info, const char* String);
+
+void PushNullForJSFunction(JSFunctionPtr Function);
+void PushBooleanForJSFunction(JSFunctionPtr Function, int B);
+void PushBigIntForJSFunction(JSFunctionPtr Function, int64_t V);
+void PushStringForJSFunction(JSFunctionPtr Function, const char* S);
+void PushNumberForJSFunction(JSFunctionPtr Function, double D);
+ResultInfoPtr InvokeJSFunction(JSFunctionPtr Function, int HasResult);
+double GetNumberFromResult(ResultInfoPtr ResultInfo);
+JSFunctionPtr GetFunctionFromResult(ResultInfoPtr ResultInfo);
+const char* GetFunctionLastExceptionInfo(JSFunctionPtr Function, int* Length);
+void ReleaseJSFunction(IsolatePtr Isolate, JSFunctionPtr Function);
+}
+
+namespace
+{
+struct FBenchOptions
+{
+    int64_t Iterations = 200000;
+    int Rounds = 5;
+    std::string Filter;
+    std::string OutputPath;
+};
+
+struct FBenchResult
+{
+    std::string Name;
+    int64_t Iterations;
+    std::vector<double> RoundNanoseconds;
+};
+
+// Sinks written by the callbacks, they keep the work observable and let us sanity check the dispatch.
+int64_t GCallbackCount = 0;
+int64_t GStringBytes = 0;
+
+void NoopCallback(IsolatePtr Isolate, CallbackInfoPtr Info, void* Self, int ParamLen, int64_t UserData)
+{
+    ++GCallbackCount;
+}
+
+void AddCallback(IsolatePtr Isolate, CallbackInfoPtr Info, void* Self, int ParamLen, int64_t UserData)
+{
+    double A = GetNumberFromValue(Isolate, GetArgumentValue(Info, 0), 0);
+    double B = GetNumberFromValue(Isolate, GetArgumentValue(Info, 1), 0);
+    ReturnNumber(Isolate, Info, A + B);
+}
+
+void GetStringCallback(IsolatePtr Isolate, CallbackInfoPtr Info, void* Self, int ParamLen, int64_t UserData)
+{
+    int Length = 0;
+    GetStringFromValue(Isolate, GetArgumentValue(Info, 0), &Length, 0);
+    GStringBytes += Length;
+}
+
+void ReturnStringCallback(IsolatePtr Isolate, CallbackInfoPtr Info, void* Self, int ParamLen, int64_t UserData)
+{
+    ReturnString(Isolate, Info, "puerts");
+}
+
+const char* BackendName(int Backend)
+{
+    switch (Backend)
+    {
+    case 0:
+        return "v8";
+    case 1:
+        return "nodejs";
+    case 2:
+        return "quickjs";
+    default:
+        return "unknown";
+    }
+}
+
+class FBenchRunner
+{
+public:
+    explicit FBenchRunner(const FBenchOptions& InOptions) : Options(InOptions)
+    {
+        Isolate = CreateJSEngine();
+        SetGlobalFunction(Isolate, "__benchNoop", NoopCallback, 0);
+        SetGlobalFunction(Isolate, "__benchAdd", AddCallback, 0);
+        SetGlobalFunction(Isolate, "__benchGetString", GetStringCallback, 0);
+        SetGlobalFunction(Isolate, "__benchReturnString", ReturnStringCallback, 0);
+    }
+
+    ~FBenchRunner()
+    {
+        for (auto Function : Functions)
+        {
+            ReleaseJSFunction(Isolate, Function);
+        }
+        DestroyJSEngine(Isolate);
+    }
+
+    JSFunctionPtr Compile(const char* Code)
+    {
+        ResultInfoPtr ResultInfo = Eval(Isolate, Code, "bench.js");
+        if (!ResultInfo)
+        {
+            int Length = 0;
+            fprintf(stderr, "eval failed: %s\n", GetLastExceptionInfo(Isolate, &Length));
+            exit(1);
+        }
+        JSFunctionPtr Function = GetFunctionFromResult(ResultInfo);
+        Functions.push_back(Function);
+        return Function;
+    }
+
+    ResultInfoPtr Invoke(JSFunctionPtr Function, int HasResult)
+    {
+        ResultInfoPtr ResultInfo = InvokeJSFunction(Function, HasResult);
+        if (!ResultInfo)
+        {
+            int Length = 0;
+            fprintf(stderr, "invoke failed: %s\n", GetFunctionLastExceptionInfo(Function, &Length));
+            exit(1);
+        }
+        return ResultInfo;
+    }
+
+    // Body is called once per round and must perform exactly Iterations operations.
+    void Run(const std::string& Name, int64_t Iterations, const std::function<void(int64_t)>& Body)
+    {
+        if (!Options.Filter.empty() && Name.find(Options.Filter) == std::string::npos)
+        {
+            return;
+        }
+
+        FBenchResult Result;
+        Result.Name = Name;
+        Result.Iterations = Iterations;
+
+        Body(std::max<int64_t>(Iterations / 10, 1));    // warm up, let the jit settle
+        for (int i = 0; i < Options.Rounds; ++i)
+        {
+            auto Start = std::chrono::steady_clock::now();
+            Body(Iterations);
+            auto End = std::chrono::steady_clock::now();
+            Result.RoundNanoseconds.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count()));
+        }
+        fprintf(stderr, "%s done\n", Name.c_str());
+        Results.push_back(std::move(Result));
+    }
+
+    void RunAll()
+    {
+        const int64_t N = Options.Iterations;
+
+        // cs call js: InvokeJSFunction round trip
+        {
+            JSFunctionPtr Empty = Compile("(function() {})");
+            Run("invoke/void", N, [&](int64_t Count) {
+                for (int64_t i = 0; i < Count; ++i)
+                {
+                    Invoke(Empty, 0);
+                }
+            });
+
+            JSFunctionPtr Identity = Compile("(function(a) { return a; })");
+            Run("invoke/number_roundtrip", N, [&](int64_t Count) {
+                double Sum = 0;
+                for (int64_t i = 0; i < Count; ++i)
+                {
+                    PushNumberForJSFunction(Identity, static_cast<double>(i));
+                    Sum += GetNumberFromResult(Invoke(Identity, 1));
+                }
+                Sink += Sum;
+            });
+        }
+
+        // cs call js: Push*ForJSFunction by arity
+        {
+            JSFunctionPtr Variadic = Compile("(function() { return arguments.length; })");
+            const int Arities[] = {1, 2, 4, 8};
+            for (int Arity : Arities)
+            {
+                Run("push/number/arity" + std::to_string(Arity), N, [&](int64_t Count) {
+                    for (int64_t i = 0; i < Count; ++i)
+                    {
+                        for (int j = 0; j < Arity; ++j)
+                        {
+                            PushNumberForJSFunction(Variadic, static_cast<double>(j));
+                        }
+                        Invoke(Variadic, 0);
+                    }
+                });
+                Run("push/string/arity" + std::to_string(Arity), N, [&](int64_t Count) {
+                    for (int64_t i = 0; i < Count; ++i)
+                    {
+                        for (int j = 0; j < Arity; ++j)
+                        {
+                            PushStringForJSFunction(Variadic, "puerts");
+                        }
+                        Invoke(Variadic, 0);
+                    }
+                });
+            }
+            Run("push/mixed/arity5", N, [&](int64_t Count) {
+                for (int64_t i = 0; i < Count; ++i)
+                {
+                    PushNumberForJSFunction(Variadic, 1.0);
+                    PushStringForJSFunction(Variadic, "puerts");
+                    PushBooleanForJSFunction(Variadic, 1);
+                    PushBigIntForJSFunction(Variadic, i);
+                    PushNullForJSFunction(Variadic);
+                    Invoke(Variadic, 0);
+                }
+            });
+        }
+
+        // js call cs: CSharpFunctionCallbackWrap dispatch, the loop stays in js so only the dispatch is measured
+        {
+            JSFunctionPtr Noop = Compile("(function(n) { for (let i = 0; i < n; ++i) __benchNoop(); })");
+            Run("callback/noop", N, [&](int64_t Count) {
+                PushNumberForJSFunction(Noop, static_cast<double>(Count));
+                Invoke(Noop, 0);
+            });
+
+            JSFunctionPtr Add = Compile("(function(n) { let s = 0; for (let i = 0; i < n; ++i) s = __benchAdd(s, 1); return s; })");
+            Run("callback/number_arity2", N, [&](int64_t Count) {
+                PushNumberForJSFunction(Add, static_cast<double>(Count));
+                Sink += GetNumberFromResult(Invoke(Add, 1));
+            });
+
+            JSFunctionPtr Str = Compile("(function(n) { let s; for (let i = 0; i < n; ++i) s = __benchReturnString(); return s.length; })");
+            Run("callback/return_string", N, [&](int64_t Count) {
+                PushNumberForJSFunction(Str, static_cast<double>(Count));
+                Sink += GetNumberFromResult(Invoke(Str, 1));
+            });
+        }
+
+        // js call cs: GetStringFromValue by string size, ascii and multi-byte
+        {
+            JSFunctionPtr GetString = Compile(
+                "(function(n, size, ch) { const s = ch.repeat(size); for (let i = 0; i < n; ++i) __benchGetString(s); })");
+            const int Sizes[] = {8, 64, 1024, 16384};
+            for (int Size : Sizes)
+            {
+                // big strings are dominated by the copy, keep the total runtime in the same ballpark
+                int64_t Count = std::max<int64_t>(N / std::max(Size / 64, 1), 1000);
+                Run("get_string/ascii/" + std::to_string(Size), Count, [&](int64_t InCount) {
+                    PushNumberForJSFunction(GetString, static_cast<double>(InCount));
+                    PushNumberForJSFunction(GetString, Size);
+                    PushStringForJSFunction(GetString, "x");
+                    Invoke(GetString, 0);
+                });
+                Run("get_string/utf8/" + std::to_string(Size), Count, [&](int64_t InCount) {
+                    PushNumberForJSFunction(GetString, static_cast<double>(InCount));
+                    PushNumberForJSFunction(GetString, Size);
+                    PushStringForJSFunction(GetString, "\xe4\xb8\xad");    // U+4E2D
+                    Invoke(GetString, 0);
+                });
+            }
+        }
+    }
+
+    void WriteJson(FILE* Out) const
+    {
+        fprintf(Out, "{\n");
+        fprintf(Out, "  \"backend\": \"%s\",\n", BackendName(GetLibBackend()));
+        fprintf(Out, "  \"apiLevel\": %d,\n", GetApiLevel());
+        fprintf(Out, "  \"rounds\": %d,\n", Options.Rounds);
+        fprintf(Out, "  \"checksum\": %.1f,\n", Sink + static_cast<double>(GCallbackCount) + static_cast<double>(GStringBytes));
+        fprintf(Out, "  \"results\": [");
+        for (size_t i = 0; i < Results.size(); ++i)
+        {
+            const FBenchResult& Result = Results[i];
+            std::vector<double> Sorted = Result.RoundNanoseconds;
+            std::sort(Sorted.begin(), Sorted.end());
+            double Iterations = static_cast<double>(Result.Iterations);
+            double MinNs = Sorted.front() / Iterations;
+            double MedianNs = Sorted[Sorted.size() / 2] / Iterations;
+            double MaxNs = Sorted.back() / Iterations;
+            fprintf(Out, "%s\n    {\"name\": \"%s\", \"iterations\": %lld, \"nsPerOpMin\": %.3f, \"nsPerOpMedian\": %.3f, \"nsPerOpMax\": %.3f, \"opsPerSec\": %.1f}",
+                i == 0 ? "" : ",", Result.Name.c_str(), static_cast<long long>(Result.Iterations), MinNs, MedianNs, MaxNs, 1e9 / MedianNs);
+        }
+        fprintf(Out, "\n  ]\n}\n");
+    }
+
+private:
+    FBenchOptions Options;
+    IsolatePtr Isolate;
+    std::vector<JSFunctionPtr> Functions;
+    std::vector<FBenchResult> Results;
+    double Sink = 0;
+};
+}    // namespace
+
+static void PrintUsage(const char* Program)
+{
+    fprintf(stderr, "usage: %s [--iterations N] [--rounds N] [--filter SUBSTRING] [--output FILE]\n", Program);
+}
+
+int main(int argc, char** argv)
+{
+    FBenchOptions Options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* Arg = argv[i];
+        const char* Next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!Next)
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        if (strcmp(Arg, "--iterations") == 0)
+        {
+            Options.Iterations = std::max<int64_t>(atoll(Next), 1);
+        }
+        else if (strcmp(Arg, "--rounds") == 0)
+        {
+            Options.Rounds = std::max(atoi(Next), 1);
+        }
+        else if (strcmp(Arg, "--filter") == 0)
+        {
+            Options.Filter = Next;
+        }
+        else if (strcmp(Arg, "--output") == 0)
+        {
+            Options.OutputPath = Next;
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    FBenchRunner Runner(Options);
+    Runner.RunAll();
+
+    FILE* Out = Options.OutputPath.empty() ? stdout : fopen(Options.OutputPath.c_str(), "w");
+    if (!Out)
+    {
+        fprintf(stderr, "can not open %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+    Runner.WriteJson(Out);
+    if (Out != stdout)
+    {
+        fclose(Out);
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// Binds a sample class through V8Backend.hpp with the engine independent JSClassRegister/CppObjectMapper
+// and checks that TurboFan takes the fast api path, and that invalid receivers/arguments never reach native code.
+// v8 >= 12 can not replay a fast call through the slow callback, there only free functions whose arguments can not be
+// rejected get a fast path, everything else has to keep the slow path semantics.
+
+#include <climits>
+
+#include "V8TestEnv.h"
+
+#include "Binding.hpp"
+#include "CppObjectMapper.h"
+
+class FFastCallSample
+{
+public:
+    int32_t Add(int32_t A, int32_t B)
+    {
+        return A + B + Base;
+    }
+
+    double Scale(double Value) const
+    {
+        return Value * Base;
+    }
+
+    void SetBase(uint32_t Value)
+    {
+        Base = static_cast<int32_t>(Value);
+    }
+
+    static bool IsPositive(int32_t Value)
+    {
+        return Value > 0;
+    }
+
+    static int32_t BaseOf(FFastCallSample* Sample)
+    {
+        return Sample ? Sample->Base : -1;
+    }
+
+    static double FirstOf(double* Values)
+    {
+        return Values ? Values[0] : -1;
+    }
+
+    int32_t Base = 1;
+};
+
+class FFastCallOther
+{
+public:
+    int32_t Padding[4] = {0};
+};
+
+UsingCppType(FFastCallSample);
+UsingCppType(FFastCallOther);
+
+namespace puerts
+{
+namespace test
+{
+template <typename Sig, Sig Func>
+static uint64_t FastHits()
+{
+    return V8FastCall<Sig, Func>::statistics()->FastHits.load();
+}
+
+template <typename Sig, Sig Func>
+static uint64_t SlowHits()
+{
+    return V8FastCall<Sig, Func>::statistics()->SlowHits.load();
+}
+
+// member functions, object pointer and typed array arguments
+#if V8_MAJOR_VERSION >= 12
+static constexpr bool CheckedSignatureTakesFastPath = false;
+#else
+static constexpr bool CheckedSignatureTakesFastPath = true;
+#endif
+
+// checks which path the calls since FastBefore/SlowBefore took
+template <typename Sig, Sig Func>
+static void ExpectPath(bool Fast, uint64_t FastBefore, uint64_t SlowBefore)
+{
+    if (Fast)
+    {
+        EXPECT_GT((FastHits<Sig, Func>()), FastBefore);
+    }
+    else
+    {
+        EXPECT_EQ(FastBefore, (FastHits<Sig, Func>()));
+        EXPECT_GT((SlowHits<Sig, Func>()), SlowBefore);
+    }
+}
+
+class FastCallTest : public V8Test
+{
+protected:
+    static void LoadCppType(const v8::FunctionCallbackInfo<v8::Value>& Info)
+    {
+        static_cast<FCppObjectMapper*>(DataTransfer::IsolateData<ICppObjectMapper>(Info.GetIsolate()))->LoadCppType(Info);
+    }
+
+    void SetUp() override
+    {
+        static bool Registered = false;
+        if (!Registered)
+        {
+            Registered = true;
+            DefineClass<FFastCallSample>()
+                .Constructor<>()
+                .Method("Add", MakeFunction(&FFastCallSample::Add))
+                .Method("Scale", MakeFunction(&FFastCallSample::Scale))
+                .Method("SetBase", MakeFunction(&FFastCallSample::SetBase))
+                .Function("IsPositive", MakeFunction(&FFastCallSample::IsPositive))
+                .Function("BaseOf", MakeFunction(&FFastCallSample::BaseOf))
+                .Function("FirstOf", MakeFunction(&FFastCallSample::FirstOf))
+                .Register();
+            DefineClass<FFastCallOther>().Constructor<>().Register();
+        }
+
+        V8Test::SetUp();
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        v8::Local<v8::Context> LocalContext = Context.Get(Isolate);
+        v8::Context::Scope ContextScope(LocalContext);
+
+        Isolate->SetData(MAPPER_ISOLATE_DATA_POS, static_cast<ICppObjectMapper*>(&CppObjectMapper));
+        CppObjectMapper.Initialize(Isolate, LocalContext);
+        LocalContext->Global()
+            ->Set(LocalContext, v8::String::NewFromUtf8(Isolate, "loadCppType").ToLocalChecked(),
+                v8::FunctionTemplate::New(Isolate, LoadCppType)->GetFunction(LocalContext).ToLocalChecked())
+            .Check();
+        Run("const Sample = loadCppType('FFastCallSample'); const Other = loadCppType('FFastCallOther');"
+            "function optimize(f, ...args) {"
+            "    %PrepareFunctionForOptimization(f); f(...args); f(...args);"
+            "    %OptimizeFunctionOnNextCall(f); return f(...args);"
+            "}");
+    }
+
+    void TearDown() override
+    {
+        {
+            v8::Isolate::Scope IsolateScope(Isolate);
+            v8::HandleScope HandleScope(Isolate);
+            CppObjectMapper.UnInitialize(Isolate);
+        }
+        V8Test::TearDown();
+    }
+
+    int32_t RunInt(const char* Code)
+    {
+        v8::Local<v8::Value> Result = Run(Code);
+        return Result.IsEmpty() ? INT32_MIN : Result->Int32Value(Context.Get(Isolate)).FromMaybe(INT32_MIN);
+    }
+
+    FCppObjectMapper CppObjectMapper;
+};
+
+TEST_F(FastCallTest, MemberFunctionTakesFastPath)
+{
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+    const uint64_t FastBefore = FastHits<decltype(&FFastCallSample::Add), &FFastCallSample::Add>();
+    const uint64_t SlowBefore = SlowHits<decltype(&FFastCallSample::Add), &FFastCallSample::Add>();
+    EXPECT_EQ(6, RunInt("const s = new Sample(); optimize((o, a, b) => o.Add(a, b), s, 2, 3)"));
+    ExpectPath<decltype(&FFastCallSample::Add), &FFastCallSample::Add>(CheckedSignatureTakesFastPath, FastBefore, SlowBefore);
+
+    // unsigned argument, void return, const member and double
+    const uint64_t ScaleFastBefore = FastHits<decltype(&FFastCallSample::Scale), &FFastCallSample::Scale>();
+    const uint64_t ScaleSlowBefore = SlowHits<decltype(&FFastCallSample::Scale), &FFastCallSample::Scale>();
+    const uint64_t SetBaseFastBefore = FastHits<decltype(&FFastCallSample::SetBase), &FFastCallSample::SetBase>();
+    const uint64_t SetBaseSlowBefore = SlowHits<decltype(&FFastCallSample::SetBase), &FFastCallSample::SetBase>();
+    EXPECT_EQ(10, RunInt("optimize((o, v) => { o.SetBase(v); return o.Scale(2.5); }, s, 4)"));
+    ExpectPath<decltype(&FFastCallSample::Scale), &FFastCallSample::Scale>(
+        CheckedSignatureTakesFastPath, ScaleFastBefore, ScaleSlowBefore);
+    ExpectPath<decltype(&FFastCallSample::SetBase), &FFastCallSample::SetBase>(
+        CheckedSignatureTakesFastPath, SetBaseFastBefore, SetBaseSlowBefore);
+}
+
+TEST_F(FastCallTest, StaticFunctionTakesFastPath)
+{
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+    const uint64_t FastBefore = FastHits<decltype(&FFastCallSample::IsPositive), &FFastCallSample::IsPositive>();
+    EXPECT_EQ(1, RunInt("optimize((v) => Sample.IsPositive(v) ? 1 : 0, 7)"));
+    EXPECT_GT((FastHits<decltype(&FFastCallSample::IsPositive), &FFastCallSample::IsPositive>()), FastBefore);
+
+    const uint64_t PtrFastBefore = FastHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>();
+    const uint64_t PtrSlowBefore = SlowHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>();
+    EXPECT_EQ(1, RunInt("optimize((o) => Sample.BaseOf(o), new Sample())"));
+    ExpectPath<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>(
+        CheckedSignatureTakesFastPath, PtrFastBefore, PtrSlowBefore);
+}
+
+TEST_F(FastCallTest, TypedArrayArgument)
+{
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+    const uint64_t FastBefore = FastHits<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>();
+    const uint64_t SlowBefore = SlowHits<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>();
+    EXPECT_EQ(5, RunInt("optimize((a) => Sample.FirstOf(a) * 2, new Float64Array([2.5, 7]))"));
+#if V8_MAJOR_VERSION >= 10
+    ExpectPath<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>(
+        CheckedSignatureTakesFastPath, FastBefore, SlowBefore);
+#else
+    ExpectPath<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>(false, FastBefore, SlowBefore);
+#endif
+
+    // a [value] holder and a typed array of another element type are not Float64Array, they never reach the fast path
+    const uint64_t HolderFastBefore = FastHits<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>();
+    EXPECT_EQ(3, RunInt("const firstOf = (a) => Sample.FirstOf(a); optimize(firstOf, new Float64Array([1])); firstOf([3])"));
+    Run("firstOf(new Int32Array([1]))");
+    EXPECT_EQ(HolderFastBefore, (FastHits<decltype(&FFastCallSample::FirstOf), &FFastCallSample::FirstOf>()));
+}
+
+TEST_F(FastCallTest, InvalidArgumentNeverReachesFastPath)
+{
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+    Run("const baseOf = (o) => Sample.BaseOf(o); optimize(baseOf, new Sample());");
+    const uint64_t FastBefore = FastHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>();
+
+    // the slow callback maps null / non cpp objects to nullptr, whichever path the optimized code would take
+    const uint64_t SlowBefore = SlowHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>();
+    EXPECT_EQ(-1, RunInt("baseOf(null)"));
+    EXPECT_EQ(-1, RunInt("baseOf({})"));
+    EXPECT_GT((SlowHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>()), SlowBefore);
+    // an object of another registered class is rejected by type id instead of being dereferenced as FFastCallSample
+    Run("try { baseOf(new Other()); } catch (e) {}");
+    EXPECT_EQ(FastBefore, (FastHits<decltype(&FFastCallSample::BaseOf), &FFastCallSample::BaseOf>()));
+}
+
+TEST_F(FastCallTest, InvalidReceiverNeverReachesFastPath)
+{
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+    Run("const add = (o) => Sample.prototype.Add.call(o, 1, 2); optimize(add, new Sample());");
+    const uint64_t FastBefore = FastHits<decltype(&FFastCallSample::Add), &FFastCallSample::Add>();
+    EXPECT_EQ(1, RunInt("(() => { try { add({}); return 0; } catch (e) { return 1; } })()"));
+    EXPECT_EQ(FastBefore, (FastHits<decltype(&FFastCallSample::Add), &FFastCallSample::Add>()));
+}
+}    // namespace test
+}    // namespace puerts
@@ -0,0 +1,128 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+#pragma once
+
+// the linked list FObjectCacheNode the inline/overflow storage replaced, kept as the reference model of
+// ObjectCacheNodeFuzzTest. TUserData is UserData (ue) or ObjectIndex (il2cpp).
+// one intended difference: the original move assignment left UserData behind when the head was removed, here it
+// moves with the handle like the new node does.
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
+
+namespace puerts
+{
+namespace test
+{
+template <typename TUserData>
+class TLegacyObjectCacheNode
+{
+public:
+    TLegacyObjectCacheNode(const void* TypeId_) : TypeId(TypeId_), UserData(), Next(nullptr)
+    {
+    }
+
+    TLegacyObjectCacheNode(const void* TypeId_, TLegacyObjectCacheNode* Next_) : TypeId(TypeId_), UserData(), Next(Next_)
+    {
+    }
+
+    TLegacyObjectCacheNode(TLegacyObjectCacheNode&& other) noexcept
+        : TypeId(other.TypeId), UserData(other.UserData), Next(other.Next), Value(std::move(other.Value))
+    {
+        other.TypeId = nullptr;
+        other.UserData = TUserData();
+        other.Next = nullptr;
+    }
+
+    TLegacyObjectCacheNode& operator=(TLegacyObjectCacheNode&& rhs) noexcept
+    {
+        TypeId = rhs.TypeId;
+        UserData = rhs.UserData;
+        Next = rhs.Next;
+        Value = std::move(rhs.Value);
+        rhs.TypeId = nullptr;
+        rhs.UserData = TUserData();
+        rhs.Next = nullptr;
+        return *this;
+    }
+
+    ~TLegacyObjectCacheNode()
+    {
+        if (Next)
+            delete Next;
+    }
+
+    TLegacyObjectCacheNode* Find(const void* TypeId_)
+    {
+        if (TypeId_ == TypeId)
+        {
+            return this;
+        }
+        if (Next)
+        {
+            return Next->Find(TypeId_);
+        }
+        return nullptr;
+    }
+
+    TLegacyObjectCacheNode* Remove(const void* TypeId_, bool IsHead)
+    {
+        if (TypeId_ == TypeId)
+        {
+            if (IsHead)
+            {
+                if (Next)
+                {
+                    auto PreNext = Next;
+                    *this = std::move(*Next);
+                    delete PreNext;
+                }
+                else
+                {
+                    TypeId = nullptr;
+                    UserData = TUserData();
+                    Next = nullptr;
+                    Value.Reset();
+                }
+            }
+            return this;
+        }
+        if (Next)
+        {
+            auto Removed = Next->Remove(TypeId_, false);
+            if (Removed && Removed == Next)    // detach & delete by prev node
+            {
+                Next = Removed->Next;
+                Removed->Next = nullptr;
+                delete Removed;
+            }
+            return Removed;
+        }
+        return nullptr;
+    }
+
+    TLegacyObjectCacheNode* Add(const void* TypeId_)
+    {
+        Next = new TLegacyObjectCacheNode(TypeId_, Next);
+        return Next;
+    }
+
+    const void* TypeId;
+
+    TUserData UserData;
+
+    TLegacyObjectCacheNode* Next;
+
+    v8::UniquePersistent<v8::Value> Value;
+
+    TLegacyObjectCacheNode(const TLegacyObjectCacheNode&) = delete;
+    void operator=(const TLegacyObjectCacheNode&) = delete;
+};
+}    // namespace test
+}    // namespace puerts
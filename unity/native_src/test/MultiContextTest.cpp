@@ -0,0 +1,151 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// Drives CreateContext/EnterContext/DestroyContext of libpuerts through the exported C API (Src/Puerts.cpp), the way
+// PuertsDLL.cs does. The module loader hooks JsEnv.cs installs in the main context are replaced by a small js table.
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+typedef void* IsolatePtr;
+typedef void* ResultInfoPtr;
+
+extern "C" {
+int GetLibBackend();
+IsolatePtr CreateJSEngine();
+void DestroyJSEngine(IsolatePtr Isolate);
+ResultInfoPtr Eval(IsolatePtr Isolate, const char* Code, const char* Path);
+const char* GetLastExceptionInfo(IsolatePtr Isolate, int* Length);
+const char* GetStringFromResult(ResultInfoPtr ResultInfo, int* Length);
+int CreateContext(IsolatePtr Isolate, const char* SecurityToken, int FreezeIntrinsics);
+int EnterContext(IsolatePtr Isolate, int ContextId);
+int DestroyContext(IsolatePtr Isolate, int ContextId);
+}
+
+namespace puerts
+{
+namespace test
+{
+static const char* ModuleLoaderScript =
+    "(function() {"
+    "    const files = {"
+    "        'main.mjs': \"import { value } from 'dep.mjs'; globalThis.loaded = true; export const result = String(value + 1);\","
+    "        'dep.mjs': 'export const value = 41;',"
+    "    };"
+    "    globalThis.__puer_resolve_module_url__ = function(specifier, referer) {"
+    "        if (!(specifier in files)) throw new Error('module not found: ' + specifier);"
+    "        return specifier;"
+    "    };"
+    "    globalThis.__puer_resolve_module_content__ = function(specifier) {"
+    "        return files[specifier];"
+    "    };"
+    "})();";
+
+class MultiContextTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Isolate = CreateJSEngine();
+        ASSERT_NE(nullptr, Isolate);
+        ASSERT_NE(nullptr, Eval(Isolate, ModuleLoaderScript, "loader.js")) << LastException();
+    }
+
+    void TearDown() override
+    {
+        if (Isolate)
+        {
+            DestroyJSEngine(Isolate);
+        }
+    }
+
+    std::string LastException()
+    {
+        int Length = 0;
+        const char* Info = GetLastExceptionInfo(Isolate, &Length);
+        return Info ? std::string(Info, Length) : std::string();
+    }
+
+    // 失败时返回"exception: "加上异常信息
+    std::string EvalString(const char* Code)
+    {
+        ResultInfoPtr Result = Eval(Isolate, Code, "test.js");
+        if (!Result)
+        {
+            return "exception: " + LastException();
+        }
+        int Length = 0;
+        const char* Str = GetStringFromResult(Result, &Length);
+        return Str ? std::string(Str, Length) : std::string();
+    }
+
+    int CreateContextOrSkip()
+    {
+        int ContextId = CreateContext(Isolate, nullptr, 0);
+        if (GetLibBackend() == 2)
+        {
+            EXPECT_EQ(-1, ContextId);
+        }
+        else
+        {
+            EXPECT_GT(ContextId, 0) << LastException();
+        }
+        return ContextId;
+    }
+
+    IsolatePtr Isolate = nullptr;
+};
+
+TEST_F(MultiContextTest, ExecuteModuleInCreatedContext)
+{
+    int ContextId = CreateContextOrSkip();
+    if (ContextId <= 0)
+    {
+        GTEST_SKIP() << "multiple contexts is not supported by this backend";
+    }
+
+    // 新context里的模块通过主context的hook解析和读取，但在自己的全局对象上执行
+    ASSERT_EQ(1, EnterContext(Isolate, ContextId));
+    EXPECT_EQ("42", EvalString("__puer_execute_module_sync__('main.mjs').result"));
+    EXPECT_EQ("true", EvalString("String(globalThis.loaded)"));
+
+    // hook只带出字符串，拿不到主context的对象
+    EXPECT_EQ("true", EvalString("String(__puer_resolve_module_url__.constructor('return globalThis')() === globalThis)"));
+    EXPECT_EQ("true:true", EvalString(
+        "(function() {"
+        "    try { __puer_execute_module_sync__('missing.mjs'); return 'no exception'; }"
+        "    catch (e) { return (e instanceof Error) + ':' + (String(e.message).indexOf('missing.mjs') >= 0); }"
+        "})()"));
+
+    // 模块表按context区分
+    ASSERT_EQ(1, EnterContext(Isolate, 0));
+    EXPECT_EQ("undefined", EvalString("typeof globalThis.loaded"));
+    EXPECT_EQ("42", EvalString("__puer_execute_module_sync__('main.mjs').result"));
+
+    EXPECT_EQ(1, DestroyContext(Isolate, ContextId));
+    EXPECT_EQ(0, EnterContext(Isolate, ContextId));
+}
+
+TEST_F(MultiContextTest, MissingLoaderHookThrows)
+{
+    int ContextId = CreateContextOrSkip();
+    if (ContextId <= 0)
+    {
+        GTEST_SKIP() << "multiple contexts is not supported by this backend";
+    }
+
+    ASSERT_NE(nullptr, Eval(Isolate, "delete globalThis.__puer_resolve_module_content__;", "test.js"));
+    ASSERT_EQ(1, EnterContext(Isolate, ContextId));
+    const std::string Result = EvalString("__puer_execute_module_sync__('main.mjs').result");
+    EXPECT_EQ(0u, Result.find("exception: ")) << Result;
+    EXPECT_NE(std::string::npos, Result.find("hook")) << Result;
+
+    EXPECT_EQ(1, DestroyContext(Isolate, ContextId));
+}
+}    // namespace test
+}    // namespace puerts
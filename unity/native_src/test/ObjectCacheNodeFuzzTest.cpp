@@ -0,0 +1,216 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// Drives the inline/overflow FObjectCacheNode and the linked list it replaced with the same random bind/unbind/find
+// sequence, the way CppObjectMapper uses them (one node per pointer, erased when empty), and checks that they agree on
+// every result, on entry order and on which handles are alive.
+// Compiled once against the ue header (PUERTS_TEST_USER_DATA_FIELD=UserData) and once against the il2cpp one
+// (PUERTS_TEST_USER_DATA_FIELD=ObjectIndex).
+
+#include <random>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "V8TestEnv.h"
+
+#include "LegacyObjectCacheNode.h"
+#include "ObjectCacheNode.h"
+
+#ifndef PUERTS_TEST_USER_DATA_FIELD
+#error "PUERTS_TEST_USER_DATA_FIELD must name the user data member of FObjectCacheNode::FEntry"
+#endif
+
+namespace puerts
+{
+namespace test
+{
+using FUserData = decltype(FObjectCacheNode::FEntry::PUERTS_TEST_USER_DATA_FIELD);
+
+using FLegacyNode = TLegacyObjectCacheNode<FUserData>;
+
+template <typename T>
+static typename std::enable_if<std::is_pointer<T>::value, T>::type MakeUserData(uint32_t Value)
+{
+    return reinterpret_cast<T>(static_cast<uintptr_t>(Value) * 16);
+}
+
+template <typename T>
+static typename std::enable_if<!std::is_pointer<T>::value, T>::type MakeUserData(uint32_t Value)
+{
+    return static_cast<T>(Value);
+}
+
+class ObjectCacheNodeFuzzTest : public V8Test
+{
+protected:
+    static constexpr int TypeCount = 9;
+
+    const void* TypeIdOf(int Index) const
+    {
+        return &TypeIds[Index];
+    }
+
+    // 逻辑顺序上的所有条目都要一致，包括持有的是不是同一个js对象
+    void ExpectSameEntries(int Ptr, FObjectCacheNode* Node, FLegacyNode* Legacy)
+    {
+        std::vector<const FObjectCacheNode::FEntry*> Entries;
+        if (Node)
+        {
+            Node->ForEach([&](FObjectCacheNode::FEntry& Entry) { Entries.push_back(&Entry); });
+        }
+        size_t Index = 0;
+        for (FLegacyNode* Iter = Legacy; Iter; Iter = Iter->Next, ++Index)
+        {
+            ASSERT_LT(Index, Entries.size()) << "ptr " << Ptr;
+            EXPECT_EQ(Iter->TypeId, Entries[Index]->TypeId) << "ptr " << Ptr << " entry " << Index;
+            EXPECT_EQ(Iter->UserData, Entries[Index]->PUERTS_TEST_USER_DATA_FIELD) << "ptr " << Ptr << " entry " << Index;
+            ExpectSameValue(Iter->Value, Entries[Index]->Value);
+        }
+        EXPECT_EQ(Index, Entries.size()) << "ptr " << Ptr;
+    }
+
+    void ExpectSameValue(const v8::UniquePersistent<v8::Value>& Expected, const v8::UniquePersistent<v8::Value>& Actual)
+    {
+        ASSERT_EQ(Expected.IsEmpty(), Actual.IsEmpty());
+        if (!Expected.IsEmpty())
+        {
+            EXPECT_TRUE(Expected.Get(Isolate) == Actual.Get(Isolate));
+        }
+    }
+
+    void Run(uint32_t Seed, int Steps, int PointerCount)
+    {
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        v8::Context::Scope ContextScope(Context.Get(Isolate));
+
+        std::unordered_map<int, FObjectCacheNode> Cache;
+        std::unordered_map<int, FLegacyNode> LegacyCache;
+        std::mt19937 Random(Seed);
+
+        for (int Step = 0; Step < Steps && !::testing::Test::HasFailure(); ++Step)
+        {
+            v8::HandleScope StepScope(Isolate);
+            const int Ptr = static_cast<int>(Random() % PointerCount);
+            const void* TypeId = TypeIdOf(static_cast<int>(Random() % TypeCount));
+            auto Iter = Cache.find(Ptr);
+            auto LegacyIter = LegacyCache.find(Ptr);
+            ASSERT_EQ(Iter == Cache.end(), LegacyIter == LegacyCache.end());
+
+            switch (Random() % 8)
+            {
+                case 0:
+                case 1:
+                case 2:
+                {
+                    // bind，同一个类型重复绑定也是允许的
+                    v8::Local<v8::Object> Object = v8::Object::New(Isolate);
+                    const FUserData UserData = MakeUserData<FUserData>(Random());
+                    FObjectCacheNode::FEntry* Entry;
+                    FLegacyNode* LegacyEntry;
+                    if (Iter != Cache.end())
+                    {
+                        Entry = Iter->second.Add(TypeId);
+                        LegacyEntry = LegacyIter->second.Add(TypeId);
+                    }
+                    else
+                    {
+                        Entry = Cache.emplace(Ptr, FObjectCacheNode(TypeId)).first->second.Find(TypeId);
+                        LegacyEntry = &LegacyCache.emplace(Ptr, FLegacyNode(TypeId)).first->second;
+                    }
+                    ASSERT_NE(nullptr, Entry);
+                    Entry->Value.Reset(Isolate, Object);
+                    Entry->PUERTS_TEST_USER_DATA_FIELD = UserData;
+                    LegacyEntry->Value.Reset(Isolate, Object);
+                    LegacyEntry->UserData = UserData;
+                    break;
+                }
+                case 3:
+                case 4:
+                case 5:
+                {
+                    // unbind
+                    if (Iter == Cache.end())
+                    {
+                        break;
+                    }
+                    const bool Removed = Iter->second.Remove(TypeId);
+                    EXPECT_EQ(LegacyIter->second.Remove(TypeId, true) != nullptr, Removed);
+                    EXPECT_EQ(LegacyIter->second.TypeId == nullptr, Iter->second.IsEmpty());
+                    if (Iter->second.IsEmpty())
+                    {
+                        Cache.erase(Iter);
+                        LegacyCache.erase(LegacyIter);
+                    }
+                    break;
+                }
+                case 6:
+                {
+                    // find
+                    if (Iter == Cache.end())
+                    {
+                        break;
+                    }
+                    FObjectCacheNode::FEntry* Entry = Iter->second.Find(TypeId);
+                    FLegacyNode* LegacyEntry = LegacyIter->second.Find(TypeId);
+                    ASSERT_EQ(LegacyEntry == nullptr, Entry == nullptr);
+                    if (Entry)
+                    {
+                        EXPECT_EQ(LegacyEntry->UserData, Entry->PUERTS_TEST_USER_DATA_FIELD);
+                        ExpectSameValue(LegacyEntry->Value, Entry->Value);
+                    }
+                    break;
+                }
+                default:
+                {
+                    // 搬移整个节点，走移动构造和移动赋值
+                    if (Iter == Cache.end())
+                    {
+                        break;
+                    }
+                    FObjectCacheNode Moved(std::move(Iter->second));
+                    EXPECT_TRUE(Iter->second.IsEmpty());
+                    Iter->second = std::move(Moved);
+                    EXPECT_TRUE(Moved.IsEmpty());
+                    break;
+                }
+            }
+
+            Iter = Cache.find(Ptr);
+            LegacyIter = LegacyCache.find(Ptr);
+            ExpectSameEntries(Ptr, Iter == Cache.end() ? nullptr : &Iter->second,
+                LegacyIter == LegacyCache.end() ? nullptr : &LegacyIter->second);
+        }
+
+        EXPECT_EQ(LegacyCache.size(), Cache.size());
+        for (auto& Pair : Cache)
+        {
+            auto LegacyIter = LegacyCache.find(Pair.first);
+            ASSERT_NE(LegacyCache.end(), LegacyIter);
+            ExpectSameEntries(Pair.first, &Pair.second, &LegacyIter->second);
+        }
+    }
+
+    char TypeIds[TypeCount] = {0};
+};
+
+TEST_F(ObjectCacheNodeFuzzTest, MatchesLinkedList)
+{
+    for (uint32_t Seed = 1; Seed <= 8 && !HasFailure(); ++Seed)
+    {
+        Run(Seed, 50000, 64);
+    }
+}
+
+// 类型少、指针少时同一个节点上会堆很多条目，溢出块会反复扩容、回到内联
+TEST_F(ObjectCacheNodeFuzzTest, MatchesLinkedListWithLongChains)
+{
+    Run(2024, 200000, 4);
+}
+}    // namespace test
+}    // namespace puerts
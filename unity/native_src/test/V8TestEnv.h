@@ -0,0 +1,86 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+#pragma once
+
+// v8 setup shared by the tests that drive the engine directly (not through libpuerts).
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#pragma warning(push, 0)
+#include "libplatform/libplatform.h"
+#include "v8.h"
+#pragma warning(pop)
+
+namespace puerts
+{
+namespace test
+{
+// flags only take effect before the first isolate is created, so every test binary initializes v8 exactly once
+inline void InitializeV8Once()
+{
+    static std::unique_ptr<v8::Platform> Platform = []() {
+        // natives syntax lets the tests force TurboFan, fast api calls are only emitted by optimized code
+        std::string Flags = "--allow-natives-syntax --turbo-fast-api-calls --no-freeze-flags-after-init";
+        v8::V8::SetFlagsFromString(Flags.c_str(), static_cast<int>(Flags.size()));
+        std::unique_ptr<v8::Platform> Result = v8::platform::NewDefaultPlatform();
+        v8::V8::InitializePlatform(Result.get());
+        v8::V8::Initialize();
+        return Result;
+    }();
+}
+
+class V8Test : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        InitializeV8Once();
+        Allocator.reset(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+        v8::Isolate::CreateParams CreateParams;
+        CreateParams.array_buffer_allocator = Allocator.get();
+        Isolate = v8::Isolate::New(CreateParams);
+        v8::Isolate::Scope IsolateScope(Isolate);
+        v8::HandleScope HandleScope(Isolate);
+        Context.Reset(Isolate, v8::Context::New(Isolate));
+    }
+
+    void TearDown() override
+    {
+        Context.Reset();
+        Isolate->Dispose();
+        Isolate = nullptr;
+    }
+
+    // caller holds the scopes, returns an empty handle and fails the test when the script throws
+    v8::Local<v8::Value> Run(const char* Code)
+    {
+        v8::Local<v8::Context> LocalContext = Context.Get(Isolate);
+        v8::TryCatch TryCatch(Isolate);
+        v8::Local<v8::String> Source = v8::String::NewFromUtf8(Isolate, Code).ToLocalChecked();
+        v8::Local<v8::Script> Script;
+        v8::Local<v8::Value> Result;
+        if (!v8::Script::Compile(LocalContext, Source).ToLocal(&Script) || !Script->Run(LocalContext).ToLocal(&Result))
+        {
+            v8::String::Utf8Value Message(Isolate, TryCatch.Exception());
+            ADD_FAILURE() << "script throws: " << (*Message ? *Message : "<unknown>");
+            return v8::Local<v8::Value>();
+        }
+        return Result;
+    }
+
+    std::unique_ptr<v8::ArrayBuffer::Allocator> Allocator;
+
+    v8::Isolate* Isolate = nullptr;
+
+    v8::Global<v8::Context> Context;
+};
+}    // namespace test
+}    // namespace puerts
@@ -12,8 +12,13 @@
 #include "v8.h"
 #pragma warning(pop)
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include "JSClassRegister.h"
 #include "ObjectCacheNode.h"
 #include "ObjectMapper.h"
@@ -23,13 +28,273 @@ namespace puerts
 typedef int32_t (*ObjectPoolAddFunc) (void * objectPool, void * obj, void* method);
 typedef void* (*ObjectPoolRemoveFunc) (void * objectPool, int32_t index, void* method);
 
+// C#终结器线程无锁地Push，js线程分批Pop的多生产者单消费者队列。
+// 生产者把节点CAS到Incoming栈上；消费者一次性摘走整个栈并翻转后接到FIFO的Ready链表尾部，之后的Pop不再碰任何原子变量。
+// 摘到Ready上的Holder同时记在ReadyHolders里，js线程可以按对象查询它是否还在等待释放
+class FPendingReleaseQueue
+{
+public:
+    FPendingReleaseQueue() = default;
+
+    FPendingReleaseQueue(const FPendingReleaseQueue&) = delete;
+
+    FPendingReleaseQueue& operator=(const FPendingReleaseQueue&) = delete;
+
+    ~FPendingReleaseQueue()
+    {
+        Clear();
+    }
+
+    // 任意线程，DelegateTypeId不为空表示是FunctionToDelegate创建的委托。
+    // Holder是释放的那个C#对象（JSObject是对象本身，委托是它的PersistentObjectInfo），用来避免误删已经指向新对象的映射
+    void Push(v8::Global<v8::Object>&& JsObject, const void* DelegateTypeId, const void* Holder)
+    {
+        FNode* Node = new FNode();
+        Node->JsObject = std::move(JsObject);
+        Node->DelegateTypeId = DelegateTypeId;
+        Node->Holder = Holder;
+        FNode* Head = Incoming.load(std::memory_order_relaxed);
+        do
+        {
+            Node->Next = Head;
+        } while (!Incoming.compare_exchange_weak(Head, Node, std::memory_order_release, std::memory_order_relaxed));
+        Backlog.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 只能在js线程调用，队列空时返回false
+    bool Pop(v8::Global<v8::Object>& OutJsObject, const void*& OutDelegateTypeId, const void*& OutHolder)
+    {
+        if (!Ready)
+        {
+            TakeIncoming();
+            if (!Ready)
+            {
+                return false;
+            }
+        }
+        FNode* Node = Ready;
+        Ready = Node->Next;
+        if (!Ready)
+        {
+            ReadyTail = nullptr;
+        }
+        ReadyHolders.erase(ReadyHolders.find(Node->Holder));
+        OutJsObject = std::move(Node->JsObject);
+        OutDelegateTypeId = Node->DelegateTypeId;
+        OutHolder = Node->Holder;
+        delete Node;
+        Backlog.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 只能在js线程调用
+    void Clear()
+    {
+        v8::Global<v8::Object> JsObject;
+        const void* DelegateTypeId;
+        const void* Holder;
+        while (Pop(JsObject, DelegateTypeId, Holder))
+        {
+            JsObject.Reset();
+        }
+    }
+
+    // 只能在js线程调用。Holder（含义同Push）对应的C#对象已被回收、还没处理到时返回true，这时js对象上的映射已经失效
+    bool IsPending(const void* Holder)
+    {
+        if (Backlog.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        TakeIncoming();
+        return ReadyHolders.find(Holder) != ReadyHolders.end();
+    }
+
+    // 还没释放的对象数，任意线程可读，只是个近似值
+    int32_t GetBacklog() const
+    {
+        return Backlog.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct FNode
+    {
+        FNode* Next;
+        v8::Global<v8::Object> JsObject;
+        const void* DelegateTypeId;
+        const void* Holder;
+    };
+
+    void TakeIncoming()
+    {
+        FNode* Node = Incoming.exchange(nullptr, std::memory_order_acquire);
+        FNode* BatchTail = Node;
+        FNode* Batch = nullptr;
+        while (Node)
+        {
+            FNode* Next = Node->Next;
+            Node->Next = Batch;
+            Batch = Node;
+            ReadyHolders.insert(Node->Holder);
+            Node = Next;
+        }
+        if (!Batch)
+        {
+            return;
+        }
+        if (ReadyTail)
+        {
+            ReadyTail->Next = Batch;
+        }
+        else
+        {
+            Ready = Batch;
+        }
+        ReadyTail = BatchTail;
+    }
+
+    std::atomic<FNode*> Incoming{nullptr};
+
+    FNode* Ready = nullptr;
+
+    FNode* ReadyTail = nullptr;
+
+    // C#对象地址可能被复用，同一个Holder可能排队多次
+    std::unordered_multiset<const void*> ReadyHolders;
+
+    std::atomic<int32_t> Backlog{0};
+};
+
+// (js函数, 委托类型) -> 委托，同一个函数以同一个委托类型多次传给C#时拿到的是同一个委托，C#那边可以用它来-=。
+// 对js函数只持有弱引用；委托被C#回收后在ClearPendingPersistentObject里移除，js函数被回收时由弱回调移除。只能在js线程访问
+class FDelegateCache
+{
+public:
+    FDelegateCache() = default;
+
+    FDelegateCache(const FDelegateCache&) = delete;
+
+    FDelegateCache& operator=(const FDelegateCache&) = delete;
+
+    // OutDelegateInfo不为空时带出命中条目的DelegateInfo
+    void* Find(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, const void** OutDelegateInfo = nullptr);
+
+    // DelegateInfo是委托的PersistentObjectInfo，委托被回收后按它精确移除对应的条目
+    void Add(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, void* Delegate, const void* DelegateInfo);
+
+    void Remove(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, const void* DelegateInfo);
+
+    void Clear();
+
+    int64_t Hits = 0;
+
+    int64_t Misses = 0;
+
+    int32_t Size() const
+    {
+        return static_cast<int32_t>(Entries.size());
+    }
+
+private:
+    struct FEntry
+    {
+        FDelegateCache* Owner;
+        int Hash;
+        const void* TypeId;
+        void* Delegate;
+        const void* DelegateInfo;
+        v8::Global<v8::Object> Func;
+    };
+
+    static void OnFuncGarbageCollected(const v8::WeakCallbackInfo<FEntry>& Data);
+
+    std::unordered_multimap<int, std::unique_ptr<FEntry>> Entries;
+};
+
+// 按值传给js的值类型副本的分配器，按16字节分级，每级一条空闲链表，js对象回收后块回到链表重用。
+// 只给不含托管引用的值类型用：这块内存不在il2cpp gc的扫描范围内，也不需要登记gc root。只能在js线程访问
+class FValueTypeArena
+{
+public:
+    FValueTypeArena() = default;
+
+    FValueTypeArena(const FValueTypeArena&) = delete;
+
+    FValueTypeArena& operator=(const FValueTypeArena&) = delete;
+
+    ~FValueTypeArena()
+    {
+        Reset();
+    }
+
+    // 返回nullptr表示这个大小不由arena负责
+    void* Alloc(size_t Size);
+
+    bool Owns(const void* Ptr) const
+    {
+        return FindChunk(Ptr) != Chunks.end();
+    }
+
+    // 不是arena分配的返回false
+    bool Free(void* Ptr);
+
+    // 释放所有chunk，之前分配的指针全部失效
+    void Reset();
+
+    static const size_t Granularity = 16;
+
+    static const size_t NumSizeClasses = 16;
+
+    static const size_t ChunkSize = 64 * 1024;
+
+private:
+    struct FFreeBlock
+    {
+        FFreeBlock* Next;
+    };
+
+    // chunk起始地址 -> size class
+    std::map<uintptr_t, size_t> Chunks;
+
+    std::map<uintptr_t, size_t>::const_iterator FindChunk(const void* Ptr) const;
+
+    FFreeBlock* FreeLists[NumSizeClasses] = {};
+
+    uint8_t* BumpCursor[NumSizeClasses] = {};
+
+    uint8_t* BumpEnd[NumSizeClasses] = {};
+};
+
 struct FPersistentObjectEnvInfo
 {
     v8::Isolate* Isolate;
     v8::Global<v8::Context> Context;
-    std::vector<v8::Global<v8::Object>> PendingReleaseObjects;
+    FPendingReleaseQueue PendingReleaseObjects;
+    // 每次tick最多释放多少个，<= 0表示不限制；剩下的留到下一次tick
+    int32_t PendingReleaseBudget = 0;
     v8::Global<v8::Symbol> SymbolCSPtr;
-    std::mutex Mutex;
+    FDelegateCache DelegateCache;
+};
+
+class FCppObjectMapper;
+
+// 延迟安装模式下一个类的实例成员表，成员在第一次被访问时才装到prototype上
+struct FLazyClassInfo
+{
+    struct FMember
+    {
+        JSFunctionInfo* Function = nullptr;
+        JSPropertyInfo* Property = nullptr;
+        bool Installed = false;
+    };
+
+    FCppObjectMapper* Mapper;
+    const JSClassDefinition* ClassDefinition;
+    // 同样是延迟安装的基类，拦截器沿着它检查整条继承链，不用再查LazyClassInfos
+    FLazyClassInfo* Super = nullptr;
+    // 还没安装的成员数，整条继承链都为0时拦截器直接返回
+    size_t PendingCount = 0;
+    std::unordered_map<std::string, FMember> Members;
 };
 
 class FCppObjectMapper final : public ICppObjectMapper
@@ -76,17 +341,48 @@ public:
 
     FPersistentObjectEnvInfo PersistentObjectEnvInfo;
 
-    void ClearPendingPersistentObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context);
+    // MaxCount <= 0时全部释放
+    void ClearPendingPersistentObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int32_t MaxCount = 0);
+
+    // 打开后，之后生成模板的类只登记实例方法和属性，由拦截器在第一次访问时安装；静态成员仍然立即安装
+    bool LazyMemberInstallation = false;
+
+    // 在ClassInfo及其基类里找到名为Property、还没安装的成员，安装到对应类的prototype上，找不到返回nullptr
+    const FLazyClassInfo::FMember* InstallLazyMember(
+        v8::Isolate* Isolate, v8::Local<v8::Context> Context, FLazyClassInfo* ClassInfo, v8::Local<v8::Name> Property);
+
+    // 注册时标记为IsBlittableValueType的类型从ValueTypeArena分配，其他类型返回nullptr，由调用方用ObjectAllocate分配
+    void* AllocValueType(const void* TypeId, size_t Size);
+
+    // 不是arena分配的返回false
+    bool FreeValueType(void* Ptr)
+    {
+        return ValueTypeArena.Free(Ptr);
+    }
 
 private:
     std::unordered_map<void*, FObjectCacheNode> CDataCache;
 
     std::unordered_map<const void*, v8::UniquePersistent<v8::FunctionTemplate>> TypeIdToTemplateMap;
 
+    // 只有延迟安装的类才有
+    std::unordered_map<const void*, std::unique_ptr<FLazyClassInfo>> LazyClassInfos;
+
+    std::set<std::string> ObjectPrototypeNames;
+
+    void SetupLazyMembers(v8::Isolate* Isolate, v8::Local<v8::FunctionTemplate> Template, const JSClassDefinition* ClassDefinition);
+
+    bool IsShadowingMember(const JSClassDefinition* ClassDefinition, const std::string& Name);
+
     v8::UniquePersistent<v8::FunctionTemplate> PointerTemplate;
 
     std::unordered_map<void*, FinalizeFunc> CDataFinalizeMap;
 
+    FValueTypeArena ValueTypeArena;
+
+    // TypeId -> 是否走arena，第一次拷贝该类型时从JSClassDefinition查出来
+    std::unordered_map<const void*, bool> ArenaValueTypes;
+
     std::shared_ptr<int> Ref = std::make_shared<int>(0);
 };
 
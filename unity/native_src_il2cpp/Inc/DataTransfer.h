@@ -19,6 +19,8 @@
 #include "v8.h"
 #pragma warning(pop)
 
+#include "RefCell.h"
+
 #if !defined(MAPPER_ISOLATE_DATA_POS)
 #define MAPPER_ISOLATE_DATA_POS 0
 #endif
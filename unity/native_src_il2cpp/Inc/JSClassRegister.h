@@ -81,6 +81,8 @@ struct JSENV_API JSClassDefinition
     NamedPropertyInfo* PropertyInfos;
     NamedPropertyInfo* VariableInfos;
     void* Data = nullptr;
+    // 不含托管引用的值类型，按值返回的副本可以放进FValueTypeArena
+    bool IsBlittableValueType = false;
 };
 
 #define JSClassEmptyDefinition                      \
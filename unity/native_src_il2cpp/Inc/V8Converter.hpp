@@ -107,8 +107,7 @@ V8_INLINE void UpdateRefValue(v8::Local<v8::Context> context, v8::Local<v8::Valu
 {
     if (holder->IsObject())
     {
-        auto outer = holder->ToObject(context).ToLocalChecked();
-        auto _unused = outer->Set(context, 0, value);
+        SetRefValue(context, holder.As<v8::Object>(), value);
     }
 }
 
@@ -444,7 +443,7 @@ struct Converter<std::reference_wrapper<T>, typename std::enable_if<!is_objectty
         if (value->IsObject())
         {
             auto outer = value->ToObject(context).ToLocalChecked();
-            auto realvalue = outer->Get(context, 0).ToLocalChecked();
+            auto realvalue = GetRefValue(context, outer);
             return Converter<T>::toCpp(context, realvalue);
         }
         return {};
@@ -471,7 +470,7 @@ struct Converter<std::reference_wrapper<T>, typename std::enable_if<is_objecttyp
         if (!value.IsEmpty() && value->IsObject())
         {
             auto outer = value->ToObject(context).ToLocalChecked();
-            auto realvalue = outer->Get(context, 0).ToLocalChecked();
+            auto realvalue = GetRefValue(context, outer);
             return Converter<typename std::decay<T>::type*>::toCpp(context, realvalue);
         }
         return nullptr;
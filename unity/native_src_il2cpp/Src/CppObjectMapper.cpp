@@ -10,6 +10,8 @@
 #include "DataTransfer.h"
 #include "Log.h"
 
+#include <stdlib.h>
+
 namespace puerts
 {
 template <typename T>
@@ -185,24 +187,35 @@ static void CDataNew(const v8::FunctionCallbackInfo<v8::Value>& Info)
     }
 }
 
-void FCppObjectMapper::ClearPendingPersistentObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context) 
+void FCppObjectMapper::ClearPendingPersistentObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, int32_t MaxCount) 
 {
-    std::lock_guard<std::mutex> guard(PersistentObjectEnvInfo.Mutex);
-    //puerts::PLog("ReleasePendingJsObjects size: %d",  jsEnv->CppObjectMapper.PersistentObjectEnvInfo.PendingReleaseObjects.size());
-    auto size = PersistentObjectEnvInfo.PendingReleaseObjects.size();
-    if (size == 0) {
+    //puerts::PLog("ReleasePendingJsObjects size: %d",  PersistentObjectEnvInfo.PendingReleaseObjects.GetBacklog());
+    if (PersistentObjectEnvInfo.PendingReleaseObjects.GetBacklog() == 0) {
         return;
     }
 
+    // 整批共用一个HandleScope
+    v8::HandleScope HandleScope(Isolate);
     auto csptrKey = PersistentObjectEnvInfo.SymbolCSPtr.Get(Isolate);
-    for (int i = 0; i < size; i++) {
-        PersistentObjectEnvInfo.PendingReleaseObjects[i].Get(Isolate)->Delete(
-            Context, 
-            csptrKey
-        );
+    v8::Global<v8::Object> JsObject;
+    const void* DelegateTypeId;
+    const void* Holder;
+    for (int32_t i = 0; (MaxCount <= 0 || i < MaxCount) && PersistentObjectEnvInfo.PendingReleaseObjects.Pop(JsObject, DelegateTypeId, Holder); i++) {
+        if (DelegateTypeId) {
+            PersistentObjectEnvInfo.DelegateCache.Remove(Isolate, JsObject.Get(Isolate), DelegateTypeId, Holder);
+        } else {
+            // 释放排队期间可能已经为这个js对象建了新的C#对象，只删指向自己的
+            auto Obj = JsObject.Get(Isolate);
+            v8::Local<v8::Value> CSPtr;
+            if (Obj->Get(Context, csptrKey).ToLocal(&CSPtr) && CSPtr->IsExternal() && v8::Local<v8::External>::Cast(CSPtr)->Value() == Holder) {
+                Obj->Delete(
+                    Context, 
+                    csptrKey
+                );
+            }
+        }
+        JsObject.Reset();
     }
-
-    PersistentObjectEnvInfo.PendingReleaseObjects.clear();
 }
 
 v8::Local<v8::FunctionTemplate> FCppObjectMapper::GetTemplateOfClass(v8::Isolate* Isolate, const void* TypeId)
@@ -221,7 +234,26 @@ v8::Local<v8::FunctionTemplate> FCppObjectMapper::GetTemplateOfClass(v8::Isolate
             Isolate, CDataNew, v8::External::New(Isolate, const_cast<void*>(reinterpret_cast<const void*>(ClassDefinition))));
         Template->InstanceTemplate()->SetInternalFieldCount(4);
 
-        JSPropertyInfo* PropertyInfo = ClassDefinition->Properties;
+        // 基类模板先生成，延迟安装时要用基类的成员表判断覆盖
+        if (ClassDefinition->SuperTypeId)
+        {
+            auto SuperTemplate = GetTemplateOfClass(Isolate, ClassDefinition->SuperTypeId);
+            if (!SuperTemplate.IsEmpty())
+            {
+                Template->Inherit(SuperTemplate);
+            }
+        }
+
+        bool IsLazy = false;
+#ifndef WITH_QUICKJS
+        if (LazyMemberInstallation)
+        {
+            SetupLazyMembers(Isolate, Template, ClassDefinition);
+            IsLazy = true;
+        }
+#endif
+
+        JSPropertyInfo* PropertyInfo = IsLazy ? nullptr : ClassDefinition->Properties;
         while (PropertyInfo && PropertyInfo->Name && PropertyInfo->Getter)
         {
             v8::PropertyAttribute PropertyAttribute = v8::DontDelete;
@@ -255,7 +287,7 @@ v8::Local<v8::FunctionTemplate> FCppObjectMapper::GetTemplateOfClass(v8::Isolate
             ++PropertyInfo;
         }
 
-        JSFunctionInfo* FunctionInfo = ClassDefinition->Methods;
+        JSFunctionInfo* FunctionInfo = IsLazy ? nullptr : ClassDefinition->Methods;
         while (FunctionInfo && FunctionInfo->Name && FunctionInfo->Callback)
         {
             Template->PrototypeTemplate()->Set(
@@ -275,32 +307,297 @@ v8::Local<v8::FunctionTemplate> FCppObjectMapper::GetTemplateOfClass(v8::Isolate
             ++FunctionInfo;
         }
 
-        if (ClassDefinition->SuperTypeId)
+        TypeIdToTemplateMap[ClassDefinition->TypeId] = v8::UniquePersistent<v8::FunctionTemplate>(Isolate, Template);
+
+        return HandleScope.Escape(Template);
+    }
+    else
+    {
+        return v8::Local<v8::FunctionTemplate>::New(Isolate, Iter->second);
+    }
+}
+
+#ifndef WITH_QUICKJS
+// 只在prototype上挂kNonMasking的拦截器：实例上的查找沿原型链走到prototype，整条链上都找不到的名字才会进来，
+// 已安装的成员走正常的属性查找，不再经过拦截器。赋值时v8先调Query，装好后再按原型链找到setter。
+// 安装后重新对This做一次Get/Set，accessor的receiver和立即安装时一致
+template <typename T>
+static FLazyClassInfo* GetLazyClassInfo(const v8::PropertyCallbackInfo<T>& Info)
+{
+    return static_cast<FLazyClassInfo*>(v8::Local<v8::External>::Cast(Info.Data())->Value());
+}
+
+static void LazyMemberGetter(v8::Local<v8::Name> Property, const v8::PropertyCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    FLazyClassInfo* ClassInfo = GetLazyClassInfo(Info);
+    if (ClassInfo->Mapper->InstallLazyMember(Isolate, Context, ClassInfo, Property))
+    {
+        v8::Local<v8::Value> Value;
+        if (Info.This()->Get(Context, Property).ToLocal(&Value))
         {
-            auto SuperTemplate = GetTemplateOfClass(Isolate, ClassDefinition->SuperTypeId);
-            if (!SuperTemplate.IsEmpty())
+            Info.GetReturnValue().Set(Value);
+        }
+    }
+}
+
+static void LazyMemberSetter(v8::Local<v8::Name> Property, v8::Local<v8::Value> Value, const v8::PropertyCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    FLazyClassInfo* ClassInfo = GetLazyClassInfo(Info);
+    if (ClassInfo->Mapper->InstallLazyMember(Isolate, Context, ClassInfo, Property))
+    {
+        __USE(Info.This()->Set(Context, Property, Value));
+        Info.GetReturnValue().Set(Value);
+    }
+}
+
+static void LazyMemberQuery(v8::Local<v8::Name> Property, const v8::PropertyCallbackInfo<v8::Integer>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    FLazyClassInfo* ClassInfo = GetLazyClassInfo(Info);
+    auto Member = ClassInfo->Mapper->InstallLazyMember(Isolate, Isolate->GetCurrentContext(), ClassInfo, Property);
+    if (Member)
+    {
+        v8::PropertyAttribute PropertyAttribute = v8::None;
+        if (Member->Property)
+        {
+            PropertyAttribute = Member->Property->Setter ? v8::DontDelete : (v8::PropertyAttribute)(v8::DontDelete | v8::ReadOnly);
+        }
+        Info.GetReturnValue().Set(static_cast<int32_t>(PropertyAttribute));
+    }
+}
+
+// 只挂在prototype上，让Object.keys(prototype)等能看到还没安装的成员
+static void LazyMemberEnumerator(const v8::PropertyCallbackInfo<v8::Array>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    FLazyClassInfo* ClassInfo = GetLazyClassInfo(Info);
+    auto Names = v8::Array::New(Isolate, static_cast<int>(ClassInfo->PendingCount));
+    uint32_t Index = 0;
+    for (auto& KV : ClassInfo->Members)
+    {
+        if (!KV.second.Installed)
+        {
+            __USE(Names->Set(Context, Index++,
+                v8::String::NewFromUtf8(Isolate, KV.first.c_str(), v8::NewStringType::kNormal, static_cast<int>(KV.first.size()))
+                    .ToLocalChecked()));
+        }
+    }
+    Info.GetReturnValue().Set(Names);
+}
+
+// kNonMasking的拦截器只在整条原型链都找不到时才触发，基类（或者Object.prototype）上已有同名成员时，子类的同名成员永远装不上，
+// 所以这类覆盖/隐藏基类的成员要在模板实例化前直接装进模板
+bool FCppObjectMapper::IsShadowingMember(const JSClassDefinition* ClassDefinition, const std::string& Name)
+{
+    if (ObjectPrototypeNames.find(Name) != ObjectPrototypeNames.end())
+    {
+        return true;
+    }
+    for (const void* TypeId = ClassDefinition->SuperTypeId; TypeId;)
+    {
+        auto Iter = LazyClassInfos.find(TypeId);
+        if (Iter != LazyClassInfos.end())
+        {
+            if (Iter->second->Members.find(Name) != Iter->second->Members.end())
             {
-                Template->Inherit(SuperTemplate);
+                return true;
             }
+            TypeId = Iter->second->ClassDefinition->SuperTypeId;
+            continue;
         }
+        // 开关打开前生成模板的基类没有成员表，直接查它的定义
+        auto SuperDefinition = FindClassByID(TypeId, true);
+        if (!SuperDefinition)
+        {
+            break;
+        }
+        for (JSPropertyInfo* PropertyInfo = SuperDefinition->Properties; PropertyInfo && PropertyInfo->Name && PropertyInfo->Getter; ++PropertyInfo)
+        {
+            if (Name == PropertyInfo->Name)
+            {
+                return true;
+            }
+        }
+        for (JSFunctionInfo* FunctionInfo = SuperDefinition->Methods; FunctionInfo && FunctionInfo->Name && FunctionInfo->Callback; ++FunctionInfo)
+        {
+            if (Name == FunctionInfo->Name)
+            {
+                return true;
+            }
+        }
+        TypeId = SuperDefinition->SuperTypeId;
+    }
+    return false;
+}
 
-        TypeIdToTemplateMap[ClassDefinition->TypeId] = v8::UniquePersistent<v8::FunctionTemplate>(Isolate, Template);
+void FCppObjectMapper::SetupLazyMembers(v8::Isolate* Isolate, v8::Local<v8::FunctionTemplate> Template, const JSClassDefinition* ClassDefinition)
+{
+    if (ObjectPrototypeNames.empty())
+    {
+        auto Context = Isolate->GetCurrentContext();
+        auto ObjectPrototype = v8::Object::New(Isolate)->GetPrototype();
+        v8::Local<v8::Array> Names;
+        if (ObjectPrototype->IsObject() && ObjectPrototype.As<v8::Object>()->GetOwnPropertyNames(Context).ToLocal(&Names))
+        {
+            for (uint32_t i = 0; i < Names->Length(); ++i)
+            {
+                v8::String::Utf8Value Name(Isolate, Names->Get(Context, i).ToLocalChecked());
+                ObjectPrototypeNames.insert(std::string(*Name, Name.length()));
+            }
+        }
+    }
 
-        return HandleScope.Escape(Template);
+    auto ClassInfo = new FLazyClassInfo();
+    ClassInfo->Mapper = this;
+    ClassInfo->ClassDefinition = ClassDefinition;
+    // 基类的模板先于子类生成，这时它的成员表已经登记好了
+    auto SuperIter = LazyClassInfos.find(ClassDefinition->SuperTypeId);
+    ClassInfo->Super = SuperIter == LazyClassInfos.end() ? nullptr : SuperIter->second.get();
+    LazyClassInfos[ClassDefinition->TypeId] = std::unique_ptr<FLazyClassInfo>(ClassInfo);
+
+    for (JSPropertyInfo* PropertyInfo = ClassDefinition->Properties; PropertyInfo && PropertyInfo->Name && PropertyInfo->Getter; ++PropertyInfo)
+    {
+        auto& Member = ClassInfo->Members[PropertyInfo->Name];
+        Member.Property = PropertyInfo;
+        if (IsShadowingMember(ClassDefinition, PropertyInfo->Name))
+        {
+            v8::PropertyAttribute PropertyAttribute = v8::DontDelete;
+            if (!PropertyInfo->Setter)
+                PropertyAttribute = (v8::PropertyAttribute)(PropertyAttribute | v8::ReadOnly);
+            auto GetterData = PropertyInfo->GetterData ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, PropertyInfo->GetterData))
+                                           : v8::Local<v8::Value>();
+            auto SetterData = PropertyInfo->SetterData ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, PropertyInfo->SetterData))
+                                           : v8::Local<v8::Value>();
+            Template->PrototypeTemplate()->SetAccessorProperty(
+                v8::String::NewFromUtf8(Isolate, PropertyInfo->Name, v8::NewStringType::kNormal).ToLocalChecked(),
+                v8::FunctionTemplate::New(Isolate, PropertyInfo->Getter, GetterData),
+                v8::FunctionTemplate::New(Isolate, PropertyInfo->Setter, SetterData), PropertyAttribute);
+            Member.Installed = true;
+        }
+        else
+        {
+            ++ClassInfo->PendingCount;
+        }
     }
-    else
+
+    for (JSFunctionInfo* FunctionInfo = ClassDefinition->Methods; FunctionInfo && FunctionInfo->Name && FunctionInfo->Callback; ++FunctionInfo)
     {
-        return v8::Local<v8::FunctionTemplate>::New(Isolate, Iter->second);
+        auto& Member = ClassInfo->Members[FunctionInfo->Name];
+        if (Member.Property)
+        {
+            // 同名的属性已经登记过，和立即安装时一样后者覆盖前者
+            if (!Member.Installed)
+                --ClassInfo->PendingCount;
+            Member = FLazyClassInfo::FMember();
+        }
+        Member.Function = FunctionInfo;
+        if (IsShadowingMember(ClassDefinition, FunctionInfo->Name))
+        {
+            Template->PrototypeTemplate()->Set(
+                v8::String::NewFromUtf8(Isolate, FunctionInfo->Name, v8::NewStringType::kNormal).ToLocalChecked(),
+                v8::FunctionTemplate::New(Isolate, FunctionInfo->Callback,
+                    FunctionInfo->Data ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, FunctionInfo->Data))
+                                       : v8::Local<v8::Value>()));
+            Member.Installed = true;
+        }
+        else
+        {
+            ++ClassInfo->PendingCount;
+        }
+    }
+
+    Template->PrototypeTemplate()->SetHandler(v8::NamedPropertyHandlerConfiguration(LazyMemberGetter, LazyMemberSetter, LazyMemberQuery,
+        nullptr, LazyMemberEnumerator, v8::External::New(Isolate, ClassInfo), v8::PropertyHandlerFlags::kNonMasking));
+}
+
+const FLazyClassInfo::FMember* FCppObjectMapper::InstallLazyMember(
+    v8::Isolate* Isolate, v8::Local<v8::Context> Context, FLazyClassInfo* ClassInfo, v8::Local<v8::Name> Property)
+{
+    bool HasPending = false;
+    for (auto Iter = ClassInfo; Iter; Iter = Iter->Super)
+    {
+        if (Iter->PendingCount > 0)
+        {
+            HasPending = true;
+            break;
+        }
+    }
+    if (!HasPending || !Property->IsString())
+    {
+        return nullptr;
     }
+
+    v8::String::Utf8Value Utf8Name(Isolate, Property);
+    std::string Name(*Utf8Name, Utf8Name.length());
+    for (auto Iter = ClassInfo; Iter; Iter = Iter->Super)
+    {
+        auto MemberIter = Iter->Members.find(Name);
+        if (MemberIter != Iter->Members.end())
+        {
+            auto& Member = MemberIter->second;
+            if (Member.Installed)
+            {
+                return nullptr;
+            }
+            v8::Local<v8::Value> PrototypeValue;
+            if (!GetTemplateOfClass(Isolate, Iter->ClassDefinition->TypeId)
+                     ->GetFunction(Context)
+                     .ToLocalChecked()
+                     ->Get(Context, v8::String::NewFromUtf8(Isolate, "prototype", v8::NewStringType::kNormal).ToLocalChecked())
+                     .ToLocal(&PrototypeValue) ||
+                !PrototypeValue->IsObject())
+            {
+                return nullptr;
+            }
+            auto Prototype = PrototypeValue.As<v8::Object>();
+
+            Member.Installed = true;
+            --Iter->PendingCount;
+            if (Member.Property)
+            {
+                JSPropertyInfo* PropertyInfo = Member.Property;
+                v8::PropertyAttribute PropertyAttribute = v8::DontDelete;
+                if (!PropertyInfo->Setter)
+                    PropertyAttribute = (v8::PropertyAttribute)(PropertyAttribute | v8::ReadOnly);
+                auto GetterData = PropertyInfo->GetterData ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, PropertyInfo->GetterData))
+                                               : v8::Local<v8::Value>();
+                auto SetterData = PropertyInfo->SetterData ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, PropertyInfo->SetterData))
+                                               : v8::Local<v8::Value>();
+                Prototype->SetAccessorProperty(Property,
+                    v8::FunctionTemplate::New(Isolate, PropertyInfo->Getter, GetterData)->GetFunction(Context).ToLocalChecked(),
+                    v8::FunctionTemplate::New(Isolate, PropertyInfo->Setter, SetterData)->GetFunction(Context).ToLocalChecked(),
+                    PropertyAttribute);
+            }
+            else
+            {
+                JSFunctionInfo* FunctionInfo = Member.Function;
+                __USE(Prototype->DefineOwnProperty(Context, Property,
+                    v8::FunctionTemplate::New(Isolate, FunctionInfo->Callback,
+                        FunctionInfo->Data ? static_cast<v8::Local<v8::Value>>(v8::External::New(Isolate, FunctionInfo->Data))
+                                           : v8::Local<v8::Value>())
+                        ->GetFunction(Context)
+                        .ToLocalChecked()));
+            }
+            return &Member;
+        }
+    }
+    return nullptr;
 }
+#endif
 
 static void CDataGarbageCollectedWithFree(const v8::WeakCallbackInfo<JSClassDefinition>& Data)
 {
     JSClassDefinition* ClassDefinition = Data.GetParameter();
     void* Ptr = DataTransfer::MakeAddressWithHighPartOfTwo(Data.GetInternalField(0), Data.GetInternalField(1));
-    if (ClassDefinition->Finalize)
+    auto CppObjectMapper = static_cast<FCppObjectMapper*>(DataTransfer::IsolateData<ICppObjectMapper>(Data.GetIsolate()));
+    if (!CppObjectMapper->FreeValueType(Ptr) && ClassDefinition->Finalize)
         ClassDefinition->Finalize(Ptr);
-    DataTransfer::IsolateData<ICppObjectMapper>(Data.GetIsolate())->UnBindCppObject(ClassDefinition, Ptr);
+    CppObjectMapper->UnBindCppObject(ClassDefinition, Ptr);
 }
 
 static void CDataGarbageCollectedWithoutFree(const v8::WeakCallbackInfo<JSClassDefinition>& Data)
@@ -316,7 +613,7 @@ void FCppObjectMapper::BindCppObject(
     DataTransfer::SetPointer(Isolate, JSObject, Ptr, 0);
     DataTransfer::SetPointer(Isolate, JSObject, ClassDefinition->TypeId, 1);
 
-    FObjectCacheNode* CacheNodePtr = nullptr;
+    FObjectCacheNode::FEntry* CacheNodePtr = nullptr;
     auto Iter = CDataCache.find(Ptr);
         
     if (Iter != CDataCache.end())
@@ -326,7 +623,7 @@ void FCppObjectMapper::BindCppObject(
     else
     {
         auto Ret = CDataCache.insert({Ptr, FObjectCacheNode(ClassDefinition->TypeId)});
-        CacheNodePtr = &Ret.first->second;
+        CacheNodePtr = Ret.first->second.Find(ClassDefinition->TypeId);
     }
     CacheNodePtr->Value.Reset(Isolate, JSObject);
     
@@ -365,8 +662,8 @@ void FCppObjectMapper::UnBindCppObject(JSClassDefinition* ClassDefinition, void*
                 ObjectPoolRemove(ObjectPoolInstance, CacheNodePtr->ObjectIndex, ObjectPoolRemoveMethodInfo);
             }
         }
-        auto Removed = Iter->second.Remove(ClassDefinition->TypeId, true);
-        if (!Iter->second.TypeId)    // last one
+        Iter->second.Remove(ClassDefinition->TypeId);
+        if (Iter->second.IsEmpty())    // last one
         {
             CDataCache.erase(Ptr);
         }
@@ -378,17 +675,168 @@ void FCppObjectMapper::UnInitialize(v8::Isolate* InIsolate)
     Ref.reset();// let c# do not callback
     for (auto Iter = CDataFinalizeMap.begin(); Iter != CDataFinalizeMap.end(); Iter++)
     {
-        if (Iter->second)
+        if (Iter->second && !ValueTypeArena.Owns(Iter->first))
             Iter->second(Iter->first);
     }
     CDataCache.clear();
     CDataFinalizeMap.clear();
+    ValueTypeArena.Reset();
+    ArenaValueTypes.clear();
     TypeIdToTemplateMap.clear();
+    LazyClassInfos.clear();
     PointerTemplate.Reset();
     PersistentObjectEnvInfo.Context.Reset();
     PersistentObjectEnvInfo.SymbolCSPtr.Reset();
-    std::lock_guard<std::mutex> guard(PersistentObjectEnvInfo.Mutex);
-    PersistentObjectEnvInfo.PendingReleaseObjects.clear();
+    PersistentObjectEnvInfo.PendingReleaseObjects.Clear();
+    PersistentObjectEnvInfo.DelegateCache.Clear();
+}
+
+void* FDelegateCache::Find(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, const void** OutDelegateInfo)
+{
+    auto Range = Entries.equal_range(Func->GetIdentityHash());
+    for (auto Iter = Range.first; Iter != Range.second; ++Iter)
+    {
+        if (Iter->second->TypeId == TypeId && Iter->second->Func == Func)
+        {
+            if (OutDelegateInfo)
+            {
+                *OutDelegateInfo = Iter->second->DelegateInfo;
+            }
+            ++Hits;
+            return Iter->second->Delegate;
+        }
+    }
+    ++Misses;
+    return nullptr;
+}
+
+void FDelegateCache::Add(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, void* Delegate, const void* DelegateInfo)
+{
+    FEntry* Entry = new FEntry();
+    Entry->Owner = this;
+    Entry->Hash = Func->GetIdentityHash();
+    Entry->TypeId = TypeId;
+    Entry->Delegate = Delegate;
+    Entry->DelegateInfo = DelegateInfo;
+    Entry->Func.Reset(Isolate, Func);
+    Entry->Func.SetWeak(Entry, OnFuncGarbageCollected, v8::WeakCallbackType::kParameter);
+    Entries.emplace(Entry->Hash, std::unique_ptr<FEntry>(Entry));
+}
+
+void FDelegateCache::Remove(v8::Isolate* Isolate, v8::Local<v8::Object> Func, const void* TypeId, const void* DelegateInfo)
+{
+    auto Range = Entries.equal_range(Func->GetIdentityHash());
+    for (auto Iter = Range.first; Iter != Range.second; ++Iter)
+    {
+        if (Iter->second->DelegateInfo == DelegateInfo && Iter->second->TypeId == TypeId && Iter->second->Func == Func)
+        {
+            Entries.erase(Iter);
+            return;
+        }
+    }
+}
+
+void FDelegateCache::Clear()
+{
+    Entries.clear();
+}
+
+void* FCppObjectMapper::AllocValueType(const void* TypeId, size_t Size)
+{
+    auto Iter = ArenaValueTypes.find(TypeId);
+    if (Iter == ArenaValueTypes.end())
+    {
+        auto ClassDefinition = FindClassByID(TypeId, true);
+        Iter = ArenaValueTypes.emplace(TypeId, ClassDefinition && ClassDefinition->IsBlittableValueType).first;
+    }
+    return Iter->second ? ValueTypeArena.Alloc(Size) : nullptr;
+}
+
+std::map<uintptr_t, size_t>::const_iterator FValueTypeArena::FindChunk(const void* Ptr) const
+{
+    uintptr_t Address = reinterpret_cast<uintptr_t>(Ptr);
+    auto Iter = Chunks.upper_bound(Address);
+    if (Iter == Chunks.begin())
+    {
+        return Chunks.end();
+    }
+    --Iter;
+    return Address < Iter->first + ChunkSize ? Iter : Chunks.end();
+}
+
+void* FValueTypeArena::Alloc(size_t Size)
+{
+    if (Size == 0 || Size > Granularity * NumSizeClasses)
+    {
+        return nullptr;
+    }
+    size_t SizeClass = (Size - 1) / Granularity;
+
+    if (FFreeBlock* Block = FreeLists[SizeClass])
+    {
+        FreeLists[SizeClass] = Block->Next;
+        return Block;
+    }
+
+    size_t BlockSize = (SizeClass + 1) * Granularity;
+    if (static_cast<size_t>(BumpEnd[SizeClass] - BumpCursor[SizeClass]) < BlockSize)
+    {
+        // malloc至少按16字节对齐，块大小都是16的倍数，切出来的块也是16字节对齐
+        uint8_t* Chunk = static_cast<uint8_t*>(::malloc(ChunkSize));
+        if (!Chunk)
+        {
+            return nullptr;
+        }
+        Chunks.emplace(reinterpret_cast<uintptr_t>(Chunk), SizeClass);
+        BumpCursor[SizeClass] = Chunk;
+        BumpEnd[SizeClass] = Chunk + ChunkSize;
+    }
+    void* Result = BumpCursor[SizeClass];
+    BumpCursor[SizeClass] += BlockSize;
+    return Result;
+}
+
+bool FValueTypeArena::Free(void* Ptr)
+{
+    auto Iter = FindChunk(Ptr);
+    if (Iter == Chunks.end())
+    {
+        return false;
+    }
+    FFreeBlock* Block = static_cast<FFreeBlock*>(Ptr);
+    Block->Next = FreeLists[Iter->second];
+    FreeLists[Iter->second] = Block;
+    return true;
+}
+
+void FValueTypeArena::Reset()
+{
+    for (auto& KV : Chunks)
+    {
+        ::free(reinterpret_cast<void*>(KV.first));
+    }
+    Chunks.clear();
+    for (size_t i = 0; i < NumSizeClasses; ++i)
+    {
+        FreeLists[i] = nullptr;
+        BumpCursor[i] = nullptr;
+        BumpEnd[i] = nullptr;
+    }
+}
+
+void FDelegateCache::OnFuncGarbageCollected(const v8::WeakCallbackInfo<FEntry>& Data)
+{
+    FEntry* Entry = Data.GetParameter();
+    auto& Entries = Entry->Owner->Entries;
+    auto Range = Entries.equal_range(Entry->Hash);
+    for (auto Iter = Range.first; Iter != Range.second; ++Iter)
+    {
+        if (Iter->second.get() == Entry)
+        {
+            Entries.erase(Iter);
+            return;
+        }
+    }
 }
 
 }    // namespace puerts
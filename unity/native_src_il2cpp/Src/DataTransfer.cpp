@@ -33,7 +33,7 @@ v8::Local<v8::Value> DataTransfer::UnRef(v8::Isolate* Isolate, const v8::Local<v
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
     v8::Context::Scope ContextScope(Context);
 
-    v8::Local<v8::Value> ReturnValue = Value->ToObject(Context).ToLocalChecked()->Get(Context, 0).ToLocalChecked();
+    v8::Local<v8::Value> ReturnValue = GetRefValue(Context, Value->ToObject(Context).ToLocalChecked());
 
     return HandleScope.Escape(ReturnValue);
 }
@@ -45,7 +45,7 @@ void DataTransfer::UpdateRef(v8::Isolate* Isolate, v8::Local<v8::Value> Outer, c
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
     v8::Context::Scope ContextScope(Context);
 
-    auto Ret = Outer->ToObject(Context).ToLocalChecked()->Set(Context, 0, Value);
+    SetRefValue(Context, Outer->ToObject(Context).ToLocalChecked(), Value);
 }
 
 std::weak_ptr<int> DataTransfer::GetJsEnvLifeCycleTracker(v8::Isolate* Isolate)
@@ -46,6 +46,11 @@
 #include "Binding.hpp"   
 #include <stdarg.h>
 #include "BackendEnv.h"
+#include "GcScheduler.h"
+#include "CallStatistics.h"
+#if defined(WITH_NODEJS)
+#include "UvPump.h"
+#endif
 
 #define USE_OUTSIZE_UNITY 1
 
@@ -90,6 +95,7 @@ struct PersistentObjectInfo
     FPersistentObjectEnvInfo* EnvInfo;
     v8::Global<v8::Object> JsObject;
     std::weak_ptr<int> JsEnvLifeCycleTracker;
+    const void* DelegateTypeId; // 只有FunctionToDelegate创建的委托才有，用于释放时从FDelegateCache移除
     //std::map<void*, void*> 
 };
 
@@ -137,6 +143,7 @@ struct CSharpFieldInfo
 struct JsClassInfo : public JsClassInfoHeader
 {
     std::string Name;
+    bool IsBlittable = false;
     std::vector<WrapData*> Ctors;
     std::vector<CSharpMethodInfo> Methods;
     std::vector<CSharpFieldInfo> Fields;
@@ -174,7 +181,8 @@ static void* _GetRuntimeObjectFromPersistentObject(v8::Local<v8::Context> Contex
     auto POEnv = DataTransfer::GetPersistentObjectEnvInfo(Isolate);
 
     puerts::FCppObjectMapper* mapper = reinterpret_cast<puerts::FCppObjectMapper*>(Isolate->GetData(MAPPER_ISOLATE_DATA_POS));
-    mapper->ClearPendingPersistentObject(Isolate, Context);
+    // 和tick一样按预算释放
+    mapper->ClearPendingPersistentObject(Isolate, Context, POEnv->PendingReleaseBudget);
 
     v8::MaybeLocal<v8::Value> maybeValue = Obj->Get(Context, POEnv->SymbolCSPtr.Get(Isolate));
     if (maybeValue.IsEmpty())
@@ -187,7 +195,14 @@ static void* _GetRuntimeObjectFromPersistentObject(v8::Local<v8::Context> Contex
         return nullptr;
     }
 
-    return v8::Local<v8::External>::Cast(maybeExternal)->Value();
+    void* RuntimeObject = v8::Local<v8::External>::Cast(maybeExternal)->Value();
+    // 指向的C#对象已被回收但还排在释放队列里：去掉失效的映射，当作没有，由调用方新建一个（之后排到它时holder不匹配，不会误删）
+    if (POEnv->PendingReleaseObjects.IsPending(RuntimeObject))
+    {
+        Obj->Delete(Context, POEnv->SymbolCSPtr.Get(Isolate));
+        return nullptr;
+    }
+    return RuntimeObject;
 }
 static void* GetRuntimeObjectFromPersistentObject(pesapi_env env, pesapi_value pvalue)
 {
@@ -218,14 +233,19 @@ static void SetRuntimeObjectToPersistentObject(pesapi_env env, pesapi_value pval
 
 static void* FunctionToDelegate(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Object> Func, const JSClassDefinition* ClassDefinition)
 {
-    //auto MaybeDelegate = Func->Get(Context, 0);
-    
-    //TODO: 缓存delegate，实现用同一个function可以remove
-    //if (!MaybeDelegate.IsEmpty() && MaybeDelegate.ToLocalChecked()->IsExternal())
-    //{
-    //    PersistentObjectInfo* delegateInfo = static_cast<PersistentObjectInfo*>((v8::Local<v8::External>::Cast(MaybeDelegate.ToLocalChecked()))->Value());
-    //}
-    void* Ptr = _GetRuntimeObjectFromPersistentObject(Context, Func);
+    puerts::FCppObjectMapper* mapper = reinterpret_cast<puerts::FCppObjectMapper*>(Isolate->GetData(MAPPER_ISOLATE_DATA_POS));
+    // 按预算把已经被C#回收的委托从缓存里移除
+    mapper->ClearPendingPersistentObject(Isolate, Context, mapper->PersistentObjectEnvInfo.PendingReleaseBudget);
+
+    auto& DelegateCache = mapper->PersistentObjectEnvInfo.DelegateCache;
+    const void* CachedInfo = nullptr;
+    void* Ptr = DelegateCache.Find(Isolate, Func, ClassDefinition->TypeId, &CachedInfo);
+    // 命中的委托已被回收、还没处理到：先移除这个条目再新建，之后排到它时Remove按DelegateInfo匹配不到，什么都不做
+    if (Ptr && mapper->PersistentObjectEnvInfo.PendingReleaseObjects.IsPending(CachedInfo))
+    {
+        DelegateCache.Remove(Isolate, Func, ClassDefinition->TypeId, CachedInfo);
+        Ptr = nullptr;
+    }
     if (Ptr == nullptr)
     {
         JsClassInfo* classInfo = reinterpret_cast<JsClassInfo*>(ClassDefinition->Data);
@@ -237,7 +257,8 @@ static void* FunctionToDelegate(v8::Isolate* Isolate, v8::Local<v8::Context> Con
         
         delegateInfo->JsObject.Reset(Isolate, Func);
         delegateInfo->JsEnvLifeCycleTracker = DataTransfer::GetJsEnvLifeCycleTracker(Isolate);
-        _SetRuntimeObjectToPersistentObject(Context, Func, Ptr);
+        delegateInfo->DelegateTypeId = ClassDefinition->TypeId;
+        DelegateCache.Add(Isolate, Func, ClassDefinition->TypeId, Ptr, delegateInfo);
     }
     
     return Ptr;
@@ -389,7 +410,12 @@ inline static v8::Local<v8::Value> CSAnyToJsValue(v8::Isolate* Isolate, v8::Loca
 
 inline static v8::Local<v8::Value> CopyValueType(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const void* TypeId, const void* Ptr, size_t SizeOfValueType)
 {
-    void* buff =  GUnityExports.ObjectAllocate(TypeId); //TODO: allc by jsenv
+    auto CppObjectMapper = static_cast<FCppObjectMapper*>(DataTransfer::IsolateData<ICppObjectMapper>(Isolate));
+    void* buff = CppObjectMapper->AllocValueType(TypeId, SizeOfValueType);
+    if (!buff)
+    {
+        buff = GUnityExports.ObjectAllocate(TypeId);
+    }
     memcpy(buff, Ptr, SizeOfValueType);
     return DataTransfer::FindOrAddCData(Isolate, Context, TypeId, buff, false);
 }
@@ -469,8 +495,10 @@ static void UnrefJsObject(PersistentObjectInfo* objectInfo)
 {
     if (!objectInfo->JsEnvLifeCycleTracker.expired())
     {
-        std::lock_guard<std::mutex> guard(objectInfo->EnvInfo->Mutex);
-        objectInfo->EnvInfo->PendingReleaseObjects.push_back(std::move(objectInfo->JsObject));
+        // JSObject的PersistentObjectInfo紧跟在C#对象头后面（见Puerts_il2cpp.cpp的JsValueToCSRef）
+        const void* Holder = objectInfo->DelegateTypeId ? static_cast<const void*>(objectInfo)
+                                                        : reinterpret_cast<const uint8_t*>(objectInfo) - GUnityExports.SizeOfRuntimeObject;
+        objectInfo->EnvInfo->PendingReleaseObjects.Push(std::move(objectInfo->JsObject), objectInfo->DelegateTypeId, Holder);
         //PLog("add jsobject to pending release list");
     }
     objectInfo->EnvInfo = nullptr;
@@ -646,42 +674,101 @@ struct FieldWrapFuncInfo
 
 #include "FunctionBridge.Gen.h"
 
-MethodPointer FindBridgeFunc(const char* signature)
+template <typename T>
+static T* FindBySignatureBinarySearch(T* Infos, size_t Count, const char* signature)
 {
-    auto begin = &g_bridgeFuncInfos[0];
-    auto end = &g_bridgeFuncInfos[sizeof(g_bridgeFuncInfos) / sizeof(BridgeFuncInfo) - 1];
-    auto first = std::lower_bound(begin, end, signature, [](const BridgeFuncInfo& x, const char* signature) {return strcmp(x.Signature, signature) < 0;});
+    auto end = Infos + Count;
+    auto first = std::lower_bound(Infos, end, signature, [](const T& x, const char* signature) {return strcmp(x.Signature, signature) < 0;});
     if (first != end && strcmp(first->Signature, signature) == 0) {
-        return first->Method;
+        return first;
     }
     return nullptr;
 }
 
-WrapFuncPtr FindWrapFunc(const char* signature)
+#if defined(PUERTS_SIGNATURE_PERFECT_HASH)
+// 必须和puerts/templates/perfecthash.mjs里的signatureHash保持一致
+static uint32_t SignatureHash(uint32_t Seed, const char* signature)
 {
-    auto begin = &g_wrapFuncInfos[0];
-    auto end = &g_wrapFuncInfos[sizeof(g_wrapFuncInfos) / sizeof(WrapFuncInfo) - 1];
-    auto first = std::lower_bound(begin, end, signature, [](const WrapFuncInfo& x, const char* signature) {return strcmp(x.Signature, signature) < 0;});
-    if (first != end && strcmp(first->Signature, signature) == 0) {
-        return first->Method;
+    uint32_t Hash = 2166136261u ^ Seed;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(signature); *p; ++p) {
+        Hash = (Hash ^ *p) * 16777619u;
     }
-    return nullptr;
+    Hash ^= Hash >> 16;
+    Hash *= 0x85ebca6bu;
+    Hash ^= Hash >> 13;
+    Hash *= 0xc2b2ae35u;
+    Hash ^= Hash >> 16;
+    return Hash;
+}
+
+// 生成器输出的最小完美哈希（见perfecthash.mjs的perfectHash），查找只需要算两次hash和一次strcmp
+template <typename T, size_t SeedCount>
+static T* FindBySignaturePerfectHash(T* Infos, size_t Count, const int32_t (&Seeds)[SeedCount], const int32_t* Slots, const char* signature)
+{
+    if (Count == 0) {
+        return nullptr;
+    }
+    int32_t Seed = Seeds[SignatureHash(0, signature) % SeedCount];
+    size_t Slot = Seed < 0 ? static_cast<size_t>(-Seed - 1) : SignatureHash(static_cast<uint32_t>(Seed), signature) % Count;
+    T* Info = &Infos[Slots[Slot]];
+    return strcmp(Info->Signature, signature) == 0 ? Info : nullptr;
+}
+
+#define FIND_BY_SIGNATURE(Infos, Name, signature) \
+    FindBySignaturePerfectHash(Infos, sizeof(Infos) / sizeof(Infos[0]) - 1, Name##Seeds, Name##Slots, signature)
+#else
+// 旧版本生成的FunctionBridge.Gen.h没有哈希表，退回二分查找
+#define FIND_BY_SIGNATURE(Infos, Name, signature) FindBySignatureBinarySearch(Infos, sizeof(Infos) / sizeof(Infos[0]) - 1, signature)
+#endif
+
+MethodPointer FindBridgeFunc(const char* signature)
+{
+    auto info = FIND_BY_SIGNATURE(g_bridgeFuncInfos, g_bridgeFuncHash, signature);
+    return info ? info->Method : nullptr;
+}
+
+WrapFuncPtr FindWrapFunc(const char* signature)
+{
+    auto info = FIND_BY_SIGNATURE(g_wrapFuncInfos, g_wrapFuncHash, signature);
+    return info ? info->Method : nullptr;
 }
 
 FieldWrapFuncInfo * FindFieldWrapFuncInfo(const char* signature)
 {
-    auto begin = &g_fieldWrapFuncInfos[0];
-    auto end = &g_fieldWrapFuncInfos[sizeof(g_fieldWrapFuncInfos) / sizeof(FieldWrapFuncInfo) - 1];
-    auto first = std::lower_bound(begin, end, signature, [](const FieldWrapFuncInfo& x, const char* signature) {return strcmp(x.Signature, signature) < 0;});
-    if (first != end && strcmp(first->Signature, signature) == 0) {
-        return first;
+    return FIND_BY_SIGNATURE(g_fieldWrapFuncInfos, g_fieldWrapFuncHash, signature);
+}
+
+// 用二分查找逐个核对所有签名的查找结果，返回不一致的个数
+template <typename T, typename F>
+static int32_t CheckSignatureTable(T* Infos, size_t Count, F&& Find)
+{
+    int32_t Mismatches = 0;
+    for (size_t i = 0; i < Count; ++i) {
+        if (Find(Infos[i].Signature) != FindBySignatureBinarySearch(Infos, Count, Infos[i].Signature)) {
+            ++Mismatches;
+        }
+        std::string Missing = std::string(Infos[i].Signature) + "__missing";
+        if (Find(Missing.c_str()) != FindBySignatureBinarySearch(Infos, Count, Missing.c_str())) {
+            ++Mismatches;
+        }
     }
-    return nullptr;
+    return Mismatches;
+}
+
+int32_t CheckSignatureLookup()
+{
+    return CheckSignatureTable(g_bridgeFuncInfos, sizeof(g_bridgeFuncInfos) / sizeof(BridgeFuncInfo) - 1,
+               [](const char* signature) { return FIND_BY_SIGNATURE(g_bridgeFuncInfos, g_bridgeFuncHash, signature); }) +
+           CheckSignatureTable(g_wrapFuncInfos, sizeof(g_wrapFuncInfos) / sizeof(WrapFuncInfo) - 1,
+               [](const char* signature) { return FIND_BY_SIGNATURE(g_wrapFuncInfos, g_wrapFuncHash, signature); }) +
+           CheckSignatureTable(g_fieldWrapFuncInfos, sizeof(g_fieldWrapFuncInfos) / sizeof(FieldWrapFuncInfo) - 1,
+               [](const char* signature) { return FIND_BY_SIGNATURE(g_fieldWrapFuncInfos, g_fieldWrapFuncHash, signature); });
 }
 
 struct JSEnv
 {
-    JSEnv()
+    // MaxYoungGenerationSizeMB/MaxOldGenerationSizeMB为0表示使用v8的默认堆大小
+    JSEnv(uint32_t MaxYoungGenerationSizeMB = 0, uint32_t MaxOldGenerationSizeMB = 0)
     {
         if (!GPlatform)
         {
@@ -728,13 +815,18 @@ struct JSEnv
             printf("uv_loop_init failed\n");
             return;
         }
+        NodeUVPump.reset(new puerts::UvPump(NodeUVLoop));
 
         NodeArrayBufferAllocator = node::ArrayBufferAllocator::Create();
         // PLog(puerts::Log, "[PuertsDLL][JSEngineWithNode]isolate");
 
         auto Platform = static_cast<node::MultiIsolatePlatform*>(GPlatform.get());
-        MainIsolate = node::NewIsolate(NodeArrayBufferAllocator.get(), NodeUVLoop,
-            Platform);
+        {
+            // node::NewIsolate不接受CreateParams，堆大小只能在创建期间用flag指定
+            puerts::ScopedHeapSizeFlags HeapSizeFlags(MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
+            MainIsolate = node::NewIsolate(NodeArrayBufferAllocator.get(), NodeUVLoop,
+                Platform);
+        }
 
         MainIsolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
 #else
@@ -746,9 +838,11 @@ struct JSEnv
         // 初始化Isolate和DefaultContext
         CreateParams = new v8::Isolate::CreateParams();
         CreateParams->array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+        puerts::GcScheduler::ApplyResourceConstraints(*CreateParams, MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
         
         MainIsolate = v8::Isolate::New(*CreateParams);
 #endif
+        GcScheduler.Attach(MainIsolate, GPlatform.get());
         auto Isolate = MainIsolate;
         
         v8::Isolate::Scope Isolatescope(Isolate);
@@ -809,6 +903,8 @@ struct JSEnv
             }
             
         }, v8::External::New(Isolate, &CppObjectMapper))->GetFunction(Context).ToLocalChecked()).Check();
+
+        Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "__puertsRefCell").ToLocalChecked(), puerts::CreateRefCellClass(Context)).Check();
         
         Context->Global()->Set(Context, v8::String::NewFromUtf8(Isolate, "log").ToLocalChecked(), v8::FunctionTemplate::New(Isolate, [](const v8::FunctionCallbackInfo<v8::Value>& info)
         {
@@ -835,6 +931,7 @@ struct JSEnv
             delete BackendEnv.Inspector;
             BackendEnv.Inspector = nullptr;
         }
+        BackendEnv.DestroyProfiler(MainIsolate);
 
 #if defined(WITH_NODEJS)
         // node::EmitExit(NodeEnv);
@@ -849,6 +946,7 @@ struct JSEnv
         Platform->UnregisterIsolate(MainIsolate);
 #endif
         MainContext.Reset();
+        GcScheduler.Detach();
         MainIsolate->Dispose();
 #if WITH_NODEJS
         // Wait until the platform has cleaned up all relevant resources.
@@ -857,6 +955,7 @@ struct JSEnv
             uv_run(NodeUVLoop, UV_RUN_ONCE);
         }
 
+        NodeUVPump.reset();
         int err = uv_loop_close(NodeUVLoop);
         assert(err == 0);
         delete NodeUVLoop;
@@ -874,8 +973,11 @@ struct JSEnv
     puerts::FCppObjectMapper CppObjectMapper;
     puerts::BackendEnv BackendEnv;
 
+    puerts::GcScheduler GcScheduler;
+
 #if defined(WITH_NODEJS)
     uv_loop_t* NodeUVLoop;
+    std::unique_ptr<puerts::UvPump> NodeUVPump;
     std::unique_ptr<node::ArrayBufferAllocator> NodeArrayBufferAllocator;
     node::IsolateData* NodeIsolateData;
     node::Environment* NodeEnv;
@@ -907,6 +1009,12 @@ V8_EXPORT puerts::JSEnv* CreateNativeJSEnv()
     return new puerts::JSEnv();
 }
 
+// 0表示使用v8的默认值
+V8_EXPORT puerts::JSEnv* CreateNativeJSEnvWithResourceConstraints(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
+{
+    return new puerts::JSEnv(MaxYoungGenerationSizeMB, MaxOldGenerationSizeMB);
+}
+
 V8_EXPORT void DestroyNativeJSEnv(puerts::JSEnv* jsEnv)
 {
     delete jsEnv;
@@ -929,7 +1037,7 @@ V8_EXPORT pesapi_env_holder GetPesapiEnvHolder(puerts::JSEnv* jsEnv)
     return pesapi_hold_env(env);
 }
 
-V8_EXPORT puerts::JsClassInfo* CreateCSharpTypeInfo(const char* name, const void* type_id, const void* super_type_id, void* klass, bool isValueType, bool isDelegate, const char* delegateSignature)
+V8_EXPORT puerts::JsClassInfo* CreateCSharpTypeInfo(const char* name, const void* type_id, const void* super_type_id, void* klass, bool isValueType, bool isBlittable, bool isDelegate, const char* delegateSignature)
 {
     puerts::MethodPointer delegateBridge = nullptr;
     if (isDelegate)
@@ -943,6 +1051,7 @@ V8_EXPORT puerts::JsClassInfo* CreateCSharpTypeInfo(const char* name, const void
     ret->SuperTypeId = super_type_id;
     ret->Class = klass;
     ret->IsValueType = isValueType;
+    ret->IsBlittable = isValueType && isBlittable;
     ret->DelegateBridge = delegateBridge;
     
     return ret;
@@ -974,6 +1083,12 @@ static void SetParamArrayFlagAndOptionalNum(puerts::WrapData* data, const char*
     }
 }
 
+// 测试用：核对生成的签名查找表，返回不一致的个数，0表示全部正确
+V8_EXPORT int32_t CheckSignatureLookup()
+{
+    return puerts::CheckSignatureLookup();
+}
+
 V8_EXPORT puerts::WrapFuncPtr FindWrapFunc(const char* signature)
 {
     if (signature == nullptr)
@@ -995,6 +1110,9 @@ V8_EXPORT puerts::WrapData* AddConstructor(puerts::JsClassInfo* classInfo, const
     data->IsStatic = false;
     data->IsExtensionMethod = false;
     SetParamArrayFlagAndOptionalNum(data, signature);
+#ifdef PUERTS_CALL_STATISTICS
+    data->Statistics = puerts::RegisterCallStatistics((classInfo->Name + ".constructor(" + (signature ? signature : "") + ")").c_str());
+#endif
     
     classInfo->Ctors.push_back(data);
     return data;
@@ -1012,6 +1130,10 @@ V8_EXPORT puerts::WrapData* AddMethod(puerts::JsClassInfo* classInfo, const char
     data->IsStatic = isStatic;
     data->IsExtensionMethod = isExtensionMethod;
     SetParamArrayFlagAndOptionalNum(data, signature);
+#ifdef PUERTS_CALL_STATISTICS
+    // 每个重载一个条目，用签名区分
+    data->Statistics = puerts::RegisterCallStatistics((classInfo->Name + "." + (isGetter ? "get " : isSetter ? "set " : "") + name + "(" + (signature ? signature : "") + ")").c_str());
+#endif
     
     for(int i = 0; i < classInfo->Methods.size(); ++i)
     {
@@ -1099,6 +1221,7 @@ V8_EXPORT bool RegisterCSharpType(puerts::JsClassInfo* classInfo)
     
     ClassDef.Initialize = classInfo->DelegateBridge ? puerts::DelegateCtorCallback : puerts::GUnityExports.ConstructorCallback;
     ClassDef.Finalize = classInfo->IsValueType ? puerts::GUnityExports.ValueTypeDeallocate : (puerts::FinalizeFunc)nullptr;
+    ClassDef.IsBlittableValueType = classInfo->IsBlittable;
     ClassDef.Data = classInfo;
     
     classInfo->Ctors.push_back(nullptr);
@@ -1219,6 +1342,10 @@ V8_EXPORT void ExchangeAPI(puerts::UnityExports * exports)
     exports->GetPersistentObject = &puerts::GetPersistentObject;
     exports->SetRuntimeObjectToPersistentObject = &puerts::SetRuntimeObjectToPersistentObject;
     exports->GetRuntimeObjectFromPersistentObject = &puerts::GetRuntimeObjectFromPersistentObject;
+#ifdef PUERTS_CALL_STATISTICS
+    exports->CallStatisticsStart = &puerts::CallStatisticsStart;
+    exports->RecordCallStatistics = &puerts::RecordCallStatistics;
+#endif
     puerts::GUnityExports = *exports;
 }
 
@@ -1259,7 +1386,37 @@ V8_EXPORT void ReleasePendingJsObjects(puerts::JSEnv* jsEnv)
     v8::Isolate::Scope IsolateScope(Isolate);
     v8::HandleScope HandleScope(Isolate);
     
-    jsEnv->CppObjectMapper.ClearPendingPersistentObject(Isolate, jsEnv->MainContext.Get(Isolate));
+    jsEnv->CppObjectMapper.ClearPendingPersistentObject(Isolate, jsEnv->MainContext.Get(Isolate),
+        jsEnv->CppObjectMapper.PersistentObjectEnvInfo.PendingReleaseBudget);
+}
+
+// FunctionToDelegate缓存的命中、未命中次数和当前条目数
+V8_EXPORT void GetDelegateCacheStats(puerts::JSEnv* jsEnv, int64_t* Hits, int64_t* Misses, int32_t* Size)
+{
+    auto& DelegateCache = jsEnv->CppObjectMapper.PersistentObjectEnvInfo.DelegateCache;
+    *Hits = DelegateCache.Hits;
+    *Misses = DelegateCache.Misses;
+    *Size = DelegateCache.Size();
+}
+
+// 每次ReleasePendingJsObjects最多释放的对象数，<= 0表示不限制
+V8_EXPORT void SetPendingReleaseBudget(puerts::JSEnv* jsEnv, int32_t MaxPerTick)
+{
+    jsEnv->CppObjectMapper.PersistentObjectEnvInfo.PendingReleaseBudget = MaxPerTick;
+}
+
+// 只影响之后生成模板的类，quickjs后端忽略
+V8_EXPORT void SetLazyMemberInstallation(puerts::JSEnv* jsEnv, int Enable)
+{
+#ifndef WITH_QUICKJS
+    jsEnv->CppObjectMapper.LazyMemberInstallation = Enable != 0;
+#endif
+}
+
+// 已经被C#回收、但对应js对象还没释放的数量，可以在任意线程读取
+V8_EXPORT int32_t GetPendingReleaseBacklog(puerts::JSEnv* jsEnv)
+{
+    return jsEnv->CppObjectMapper.PersistentObjectEnvInfo.PendingReleaseObjects.GetBacklog();
 }
 
 V8_EXPORT void CreateInspector(puerts::JSEnv* jsEnv, int32_t Port)
@@ -1277,9 +1434,39 @@ V8_EXPORT int InspectorTick(puerts::JSEnv* jsEnv)
     return jsEnv->BackendEnv.InspectorTick() ? 1 : 0;
 }
 
+V8_EXPORT int StartCpuProfile(puerts::JSEnv* jsEnv, int32_t SamplingIntervalUs)
+{
+    return jsEnv->BackendEnv.StartCpuProfile(jsEnv->MainIsolate, SamplingIntervalUs) ? 1 : 0;
+}
+
+V8_EXPORT int StopCpuProfile(puerts::JSEnv* jsEnv, const char* Path)
+{
+    return jsEnv->BackendEnv.StopCpuProfile(jsEnv->MainIsolate, Path) ? 1 : 0;
+}
+
+V8_EXPORT int TakeHeapSnapshot(puerts::JSEnv* jsEnv, const char* Path)
+{
+    return jsEnv->BackendEnv.TakeHeapSnapshot(jsEnv->MainIsolate, Path) ? 1 : 0;
+}
+
+V8_EXPORT int StartSamplingHeapProfiler(puerts::JSEnv* jsEnv, uint64_t SampleInterval, int32_t StackDepth)
+{
+    return jsEnv->BackendEnv.StartSamplingHeapProfiler(jsEnv->MainIsolate, SampleInterval, StackDepth) ? 1 : 0;
+}
+
+V8_EXPORT int StopSamplingHeapProfiler(puerts::JSEnv* jsEnv, const char* Path)
+{
+    return jsEnv->BackendEnv.StopSamplingHeapProfiler(jsEnv->MainIsolate, Path) ? 1 : 0;
+}
+
 V8_EXPORT void LogicTick(puerts::JSEnv* jsEnv)
 {
 #ifdef WITH_NODEJS
+    // 没有活跃handle也没有就绪事件时整个跳过
+    if (!jsEnv->NodeUVPump->IsReady())
+    {
+        return;
+    }
     v8::Isolate* Isolate = jsEnv->MainIsolate;
 #ifdef THREAD_SAFE
     v8::Locker Locker(Isolate);
@@ -1293,6 +1480,82 @@ V8_EXPORT void LogicTick(puerts::JSEnv* jsEnv)
 #endif
 }
 
+// 以下只对nodejs后端有意义，其它后端分别返回-1、-1、0
+V8_EXPORT int GetUvBackendFd(puerts::JSEnv* jsEnv)
+{
+#ifdef WITH_NODEJS
+    return jsEnv->NodeUVPump->BackendFd();
+#else
+    return -1;
+#endif
+}
+
+V8_EXPORT int GetUvNextTimeout(puerts::JSEnv* jsEnv)
+{
+#ifdef WITH_NODEJS
+    return jsEnv->NodeUVPump->NextTimeout();
+#else
+    return -1;
+#endif
+}
+
+V8_EXPORT int WaitUvEvents(puerts::JSEnv* jsEnv, int32_t MaxWaitMs)
+{
+#ifdef WITH_NODEJS
+    return jsEnv->NodeUVPump->Wait(MaxWaitMs) ? 1 : 0;
+#else
+    return 0;
+#endif
+}
+
+// 返回调用统计条目组成的平坦数组（布局见CallStatistics.h），未开启PUERTS_CALL_STATISTICS时返回nullptr，Count为0
+V8_EXPORT const void* GetCallStatistics(int* Count)
+{
+#ifdef PUERTS_CALL_STATISTICS
+    return puerts::GetCallStatistics(Count);
+#else
+    *Count = 0;
+    return nullptr;
+#endif
+}
+
+V8_EXPORT double GetCallStatisticsTicksPerSecond()
+{
+#ifdef PUERTS_CALL_STATISTICS
+    return puerts::GetCallStatisticsTicksPerSecond();
+#else
+    return 0;
+#endif
+}
+
+V8_EXPORT void ResetCallStatistics()
+{
+#ifdef PUERTS_CALL_STATISTICS
+    puerts::ResetCallStatistics();
+#endif
+}
+
+// BudgetSeconds是这一帧剩余的时间，不是绝对的deadline
+V8_EXPORT int GcIdleNotification(puerts::JSEnv* jsEnv, double BudgetSeconds)
+{
+    return jsEnv->GcScheduler.NotifyIdle(BudgetSeconds) ? 1 : 0;
+}
+
+V8_EXPORT void MemoryPressureNotification(puerts::JSEnv* jsEnv, int Level)
+{
+    jsEnv->GcScheduler.MemoryPressure(Level);
+}
+
+V8_EXPORT void GetGcStatistics(puerts::JSEnv* jsEnv, int Kind, puerts::GcPauseStatistics* Statistics)
+{
+    *Statistics = jsEnv->GcScheduler.GetStatistics(Kind);
+}
+
+V8_EXPORT void ResetGcStatistics(puerts::JSEnv* jsEnv)
+{
+    jsEnv->GcScheduler.ResetStatistics();
+}
+
 #ifdef __cplusplus
 }
 #endif
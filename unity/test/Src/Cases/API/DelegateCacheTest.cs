@@ -0,0 +1,43 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using System;
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class DelegateCacheTest
+    {
+        [Test]
+        public void SameFunctionSameDelegateTypeTest()
+        {
+#if EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP
+            var jsEnv = UnitTestEnv.GetEnv();
+            jsEnv.Eval("globalThis.__delegateCacheFunc = function() { return 1; };");
+
+            long hits, misses;
+            int size;
+            jsEnv.GetDelegateCacheStats(out hits, out misses, out size);
+            long hitsBefore = hits;
+
+            Action a1 = jsEnv.Eval<Action>("__delegateCacheFunc");
+            Action a2 = jsEnv.Eval<Action>("__delegateCacheFunc");
+            Func<int> f = jsEnv.Eval<Func<int>>("__delegateCacheFunc");
+
+            Assert.AreSame(a1, a2);
+            Assert.AreEqual(1, f());
+
+            jsEnv.GetDelegateCacheStats(out hits, out misses, out size);
+            Assert.AreEqual(hitsBefore + 1, hits);
+
+            jsEnv.Eval("delete globalThis.__delegateCacheFunc;");
+            jsEnv.Tick();
+#endif
+        }
+    }
+}
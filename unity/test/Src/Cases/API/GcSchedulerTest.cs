@@ -0,0 +1,46 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class GcSchedulerTest
+    {
+        [Test]
+        public void PauseStatisticsTest()
+        {
+            // 新生代限制得很小，保证下面的分配一定会触发scavenge
+#if PUERTS_GENERAL
+            var env = new JsEnv(new TxtLoader(), -1, 3, 0);
+#else
+            var env = new JsEnv(new UnitTestLoader(), -1, 3, 0);
+#endif
+            var backend = env.Backend as BackendV8;
+            if (backend != null)
+            {
+                env.Eval("(function() { let keep; for (let i = 0; i < 1000000; i++) keep = { i: i, s: [i, i + 1] }; return keep.i; })()");
+
+                var minor = backend.GetGcStatistics(GcPauseKind.Minor);
+                Assert.Greater(minor.Count, 0UL);
+                Assert.LessOrEqual(minor.MaxMicroseconds, minor.TotalMicroseconds);
+                ulong inHistogram = 0;
+                foreach (var n in minor.Histogram) inHistogram += n;
+                Assert.AreEqual(minor.Count, inHistogram);
+                Assert.GreaterOrEqual(backend.GetGcStatistics().Count, minor.Count);
+
+                backend.GcIdleNotification(0.01);
+                backend.MemoryPressureNotification(MemoryPressureLevel.Critical);
+
+                backend.ResetGcStatistics();
+                Assert.AreEqual(0UL, backend.GetGcStatistics().Count);
+            }
+            env.Dispose();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class HotReloadTest
+    {
+        [Test]
+        public void ReloadStopsAtAcceptBoundary()
+        {
+#if PUERTS_GENERAL
+            var loader = new TxtLoader();
+#else
+            var loader = new UnitTestLoader2();
+#endif
+            loader.AddMockFileContent("hot-reload/dep.mjs", @"
+                globalThis.hotRuns.dep++;
+                export const value = 1;
+            ");
+            loader.AddMockFileContent("hot-reload/acc.mjs", @"
+                import { value } from './dep.mjs';
+                globalThis.hotRuns.acc++;
+                export function get() { return value; }
+                import.meta.hot.data.count = (import.meta.hot.data.count || 0) + 1;
+                import.meta.hot.dispose(data => { data.disposed = true; });
+                import.meta.hot.accept(ns => { globalThis.hotAccepted = ns.get(); });
+            ");
+            loader.AddMockFileContent("hot-reload/main.mjs", @"
+                import { get } from './acc.mjs';
+                globalThis.hotRuns.main++;
+                globalThis.hotMain = get;
+            ");
+            var jsEnv = new JsEnv(loader);
+            jsEnv.Eval("globalThis.hotRuns = { dep: 0, acc: 0, main: 0 };");
+            jsEnv.ExecuteModule("hot-reload/main.mjs");
+
+            loader.AddMockFileContent("hot-reload/dep.mjs", @"
+                globalThis.hotRuns.dep++;
+                export const value = 2;
+            ");
+            jsEnv.ReloadModules("hot-reload/dep.mjs");
+
+            // dep和acc重新执行，acc接受了更新，main不受影响
+            string result = jsEnv.Eval<string>(@"
+                const r = globalThis.hotRuns;
+                [r.dep, r.acc, r.main, globalThis.hotAccepted].join(':');
+            ");
+            Assert.AreEqual("2:2:1:2", result);
+
+            jsEnv.Dispose();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [UnityEngine.Scripting.Preserve]
+    public class LazyMemberTestBase
+    {
+        [UnityEngine.Scripting.Preserve]
+        public int Value = 1;
+
+        [UnityEngine.Scripting.Preserve]
+        public int ReadOnlyValue { get { return 7; } }
+
+        [UnityEngine.Scripting.Preserve]
+        public virtual string Who()
+        {
+            return "base";
+        }
+
+        [UnityEngine.Scripting.Preserve]
+        public string BaseOnly()
+        {
+            return "baseonly";
+        }
+    }
+
+    [UnityEngine.Scripting.Preserve]
+    public class LazyMemberTestDerived : LazyMemberTestBase
+    {
+        [UnityEngine.Scripting.Preserve]
+        public override string Who()
+        {
+            return "derived";
+        }
+    }
+
+    [TestFixture]
+    public class LazyMemberTest
+    {
+        [Test]
+        public void InstallOnFirstAccessTest()
+        {
+#if PUERTS_GENERAL
+            var jsEnv = new JsEnv(new TxtLoader());
+#else
+            var jsEnv = new JsEnv(new UnitTestLoader());
+#endif
+#if EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP
+            jsEnv.LazyMemberInstallation = true;
+#else
+            jsEnv.SetLazyMemberInstallation(true);
+#endif
+
+            string result = jsEnv.Eval<string>(@"
+                (function() {
+                    const Base = CS.Puerts.UnitTest.LazyMemberTestBase;
+                    const Derived = CS.Puerts.UnitTest.LazyMemberTestDerived;
+                    const b = new Base();
+                    const d = new Derived();
+                    // 基类的同名方法先被装上，子类的覆盖仍然要生效
+                    const r = [b.Who(), d.Who(), d.BaseOnly(), 'Value' in d];
+                    d.Value = 5;
+                    r.push(d.Value, b.Value, Object.keys(d).length, d.ReadOnlyValue);
+                    return r.join(',');
+                })();
+            ");
+            Assert.AreEqual("base,derived,baseonly,true,5,1,0,7", result);
+
+            jsEnv.Dispose();
+        }
+    }
+}
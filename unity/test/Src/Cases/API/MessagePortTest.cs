@@ -0,0 +1,127 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [UnityEngine.Scripting.Preserve]
+    public class MessagePortTestObject
+    {
+        [UnityEngine.Scripting.Preserve]
+        public int Id;
+    }
+
+    [TestFixture]
+    public class MessagePortTest
+    {
+#if !(EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP)
+        private static JsEnv CreateEnv()
+        {
+#if PUERTS_GENERAL
+            return new JsEnv(new TxtLoader());
+#else
+            return new JsEnv(new UnitTestLoader());
+#endif
+        }
+
+        [Test]
+        public void PostBetweenEnvsTest()
+        {
+            var sender = CreateEnv();
+            var receiver = CreateEnv();
+            sender.ConnectMessagePort("ch", receiver, "ch");
+
+            receiver.Eval(@"
+                globalThis.received = [];
+                puer.getMessagePort('ch').onmessage = m => received.push(m);
+            ");
+            // transfer之后发送方的ArrayBuffer被detach，收方拿到同一块内存
+            string sent = sender.Eval<string>(@"
+                (function() {
+                    const port = puer.getMessagePort('ch');
+                    const buf = new Uint8Array([1, 2, 3]).buffer;
+                    const ok = port.postMessage({ a: 1, list: ['x', 'y'], buf: buf }, [buf]);
+                    port.postRaw(new Uint8Array([7, 8]));
+                    return ok + ':' + buf.byteLength;
+                })();
+            ");
+            Assert.AreEqual("true:0", sent);
+
+            receiver.Tick();
+            string result = receiver.Eval<string>(@"
+                (function() {
+                    const m = received[0];
+                    const raw = new Uint8Array(received[1]);
+                    return [received.length, m.a, m.list.join(''), new Uint8Array(m.buf).join(','), raw.join(',')].join(':');
+                })();
+            ");
+            Assert.AreEqual("2:1:xy:1,2,3:7,8", result);
+
+            sender.Dispose();
+            receiver.Dispose();
+        }
+
+        [Test]
+        public void PostCSharpObjectInSameEnvTest()
+        {
+            var jsEnv = CreateEnv();
+            jsEnv.ConnectMessagePort("left", jsEnv, "right");
+
+            jsEnv.Eval(@"
+                globalThis.sentObj = new CS.Puerts.UnitTest.MessagePortTestObject();
+                sentObj.Id = 42;
+                puer.getMessagePort('right').onmessage = m => globalThis.receivedObj = m.obj;
+                puer.getMessagePort('left').postMessage({ obj: sentObj });
+            ");
+            jsEnv.Tick();
+            string result = jsEnv.Eval<string>("(receivedObj === sentObj) + ':' + receivedObj.Id");
+            Assert.AreEqual("true:42", result);
+
+            jsEnv.Dispose();
+        }
+
+        [Test]
+        public void PostToFullPortKeepsTransferredBufferTest()
+        {
+            var sender = CreateEnv();
+            var receiver = CreateEnv();
+            sender.ConnectMessagePort("ch", receiver, "ch", 1);
+
+            // 队列满时postMessage返回false，transferList里的ArrayBuffer没有被detach，可以稍后重发
+            string result = sender.Eval<string>(@"
+                (function() {
+                    const port = puer.getMessagePort('ch');
+                    const first = new ArrayBuffer(4);
+                    const second = new ArrayBuffer(8);
+                    const posted = port.postMessage(first, [first]);
+                    const rejected = port.postMessage(second, [second]);
+                    return [posted, rejected, second.byteLength].join(':');
+                })();
+            ");
+            Assert.AreEqual("true:false:8", result);
+
+            receiver.Eval(@"
+                globalThis.received = [];
+                puer.getMessagePort('ch').onmessage = m => received.push(m.byteLength);
+            ");
+            receiver.Tick();
+            Assert.AreEqual("true:0", sender.Eval<string>(@"
+                (function() {
+                    const second = new ArrayBuffer(8);
+                    return [puer.getMessagePort('ch').postMessage(second, [second]), second.byteLength].join(':');
+                })();
+            "));
+            receiver.Tick();
+            Assert.AreEqual("4,8", receiver.Eval<string>("received.join(',')"));
+
+            sender.Dispose();
+            receiver.Dispose();
+        }
+#endif
+    }
+}
@@ -0,0 +1,100 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using System.Collections.Generic;
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    // 记录loader被请求过哪些模块，其它都交给测试用的loader
+    public class ModulePrefetchTestLoader : IResolvableLoader, ILoader
+    {
+        public List<string> Resolved = new List<string>();
+        public List<string> Read = new List<string>();
+#if PUERTS_GENERAL
+        private TxtLoader loader = new TxtLoader();
+#else
+        private UnitTestLoader2 loader = new UnitTestLoader2();
+#endif
+
+        public void AddMockFileContent(string fileName, string content)
+        {
+            loader.AddMockFileContent(fileName, content);
+        }
+
+        [UnityEngine.Scripting.Preserve]
+        public string Resolve(string specifier, string referrer)
+        {
+            Resolved.Add(specifier);
+            return loader.Resolve(specifier, referrer);
+        }
+
+        [UnityEngine.Scripting.Preserve]
+        public bool FileExists(string specifier)
+        {
+            return loader.FileExists(specifier);
+        }
+
+        [UnityEngine.Scripting.Preserve]
+        public string ReadFile(string specifier, out string debugpath)
+        {
+            if (specifier.StartsWith("prefetch/"))
+            {
+                Read.Add(specifier);
+            }
+            return loader.ReadFile(specifier, out debugpath);
+        }
+    }
+
+    [TestFixture]
+    public class ModulePrefetchTest
+    {
+        [Test]
+        public void OnlyRequestedModulesAreLoaded()
+        {
+            var loader = new ModulePrefetchTestLoader();
+            loader.AddMockFileContent("prefetch/main.mjs", @"
+                import { value } from './dep.mjs';
+                export * from './reexport.mjs';
+                // 看起来像import的正则和字符串都不是依赖
+                const re = /import 'prefetch\/missing.mjs'/;
+                const s = ""export { x } from 'prefetch/missing2.mjs'"";
+                export const result = value + (re.source.length > 0 && s.length > 0 ? 1 : 0);
+            ");
+            loader.AddMockFileContent("prefetch/dep.mjs", @"
+                import { other } from './reexport.mjs';
+                export const value = other + 1;
+            ");
+            loader.AddMockFileContent("prefetch/reexport.mjs", @"
+                export const other = 40;
+            ");
+            var jsEnv = new JsEnv(loader);
+
+            // 预取不阻塞，解析完的模块在Tick里编译，并接着预取它的依赖
+            var deadline = System.DateTime.Now.AddSeconds(10);
+            while (jsEnv.PrefetchModule("prefetch/main.mjs"))
+            {
+                Assert.Less(System.DateTime.Now, deadline, "prefetch did not finish");
+                jsEnv.Tick();
+                System.Threading.Thread.Sleep(1);
+            }
+
+            Assert.AreEqual(42, jsEnv.ExecuteModule<int>("prefetch/main.mjs", "result"));
+            Assert.AreEqual(40, jsEnv.ExecuteModule<int>("prefetch/main.mjs", "other"));
+
+            Assert.False(loader.Resolved.Exists(specifier => specifier.Contains("missing")));
+            // 预取过的模块不会在同步link时再读一次
+            CollectionAssert.AreEquivalent(new string[] { "prefetch/main.mjs", "prefetch/dep.mjs", "prefetch/reexport.mjs" }, loader.Read);
+
+            // 已经缓存的模块再执行不会重新读取
+            jsEnv.ExecuteModule("prefetch/dep.mjs");
+            Assert.AreEqual(3, loader.Read.Count);
+
+            jsEnv.Dispose();
+        }
+    }
+}
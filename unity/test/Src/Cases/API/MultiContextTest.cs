@@ -0,0 +1,137 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class MultiContextTest
+    {
+#if !(EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP)
+        private static JsEnv CreateEnv()
+        {
+#if PUERTS_GENERAL
+            return new JsEnv(new TxtLoader());
+#else
+            return new JsEnv(new UnitTestLoader());
+#endif
+        }
+
+        [Test]
+        public void GlobalsIsolatedTest()
+        {
+            var jsEnv = CreateEnv();
+            if (jsEnv.Backend is BackendQuickJS)
+            {
+                jsEnv.Dispose();
+                return;
+            }
+            jsEnv.Eval("globalThis.foo = 1;");
+
+            int contextId = jsEnv.CreateContext();
+            Assert.Greater(contextId, 0);
+
+            jsEnv.EnterContext(contextId);
+            Assert.AreEqual("undefined:undefined", jsEnv.Eval<string>("typeof foo + ':' + typeof puer"));
+            jsEnv.Eval("globalThis.bar = 2;");
+            Assert.AreEqual(2, jsEnv.Eval<int>("bar"));
+
+            jsEnv.EnterContext(0);
+            Assert.AreEqual("1:undefined", jsEnv.Eval<string>("foo + ':' + typeof bar"));
+
+            jsEnv.DestroyContext(contextId);
+            Assert.Throws<System.ArgumentException>(() => jsEnv.EnterContext(contextId));
+            Assert.AreEqual(1, jsEnv.Eval<int>("foo"));
+
+            jsEnv.Dispose();
+        }
+
+        [Test]
+        public void FreezeIntrinsicsTest()
+        {
+            var jsEnv = CreateEnv();
+            if (jsEnv.Backend is BackendQuickJS)
+            {
+                jsEnv.Dispose();
+                return;
+            }
+            int frozen = jsEnv.CreateContext(null, true);
+            int plain = jsEnv.CreateContext();
+
+            jsEnv.EnterContext(frozen);
+            string result = jsEnv.Eval<string>(@"
+                Array.prototype.evil = 1;
+                Object.isFrozen(Array.prototype) + ':' + Object.isFrozen(Object) + ':' + ([].evil === undefined);
+            ");
+            Assert.AreEqual("true:true:true", result);
+
+            jsEnv.EnterContext(plain);
+            Assert.AreEqual(false, jsEnv.Eval<bool>("Object.isFrozen(Array.prototype)"));
+
+            // 正在使用的context被销毁后回到主context
+            jsEnv.DestroyContext(plain);
+            Assert.AreEqual("object", jsEnv.Eval<string>("typeof puer"));
+
+            jsEnv.DestroyContext(frozen);
+            jsEnv.Dispose();
+        }
+
+        [Test]
+        public void ExecuteModuleInContextTest()
+        {
+#if PUERTS_GENERAL
+            var loader = new TxtLoader();
+#else
+            var loader = new UnitTestLoader();
+#endif
+            loader.AddMockFileContent("multicontext/main.mjs", @"
+                import { value } from './dep.mjs';
+                globalThis.loadedIn = typeof puer;
+                export const result = value + 1;
+            ");
+            loader.AddMockFileContent("multicontext/dep.mjs", @"
+                export const value = 41;
+            ");
+            var jsEnv = new JsEnv(loader);
+            if (jsEnv.Backend is BackendQuickJS)
+            {
+                jsEnv.Dispose();
+                return;
+            }
+            int contextId = jsEnv.CreateContext();
+
+            // 模块在新context里执行，resolve和读取仍然走主context的loader
+            jsEnv.EnterContext(contextId);
+            Assert.AreEqual(42, jsEnv.ExecuteModule<int>("multicontext/main.mjs", "result"));
+            Assert.AreEqual("undefined", jsEnv.Eval<string>("loadedIn"));
+            try
+            {
+                jsEnv.ExecuteModule("multicontext/missing.mjs");
+                Assert.Fail("unexpected to reach here");
+            }
+            catch (AssertionException)
+            {
+                throw;
+            }
+            catch (System.Exception e)
+            {
+                StringAssert.Contains("missing.mjs", e.Message);
+            }
+
+            // 模块缓存按context区分，回到主context会重新执行一次
+            jsEnv.EnterContext(0);
+            Assert.AreEqual("undefined", jsEnv.Eval<string>("typeof loadedIn"));
+            Assert.AreEqual(42, jsEnv.ExecuteModule<int>("multicontext/main.mjs", "result"));
+            Assert.AreEqual("object", jsEnv.Eval<string>("loadedIn"));
+
+            jsEnv.DestroyContext(contextId);
+            jsEnv.Dispose();
+        }
+#endif
+    }
+}
@@ -20,5 +20,25 @@ namespace Puerts.UnitTest
 #endif
             }
         }
+
+        [Test]
+        public void UvPumpTimerTest()
+        {
+            var env = UnitTestEnv.GetEnv();
+            var backend = env.Backend as BackendNodeJS;
+            if (backend == null) return;
+
+            env.Eval("globalThis.__uvPumpTestFired = false; setTimeout(() => { globalThis.__uvPumpTestFired = true; }, 20);");
+            int timeout = backend.GetUvNextTimeout();
+            Assert.True(timeout >= 0 && timeout <= 20);
+            for (int i = 0; i < 100 && !env.Eval<bool>("globalThis.__uvPumpTestFired"); i++)
+            {
+                if (backend.WaitUvEvents(50))
+                {
+                    env.Tick();
+                }
+            }
+            Assert.True(env.Eval<bool>("globalThis.__uvPumpTestFired"));
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+using System.IO;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class ProfilerTest
+    {
+        [Test]
+        public void CpuProfileTest()
+        {
+            var env = UnitTestEnv.GetEnv();
+            var backend = env.Backend as BackendV8;
+            if (backend == null) return;
+
+            string path = Path.Combine(Path.GetTempPath(), "puerts_test.cpuprofile");
+            Assert.True(backend.StartCpuProfile(100));
+            Assert.False(backend.StartCpuProfile(100));
+            env.Eval("(function() { let s = 0; for (let i = 0; i < 100000; i++) s += i; return s; })()");
+            Assert.True(backend.StopCpuProfile(path));
+            Assert.False(backend.StopCpuProfile(path));
+
+            string content = File.ReadAllText(path);
+            File.Delete(path);
+            Assert.True(content.StartsWith("{\"nodes\":["));
+            Assert.True(content.Contains("\"timeDeltas\":["));
+        }
+
+        [Test]
+        public void HeapSnapshotTest()
+        {
+            var env = UnitTestEnv.GetEnv();
+            var backend = env.Backend as BackendV8;
+            if (backend == null) return;
+
+            string path = Path.Combine(Path.GetTempPath(), "puerts_test.heapsnapshot");
+            Assert.True(backend.TakeHeapSnapshot(path));
+
+            string content = File.ReadAllText(path);
+            File.Delete(path);
+            Assert.True(content.StartsWith("{\"snapshot\":"));
+        }
+
+        [Test]
+        public void SamplingHeapProfilerTest()
+        {
+            var env = UnitTestEnv.GetEnv();
+            var backend = env.Backend as BackendV8;
+            if (backend == null) return;
+
+            string path = Path.Combine(Path.GetTempPath(), "puerts_test.heapprofile");
+            Assert.True(backend.StartSamplingHeapProfiler(1024, 16));
+            env.Eval("globalThis.__profilerTestArr = []; for (let i = 0; i < 10000; i++) globalThis.__profilerTestArr.push({ i });");
+            Assert.True(backend.StopSamplingHeapProfiler(path));
+            env.Eval("globalThis.__profilerTestArr = undefined;");
+
+            string content = File.ReadAllText(path);
+            File.Delete(path);
+            Assert.True(content.StartsWith("{\"head\":"));
+            Assert.True(content.Contains("\"samples\":["));
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [TestFixture]
+    public class SignatureLookupTest
+    {
+        [Test]
+        public void PerfectHashMatchesBinarySearchTest()
+        {
+#if EXPERIMENTAL_IL2CPP_PUERTS && ENABLE_IL2CPP
+            // every generated bridge/wrapper/field wrapper signature (and a missing variant of each) must resolve the same way as the sorted table
+            Assert.AreEqual(0, PuertsIl2cpp.NativeAPI.CheckSignatureLookup());
+#endif
+        }
+
+#if PUERTS_GENERAL || UNITY_EDITOR
+        [Test]
+        public void PerfectHashGeneratorTest()
+        {
+            // the generator itself (puerts/templates/perfecthash.mjs) runs on every backend: tables must be minimal and
+            // exact, and duplicated signatures must fail with the colliding keys instead of searching seeds forever
+            var env = UnitTestEnv.GetEnv();
+            env.ExecuteModule("CSharpModuleTest/perfect_hash_test.mjs");
+        }
+#endif
+    }
+}
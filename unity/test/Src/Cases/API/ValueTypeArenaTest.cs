@@ -0,0 +1,81 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+using NUnit.Framework;
+
+namespace Puerts.UnitTest
+{
+    [UnityEngine.Scripting.Preserve]
+    public struct ArenaBlittableStruct
+    {
+        [UnityEngine.Scripting.Preserve]
+        public int A;
+        [UnityEngine.Scripting.Preserve]
+        public double B;
+    }
+
+    [UnityEngine.Scripting.Preserve]
+    public struct ArenaManagedStruct
+    {
+        [UnityEngine.Scripting.Preserve]
+        public int A;
+        [UnityEngine.Scripting.Preserve]
+        public string S;
+    }
+
+    [UnityEngine.Scripting.Preserve]
+    public class ValueTypeArenaHelper
+    {
+        [UnityEngine.Scripting.Preserve]
+        public static ArenaBlittableStruct MakeBlittable(int i)
+        {
+            return new ArenaBlittableStruct { A = i, B = i * 0.5 };
+        }
+
+        [UnityEngine.Scripting.Preserve]
+        public static ArenaManagedStruct MakeManaged(int i)
+        {
+            return new ArenaManagedStruct { A = i, S = "s" + i };
+        }
+    }
+
+    [TestFixture]
+    public class ValueTypeArenaTest
+    {
+        [Test]
+        public void ReuseAfterCollectTest()
+        {
+#if PUERTS_GENERAL
+            var jsEnv = new JsEnv(new TxtLoader());
+#else
+            var jsEnv = new JsEnv(new UnitTestLoader());
+#endif
+            // 大量临时的struct返回值被回收后槽位会被重用，留下来的那些值不能被覆盖
+            string result = jsEnv.Eval<string>(@"
+                (function() {
+                    const H = CS.Puerts.UnitTest.ValueTypeArenaHelper;
+                    const kept = [];
+                    for (let i = 0; i < 200000; i++) {
+                        const v = H.MakeBlittable(i);
+                        if (i % 10000 == 0) kept.push(v);
+                    }
+                    const managed = [];
+                    for (let i = 0; i < 1000; i++) {
+                        const v = H.MakeManaged(i);
+                        if (i % 100 == 0) managed.push(v);
+                    }
+                    let ok = kept.every((v, n) => v.A == n * 10000 && v.B == n * 5000);
+                    ok = ok && managed.every((v, n) => v.A == n * 100 && v.S == 's' + n * 100);
+                    return ok + ':' + kept.length + ':' + managed.length;
+                })();
+            ");
+            Assert.AreEqual("true:20:10", result);
+
+            jsEnv.Dispose();
+        }
+    }
+}
@@ -0,0 +1,37 @@
+import { perfectHash, perfectHashLookup } from "puerts/templates/perfecthash.mjs"
+
+let Assert_AreEqual = CS.NUnit.Framework.Assert.AreEqual
+let Assert_IsTrue = CS.NUnit.Framework.Assert.IsTrue
+
+const primitives = ['v', 'b', 'i1', 'u1', 'i2', 'u2', 'i4', 'u4', 'i8', 'u8', 'r4', 'r8', 's', 'o', 'Pv'];
+
+function makeSignatures(count) {
+    const signatures = new Set();
+    for (let i = 0; signatures.size < count; i++) {
+        let signature = primitives[i % primitives.length];
+        for (let j = Math.floor(i / primitives.length); j > 0; j = Math.floor(j / primitives.length)) {
+            signature += primitives[j % primitives.length];
+        }
+        signatures.add(signature);
+    }
+    return [...signatures].sort();
+}
+
+for (const count of [0, 1, 2, 3, 5, 17, 256, 3000]) {
+    const signatures = makeSignatures(count);
+    const table = perfectHash(signatures);
+    signatures.forEach((signature, i) => {
+        Assert_AreEqual(i, perfectHashLookup(table, signatures, signature));
+        Assert_AreEqual(-1, perfectHashLookup(table, signatures, signature + 'x'));
+    });
+    Assert_AreEqual(count, new Set(table.slots.filter(slot => slot != -1)).size);
+}
+
+// 重复的签名不能死循环，要报出冲突的签名
+let error = '';
+try {
+    perfectHash(['i4', 'ti4i4', 'ti4i4', 'v', 'vs']);
+} catch (e) {
+    error = e.message;
+}
+Assert_IsTrue(error.indexOf('ti4i4') != -1, error);
@@ -0,0 +1,58 @@
+/*
+* Tencent is pleased to support the open source community by making Puerts available.
+* Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+* Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may be subject to their corresponding license terms.
+* This file is subject to the terms and conditions defined in file 'LICENSE', which is part of this source code package.
+*/
+
+// 对比ffi_bind和ffi_call两条调用路径，用法：require('ffi/benchmark').run(targets, 1000000)
+// targets由调用方（比如项目里的测试模块）提供两个典型签名的native函数指针，插件本身不导出测试函数：
+//   addInt: int(int,int)，返回两数之和
+//   offsetPointer: void*(void*,size_t)，返回指针加偏移
+const binding = require('binding').binding;
+const typeInfo = require('type').typeInfo;
+
+function measure(name, iterations, fn) {
+    fn(); // warm up
+    const start = Date.now();
+    fn();
+    const elapsed = Date.now() - start;
+    console.log(`${name}: ${iterations} calls in ${elapsed}ms, ${(elapsed * 1e6 / iterations).toFixed(1)}ns/call`);
+    return elapsed;
+}
+
+function run(targets, iterations) {
+    if (!targets || !targets.addInt || !targets.offsetPointer) {
+        throw new Error('native function pointers of addInt and offsetPointer expected');
+    }
+    iterations = iterations || 1000000;
+
+    // 传typeInfo对象而不是类型名就不会走ffi_bind，得到的就是原来基于ffi_call的实现
+    const addFast = binding(targets.addInt, 'int32', ['int32', 'int32']);
+    const addSlow = binding(targets.addInt, typeInfo('int32'), [typeInfo('int32'), typeInfo('int32')]);
+    const offsetFast = binding(targets.offsetPointer, 'pointer', ['pointer', 'size_t']);
+    const offsetSlow = binding(targets.offsetPointer, typeInfo('pointer'), [typeInfo('pointer'), typeInfo('size_t')]);
+
+    if (addFast(1, 2) !== 3 || addSlow(1, 2) !== 3) {
+        throw new Error('int(int,int) result mismatch');
+    }
+
+    const buff = new Uint8Array(16);
+    let sum = 0;
+    const results = {};
+    results['int(int,int) ffi_call'] = measure('int(int,int) ffi_call', iterations, () => {
+        for (let i = 0; i < iterations; i++) sum += addSlow(i, 1);
+    });
+    results['int(int,int) ffi_bind'] = measure('int(int,int) ffi_bind', iterations, () => {
+        for (let i = 0; i < iterations; i++) sum += addFast(i, 1);
+    });
+    results['void*(void*,size_t) ffi_call'] = measure('void*(void*,size_t) ffi_call', iterations, () => {
+        for (let i = 0; i < iterations; i++) offsetSlow(buff, 8);
+    });
+    results['void*(void*,size_t) ffi_bind'] = measure('void*(void*,size_t) ffi_bind', iterations, () => {
+        for (let i = 0; i < iterations; i++) offsetFast(buff, 8);
+    });
+    return results;
+}
+
+exports.run = run;
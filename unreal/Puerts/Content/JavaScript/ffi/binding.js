@@ -41,6 +41,36 @@ function allocCif(returnType, parameterTypes, abi, fixArgNum) {
     return cifPtr;
 }
 
+function bindName(t) {
+    if (t === 'cstring') return 'pointer';
+    if (t === 'size_t') return pointer.size == 4 ? 'uint32' : 'uint64';
+    return t;
+}
+
+// 参数和返回值都是基础类型（包括cstring、size_t）时走native的ffi_bind，cif和参数槽都在native侧准备好
+function fastBinding(func, abi, returnType, parameterTypes, fixArgNum, argsProcessers, resultProcesser) {
+    if (typeof returnType !== 'string' || !parameterTypes.every(t => typeof t === 'string')) {
+        return undefined;
+    }
+    const bound = ffi_bindings.ffi_bind(abi, func, bindName(returnType), parameterTypes.map(bindName), fixArgNum);
+    if (!bound) {
+        return undefined;
+    }
+    if (resultProcesser === id && argsProcessers.every(p => p === id)) {
+        return bound;
+    }
+    const expectArgNum = parameterTypes.length;
+    return function wrap(...args) {
+        if (args.length != expectArgNum) {
+            throw new Error(`expect ${expectArgNum} argument but got ${args.length}`);
+        }
+        for (var i = 0; i < expectArgNum; i++) {
+            args[i] = argsProcessers[i](args[i]);
+        }
+        return resultProcesser(bound(...args));
+    }
+}
+
 function binding(func, abi, returnType, parameterTypes, fixArgNum) {
     if (typeof abi !== 'number') {
         fixArgNum = parameterTypes;
@@ -51,6 +81,10 @@ function binding(func, abi, returnType, parameterTypes, fixArgNum) {
 
     const argsProcessers = parameterTypes.map(t => t === 'cstring' ? stringToCString : id);
     const resultProcesser = returnType === 'cstring' ? readUTF8String : id;
+    const fast = fastBinding(func, abi, returnType, parameterTypes, fixArgNum, argsProcessers, resultProcesser);
+    if (fast) {
+        return fast;
+    }
     returnType = typeInfo(returnType);
     parameterTypes = parameterTypes.map(t => typeInfo(t));
     const cifPtr = allocCif(returnType, parameterTypes, abi, fixArgNum);
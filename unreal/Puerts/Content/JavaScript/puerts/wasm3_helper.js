@@ -21,8 +21,9 @@ var global = global || (function () { return this; }());
             this._Seq = Wasm_NewMemory(initial, maximum)
         }
         grow(n){
-            Wasm_MemoryGrowth(this._Seq, n)
+            return Wasm_MemoryGrowth(this._Seq, n)
         }
+        // 直接指向wasm线性内存，不拷贝；grow之后旧的buffer会被detach（byteLength为0），需要重新获取
         get buffer(){
             return Wasm_MemoryBuffer(this._Seq)
         }
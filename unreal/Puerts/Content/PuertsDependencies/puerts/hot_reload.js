@@ -10,6 +10,69 @@ var global = global || (function () { return this; }());
     let setInspectorCallback = global.__tgjsSetInspectorCallback 
     global.__tgjsSetInspectorCallback = undefined;
     
+    let invalidateModules = global.__tgjsInvalidateModules;
+    global.__tgjsInvalidateModules = undefined;
+    
+    // es模块：按依赖图失效并重新执行，不需要inspector。key是FetchESModuleTree用的路径
+    // 当前这份模块实例的import.meta.hot
+    const hotRecords = Object.create(null);
+    // import.meta.hot.data，跨越重新加载保留
+    const hotData = Object.create(null);
+    
+    function createHotContext(path) {
+        const data = hotData[path] || (hotData[path] = {});
+        const record = { acceptCallbacks: [], disposeCallbacks: [], selfAccepted: false };
+        hotRecords[path] = record;
+        return {
+            data: data,
+            // 接受自己的更新：重新执行的范围到此为止，importer不受影响，回调参数是新的module namespace
+            accept(callback) {
+                record.selfAccepted = true;
+                if (typeof callback === 'function') {
+                    record.acceptCallbacks.push(callback);
+                }
+            },
+            // 本模块失效时调用，用来清理定时器、事件监听等副作用，可以往data里放东西留给新的实例
+            dispose(callback) {
+                if (typeof callback !== 'function') {
+                    throw new Error('dispose expect a function');
+                }
+                record.disposeCallbacks.push(callback);
+            },
+        };
+    }
+    
+    // 返回失效并重新执行过的模块路径，changed里没有加载过的es模块时返回空数组
+    function reloadModules(changed) {
+        const accepted = Object.keys(hotRecords).filter(path => hotRecords[path].selfAccepted);
+        const result = invalidateModules(changed, accepted);
+        // quickjs后端没有es模块缓存可以失效
+        if (!result) return [];
+        
+        const previous = Object.create(null);
+        for (const path of result.invalidated) {
+            const record = hotRecords[path];
+            if (record) {
+                delete hotRecords[path];
+                previous[path] = record;
+                for (const callback of record.disposeCallbacks) {
+                    callback(hotData[path]);
+                }
+            }
+        }
+        // 失效但不是边界的模块会在边界重新执行时作为依赖被重新加载
+        for (const path of result.boundaries) {
+            const ns = puerts.__executeESModule(path);
+            const record = previous[path];
+            if (record) {
+                for (const callback of record.acceptCallbacks) {
+                    callback(ns);
+                }
+            }
+        }
+        return result.invalidated;
+    }
+    
     const parsedScript = new Map();
     
     let contextInfo
@@ -48,12 +111,12 @@ var global = global || (function () { return this; }());
         });
     }
     
-    let inited = false;
+    let debuggerAvailable;
     
     async function enableDebugger() {
-        if (inited) return;
-        inited = true;
-        setInspectorCallback(messageHandler);
+        if (debuggerAvailable !== undefined) return debuggerAvailable;
+        debuggerAvailable = !!setInspectorCallback(messageHandler);
+        if (!debuggerAvailable) return false;
         await sendCommand("Runtime.enable", {});
         await sendCommand("Debugger.enable", {"maxScriptsCacheSize":10000000});
         //await sendCommand("Debugger.setPauseOnExceptions",{"state":"none"});
@@ -62,10 +125,20 @@ var global = global || (function () { return this; }());
         //await sendCommand("Runtime.getIsolateId",{});
         //await sendCommand("Debugger.setBlackboxPatterns",{"patterns":[]});
         //await sendCommand("Runtime.runIfWaitingForDebugger");
+        return true;
     }
     
     async function reload(moduleName, url, source) {
-        await enableDebugger();
+        if (invalidateModules) {
+            if (reloadModules([url]).length > 0 || url.endsWith(".mjs")) {
+                return;
+            }
+        }
+        // commonjs模块通过Debugger.setScriptSource原地替换函数
+        if (!await enableDebugger()) {
+            console.warn(`reload ${url} need the inspector, use an es module to reload without it`);
+            return;
+        }
         let scriptId
         if (parsedScript.has(url)) {
             scriptId = parsedScript.get(url)
@@ -99,4 +172,8 @@ var global = global || (function () { return this; }());
     };
     
     puerts.__reload = reload;
+    
+    puerts.__createHotContext = createHotContext;
+    
+    puerts.hot = { reloadModules };
 }(global));
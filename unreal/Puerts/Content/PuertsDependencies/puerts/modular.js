@@ -211,4 +211,9 @@ var global = global || (function () { return this; }());
     puerts.forceReload = forceReload;
     
     puerts.getModuleByUrl = getModuleByUrl;
+    
+    // hot_reload.js重新执行失效的es模块用，返回module namespace
+    puerts.__executeESModule = function(fullPath) {
+        return evalScript("", fullPath, true, fullPath);
+    };
 }(global));
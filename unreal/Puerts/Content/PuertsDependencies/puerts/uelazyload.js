@@ -86,8 +86,21 @@ var global = global || (function () { return this; }());
     puerts.registerBuildinModule('cpp', CPP);
     global.CPP = CPP;
     
+    // 原生的引用单元，C++读写时不走属性查找；r[0]通过原型上的访问器继续可用
+    let RefCell = global.__tgjsRefCell;
+    global.__tgjsRefCell = undefined;
+    if (RefCell) {
+        Object.defineProperty(RefCell.prototype, 0, {
+            get: function() { return RefCell.get(this); },
+            set: function(val) { RefCell.set(this, val); }
+        });
+        // 和原来$ref返回的单元素数组一样可以取length、展开和解构
+        Object.defineProperty(RefCell.prototype, 'length', { get: function() { return 1; } });
+        RefCell.prototype[Symbol.iterator] = function* () { yield RefCell.get(this); };
+    }
+
     function ref(x) {
-        return [x];
+        return RefCell ? new RefCell(x) : [x];
     }
 
     function unref(r) {
@@ -297,6 +310,32 @@ var global = global || (function () { return this; }());
     cache.NewSet = NewSet;
     cache.NewMap = NewMap;
     
+    // 容器的迭代器每批从native取ContainerBatchSize个元素，避免逐个元素调用Get
+    const ContainerBatchSize = 64;
+    const IterateValues = 0, IterateKeys = 1, IterateEntries = 2;
+    
+    function* iterateContainer(container, kind) {
+        const batch = [];
+        let cursor = 0;
+        while (cursor >= 0) {
+            cursor = container.NextBatch(batch, cursor, ContainerBatchSize, kind);
+            for (let i = 0; i < batch.length; i++) {
+                yield batch[i];
+            }
+        }
+    }
+    
+    function addIterators(proto, isMap) {
+        proto.values = function() { return iterateContainer(this, IterateValues); };
+        proto.keys = function() { return iterateContainer(this, IterateKeys); };
+        proto.entries = function() { return iterateContainer(this, IterateEntries); };
+        proto[Symbol.iterator] = isMap ? proto.entries : proto.values;
+    }
+    
+    addIterators(Object.getPrototypeOf(NewArray(cache.BuiltinInt)), false);
+    addIterators(Object.getPrototypeOf(NewSet(cache.BuiltinInt)), false);
+    addIterators(Object.getPrototypeOf(NewMap(cache.BuiltinInt, cache.BuiltinInt)), true);
+    
     const FunctionFlags = {
         FUNC_None                : 0x00000000,
 
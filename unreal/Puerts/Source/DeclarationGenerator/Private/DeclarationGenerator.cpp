@@ -42,6 +42,8 @@
 #include "PuertsModule.h"
 #include "FileSystemOperation.h"
 #include "PathEscape.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
 
 #define STRINGIZE(x) #x
 #define STRINGIZE_VALUE_OF(x) STRINGIZE(x)
@@ -49,6 +51,8 @@
 #define TYPE_DECL_START "// __TYPE_DECL_START: "
 #define TYPE_DECL_END "// __TYPE_DECL_END"
 #define TYPE_ASSOCIATION "ASSOCIATION"
+// 生成逻辑有改动导致同样的反射信息产出不同声明时，要改这个版本号让旧缓存失效
+#define TYPE_DECL_CACHE_VERSION "// __TYPE_DECL_CACHE_VERSION: 2"
 
 //全局的跳过生成列表
 static TArray<FString> IgnoreGenDTSStrLists =
@@ -213,14 +217,39 @@ TArray<UObject*> GetSortedClasses(bool GenStruct = false, bool GenEnum = false)
         }
     }
 
-    SortedClasses.Sort([&](const UObject& ClassA, const UObject& ClassB) -> bool { return ClassA.GetName() < ClassB.GetName(); });
+    // 同名类型用路径决胜，保证每次生成时重名类型的取舍一致
+    SortedClasses.Sort(
+        [&](const UObject& ClassA, const UObject& ClassB) -> bool
+        {
+            const int32 Result = ClassA.GetName().Compare(ClassB.GetName());
+            return Result != 0 ? Result < 0 : ClassA.GetPathName().Compare(ClassB.GetPathName(), ESearchCase::CaseSensitive) < 0;
+        });
 
     return SortedClasses;
 }
 
+// 内容没变就不写，避免文件时间戳变化让tsc的增量编译失效
+static bool SaveDeclarationFileIfChanged(const FString& Content, const FString& FilePath)
+{
+    FTCHARToUTF8 Utf8(*Content);
+    TArray<uint8> Existing;
+    if (FFileHelper::LoadFileToArray(Existing, *FilePath, FILEREAD_Silent) && Existing.Num() == Utf8.Length() &&
+        FMemory::Memcmp(Existing.GetData(), Utf8.Get(), Utf8.Length()) == 0)
+    {
+        return false;
+    }
+
+#ifdef PUERTS_WITH_SOURCE_CONTROL
+    PuertsSourceControlUtils::MakeSourceControlFileWritable(FilePath);
+#endif
+
+    return FFileHelper::SaveStringToFile(Content, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
 void FTypeScriptDeclarationGenerator::Begin(FString ModuleName)
 {
     AllFuncionOutputs.clear();
+    TypeDecls.Empty();
     InitExtensionMethodsMap();
     Output = {"", ""};
     Output << "/// <reference path=\"puerts.d.ts\" />\n";
@@ -380,6 +409,8 @@ void FTypeScriptDeclarationGenerator::GenTypeScriptDeclaration(bool InGenStruct,
     Begin();
     BeginGenAssetData = false;
     TArray<UObject*> SortedClasses(GetSortedClasses(InGenStruct, InGenEnum));
+    NewTypeDeclCache.Empty();
+    ComputeTypeFingerprints(SortedClasses);
     for (int i = 0; i < SortedClasses.Num(); ++i)
     {
         UObject* Class = SortedClasses[i];
@@ -446,11 +477,8 @@ void FTypeScriptDeclarationGenerator::GenTypeScriptDeclaration(bool InGenStruct,
 
     const FString UEDeclarationFilePath = FPaths::ProjectDir() / TEXT("Typing/ue/ue.d.ts");
 
-#ifdef PUERTS_WITH_SOURCE_CONTROL
-    PuertsSourceControlUtils::MakeSourceControlFileWritable(UEDeclarationFilePath);
-#endif
-
-    FFileHelper::SaveStringToFile(ToString(), *UEDeclarationFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    SaveDeclarationFileIfChanged(ToString(), UEDeclarationFilePath);
+    SaveDeclarationFileIfChanged(SerializeTypeDeclCache(), UEDeclarationFilePath + TEXT(".cache"));
 
     Begin();
     for (auto& KV : BlueprintTypeDeclInfoCache)
@@ -469,11 +497,7 @@ void FTypeScriptDeclarationGenerator::GenTypeScriptDeclaration(bool InGenStruct,
 
     const FString BPDeclarationFilePath = FPaths::ProjectDir() / TEXT("Typing/ue/ue_bp.d.ts");
 
-#ifdef PUERTS_WITH_SOURCE_CONTROL
-    PuertsSourceControlUtils::MakeSourceControlFileWritable(BPDeclarationFilePath);
-#endif
-
-    FFileHelper::SaveStringToFile(ToString(), *BPDeclarationFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    SaveDeclarationFileIfChanged(ToString(), BPDeclarationFilePath);
 }
 
 static UPackage* GetPackage(UObject* Obj)
@@ -561,9 +585,12 @@ void FTypeScriptDeclarationGenerator::WriteOutput(UObject* Obj, const FStringBuf
     }
     else if (Obj->IsNative())
     {
-        NamespaceBegin(Obj, Output);
-        Output << Buff;
-        NamespaceEnd(Obj, Output);
+        FStringBuffer Temp;
+        Temp.Prefix = Output.Prefix;
+        NamespaceBegin(Obj, Temp);
+        Temp << Buff;
+        NamespaceEnd(Obj, Temp);
+        TypeDecls.Add(Obj->GetPathName(), Temp.Buffer);
     }
 }
 
@@ -690,6 +717,10 @@ void FTypeScriptDeclarationGenerator::LoadAllWidgetBlueprint(FName InSearchPath,
 
 void FTypeScriptDeclarationGenerator::Gen(UObject* ToGen)
 {
+    if (GenStack.Num() > 0)
+    {
+        TypeDeclDeps.FindOrAdd(GenStack.Top()).AddUnique(ToGen);
+    }
     if (ToGen->GetName().Equals(TEXT("ArrayBuffer")) || ToGen->GetName().Equals(TEXT("ArrayBufferValue")) ||
         ToGen->GetName().Equals(TEXT("JsObject")))
     {
@@ -723,6 +754,12 @@ void FTypeScriptDeclarationGenerator::Gen(UObject* ToGen)
         }
     }
 
+    if (GenFromTypeDeclCache(ToGen))
+    {
+        return;
+    }
+
+    GenStack.Push(ToGen);
     if (auto Class = Cast<UClass>(ToGen))
     {
         GenClass(Class);
@@ -735,6 +772,9 @@ void FTypeScriptDeclarationGenerator::Gen(UObject* ToGen)
     {
         GenEnum(Enum);
     }
+    GenStack.Pop();
+
+    AddToTypeDeclCache(ToGen);
 }
 
 // #lizard forgives
@@ -1024,6 +1064,20 @@ bool FTypeScriptDeclarationGenerator::GenFunction(
             }
         }
     }
+    // 返回struct的函数可以多传一个同类型对象接收返回值，见FFunctionTranslator::ReturnInto
+    auto ReturnStructProperty = CastFieldMacro<StructPropertyMacro>(ReturnValue);
+    if (WithName && ReturnStructProperty && ReturnStructProperty->Struct->GetName() != TEXT("ArrayBuffer") &&
+        ReturnStructProperty->Struct->GetName() != TEXT("ArrayBufferValue") &&
+        ReturnStructProperty->Struct->GetName() != TEXT("JsObject"))
+    {
+        FStringBuffer TmpBuf;
+        TmpBuf << "$ReturnInto?: ";
+        if (!GenTypeDecl(TmpBuf, ReturnValue, RefTypes))
+        {
+            return false;
+        }
+        ParamDecls.Add(TmpBuf.Buffer);
+    }
     OwnerBuffer << FString::Join(ParamDecls, TEXT(", "));
     OwnerBuffer << ")" << (WithName ? " : " : " => ");
     if (!GenTypeDecl(OwnerBuffer, ReturnValue, RefTypes))
@@ -1054,6 +1108,342 @@ static bool GenTemplateBindingFunction(FStringBuffer& OwnerBuffer, puerts::Named
     return true;
 }
 
+static void AppendPropertyFingerprint(FString& Out, PropertyMacro* Property)
+{
+    FString ExtendedType;
+    Out += Property->GetName();
+    Out += TEXT(":");
+    Out += Property->GetCPPType(&ExtendedType, 0);
+    Out += ExtendedType;
+    Out += FString::Printf(TEXT(":%llx:%d;"), (unsigned long long) Property->PropertyFlags, Property->ArrayDim);
+
+    // 委托属性在声明里展开成签名，签名变了声明也跟着变
+    UFunction* SignatureFunction = nullptr;
+    if (auto DelegateProperty = CastFieldMacro<DelegatePropertyMacro>(Property))
+    {
+        SignatureFunction = DelegateProperty->SignatureFunction;
+    }
+    else if (auto MulticastDelegateProperty = CastFieldMacro<MulticastDelegatePropertyMacro>(Property))
+    {
+        SignatureFunction = MulticastDelegateProperty->SignatureFunction;
+    }
+    if (SignatureFunction)
+    {
+        Out += TEXT("(");
+        for (TFieldIterator<PropertyMacro> ParamIt(SignatureFunction); ParamIt; ++ParamIt)
+        {
+            AppendPropertyFingerprint(Out, *ParamIt);
+        }
+        Out += TEXT(")");
+    }
+}
+
+static void AppendFunctionFingerprint(FString& Out, UFunction* Function)
+{
+    Out += Function->GetPathName();
+    Out += FString::Printf(TEXT(":%x("), (uint32) Function->FunctionFlags);
+    for (TFieldIterator<PropertyMacro> ParamIt(Function); ParamIt; ++ParamIt)
+    {
+        AppendPropertyFingerprint(Out, *ParamIt);
+    }
+    Out += TEXT(")");
+
+    // 声明里用到的元数据只有参数默认值和ToolTip
+    if (TMap<FName, FString>* MetaMap = UMetaData::GetMapForObject(Function))
+    {
+        TArray<FString> Entries;
+        for (auto& KV : *MetaMap)
+        {
+            const FString Key = KV.Key.ToString();
+            if (Key == TEXT("ToolTip") || Key.StartsWith(TEXT("CPP_Default_")))
+            {
+                Entries.Add(Key + TEXT("=") + KV.Value);
+            }
+        }
+        Entries.Sort([](const FString& A, const FString& B) { return A.Compare(B, ESearchCase::CaseSensitive) < 0; });
+        Out += FString::Join(Entries, TEXT(";"));
+    }
+    Out += TEXT("\n");
+}
+
+// 只读反射信息，会在ParallelFor的worker里调用
+static uint64 ComputeOwnFingerprint(UObject* Type, const std::map<UStruct*, std::vector<UFunction*>>& ExtensionMethodsMap)
+{
+    FString Out = Type->GetClass()->GetName() + TEXT(" ") + Type->GetPathName() + TEXT("\n");
+
+    if (auto Struct = Cast<UStruct>(Type))
+    {
+        if (auto Class = Cast<UClass>(Struct))
+        {
+            Out += Class->ImplementsInterface(UTypeScriptObject::StaticClass()) ? TEXT("TypeScriptObject\n") : TEXT("\n");
+        }
+        if (auto Super = Struct->GetSuperStruct())
+        {
+            Out += Super->GetPathName() + TEXT("\n");
+        }
+        for (TFieldIterator<PropertyMacro> PropertyIt(Struct, EFieldIteratorFlags::ExcludeSuper); PropertyIt; ++PropertyIt)
+        {
+            AppendPropertyFingerprint(Out, *PropertyIt);
+        }
+        Out += TEXT("\n");
+        for (TFieldIterator<UFunction> FunctionIt(Struct, EFieldIteratorFlags::ExcludeSuper); FunctionIt; ++FunctionIt)
+        {
+            AppendFunctionFingerprint(Out, *FunctionIt);
+        }
+
+        auto ExtensionMethodsIter = ExtensionMethodsMap.find(Struct);
+        if (ExtensionMethodsIter != ExtensionMethodsMap.end())
+        {
+            for (UFunction* Function : ExtensionMethodsIter->second)
+            {
+                AppendFunctionFingerprint(Out, Function);
+            }
+        }
+
+        auto ClassDefinition = puerts::FindClassByType(Struct);
+        if (ClassDefinition)
+        {
+            FStringBuffer Tmp;
+            for (auto FunctionInfo = ClassDefinition->FunctionInfos; FunctionInfo && FunctionInfo->Name && FunctionInfo->Type;
+                 ++FunctionInfo)
+            {
+                GenTemplateBindingFunction(Tmp, FunctionInfo, true);
+                Tmp << "\n";
+            }
+            for (auto MethodInfo = ClassDefinition->MethodInfos; MethodInfo && MethodInfo->Name && MethodInfo->Type; ++MethodInfo)
+            {
+                GenTemplateBindingFunction(Tmp, MethodInfo, false);
+                Tmp << "\n";
+            }
+            for (auto PropertyInfo = ClassDefinition->PropertyInfos; PropertyInfo && PropertyInfo->Name && PropertyInfo->Type;
+                 ++PropertyInfo)
+            {
+                Tmp << PropertyInfo->Name << ": " << PropertyInfo->Type->Name() << "\n";
+            }
+            for (auto VariableInfo = ClassDefinition->VariableInfos; VariableInfo && VariableInfo->Name && VariableInfo->Type;
+                 ++VariableInfo)
+            {
+                int Pos = VariableInfo - ClassDefinition->VariableInfos;
+                Tmp << (ClassDefinition->Variables[Pos].Setter ? "" : "readonly ") << VariableInfo->Name << ": "
+                    << VariableInfo->Type->Name() << "\n";
+            }
+            Out += Tmp.Buffer;
+        }
+    }
+    else if (auto Enum = Cast<UEnum>(Type))
+    {
+        Out += FString::Printf(TEXT("%d\n"), (int32) Enum->GetCppForm());
+        for (int i = 0; i < Enum->NumEnums(); ++i)
+        {
+            Out += FString::Printf(TEXT("%s=%lld\n"), *Enum->GetNameStringByIndex(i), (long long) Enum->GetValueByIndex(i));
+        }
+    }
+
+    const uint64 Hash = CityHash64(reinterpret_cast<const char*>(*Out), Out.Len() * sizeof(TCHAR));
+    return Hash == 0 ? 1 : Hash;
+}
+
+// 父类的指纹要链进子类：父类的重载和同名父类计数都会出现在子类的声明里
+static uint64 ChainFingerprint(UObject* Type, const TMap<UObject*, uint64>& OwnFingerprints, TMap<UObject*, uint64>& Fingerprints)
+{
+    if (const uint64* Done = Fingerprints.Find(Type))
+    {
+        return *Done;
+    }
+    const uint64* Own = OwnFingerprints.Find(Type);
+    uint64 Hash = Own ? *Own : 0;
+    auto Struct = Cast<UStruct>(Type);
+    if (Hash != 0 && Struct && Struct->GetSuperStruct())
+    {
+        const uint64 SuperHash = ChainFingerprint(Struct->GetSuperStruct(), OwnFingerprints, Fingerprints);
+        Hash = SuperHash == 0 ? 0 : CityHash64WithSeed(reinterpret_cast<const char*>(&Hash), sizeof(Hash), SuperHash);
+    }
+    Fingerprints.Add(Type, Hash);
+    return Hash;
+}
+
+void FTypeScriptDeclarationGenerator::ComputeTypeFingerprints(const TArray<UObject*>& Types)
+{
+    TypeFingerprints.Empty();
+    StaleTypes.Empty();
+    TypeDeclDeps.Empty();
+
+    // 碰撞通道名来自项目设置，这两个枚举每次都重新生成
+    TArray<UObject*> NativeTypes;
+    TSet<UPackage*> Packages;
+    for (UObject* Type : Types)
+    {
+        if (Type->IsNative() && Type != StaticEnum<EObjectTypeQuery>() && Type != StaticEnum<ETraceTypeQuery>())
+        {
+            NativeTypes.Add(Type);
+            Packages.Add(GetPackage(Type));
+        }
+    }
+
+    // 包的元数据对象是按需创建的，先在游戏线程上建好，worker里只读
+    for (UPackage* Package : Packages)
+    {
+        Package->GetMetaData();
+    }
+
+    TArray<uint64> OwnHashes;
+    OwnHashes.SetNumZeroed(NativeTypes.Num());
+    ParallelFor(NativeTypes.Num(),
+        [&](int32 Index) { OwnHashes[Index] = ComputeOwnFingerprint(NativeTypes[Index], ExtensionMethodsMap); });
+
+    TMap<UObject*, uint64> OwnFingerprints;
+    for (int i = 0; i < NativeTypes.Num(); ++i)
+    {
+        OwnFingerprints.Add(NativeTypes[i], OwnHashes[i]);
+    }
+    TMap<UObject*, uint64> Fingerprints;
+    for (UObject* Type : NativeTypes)
+    {
+        const uint64 Hash = ChainFingerprint(Type, OwnFingerprints, Fingerprints);
+        if (Hash != 0)
+        {
+            TypeFingerprints.Add(Type, Hash);
+        }
+    }
+
+    // 子类重新生成时要读父类收集的函数重载，所以变了的类型连同它的父类都要重新生成
+    for (auto& KV : TypeFingerprints)
+    {
+        const TypeDeclCacheEntry* Entry = TypeDeclCache.Find(KV.Key->GetPathName());
+        if (Entry && Entry->Hash == KV.Value)
+        {
+            continue;
+        }
+        StaleTypes.Add(KV.Key);
+        if (auto Struct = Cast<UStruct>(KV.Key))
+        {
+            for (UStruct* Super = Struct->GetSuperStruct(); Super; Super = Super->GetSuperStruct())
+            {
+                StaleTypes.Add(Super);
+            }
+        }
+    }
+}
+
+bool FTypeScriptDeclarationGenerator::GenFromTypeDeclCache(UObject* ToGen)
+{
+    const uint64* Fingerprint = TypeFingerprints.Find(ToGen);
+    if (!Fingerprint || StaleTypes.Contains(ToGen))
+    {
+        return false;
+    }
+    const FString Path = ToGen->GetPathName();
+    const TypeDeclCacheEntry* Entry = TypeDeclCache.Find(Path);
+    if (!Entry || Entry->Hash != *Fingerprint)
+    {
+        return false;
+    }
+
+    if (!Entry->Decl.IsEmpty())
+    {
+        TypeDecls.Add(Path, Entry->Decl);
+    }
+    NewTypeDeclCache.Add(Path, *Entry);
+
+    // 生成时顺带生成的类型也要补上，只靠引用带出来的类型(比如在忽略列表里的)否则会丢
+    for (const FString& DepPath : Entry->Deps)
+    {
+        if (UObject* Dep = FindObject<UObject>(nullptr, *DepPath))
+        {
+            Gen(Dep);
+        }
+    }
+    return true;
+}
+
+void FTypeScriptDeclarationGenerator::AddToTypeDeclCache(UObject* ToGen)
+{
+    const uint64* Fingerprint = TypeFingerprints.Find(ToGen);
+    if (!Fingerprint)
+    {
+        return;
+    }
+    const FString Path = ToGen->GetPathName();
+    TypeDeclCacheEntry Entry{*Fingerprint, TArray<FString>(), TypeDecls.FindRef(Path)};
+    if (const TArray<UObject*>* Deps = TypeDeclDeps.Find(ToGen))
+    {
+        for (UObject* Dep : *Deps)
+        {
+            Entry.Deps.Add(Dep->GetPathName());
+        }
+    }
+    NewTypeDeclCache.Add(Path, MoveTemp(Entry));
+}
+
+void FTypeScriptDeclarationGenerator::RestoreTypeDeclCache(bool InGenFull)
+{
+    TypeDeclCache.Empty();
+    if (InGenFull)
+    {
+        return;
+    }
+    FString FileContent;
+    if (FFileHelper::LoadFileToString(FileContent, *(FPaths::ProjectDir() / TEXT("Typing/ue/ue.d.ts.cache"))))
+    {
+        RestoreTypeDeclCache(FileContent);
+    }
+}
+
+void FTypeScriptDeclarationGenerator::RestoreTypeDeclCache(const FString& FileContent)
+{
+    static const FString Version = TEXT(TYPE_DECL_CACHE_VERSION);
+    static const FString Start = TEXT(TYPE_DECL_START);
+    static const FString End = TEXT(TYPE_DECL_END);
+    if (!FileContent.StartsWith(Version, ESearchCase::CaseSensitive))
+    {
+        return;
+    }
+    int Pos = FileContent.Find(*Start, ESearchCase::CaseSensitive);
+    while (Pos >= 0)
+    {
+        int HeaderEnd = FileContent.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Pos + Start.Len());
+        if (HeaderEnd < 0)
+            return;
+        int DeclEnd = FileContent.Find(*End, ESearchCase::CaseSensitive, ESearchDir::FromStart, HeaderEnd + 1);
+        if (DeclEnd < 0)
+            return;
+        TArray<FString> Header;
+        FileContent.Mid(Pos + Start.Len(), HeaderEnd - Pos - Start.Len()).ParseIntoArray(Header, TEXT(" "));
+        if (Header.Num() >= 2)
+        {
+            TypeDeclCacheEntry Entry{FCString::Strtoui64(*Header[1], nullptr, 16), TArray<FString>(),
+                FileContent.Mid(HeaderEnd + 1, DeclEnd - HeaderEnd - 1)};
+            if (Header.Num() > 2)
+            {
+                Header[2].ParseIntoArray(Entry.Deps, TEXT(";"));
+            }
+            TypeDeclCache.Add(Header[0], MoveTemp(Entry));
+        }
+        Pos = FileContent.Find(*Start, ESearchCase::CaseSensitive, ESearchDir::FromStart, DeclEnd + End.Len());
+    }
+}
+
+FString FTypeScriptDeclarationGenerator::SerializeTypeDeclCache() const
+{
+    TArray<FString> Paths;
+    NewTypeDeclCache.GetKeys(Paths);
+    Paths.Sort([](const FString& A, const FString& B) { return A.Compare(B, ESearchCase::CaseSensitive) < 0; });
+
+    FString Result = TEXT(TYPE_DECL_CACHE_VERSION);
+    Result += TEXT("\n");
+    for (const FString& Path : Paths)
+    {
+        const TypeDeclCacheEntry& Entry = NewTypeDeclCache[Path];
+        Result += TEXT(TYPE_DECL_START) + Path + FString::Printf(TEXT(" %016llx"), (unsigned long long) Entry.Hash);
+        if (Entry.Deps.Num() > 0)
+        {
+            Result += TEXT(" ") + FString::Join(Entry.Deps, TEXT(";"));
+        }
+        Result += TEXT("\n") + Entry.Decl + TEXT(TYPE_DECL_END) + TEXT("\n");
+    }
+    return Result;
+}
+
 FTypeScriptDeclarationGenerator::FunctionOutputs& FTypeScriptDeclarationGenerator::GetFunctionOutputs(UStruct* Struct)
 {
     return AllFuncionOutputs[Struct];
@@ -1467,6 +1857,15 @@ void FTypeScriptDeclarationGenerator::GenStruct(UStruct* Struct)
 
 void FTypeScriptDeclarationGenerator::End()
 {
+    TArray<FString> Paths;
+    TypeDecls.GetKeys(Paths);
+    Paths.Sort([](const FString& A, const FString& B) { return A.Compare(B, ESearchCase::CaseSensitive) < 0; });
+    for (const FString& Path : Paths)
+    {
+        Output.Buffer += TypeDecls[Path];
+    }
+    TypeDecls.Empty();
+
     Output.Indent(-4);
     Output << "}\n";
 }
@@ -1629,6 +2028,7 @@ public:
         FTypeScriptDeclarationGenerator TypeScriptDeclarationGenerator;
         TypeScriptDeclarationGenerator.RestoreBlueprintTypeDeclInfos(InGenFull);
         TypeScriptDeclarationGenerator.LoadAllWidgetBlueprint(InSearchPath, InGenFull);
+        TypeScriptDeclarationGenerator.RestoreTypeDeclCache(InGenFull);
         TypeScriptDeclarationGenerator.GenTypeScriptDeclaration(true, true);
     }
 
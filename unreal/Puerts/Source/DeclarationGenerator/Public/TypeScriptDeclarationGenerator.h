@@ -75,6 +75,29 @@ struct DECLARATIONGENERATOR_API FTypeScriptDeclarationGenerator
 
     bool BeginGenAssetData = false;
 
+    // 原生类型的声明按对象路径存放，End时按路径排序合并，输出和Gen的递归顺序无关
+    TMap<FString, FString> TypeDecls;
+
+    struct TypeDeclCacheEntry
+    {
+        uint64 Hash;
+        TArray<FString> Deps;
+        FString Decl;
+    };
+
+    // 上次生成的原生类型声明(Typing/ue/ue.d.ts.cache)，反射指纹没变的类型直接复用
+    TMap<FString, TypeDeclCacheEntry> TypeDeclCache;
+
+    TMap<FString, TypeDeclCacheEntry> NewTypeDeclCache;
+
+    TMap<UObject*, uint64> TypeFingerprints;
+
+    TSet<UObject*> StaleTypes;
+
+    TMap<UObject*, TArray<UObject*>> TypeDeclDeps;
+
+    TArray<UObject*> GenStack;
+
     const FString& GetNamespace(UObject* Obj);
 
     FString GetNameWithNamespace(UObject* Obj);
@@ -91,6 +114,18 @@ struct DECLARATIONGENERATOR_API FTypeScriptDeclarationGenerator
 
     void LoadAllWidgetBlueprint(FName InSearchPath, bool InGenFull);
 
+    void RestoreTypeDeclCache(bool InGenFull);
+
+    void RestoreTypeDeclCache(const FString& FileContent);
+
+    FString SerializeTypeDeclCache() const;
+
+    void ComputeTypeFingerprints(const TArray<UObject*>& Types);
+
+    bool GenFromTypeDeclCache(UObject* ToGen);
+
+    void AddToTypeDeclCache(UObject* ToGen);
+
     void InitExtensionMethodsMap();
 
     virtual void Begin(FString Namespace = TEXT("ue"));
@@ -31,6 +31,17 @@ public class JsEnv : ModuleRules
     private bool ThreadSafe = false;
 
     private bool FTextAsString = true;
+
+    // only take effect with v8 backend (including nodejs), quickjs and the v8 for ue4.24 or below has no fast api.
+    // opt-in until the fast path has been verified on the v8 version shipped with the project (see unity/native_src/test)
+    private bool WithV8FastCall = false;
+
+    // count calls, total time and latency histogram of each UFunction binding, see puerts.getCallStatistics / dumpStatisticsLog
+    private bool WithCallStatistics = false;
+
+    // reuse the v8 string of an unchanged FString/FText property value (and the FText of a repeatedly assigned js string), v8 backend only.
+    // pays off when the same property is read again and again with the same value, e.g. ui bindings
+    private bool WithPropertyStringCache = false;
     
     public static bool WithSourceControl = false;
     
@@ -40,7 +51,6 @@ public class JsEnv : ModuleRules
         PCHUsage = PCHUsageMode.NoPCHs;
         PublicDefinitions.Add("USING_IN_UNREAL_ENGINE");
         PublicDefinitions.Add("ENGINE_MAJOR_VERSION=5");
-        //PublicDefinitions.Add("WITH_V8_FAST_CALL");
         
         PublicDefinitions.Add("TS_BLUEPRINT_PATH=\"/Blueprints/TypeScriptsGen/\"");
         
@@ -53,6 +63,21 @@ public class JsEnv : ModuleRules
             PublicDefinitions.Add("PUERTS_FTEXT_AS_OBJECT");
         }
 
+        if (WithV8FastCall && UseNewV8 && !UseQuickjs)
+        {
+            PublicDefinitions.Add("WITH_V8_FAST_CALL");
+        }
+
+        if (WithCallStatistics)
+        {
+            PublicDefinitions.Add("PUERTS_CALL_STATISTICS");
+        }
+
+        if (WithPropertyStringCache && !UseQuickjs)
+        {
+            PublicDefinitions.Add("PUERTS_PROPERTY_STRING_CACHE");
+        }
+
         PublicDependencyModuleNames.AddRange(new string[]
         {
             "Core", "CoreUObject", "Engine", "ParamDefaultValueMetas", "UMG", "Projects",  
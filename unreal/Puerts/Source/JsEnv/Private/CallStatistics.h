@@ -0,0 +1,264 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+// 按绑定统计调用次数、总耗时以及log2耗时直方图，定义PUERTS_CALL_STATISTICS后生效，未定义时所有统计代码都会被编译掉。
+// per-binding call counters, total time and log2 latency histogram. only compiled in with PUERTS_CALL_STATISTICS.
+// every call costs one relaxed increment, only a random 1/2^PUERTS_CALL_STATISTICS_SAMPLE_SHIFT of the calls read the
+// cycle counter and go into the histogram, the total time is extrapolated from those samples.
+//
+// the unity plugins include this file from here. Puerts_il2cpp.cpp (built by il2cpp) can not reach this directory, it only
+// holds CallStatisticsEntry pointers and times calls through CallStatisticsStart/RecordCallStatistics handed over in
+// UnityExports, so it counts when both the plugin (cmake -DPUERTS_CALL_STATISTICS=ON) and Puerts_il2cpp.cpp
+// (PlayerSettings.SetAdditionalIl2CppArgs("--compiler-flags=-DPUERTS_CALL_STATISTICS")) are built with the macro.
+
+#ifndef PUERTS_CALL_STATISTICS_H
+#define PUERTS_CALL_STATISTICS_H
+
+#ifdef PUERTS_CALL_STATISTICS
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef PUERTS_CALL_STATISTICS_CAPACITY
+#define PUERTS_CALL_STATISTICS_CAPACITY 4096
+#endif
+
+#define PUERTS_CALL_STATISTICS_BUCKETS 32
+
+#define PUERTS_CALL_STATISTICS_NAME_SIZE 96
+
+// 默认计时1/16的调用，定义为0则每次调用都计时
+#ifndef PUERTS_CALL_STATISTICS_SAMPLE_SHIFT
+#define PUERTS_CALL_STATISTICS_SAMPLE_SHIFT 4
+#endif
+
+namespace puerts
+{
+// 内存布局等价于C结构体 { char Name[96]; uint64_t Calls; uint64_t TotalTicks; uint64_t Histogram[32]; }，可以直接当平坦数组读取
+// Calls是全部调用次数；TotalTicks和Histogram只统计被采样计时的调用，Histogram[i]记录耗时在[2^i, 2^(i+1))个tick的采样次数
+// （0 tick计入第0个桶，最后一个桶包含所有更慢的调用），采样次数为各桶之和
+struct CallStatisticsEntry
+{
+    char Name[PUERTS_CALL_STATISTICS_NAME_SIZE];
+    std::atomic<uint64_t> Calls;
+    std::atomic<uint64_t> TotalTicks;
+    std::atomic<uint64_t> Histogram[PUERTS_CALL_STATISTICS_BUCKETS];
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "CallStatisticsEntry must be readable as a plain C struct");
+
+inline uint64_t CallStatisticsTicks()
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    return _ReadStatusReg(0x5F02);    // CNTVCT_EL0
+#elif defined(__aarch64__)
+    uint64_t Ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(Ticks));
+    return Ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline int CallStatisticsBucket(uint64_t Ticks)
+{
+    int Bucket;
+#if defined(_MSC_VER)
+    unsigned long Index;
+#if defined(_M_X64) || defined(_M_ARM64)
+    Bucket = _BitScanReverse64(&Index, Ticks) ? static_cast<int>(Index) : 0;
+#else
+    if (Ticks >> 32)
+    {
+        _BitScanReverse(&Index, static_cast<unsigned long>(Ticks >> 32));
+        Bucket = static_cast<int>(Index) + 32;
+    }
+    else
+    {
+        Bucket = _BitScanReverse(&Index, static_cast<unsigned long>(Ticks)) ? static_cast<int>(Index) : 0;
+    }
+#endif
+#else
+    Bucket = Ticks ? 63 - __builtin_clzll(Ticks) : 0;
+#endif
+    return Bucket < PUERTS_CALL_STATISTICS_BUCKETS ? Bucket : PUERTS_CALL_STATISTICS_BUCKETS - 1;
+}
+
+// 调用开始时调用，返回0表示这次不计时。用线程内的xorshift随机采样而不是每N次取一次，避免和调用模式的周期重合
+inline uint64_t CallStatisticsStart()
+{
+#if PUERTS_CALL_STATISTICS_SAMPLE_SHIFT > 0
+    static thread_local uint32_t State = 0x9E3779B9u;
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    if (State & ((1u << PUERTS_CALL_STATISTICS_SAMPLE_SHIFT) - 1))
+    {
+        return 0;
+    }
+#endif
+    uint64_t Ticks = CallStatisticsTicks();
+    return Ticks ? Ticks : 1;
+}
+
+inline void RecordCallStatistics(CallStatisticsEntry* Entry, uint64_t StartTicks)
+{
+    Entry->Calls.fetch_add(1, std::memory_order_relaxed);
+    if (StartTicks)
+    {
+        uint64_t Elapsed = CallStatisticsTicks() - StartTicks;
+        Entry->Histogram[CallStatisticsBucket(Elapsed)].fetch_add(1, std::memory_order_relaxed);
+        Entry->TotalTicks.fetch_add(Elapsed, std::memory_order_relaxed);
+    }
+}
+
+inline uint64_t GetCallCount(const CallStatisticsEntry& Entry)
+{
+    return Entry.Calls.load(std::memory_order_relaxed);
+}
+
+// 按采样的平均耗时外推全部调用的总耗时
+inline double GetEstimatedTotalTicks(const CallStatisticsEntry& Entry)
+{
+    uint64_t Samples = 0;
+    for (int i = 0; i < PUERTS_CALL_STATISTICS_BUCKETS; ++i)
+    {
+        Samples += Entry.Histogram[i].load(std::memory_order_relaxed);
+    }
+    return Samples ? static_cast<double>(Entry.TotalTicks.load(std::memory_order_relaxed)) * GetCallCount(Entry) / Samples : 0.0;
+}
+
+struct CallStatisticsRegistry
+{
+    // 静态存储，初始全为0，只追加不删除，所以条目指针一直有效
+    CallStatisticsEntry Entries[PUERTS_CALL_STATISTICS_CAPACITY];
+    std::atomic<int> Count;
+    std::mutex Mutex;
+    std::unordered_map<std::string, int> NameToIndex;
+};
+
+inline CallStatisticsRegistry& GetCallStatisticsRegistry()
+{
+    static CallStatisticsRegistry Registry;
+    return Registry;
+}
+
+// 同名绑定（比如多个虚拟机注册同一个方法）共享一个条目；容量用完后新的绑定都计入最后一个"<overflow>"条目，所以永远不会返回nullptr
+inline CallStatisticsEntry* RegisterCallStatistics(const char* Name)
+{
+    CallStatisticsRegistry& Registry = GetCallStatisticsRegistry();
+    std::lock_guard<std::mutex> Guard(Registry.Mutex);
+    std::string Key = Name ? Name : "";
+    auto Iter = Registry.NameToIndex.find(Key);
+    if (Iter == Registry.NameToIndex.end() && Registry.Count.load(std::memory_order_relaxed) >= PUERTS_CALL_STATISTICS_CAPACITY - 1)
+    {
+        Key = "<overflow>";
+        Iter = Registry.NameToIndex.find(Key);
+    }
+    if (Iter != Registry.NameToIndex.end())
+    {
+        return &Registry.Entries[Iter->second];
+    }
+
+    int Index = Registry.Count.load(std::memory_order_relaxed);
+    CallStatisticsEntry& Entry = Registry.Entries[Index];
+    memcpy(Entry.Name, Key.c_str(), Key.size() < PUERTS_CALL_STATISTICS_NAME_SIZE - 1 ? Key.size() : PUERTS_CALL_STATISTICS_NAME_SIZE - 1);
+    Registry.NameToIndex.emplace(Key, Index);
+    Registry.Count.store(Index + 1, std::memory_order_release);
+    return &Entry;
+}
+
+// 返回所有条目组成的连续数组，OutCount为条目数，读取期间其它线程可能仍在计数
+inline const CallStatisticsEntry* GetCallStatistics(int* OutCount)
+{
+    CallStatisticsRegistry& Registry = GetCallStatisticsRegistry();
+    *OutCount = Registry.Count.load(std::memory_order_acquire);
+    return Registry.Entries;
+}
+
+inline void ResetCallStatistics()
+{
+    CallStatisticsRegistry& Registry = GetCallStatisticsRegistry();
+    int Count = Registry.Count.load(std::memory_order_acquire);
+    for (int i = 0; i < Count; ++i)
+    {
+        Registry.Entries[i].Calls.store(0, std::memory_order_relaxed);
+        Registry.Entries[i].TotalTicks.store(0, std::memory_order_relaxed);
+        for (int j = 0; j < PUERTS_CALL_STATISTICS_BUCKETS; ++j)
+        {
+            Registry.Entries[i].Histogram[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// tick频率，x86上tsc频率需要校准（首次调用时阻塞约20ms），只在读取统计结果时用到
+inline double GetCallStatisticsTicksPerSecond()
+{
+    static double TicksPerSecond = []() -> double
+    {
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+        auto StartTime = std::chrono::steady_clock::now();
+        uint64_t StartTicks = CallStatisticsTicks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t EndTicks = CallStatisticsTicks();
+        double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+        return static_cast<double>(EndTicks - StartTicks) / Seconds;
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+        return static_cast<double>(_ReadStatusReg(0x5F00));    // CNTFRQ_EL0
+#elif defined(__aarch64__)
+        uint64_t Frequency;
+        __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(Frequency));
+        return static_cast<double>(Frequency);
+#else
+        return 1e9;
+#endif
+    }();
+    return TicksPerSecond;
+}
+
+class CallStatisticsScope
+{
+public:
+    explicit CallStatisticsScope(CallStatisticsEntry* InEntry) : Entry(InEntry), StartTicks(CallStatisticsStart())
+    {
+    }
+
+    ~CallStatisticsScope()
+    {
+        RecordCallStatistics(Entry, StartTicks);
+    }
+
+private:
+    CallStatisticsEntry* Entry;
+    uint64_t StartTicks;
+};
+}    // namespace puerts
+
+#define PUERTS_CALL_STATISTICS_SCOPE(Entry) puerts::CallStatisticsScope PuertsCallStatisticsScope(Entry)
+
+#else
+
+#define PUERTS_CALL_STATISTICS_SCOPE(Entry)
+
+#endif    // PUERTS_CALL_STATISTICS
+
+#endif    // PUERTS_CALL_STATISTICS_H
@@ -11,6 +11,32 @@
 
 namespace puerts
 {
+// 这些类型的元素和对应TypedArray的内存布局一致，可以整段拷贝
+static bool IsTypedArrayOf(PropertyMacro* Property, v8::Local<v8::Value> Value)
+{
+    if (Property->IsA<FloatPropertyMacro>())
+        return Value->IsFloat32Array();
+    if (Property->IsA<DoublePropertyMacro>())
+        return Value->IsFloat64Array();
+    if (Property->IsA<IntPropertyMacro>())
+        return Value->IsInt32Array();
+    if (Property->IsA<UInt32PropertyMacro>())
+        return Value->IsUint32Array();
+    if (Property->IsA<Int16PropertyMacro>())
+        return Value->IsInt16Array();
+    if (Property->IsA<UInt16PropertyMacro>())
+        return Value->IsUint16Array();
+    if (Property->IsA<Int8PropertyMacro>())
+        return Value->IsInt8Array();
+    if (Property->IsA<BytePropertyMacro>())
+        return Value->IsUint8Array();
+    if (Property->IsA<Int64PropertyMacro>())
+        return Value->IsBigInt64Array();
+    if (Property->IsA<UInt64PropertyMacro>())
+        return Value->IsBigUint64Array();
+    return false;
+}
+
 v8::Local<v8::FunctionTemplate> FScriptArrayWrapper::ToFunctionTemplate(v8::Isolate* Isolate)
 {
     v8::Isolate::Scope Isolatescope(Isolate);
@@ -28,6 +54,9 @@ v8::Local<v8::FunctionTemplate> FScriptArrayWrapper::ToFunctionTemplate(v8::Isol
     Result->PrototypeTemplate()->Set(
         FV8Utils::InternalString(Isolate, "IsValidIndex"), v8::FunctionTemplate::New(Isolate, IsValidIndex));
     Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "Empty"), v8::FunctionTemplate::New(Isolate, Empty));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "ToArray"), v8::FunctionTemplate::New(Isolate, ToArray));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "FromArray"), v8::FunctionTemplate::New(Isolate, FromArray));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "NextBatch"), v8::FunctionTemplate::New(Isolate, NextBatch));
 
     return Result;
 }
@@ -204,6 +233,164 @@ void FScriptArrayWrapper::Empty(const v8::FunctionCallbackInfo<v8::Value>& Info)
     FScriptArrayEx::Empty(Self, Inner->Property);
 }
 
+void FScriptArrayWrapper::ToArray(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    auto Self = FV8Utils::GetPointerFast<FScriptArray>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+
+    const int32 Num = Self->Num();
+    const int32 ElementSize = GetSizeWithAlignment(Inner->Property);
+    auto Result = v8::Array::New(Isolate, Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        auto _unused = Result->Set(Context, i, Inner->UEToJs(Isolate, Context, GetData(Self, ElementSize, i), false));
+    }
+    Info.GetReturnValue().Set(Result);
+}
+
+void FScriptArrayWrapper::FromArray(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    CHECK_V8_ARGS(EArgObject);
+
+    auto Self = FV8Utils::GetPointerFast<FScriptArray>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+    auto Property = Inner->Property;
+
+    const int32 ElementSize = GetSizeWithAlignment(Property);
+    int32 Length = 0;
+    const uint8* TypedArraySrc = nullptr;
+    if (Info[0]->IsArray())
+    {
+        Length = static_cast<int32>(Info[0].As<v8::Array>()->Length());
+    }
+    else if (Info[0]->IsTypedArray())
+    {
+        // buffer被转移（detach）后Length为0，GetArrayBufferData也可能返回nullptr，都按空数组处理
+        Length = static_cast<int32>(Info[0].As<v8::TypedArray>()->Length());
+        if (Length > 0 && IsTypedArrayOf(Property, Info[0]))
+        {
+            auto View = Info[0].As<v8::ArrayBufferView>();
+            size_t DataLength = 0;
+            const uint8* Data = static_cast<const uint8*>(DataTransfer::GetArrayBufferData(View->Buffer(), DataLength));
+            if (!Data || View->ByteOffset() + static_cast<size_t>(Length) * ElementSize > DataLength)
+            {
+                Length = 0;
+            }
+            else
+            {
+                TypedArraySrc = Data + View->ByteOffset();
+            }
+        }
+    }
+    else
+    {
+        // 其它array-like对象按length和下标读取
+        v8::Local<v8::Value> LengthValue;
+        double LengthNumber = 0;
+        if (!Info[0].As<v8::Object>()->Get(Context, FV8Utils::InternalString(Isolate, "length")).ToLocal(&LengthValue) ||
+            !LengthValue->NumberValue(Context).To(&LengthNumber))
+        {
+            return;
+        }
+        if (!(LengthNumber >= 0 && LengthNumber <= MAX_int32))
+        {
+            FV8Utils::ThrowException(Isolate, "expect an array-like object with a valid length");
+            return;
+        }
+        Length = static_cast<int32>(LengthNumber);
+    }
+
+    FScriptArrayEx::Empty(Self, Property);
+    if (Length == 0)
+    {
+        return;
+    }
+    AddUninitialized(Self, ElementSize, Length);
+
+    if (TypedArraySrc)
+    {
+        FMemory::Memcpy(GetData(Self, ElementSize, 0), TypedArraySrc, Length * ElementSize);
+        return;
+    }
+
+    Construct(Self, Inner, 0, Length);
+    auto Src = Info[0].As<v8::Object>();
+    for (int32 i = 0; i < Length; ++i)
+    {
+        v8::Local<v8::Value> Element;
+        if (!Src->Get(Context, i).ToLocal(&Element))
+        {
+            return;
+        }
+        Inner->JsToUE(Isolate, Context, Element, GetData(Self, ElementSize, i), false);
+    }
+}
+
+void FScriptArrayWrapper::NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    CHECK_V8_ARGS(EArgObject, EArgInt32, EArgInt32, EArgInt32);
+
+    auto Self = FV8Utils::GetPointerFast<FScriptArray>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+
+    auto Out = Info[0].As<v8::Object>();
+    const int32 Start = FMath::Max(Info[1]->Int32Value(Context).ToChecked(), 0);
+    const int32 Count = FMath::Max(Info[2]->Int32Value(Context).ToChecked(), 1);
+    const int32 Kind = Info[3]->Int32Value(Context).ToChecked();
+
+    // 迭代过程中容器可能被js修改，每批都重新取Num
+    const int32 Num = Self->Num();
+    const int32 End = Start < Num ? Start + FMath::Min(Count, Num - Start) : Num;
+    const int32 ElementSize = GetSizeWithAlignment(Inner->Property);
+    int32 Written = 0;
+    for (int32 i = Start; i < End; ++i)
+    {
+        v8::Local<v8::Value> Value;
+        if (Kind == IterateKeys)
+        {
+            Value = v8::Integer::New(Isolate, i);
+        }
+        else
+        {
+            Value = Inner->UEToJs(Isolate, Context, GetData(Self, ElementSize, i), false);
+            if (Kind == IterateEntries)
+            {
+                Value = MakeEntry(Context, v8::Integer::New(Isolate, i), Value);
+            }
+        }
+        auto _unused = Out->Set(Context, Written++, Value);
+    }
+    SetBatchLength(Context, Out, Written);
+    Info.GetReturnValue().Set(End < Num ? End : -1);
+}
+
 FORCEINLINE int32 FScriptArrayWrapper::AddUninitialized(FScriptArray* ScriptArray, int32 ElementSize, int32 Count)
 {
 #if ENGINE_MAJOR_VERSION > 4
@@ -283,6 +470,9 @@ v8::Local<v8::FunctionTemplate> FScriptSetWrapper::ToFunctionTemplate(v8::Isolat
     Result->PrototypeTemplate()->Set(
         FV8Utils::InternalString(Isolate, "IsValidIndex"), v8::FunctionTemplate::New(Isolate, IsValidIndex));
     Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "Empty"), v8::FunctionTemplate::New(Isolate, Empty));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "ToArray"), v8::FunctionTemplate::New(Isolate, ToArray));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "ToJSSet"), v8::FunctionTemplate::New(Isolate, ToJSSet));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "NextBatch"), v8::FunctionTemplate::New(Isolate, NextBatch));
 
     return Result;
 }
@@ -453,6 +643,104 @@ void FScriptSetWrapper::Empty(const v8::FunctionCallbackInfo<v8::Value>& Info)
     FScriptSetEx::Empty(Self, Inner->Property);
 }
 
+void FScriptSetWrapper::ToArray(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    auto Self = FV8Utils::GetPointerFast<FScriptSet>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+    auto Property = Inner->Property;
+
+    auto ScriptLayout = FScriptSet::GetScriptLayout(Property->GetSize(), Property->GetMinAlignment());
+    auto Result = v8::Array::New(Isolate, Self->Num());
+    int32 Written = 0;
+    for (int32 i = 0, MaxIndex = Self->GetMaxIndex(); i < MaxIndex; ++i)
+    {
+        if (Self->IsValidIndex(i))
+        {
+            auto _unused = Result->Set(Context, Written++, Inner->UEToJs(Isolate, Context, Self->GetData(i, ScriptLayout), false));
+        }
+    }
+    Info.GetReturnValue().Set(Result);
+}
+
+void FScriptSetWrapper::ToJSSet(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    auto Self = FV8Utils::GetPointerFast<FScriptSet>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+    auto Property = Inner->Property;
+
+    auto ScriptLayout = FScriptSet::GetScriptLayout(Property->GetSize(), Property->GetMinAlignment());
+    auto Result = v8::Set::New(Isolate);
+    for (int32 i = 0, MaxIndex = Self->GetMaxIndex(); i < MaxIndex; ++i)
+    {
+        if (Self->IsValidIndex(i))
+        {
+            auto _unused = Result->Add(Context, Inner->UEToJs(Isolate, Context, Self->GetData(i, ScriptLayout), false));
+        }
+    }
+    Info.GetReturnValue().Set(Result);
+}
+
+void FScriptSetWrapper::NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    CHECK_V8_ARGS(EArgObject, EArgInt32, EArgInt32, EArgInt32);
+
+    auto Self = FV8Utils::GetPointerFast<FScriptSet>(Info.Holder(), 0);
+    auto Inner = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    if (!Inner->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "item info is invalid!");
+        return;
+    }
+    auto Property = Inner->Property;
+
+    auto Out = Info[0].As<v8::Object>();
+    int32 Index = FMath::Max(Info[1]->Int32Value(Context).ToChecked(), 0);
+    const int32 Count = FMath::Max(Info[2]->Int32Value(Context).ToChecked(), 1);
+    const int32 Kind = Info[3]->Int32Value(Context).ToChecked();
+
+    // 和js的Set一样，keys()等同于values()，entries()为[value, value]
+    auto ScriptLayout = FScriptSet::GetScriptLayout(Property->GetSize(), Property->GetMinAlignment());
+    const int32 MaxIndex = Self->GetMaxIndex();
+    int32 Written = 0;
+    for (; Index < MaxIndex && Written < Count; ++Index)
+    {
+        if (!Self->IsValidIndex(Index))
+        {
+            continue;
+        }
+        v8::Local<v8::Value> Value = Inner->UEToJs(Isolate, Context, Self->GetData(Index, ScriptLayout), false);
+        if (Kind == IterateEntries)
+        {
+            Value = MakeEntry(Context, Value, Value);
+        }
+        auto _unused = Out->Set(Context, Written++, Value);
+    }
+    SetBatchLength(Context, Out, Written);
+    Info.GetReturnValue().Set(Index < MaxIndex ? Index : -1);
+}
+
 int32 FScriptSetWrapper::FindIndexInner(const v8::FunctionCallbackInfo<v8::Value>& Info)
 {
     v8::Isolate* Isolate = Info.GetIsolate();
@@ -501,6 +789,8 @@ v8::Local<v8::FunctionTemplate> FScriptMapWrapper::ToFunctionTemplate(v8::Isolat
         FV8Utils::InternalString(Isolate, "IsValidIndex"), v8::FunctionTemplate::New(Isolate, IsValidIndex));
     Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "GetKey"), v8::FunctionTemplate::New(Isolate, GetKey));
     Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "Empty"), v8::FunctionTemplate::New(Isolate, Empty));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "ToJSMap"), v8::FunctionTemplate::New(Isolate, ToJSMap));
+    Result->PrototypeTemplate()->Set(FV8Utils::InternalString(Isolate, "NextBatch"), v8::FunctionTemplate::New(Isolate, NextBatch));
 
     return Result;
 }
@@ -730,6 +1020,92 @@ void FScriptMapWrapper::Empty(const v8::FunctionCallbackInfo<v8::Value>& Info)
     FScriptMapEx::Empty(Self, KeyProperty, ValueProperty);
 }
 
+void FScriptMapWrapper::ToJSMap(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    auto Self = FV8Utils::GetPointerFast<FScriptMap>(Info.Holder(), 0);
+    auto KeyPropertyTranslator = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    auto KeyProperty = KeyPropertyTranslator->Property;
+    auto ValuePropertyTranslator = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 2);
+    auto ValueProperty = ValuePropertyTranslator->Property;
+    if (!KeyPropertyTranslator->PropertyWeakPtr.IsValid() || !ValuePropertyTranslator->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "key/value info is invalid!");
+        return;
+    }
+
+    auto ScriptLayout = GetScriptLayout(KeyProperty, ValueProperty);
+    auto Result = v8::Map::New(Isolate);
+    for (int32 i = 0, MaxIndex = Self->GetMaxIndex(); i < MaxIndex; ++i)
+    {
+        if (Self->IsValidIndex(i))
+        {
+            uint8* Data = reinterpret_cast<uint8*>(Self->GetData(i, ScriptLayout));
+            auto _unused = Result->Set(Context,
+                KeyPropertyTranslator->UEToJs(Isolate, Context, Data + GetKeyOffset(ScriptLayout), false),
+                ValuePropertyTranslator->UEToJs(Isolate, Context, Data + ScriptLayout.ValueOffset, false));
+        }
+    }
+    Info.GetReturnValue().Set(Result);
+}
+
+void FScriptMapWrapper::NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+
+    CHECK_V8_ARGS(EArgObject, EArgInt32, EArgInt32, EArgInt32);
+
+    auto Self = FV8Utils::GetPointerFast<FScriptMap>(Info.Holder(), 0);
+    auto KeyPropertyTranslator = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 1);
+    auto KeyProperty = KeyPropertyTranslator->Property;
+    auto ValuePropertyTranslator = FV8Utils::GetPointerFast<FPropertyTranslator>(Info.Holder(), 2);
+    auto ValueProperty = ValuePropertyTranslator->Property;
+    if (!KeyPropertyTranslator->PropertyWeakPtr.IsValid() || !ValuePropertyTranslator->PropertyWeakPtr.IsValid())
+    {
+        FV8Utils::ThrowException(Isolate, "key/value info is invalid!");
+        return;
+    }
+
+    auto Out = Info[0].As<v8::Object>();
+    int32 Index = FMath::Max(Info[1]->Int32Value(Context).ToChecked(), 0);
+    const int32 Count = FMath::Max(Info[2]->Int32Value(Context).ToChecked(), 1);
+    const int32 Kind = Info[3]->Int32Value(Context).ToChecked();
+
+    auto ScriptLayout = GetScriptLayout(KeyProperty, ValueProperty);
+    const int32 MaxIndex = Self->GetMaxIndex();
+    int32 Written = 0;
+    for (; Index < MaxIndex && Written < Count; ++Index)
+    {
+        if (!Self->IsValidIndex(Index))
+        {
+            continue;
+        }
+        uint8* Data = reinterpret_cast<uint8*>(Self->GetData(Index, ScriptLayout));
+        v8::Local<v8::Value> Value;
+        if (Kind == IterateKeys)
+        {
+            Value = KeyPropertyTranslator->UEToJs(Isolate, Context, Data + GetKeyOffset(ScriptLayout), false);
+        }
+        else if (Kind == IterateValues)
+        {
+            Value = ValuePropertyTranslator->UEToJs(Isolate, Context, Data + ScriptLayout.ValueOffset, false);
+        }
+        else
+        {
+            Value = MakeEntry(Context, KeyPropertyTranslator->UEToJs(Isolate, Context, Data + GetKeyOffset(ScriptLayout), false),
+                ValuePropertyTranslator->UEToJs(Isolate, Context, Data + ScriptLayout.ValueOffset, false));
+        }
+        auto _unused = Out->Set(Context, Written++, Value);
+    }
+    SetBatchLength(Context, Out, Written);
+    Info.GetReturnValue().Set(Index < MaxIndex ? Index : -1);
+}
+
 FScriptMapLayout FScriptMapWrapper::GetScriptLayout(const PropertyMacro* KeyProperty, const PropertyMacro* ValueProperty)
 {
     return FScriptMap::GetScriptLayout(
@@ -239,8 +239,10 @@ public:
         typedef typename ContainerExTypeMapper<T>::Type ET;
         ET* Container =
             static_cast<ET*>(DataTransfer::MakeAddressWithHighPartOfTwo(Data.GetInternalField(0), Data.GetInternalField(1)));
-        FV8Utils::IsolateData<IObjectMapper>(Data.GetIsolate())->UnBindContainer(Container);
-        delete Container;
+        auto ObjectMapper = FV8Utils::IsolateData<IObjectMapper>(Data.GetIsolate());
+        ObjectMapper->UnBindContainer(Container);
+        // 析构元素要在游戏线程做
+        ObjectMapper->RunOnGameThread([Container]() { delete Container; });
     }
 
     static void OnGarbageCollected(const v8::WeakCallbackInfo<void>& Data)
@@ -268,6 +270,31 @@ public:
         auto Self = FV8Utils::GetPointerFast<T>(Info.Holder());
         Info.GetReturnValue().Set(Self->Num());
     }
+
+protected:
+    // NextBatch的第四个参数，对应js侧的values()/keys()/entries()
+    enum EIterateKind
+    {
+        IterateValues = 0,
+        IterateKeys = 1,
+        IterateEntries = 2
+    };
+
+    FORCEINLINE static v8::Local<v8::Value> MakeEntry(
+        v8::Local<v8::Context> Context, v8::Local<v8::Value> Key, v8::Local<v8::Value> Value)
+    {
+        auto Entry = v8::Array::New(Context->GetIsolate(), 2);
+        auto _unused = Entry->Set(Context, 0, Key);
+        _unused = Entry->Set(Context, 1, Value);
+        return Entry;
+    }
+
+    // Out由js侧的迭代器复用，每批覆盖前Count个元素后截断
+    FORCEINLINE static void SetBatchLength(v8::Local<v8::Context> Context, v8::Local<v8::Object> Out, int32 Count)
+    {
+        auto _unused = Out->Set(Context, FV8Utils::InternalString(Context->GetIsolate(), "length"),
+            v8::Integer::New(Context->GetIsolate(), Count));
+    }
 };
 
 class FScriptArrayWrapper : public FContainerWrapper<FScriptArray>
@@ -321,6 +348,21 @@ private:
     // 作用：清空容器
     static void Empty(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
+    // 参数：无
+    // 返回：js数组（元素为值类型，有内存拷贝）
+    // 作用：一次调用把整个容器转成js数组
+    static void ToArray(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    // 参数：js数组或TypedArray
+    // 返回：无
+    // 作用：清空容器后按顺序填入参数中的所有元素；数值类型的容器传入同类型的TypedArray时整段拷贝
+    static void FromArray(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    // 参数1：输出数组（复用）；参数2：起始索引；参数3：本批最多取的个数；参数4：EIterateKind
+    // 返回：下一批的起始索引，没有更多元素时返回-1
+    // 作用：给js侧的迭代器用，每批只跨越一次边界
+    static void NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
     FORCEINLINE static int32 AddUninitialized(FScriptArray* ScriptArray, int32 ElementSize, int32 Count = 1);
 
     FORCEINLINE static uint8* GetData(FScriptArray* ScriptArray, int32 ElementSize, int32 Index);
@@ -356,6 +398,13 @@ private:
 
     static void Empty(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
+    static void ToArray(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    static void ToJSSet(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    // 同FScriptArrayWrapper::NextBatch，索引是稀疏的，会跳过无效索引
+    static void NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
     FORCEINLINE static int32 FindIndexInner(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
     FORCEINLINE static void InternalGet(const v8::FunctionCallbackInfo<v8::Value>& Info, bool PassByPointer);
@@ -385,6 +434,11 @@ private:
 
     static void Empty(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
+    static void ToJSMap(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    // 同FScriptSetWrapper::NextBatch，entries为[key, value]
+    static void NextBatch(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
     FORCEINLINE static FScriptMapLayout GetScriptLayout(const PropertyMacro* KeyProperty, const PropertyMacro* ValueProperty);
 
     FORCEINLINE static void InternalGet(const v8::FunctionCallbackInfo<v8::Value>& Info, bool PassByPointer);
@@ -269,7 +269,7 @@ void FCppObjectMapper::BindCppObject(
     DataTransfer::SetPointer(Isolate, JSObject, ClassDefinition->TypeId, 1);
 
     auto Iter = CDataCache.find(Ptr);
-    FObjectCacheNode* CacheNodePtr;
+    FObjectCacheNode::FEntry* CacheNodePtr;
     if (Iter != CDataCache.end())
     {
         CacheNodePtr = Iter->second.Add(ClassDefinition->TypeId);
@@ -277,7 +277,7 @@ void FCppObjectMapper::BindCppObject(
     else
     {
         auto Ret = CDataCache.insert({Ptr, FObjectCacheNode(ClassDefinition->TypeId)});
-        CacheNodePtr = &Ret.first->second;
+        CacheNodePtr = Ret.first->second.Find(ClassDefinition->TypeId);
     }
     CacheNodePtr->Value.Reset(Isolate, JSObject);
 
@@ -300,8 +300,8 @@ void FCppObjectMapper::UnBindCppObject(JSClassDefinition* ClassDefinition, void*
     auto Iter = CDataCache.find(Ptr);
     if (Iter != CDataCache.end())
     {
-        auto Removed = Iter->second.Remove(ClassDefinition->TypeId, true);
-        if (!Iter->second.TypeId)    // last one
+        Iter->second.Remove(ClassDefinition->TypeId);
+        if (Iter->second.IsEmpty())    // last one
         {
             CDataCache.erase(Ptr);
         }
@@ -26,10 +26,24 @@ bool DataTransfer::IsInstanceOf(v8::Isolate* Isolate, const void* TypeId, v8::Lo
     return IsolateData<ICppObjectMapper>(Isolate)->IsInstanceOfCppObject(TypeId, JsObject);
 }
 
+bool DataTransfer::IsCppSubclassOf(const void* TypeId, const void* BaseTypeId)
+{
+    while (TypeId)
+    {
+        if (TypeId == BaseTypeId)
+        {
+            return true;
+        }
+        const JSClassDefinition* ClassDefinition = FindClassByID(TypeId);
+        TypeId = ClassDefinition ? ClassDefinition->SuperTypeId : nullptr;
+    }
+    return false;
+}
+
 v8::Local<v8::Value> DataTransfer::UnRef(v8::Isolate* Isolate, const v8::Local<v8::Value>& Value)
 {
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
-    v8::Local<v8::Value> ReturnValue = Value->ToObject(Context).ToLocalChecked()->Get(Context, 0).ToLocalChecked();
+    v8::Local<v8::Value> ReturnValue = GetRefValue(Context, Value->ToObject(Context).ToLocalChecked());
 
     return ReturnValue;
 }
@@ -38,7 +52,7 @@ void DataTransfer::UpdateRef(v8::Isolate* Isolate, v8::Local<v8::Value> Outer, c
 {
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
 
-    auto Ret = Outer->ToObject(Context).ToLocalChecked()->Set(Context, 0, Value);
+    SetRefValue(Context, Outer->ToObject(Context).ToLocalChecked(), Value);
 }
 
 std::weak_ptr<int> DataTransfer::GetJsEnvLifeCycleTracker(v8::Isolate* Isolate)
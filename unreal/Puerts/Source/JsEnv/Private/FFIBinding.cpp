@@ -308,6 +308,340 @@ static void FFICall(const v8::FunctionCallbackInfo<v8::Value>& Info)
     Info.GetReturnValue().SetUndefined();
 }
 
+// ffi_bind生成的函数：cif在绑定时准备好，参数槽预先分配，调用时直接把js的number/bigint/typed array写进参数槽，不再经过Uint8Array中转。
+// 只支持基础类型，结构体和cstring等需要js侧处理的参数由binding.js在外面包一层或者回退到ffi_call。
+enum class EFFIKind : uint8_t
+{
+    Void,
+    UInt8,
+    Int8,
+    UInt16,
+    Int16,
+    UInt32,
+    Int32,
+    UInt64,
+    Int64,
+    Float,
+    Double,
+    Pointer
+};
+
+static bool GetFFIKind(const v8::String::Utf8Value& Name, EFFIKind& OutKind, ffi_type*& OutType)
+{
+    struct FKindInfo
+    {
+        const char* Name;
+        EFFIKind Kind;
+        ffi_type* Type;
+    };
+    static FKindInfo KindInfos[] = {{"void", EFFIKind::Void, &ffi_type_void}, {"uint8", EFFIKind::UInt8, &ffi_type_uint8},
+        {"int8", EFFIKind::Int8, &ffi_type_sint8}, {"uint16", EFFIKind::UInt16, &ffi_type_uint16},
+        {"int16", EFFIKind::Int16, &ffi_type_sint16}, {"uint32", EFFIKind::UInt32, &ffi_type_uint32},
+        {"int32", EFFIKind::Int32, &ffi_type_sint32}, {"uint64", EFFIKind::UInt64, &ffi_type_uint64},
+        {"int64", EFFIKind::Int64, &ffi_type_sint64}, {"float", EFFIKind::Float, &ffi_type_float},
+        {"double", EFFIKind::Double, &ffi_type_double}, {"pointer", EFFIKind::Pointer, &ffi_type_pointer}};
+
+    if (!*Name)
+        return false;
+    for (const FKindInfo& KindInfo : KindInfos)
+    {
+        if (strcmp(*Name, KindInfo.Name) == 0)
+        {
+            OutKind = KindInfo.Kind;
+            OutType = KindInfo.Type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 整块放在一个ArrayBuffer里，跟绑定出来的函数同生命周期，都是POD不需要析构
+// layout: FBoundCall | ffi_type* ArgTypes[ArgCount] | void* ArgValues[ArgCount] | uint64_t ArgSlots[ArgCount] | EFFIKind ArgKinds[ArgCount]
+struct FBoundCall
+{
+    ffi_cif Cif;
+
+    void (*Func)(void);
+
+    uint32_t ArgCount;
+
+    EFFIKind RetKind;
+
+    // ffi要求返回值缓冲区至少是ffi_arg大小
+    uint64_t RetSlot[2];
+
+    ffi_type** ArgTypes()
+    {
+        return reinterpret_cast<ffi_type**>(this + 1);
+    }
+
+    void** ArgValues()
+    {
+        return reinterpret_cast<void**>(ArgTypes() + ArgCount);
+    }
+
+    uint64_t* ArgSlots()
+    {
+        return reinterpret_cast<uint64_t*>(ArgValues() + ArgCount);
+    }
+
+    EFFIKind* ArgKinds()
+    {
+        return reinterpret_cast<EFFIKind*>(ArgSlots() + ArgCount);
+    }
+
+    static size_t AllocSize(uint32_t ArgCount)
+    {
+        return sizeof(FBoundCall) + (sizeof(ffi_type*) + sizeof(void*) + sizeof(uint64_t) + sizeof(EFFIKind)) * ArgCount;
+    }
+};
+
+static_assert(sizeof(FBoundCall) % sizeof(uint64_t) == 0, "ArgSlots must be 8 bytes aligned");
+
+static bool ToBoundArg(v8::Local<v8::Value> Val, EFFIKind Kind, uint64_t* Slot)
+{
+    switch (Kind)
+    {
+        case EFFIKind::Pointer:
+            if (Val->IsNull())
+            {
+                *reinterpret_cast<void**>(Slot) = nullptr;
+            }
+            else if (Val->IsArrayBufferView())
+            {
+                *reinterpret_cast<void**>(Slot) = ArrayBufferData(Val);
+            }
+            else if (Val->IsArrayBuffer())
+            {
+                *reinterpret_cast<void**>(Slot) = Val.As<v8::ArrayBuffer>()->GetContents().Data();
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        case EFFIKind::Float:
+        case EFFIKind::Double:
+        {
+            if (!Val->IsNumber())
+                return false;
+            double D = Val.As<v8::Number>()->Value();
+            if (Kind == EFFIKind::Float)
+                *reinterpret_cast<float*>(Slot) = static_cast<float>(D);
+            else
+                *reinterpret_cast<double*>(Slot) = D;
+            return true;
+        }
+        default:
+            break;
+    }
+
+    int64_t I;
+    if (Val->IsInt32())
+    {
+        I = Val.As<v8::Int32>()->Value();
+    }
+    else if (Val->IsNumber())
+    {
+        // NaN、Infinity以及超出目标64位整数范围的double直接转换是未定义行为，当作参数类型不对处理
+        const double D = Val.As<v8::Number>()->Value();
+        const double Max = Kind == EFFIKind::UInt64 ? 18446744073709551616.0 : 9223372036854775808.0;
+        if (!(D >= -9223372036854775808.0 && D < Max))
+        {
+            return false;
+        }
+        I = D < 9223372036854775808.0 ? static_cast<int64_t>(D) : static_cast<int64_t>(static_cast<uint64_t>(D));
+    }
+    else if (Val->IsBigInt())
+    {
+        I = Kind == EFFIKind::UInt64 ? static_cast<int64_t>(Val.As<v8::BigInt>()->Uint64Value()) : Val.As<v8::BigInt>()->Int64Value();
+    }
+    else
+    {
+        return false;
+    }
+
+    switch (Kind)
+    {
+        case EFFIKind::UInt8:
+            *reinterpret_cast<uint8_t*>(Slot) = static_cast<uint8_t>(I);
+            break;
+        case EFFIKind::Int8:
+            *reinterpret_cast<int8_t*>(Slot) = static_cast<int8_t>(I);
+            break;
+        case EFFIKind::UInt16:
+            *reinterpret_cast<uint16_t*>(Slot) = static_cast<uint16_t>(I);
+            break;
+        case EFFIKind::Int16:
+            *reinterpret_cast<int16_t*>(Slot) = static_cast<int16_t>(I);
+            break;
+        case EFFIKind::UInt32:
+            *reinterpret_cast<uint32_t*>(Slot) = static_cast<uint32_t>(I);
+            break;
+        case EFFIKind::Int32:
+            *reinterpret_cast<int32_t*>(Slot) = static_cast<int32_t>(I);
+            break;
+        default:
+            *reinterpret_cast<int64_t*>(Slot) = I;
+            break;
+    }
+    return true;
+}
+
+static v8::Local<v8::Value> FromBoundRet(v8::Isolate* Isolate, EFFIKind Kind, void* Ret)
+{
+    // 小于ffi_arg的整数返回值被扩展成ffi_arg大小
+    switch (Kind)
+    {
+        case EFFIKind::UInt8:
+            return v8::Integer::NewFromUnsigned(Isolate, static_cast<uint8_t>(*reinterpret_cast<ffi_arg*>(Ret)));
+        case EFFIKind::Int8:
+            return v8::Integer::New(Isolate, static_cast<int8_t>(*reinterpret_cast<ffi_sarg*>(Ret)));
+        case EFFIKind::UInt16:
+            return v8::Integer::NewFromUnsigned(Isolate, static_cast<uint16_t>(*reinterpret_cast<ffi_arg*>(Ret)));
+        case EFFIKind::Int16:
+            return v8::Integer::New(Isolate, static_cast<int16_t>(*reinterpret_cast<ffi_sarg*>(Ret)));
+        case EFFIKind::UInt32:
+            return v8::Integer::NewFromUnsigned(Isolate, static_cast<uint32_t>(*reinterpret_cast<ffi_arg*>(Ret)));
+        case EFFIKind::Int32:
+            return v8::Integer::New(Isolate, static_cast<int32_t>(*reinterpret_cast<ffi_sarg*>(Ret)));
+        case EFFIKind::UInt64:
+            return v8::BigInt::NewFromUnsigned(Isolate, *reinterpret_cast<uint64_t*>(Ret));
+        case EFFIKind::Int64:
+            return v8::BigInt::New(Isolate, *reinterpret_cast<int64_t*>(Ret));
+        case EFFIKind::Float:
+            return v8::Number::New(Isolate, *reinterpret_cast<float*>(Ret));
+        case EFFIKind::Double:
+            return v8::Number::New(Isolate, *reinterpret_cast<double*>(Ret));
+        case EFFIKind::Pointer:
+            return WrapPointer(Isolate, *reinterpret_cast<void**>(Ret));
+        default:
+            return v8::Undefined(Isolate);
+    }
+}
+
+static void FFIBoundCall(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    FBoundCall* Call = static_cast<FBoundCall*>(Info.Data().As<v8::External>()->Value());
+
+    if (static_cast<uint32_t>(Info.Length()) != Call->ArgCount)
+    {
+        puerts::FV8Utils::ThrowException(Isolate, "ffi bound function: arguments length not match");
+        return;
+    }
+
+    uint64_t* ArgSlots = Call->ArgSlots();
+    EFFIKind* ArgKinds = Call->ArgKinds();
+    for (uint32_t i = 0; i < Call->ArgCount; ++i)
+    {
+        if (!ToBoundArg(Info[i], ArgKinds[i], &ArgSlots[i]))
+        {
+            puerts::FV8Utils::ThrowException(Isolate, "ffi bound function: invalid argument type");
+            return;
+        }
+    }
+
+    ffi_call(&Call->Cif, Call->Func, Call->RetSlot, Call->ArgValues());
+
+    if (Call->RetKind != EFFIKind::Void)
+    {
+        Info.GetReturnValue().Set(FromBoundRet(Isolate, Call->RetKind, Call->RetSlot));
+    }
+}
+
+// ffi_bind(abi, func, returnTypeName, parameterTypeNames, fixArgNum?)
+// func跟ffi_call一样可以是GFuncArray的下标或者函数指针，类型名只能是基础类型，有不支持的类型时返回undefined，由调用者回退到ffi_call
+static void FFIBind(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    v8::Context::Scope ContextScope(Context);
+
+    if (Info.Length() < 4 || !Info[0]->IsNumber() || !(Info[1]->IsNumber() || IsArrayBuffer(Info[1])) || !Info[2]->IsString() ||
+        !Info[3]->IsArray())
+    {
+        puerts::FV8Utils::ThrowException(Isolate, "ffi_bind: Bad parameters.");
+        return;
+    }
+
+    void (*Func)(void) = nullptr;
+    if (Info[1]->IsNumber())
+    {
+        uint32_t FuncIndex = Info[1]->Uint32Value(Context).ToChecked();
+        if (FuncIndex >= GFuncArrayLength)
+        {
+            puerts::FV8Utils::ThrowException(Isolate, "ffi_bind: function index out of range!");
+            return;
+        }
+        Func = FFI_FN(GFuncArray[FuncIndex]);
+    }
+    else
+    {
+        Func = FFI_FN(ArrayBufferData(Info[1]));
+    }
+
+    EFFIKind RetKind;
+    ffi_type* RetType;
+    if (!GetFFIKind(v8::String::Utf8Value(Isolate, Info[2]), RetKind, RetType))
+    {
+        return;
+    }
+
+    v8::Local<v8::Array> ArgNames = Info[3].As<v8::Array>();
+    uint32_t ArgCount = ArgNames->Length();
+
+    v8::Local<v8::ArrayBuffer> AB = v8::ArrayBuffer::New(Isolate, FBoundCall::AllocSize(ArgCount));
+    FBoundCall* Call = new (AB->GetContents().Data()) FBoundCall();
+    Call->Func = Func;
+    Call->ArgCount = ArgCount;
+    Call->RetKind = RetKind;
+
+    ffi_type** ArgTypes = Call->ArgTypes();
+    void** ArgValues = Call->ArgValues();
+    uint64_t* ArgSlots = Call->ArgSlots();
+    EFFIKind* ArgKinds = Call->ArgKinds();
+    for (uint32_t i = 0; i < ArgCount; ++i)
+    {
+        v8::Local<v8::Value> ArgName;
+        if (!ArgNames->Get(Context, i).ToLocal(&ArgName) || !ArgName->IsString() ||
+            !GetFFIKind(v8::String::Utf8Value(Isolate, ArgName), ArgKinds[i], ArgTypes[i]) || ArgKinds[i] == EFFIKind::Void)
+        {
+            return;
+        }
+        ArgSlots[i] = 0;
+        ArgValues[i] = &ArgSlots[i];
+    }
+
+    ffi_abi Abi = (ffi_abi) Info[0]->Uint32Value(Context).ToChecked();
+    ffi_status Status;
+    if (Info.Length() > 4 && Info[4]->IsNumber())
+    {
+        Status = ffi_prep_cif_var(&Call->Cif, Abi, Info[4]->Uint32Value(Context).ToChecked(), ArgCount, RetType, ArgTypes);
+    }
+    else
+    {
+        Status = ffi_prep_cif(&Call->Cif, Abi, ArgCount, RetType, ArgTypes);
+    }
+    if (Status != FFI_OK)
+    {
+        puerts::FV8Utils::ThrowException(Isolate, "ffi_bind: ffi_prep_cif fail!");
+        return;
+    }
+
+    v8::Local<v8::Function> Bound;
+    if (!v8::Function::New(Context, FFIBoundCall, v8::External::New(Isolate, Call), ArgCount).ToLocal(&Bound))
+    {
+        return;
+    }
+    // External不持有内存，让函数引用着ArrayBuffer
+    Bound->SetPrivate(Context, v8::Private::ForApi(Isolate, puerts::FV8Utils::ToV8String(Isolate, "ffi_bound_call")), AB).Check();
+
+    Info.GetReturnValue().Set(Bound);
+}
+
 static void WritePointer(const v8::FunctionCallbackInfo<v8::Value>& Info)
 {
     v8::Isolate* Isolate = Info.GetIsolate();
@@ -463,6 +797,11 @@ static void Init(v8::Local<v8::Context> Context, v8::Local<v8::Object> Exports)
             v8::FunctionTemplate::New(Isolate, FFICall)->GetFunction(Context).ToLocalChecked())
         .Check();
 
+    Exports
+        ->Set(Context, puerts::FV8Utils::ToV8String(Isolate, "ffi_bind"),
+            v8::FunctionTemplate::New(Isolate, FFIBind)->GetFunction(Context).ToLocalChecked())
+        .Check();
+
     Exports
         ->Set(Context, puerts::FV8Utils::ToV8String(Isolate, "writePointer"),
             v8::FunctionTemplate::New(Isolate, WritePointer)->GetFunction(Context).ToLocalChecked())
@@ -96,6 +96,9 @@ void FFunctionTranslator::Init(UFunction* InFunction, bool IsDelegate)
     Function = InFunction;
 #if WITH_EDITOR
     FunctionName = Function->GetFName();
+#endif
+#ifdef PUERTS_CALL_STATISTICS
+    Statistics = puerts::RegisterCallStatistics(TCHAR_TO_UTF8(*(InFunction->GetOuter()->GetName() + TEXT(".") + InFunction->GetName())));
 #endif
     ParamsBufferSize = InFunction->PropertiesSize > InFunction->ParmsSize ? InFunction->PropertiesSize : InFunction->ParmsSize;
 
@@ -136,6 +139,11 @@ void FFunctionTranslator::Init(UFunction* InFunction, bool IsDelegate)
         }
     }
 
+    CanReturnInto = Return && Return->Property->IsA<StructPropertyMacro>() &&
+                    Return->StructProperty->Struct != FArrayBuffer::StaticStruct() &&
+                    Return->StructProperty->Struct != FArrayBufferValue::StaticStruct() &&
+                    Return->StructProperty->Struct != FJsObject::StaticStruct();
+
     ArgumentDefaultValues = nullptr;
 
     if (!IsDelegate)
@@ -222,6 +230,7 @@ void FFunctionTranslator::Call(const v8::FunctionCallbackInfo<v8::Value>& Info)
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
 
     FFunctionTranslator* This = static_cast<FFunctionTranslator*>((v8::Local<v8::External>::Cast(Info.Data()))->Value());
+    PUERTS_CALL_STATISTICS_SCOPE(This->Statistics);
     This->Call(Isolate, Context, Info);
 }
 
@@ -387,7 +396,10 @@ void FFunctionTranslator::FastCall(v8::Isolate* Isolate, v8::Local<v8::Context>&
 
     if (Return)
     {
-        Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+        if (!ReturnInto(Context, Info, Params, Arguments.size()))
+        {
+            Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+        }
         Return->Property->DestroyValue_InContainer(Params);
     }
 
@@ -418,6 +430,29 @@ void FFunctionTranslator::FastCall(v8::Isolate* Isolate, v8::Local<v8::Context>&
     }
 }
 
+bool FFunctionTranslator::ReturnInto(
+    v8::Local<v8::Context>& Context, const v8::FunctionCallbackInfo<v8::Value>& Info, void* Params, int ArgumentCount) const
+{
+    if (!CanReturnInto || Info.Length() <= ArgumentCount || !Info[ArgumentCount]->IsObject())
+    {
+        return false;
+    }
+    auto Target = Info[ArgumentCount].As<v8::Object>();
+    // index 1存的是struct类型，只接受类型完全一致的对象
+    if (FV8Utils::GetPointer(Target, 1) != Return->StructProperty->Struct)
+    {
+        return false;
+    }
+    void* Ptr = FV8Utils::GetPointer(Target);
+    if (!Ptr)
+    {
+        return false;
+    }
+    Return->StructProperty->CopySingleValue(Ptr, Return->Property->ContainerPtrToValuePtr<void>(Params));
+    Info.GetReturnValue().Set(Target);
+    return true;
+}
+
 void FFunctionTranslator::Call(v8::Isolate* Isolate, v8::Local<v8::Context>& Context,
     const v8::FunctionCallbackInfo<v8::Value>& Info, std::function<void(void*)> OnCall)
 {
@@ -658,6 +693,7 @@ void FExtensionMethodTranslator::CallExtension(const v8::FunctionCallbackInfo<v8
 
     FExtensionMethodTranslator* This =
         reinterpret_cast<FExtensionMethodTranslator*>((v8::Local<v8::External>::Cast(Info.Data()))->Value());
+    PUERTS_CALL_STATISTICS_SCOPE(This->Statistics);
     This->CallExtension(Isolate, Context, Info);
 }
 
@@ -710,7 +746,10 @@ void FExtensionMethodTranslator::CallExtension(
 
     if (Return)
     {
-        Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+        if (!ReturnInto(Context, Info, Params, Arguments.size() - 1))
+        {
+            Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+        }
         Return->Property->DestroyValue_InContainer(Params);
     }
 
@@ -15,6 +15,7 @@
 #include "CoreMinimal.h"
 #include "CoreUObject.h"
 #include "PropertyTranslator.h"
+#include "CallStatistics.h"
 
 #pragma warning(push, 0)
 #include "libplatform/libplatform.h"
@@ -79,7 +80,10 @@ protected:
     {
         if (Return)
         {
-            Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+            if (!ReturnInto(Context, Info, Params, Arguments.size() - StartPos))
+            {
+                Info.GetReturnValue().Set(Return->UEToJsInContainer(Isolate, Context, Params));
+            }
             Return->Property->DestroyValue_InContainer(Params);
         }
 
@@ -97,6 +101,13 @@ protected:
 
     std::unique_ptr<FPropertyTranslator> Return;
 
+    // 返回值是UScriptStruct时，调用方可以在参数表末尾多传一个同类型的struct对象，返回值直接写进这个对象并作为返回值，
+    // 不再分配新的struct，例如 UE.KismetMathLibrary.Add_VectorVector(a, b, out)
+    bool CanReturnInto;
+
+    bool ReturnInto(
+        v8::Local<v8::Context>& Context, const v8::FunctionCallbackInfo<v8::Value>& Info, void* Params, int ArgumentCount) const;
+
     TWeakObjectPtr<UFunction> Function;
 
     bool IsInterfaceFunction;
@@ -113,6 +124,9 @@ protected:
 #if WITH_EDITOR
     FName FunctionName;
 #endif
+#ifdef PUERTS_CALL_STATISTICS
+    puerts::CallStatisticsEntry* Statistics;
+#endif
 private:
     static void Call(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
@@ -0,0 +1,230 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "GcScheduler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace puerts
+{
+GcScheduler::GcScheduler() : Isolate(nullptr), Platform(nullptr)
+{
+    ResetStatistics();
+}
+
+GcScheduler::~GcScheduler()
+{
+    Detach();
+}
+
+void GcScheduler::ApplyResourceConstraints(
+    v8::Isolate::CreateParams& Params, uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
+{
+#if !defined(WITH_QUICKJS)
+    if (MaxYoungGenerationSizeMB > 0)
+    {
+        Params.constraints.set_max_young_generation_size_in_bytes(static_cast<size_t>(MaxYoungGenerationSizeMB) * 1024 * 1024);
+    }
+    if (MaxOldGenerationSizeMB > 0)
+    {
+        Params.constraints.set_max_old_generation_size_in_bytes(static_cast<size_t>(MaxOldGenerationSizeMB) * 1024 * 1024);
+    }
+#endif
+}
+
+void GcScheduler::Attach(v8::Isolate* InIsolate, v8::Platform* InPlatform)
+{
+    Detach();
+    Isolate = InIsolate;
+    Platform = InPlatform;
+#if !defined(WITH_QUICKJS)
+    Isolate->AddGCPrologueCallback(&GcScheduler::OnGCPrologue, this);
+    Isolate->AddGCEpilogueCallback(&GcScheduler::OnGCEpilogue, this);
+#endif
+}
+
+void GcScheduler::Detach()
+{
+    if (!Isolate)
+    {
+        return;
+    }
+#if !defined(WITH_QUICKJS)
+    Isolate->RemoveGCPrologueCallback(&GcScheduler::OnGCPrologue, this);
+    Isolate->RemoveGCEpilogueCallback(&GcScheduler::OnGCEpilogue, this);
+#endif
+    // 等其它线程上正在进行的MemoryPressure结束，之后isolate就可以Dispose了
+    std::lock_guard<std::mutex> Guard(PressureMutex);
+    Isolate = nullptr;
+    Platform = nullptr;
+}
+
+bool GcScheduler::NotifyIdle(double BudgetSeconds)
+{
+#if !defined(WITH_QUICKJS)
+    if (!Isolate || !Platform || BudgetSeconds < MinIdleSeconds)
+    {
+        return false;
+    }
+    // IdleNotificationDeadline要的是平台时钟下的绝对时间，不是时长
+    return Isolate->IdleNotificationDeadline(Platform->MonotonicallyIncreasingTime() + BudgetSeconds);
+#else
+    return true;
+#endif
+}
+
+void GcScheduler::MemoryPressure(int Level)
+{
+#if !defined(WITH_QUICKJS)
+    std::lock_guard<std::mutex> Guard(PressureMutex);
+    if (!Isolate || Level < static_cast<int>(v8::MemoryPressureLevel::kNone) ||
+        Level > static_cast<int>(v8::MemoryPressureLevel::kCritical))
+    {
+        return;
+    }
+    Isolate->MemoryPressureNotification(static_cast<v8::MemoryPressureLevel>(Level));
+#endif
+}
+
+GcPauseStatistics GcScheduler::GetStatistics(int Kind) const
+{
+    if (Kind >= 0 && Kind < GcPauseAll)
+    {
+        return Statistics[Kind];
+    }
+    GcPauseStatistics Sum;
+    memset(&Sum, 0, sizeof(Sum));
+    for (int i = 0; i < GcPauseAll; ++i)
+    {
+        const GcPauseStatistics& Item = Statistics[i];
+        Sum.Count += Item.Count;
+        Sum.TotalMicroseconds += Item.TotalMicroseconds;
+        if (Item.MaxMicroseconds > Sum.MaxMicroseconds)
+        {
+            Sum.MaxMicroseconds = Item.MaxMicroseconds;
+        }
+        for (int j = 0; j < PUERTS_GC_HISTOGRAM_BUCKETS; ++j)
+        {
+            Sum.Histogram[j] += Item.Histogram[j];
+        }
+    }
+    return Sum;
+}
+
+void GcScheduler::ResetStatistics()
+{
+    memset(Statistics, 0, sizeof(Statistics));
+}
+
+void GcScheduler::Record(int Kind, uint64_t Microseconds)
+{
+    GcPauseStatistics& Item = Statistics[Kind];
+    ++Item.Count;
+    Item.TotalMicroseconds += Microseconds;
+    if (Microseconds > Item.MaxMicroseconds)
+    {
+        Item.MaxMicroseconds = Microseconds;
+    }
+    int Bucket = 0;
+    while (Microseconds > 1 && Bucket < PUERTS_GC_HISTOGRAM_BUCKETS - 1)
+    {
+        Microseconds >>= 1;
+        ++Bucket;
+    }
+    ++Item.Histogram[Bucket];
+}
+
+#if !defined(WITH_QUICKJS)
+// minor mark compact的枚举名在不同v8版本里不一样，按位判断，剩下的都算minor
+static int ToPauseKind(v8::GCType Type)
+{
+    if (Type & v8::kGCTypeMarkSweepCompact)
+    {
+        return GcPauseMajor;
+    }
+    if (Type & (v8::kGCTypeIncrementalMarking | v8::kGCTypeProcessWeakCallbacks))
+    {
+        return GcPauseIncremental;
+    }
+    return GcPauseMinor;
+}
+
+void GcScheduler::OnGCPrologue(v8::Isolate* Isolate, v8::GCType Type, v8::GCCallbackFlags Flags, void* Data)
+{
+    auto Self = static_cast<GcScheduler*>(Data);
+    Self->PauseStart[ToPauseKind(Type)] = std::chrono::steady_clock::now();
+}
+
+void GcScheduler::OnGCEpilogue(v8::Isolate* Isolate, v8::GCType Type, v8::GCCallbackFlags Flags, void* Data)
+{
+    auto Self = static_cast<GcScheduler*>(Data);
+    int Kind = ToPauseKind(Type);
+    auto Elapsed = std::chrono::steady_clock::now() - Self->PauseStart[Kind];
+    Self->Record(Kind, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count()));
+}
+#endif
+
+// NODE_OPTIONS里--name=value或者--name_with_underscore=value的值，没有返回0
+static uint32_t HeapFlagFromNodeOptions(const char* Dashed, const char* Underscored)
+{
+    const char* Options = getenv("NODE_OPTIONS");
+    if (!Options)
+    {
+        return 0;
+    }
+    uint32_t Value = 0;
+    for (const char* Name : {Dashed, Underscored})
+    {
+        // 同一个flag出现多次时以最后一次为准
+        for (const char* Found = strstr(Options, Name); Found; Found = strstr(Found + 1, Name))
+        {
+            Value = static_cast<uint32_t>(strtoul(Found + strlen(Name), nullptr, 10));
+        }
+    }
+    return Value;
+}
+
+static std::mutex HeapSizeFlagsMutex;
+
+ScopedHeapSizeFlags::ScopedHeapSizeFlags(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB)
+{
+#if !defined(WITH_QUICKJS)
+    if (MaxYoungGenerationSizeMB == 0 && MaxOldGenerationSizeMB == 0)
+    {
+        return;
+    }
+    Lock = std::unique_lock<std::mutex>(HeapSizeFlagsMutex);
+    std::string Flags;
+    if (MaxYoungGenerationSizeMB > 0)
+    {
+        // v8的新生代大小是semi space的3倍
+        Flags += " --max-semi-space-size=" + std::to_string((MaxYoungGenerationSizeMB + 2) / 3);
+        RestoreFlags += " --max-semi-space-size=" +
+                        std::to_string(HeapFlagFromNodeOptions("--max-semi-space-size=", "--max_semi_space_size="));
+    }
+    if (MaxOldGenerationSizeMB > 0)
+    {
+        Flags += " --max-old-space-size=" + std::to_string(MaxOldGenerationSizeMB);
+        RestoreFlags += " --max-old-space-size=" +
+                        std::to_string(HeapFlagFromNodeOptions("--max-old-space-size=", "--max_old_space_size="));
+    }
+    v8::V8::SetFlagsFromString(Flags.c_str(), static_cast<int>(Flags.size()));
+#endif
+}
+
+ScopedHeapSizeFlags::~ScopedHeapSizeFlags()
+{
+#if !defined(WITH_QUICKJS)
+    if (!RestoreFlags.empty())
+    {
+        v8::V8::SetFlagsFromString(RestoreFlags.c_str(), static_cast<int>(RestoreFlags.size()));
+    }
+#endif
+}
+}    // namespace puerts
@@ -0,0 +1,118 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
+
+// bucket i统计[2^i, 2^(i+1))微秒的停顿，最后一个bucket收容所有更长的停顿
+#ifndef PUERTS_GC_HISTOGRAM_BUCKETS
+#define PUERTS_GC_HISTOGRAM_BUCKETS 20
+#endif
+
+namespace puerts
+{
+enum GcPauseKind
+{
+    GcPauseMinor = 0,          // scavenge / minor mark compact
+    GcPauseMajor = 1,          // full mark compact
+    GcPauseIncremental = 2,    // incremental marking steps and weak callback processing
+    GcPauseAll = 3,            // 查询时汇总以上三种
+};
+
+// 布局和C#侧的GcPauseStatistics一一对应，改动时两边一起改
+struct GcPauseStatistics
+{
+    uint64_t Count;
+
+    uint64_t TotalMicroseconds;
+
+    uint64_t MaxMicroseconds;
+
+    uint64_t Histogram[PUERTS_GC_HISTOGRAM_BUCKETS];
+};
+
+// 让宿主把每帧剩余的时间交给v8做gc，转发平台的内存压力信号，并统计gc停顿时间。
+// 除MemoryPressure外都要在isolate所在的线程调用（THREAD_SAFE下要持有Locker），MemoryPressure可以在任意线程调用。
+// quickjs后端下都是空操作
+class GcScheduler
+{
+public:
+    GcScheduler();
+
+    ~GcScheduler();
+
+    // 在v8::Isolate::New之前调用，0表示沿用v8的默认值
+    static void ApplyResourceConstraints(v8::Isolate::CreateParams& Params, uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB);
+
+    void Attach(v8::Isolate* InIsolate, v8::Platform* InPlatform);
+
+    // 必须在isolate Dispose之前调用
+    void Detach();
+
+    // BudgetSeconds是这一帧还剩下的时间，低于MinIdleSeconds的预算直接忽略，避免为了零碎时间打断帧。
+    // 返回true表示v8认为已经没有可以在空闲时间完成的gc工作了
+    bool NotifyIdle(double BudgetSeconds);
+
+    // Level: 0 none, 1 moderate, 2 critical, same as v8::MemoryPressureLevel
+    // v8允许在其它线程调用MemoryPressureNotification，不需要Locker，和Detach之间用PressureMutex互斥
+    void MemoryPressure(int Level);
+
+    // Kind取GcPauseKind
+    GcPauseStatistics GetStatistics(int Kind) const;
+
+    void ResetStatistics();
+
+    double MinIdleSeconds = 0.001;
+
+private:
+#if !defined(WITH_QUICKJS)
+    static void OnGCPrologue(v8::Isolate* Isolate, v8::GCType Type, v8::GCCallbackFlags Flags, void* Data);
+
+    static void OnGCEpilogue(v8::Isolate* Isolate, v8::GCType Type, v8::GCCallbackFlags Flags, void* Data);
+#endif
+
+    void Record(int Kind, uint64_t Microseconds);
+
+    v8::Isolate* Isolate;
+
+    v8::Platform* Platform;
+
+    std::mutex PressureMutex;
+
+    std::chrono::steady_clock::time_point PauseStart[GcPauseAll];
+
+    GcPauseStatistics Statistics[GcPauseAll];
+};
+
+// node::NewIsolate不接受CreateParams，只能用flag临时指定堆大小：构造时设置，析构时恢复成之前的值。
+// flag是进程全局的，整个作用域内持有一把全局锁，同时创建的isolate不会互相覆盖。
+// v8没有读取flag的接口，之前的值取自NODE_OPTIONS（node初始化时会交给v8），没有就是v8的默认值0
+class ScopedHeapSizeFlags
+{
+public:
+    ScopedHeapSizeFlags(uint32_t MaxYoungGenerationSizeMB, uint32_t MaxOldGenerationSizeMB);
+
+    ~ScopedHeapSizeFlags();
+
+    ScopedHeapSizeFlags(const ScopedHeapSizeFlags&) = delete;
+    ScopedHeapSizeFlags& operator=(const ScopedHeapSizeFlags&) = delete;
+
+private:
+    std::unique_lock<std::mutex> Lock;
+
+    std::string RestoreFlags;
+};
+}    // namespace puerts
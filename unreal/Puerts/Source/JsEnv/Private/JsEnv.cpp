@@ -49,6 +49,52 @@ void FJsEnv::RequestFullGarbageCollectionForTesting()
     GameScript->RequestFullGarbageCollectionForTesting();
 }
 
+bool FJsEnv::StartCpuProfile(int32 SamplingIntervalUs)
+{
+    return GameScript->StartCpuProfile(SamplingIntervalUs);
+}
+
+bool FJsEnv::StopCpuProfile(const FString& Path)
+{
+    return GameScript->StopCpuProfile(Path);
+}
+
+bool FJsEnv::TakeHeapSnapshot(const FString& Path)
+{
+    return GameScript->TakeHeapSnapshot(Path);
+}
+
+bool FJsEnv::StartSamplingHeapProfiler(uint64 SampleInterval, int32 StackDepth)
+{
+    return GameScript->StartSamplingHeapProfiler(SampleInterval, StackDepth);
+}
+
+bool FJsEnv::StopSamplingHeapProfiler(const FString& Path)
+{
+    return GameScript->StopSamplingHeapProfiler(Path);
+}
+
+bool FJsEnv::NotifyIdle(double BudgetSeconds)
+{
+    return GameScript->NotifyIdle(BudgetSeconds);
+}
+
+void FJsEnv::MemoryPressureNotification(int32 Level)
+{
+    GameScript->MemoryPressureNotification(Level);
+}
+
+void FJsEnv::GetGcPauseStatistics(
+    int32 Kind, uint64& OutCount, uint64& OutTotalMicroseconds, uint64& OutMaxMicroseconds, TArray<uint64>& OutHistogram)
+{
+    GameScript->GetGcPauseStatistics(Kind, OutCount, OutTotalMicroseconds, OutMaxMicroseconds, OutHistogram);
+}
+
+void FJsEnv::ResetGcPauseStatistics()
+{
+    GameScript->ResetGcPauseStatistics();
+}
+
 void FJsEnv::WaitDebugger(double timeout)
 {
     GameScript->WaitDebugger(timeout);
@@ -76,6 +122,11 @@ void FJsEnv::InitExtensionMethodsMap()
     GameScript->InitExtensionMethodsMap();
 }
 
+void FJsEnv::AddMessagePort(const FString& Name, std::shared_ptr<MessagePort> Port)
+{
+    GameScript->AddMessagePort(Name, Port);
+}
+
 void FJsEnv::ReloadModule(FName ModuleName, const FString& JsSource)
 {
     GameScript->ReloadModule(ModuleName, JsSource);
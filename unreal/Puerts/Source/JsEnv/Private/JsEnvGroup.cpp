@@ -11,9 +11,88 @@
 #include "JsEnvImpl.h"
 #include "TsDynamicInvoker.h"
 #include "DynamicInvoker.h"
+#include "V8Utils.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include <atomic>
 
 namespace puerts
 {
+// 一个env独占的工作线程，任务队列是无锁的多生产者单消费者队列
+class FJsEnvWorker : public FRunnable
+{
+public:
+    FJsEnvWorker(FJsEnvImpl* InJsEnv, int Index)
+        : JsEnv(InJsEnv), WakeUp(FPlatformProcess::GetSynchEventFromPool(false)), Stopping(false)
+    {
+        Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("PuertsJsEnvWorker%d"), Index));
+    }
+
+    virtual ~FJsEnvWorker() override
+    {
+        Stop();
+        Thread->WaitForCompletion();
+        delete Thread;
+        FPlatformProcess::ReturnSynchEventToPool(WakeUp);
+    }
+
+    void Post(FJsEnvGroup::FJob&& Job)
+    {
+        Jobs.Enqueue(MoveTemp(Job));
+        WakeUp->Trigger();
+    }
+
+    virtual uint32 Run() override
+    {
+        FV8Utils::IsJsEnvWorkerThread() = true;
+        while (!Stopping)
+        {
+            WakeUp->Wait();
+            RunPendingJobs();
+        }
+        // Stop之前投递的任务也要执行完
+        RunPendingJobs();
+        return 0;
+    }
+
+    virtual void Stop() override
+    {
+        Stopping = true;
+        WakeUp->Trigger();
+    }
+
+private:
+    void RunPendingJobs()
+    {
+        FJsEnvGroup::FJob Job;
+        while (Jobs.Dequeue(Job))
+        {
+            // 每个任务单独拿锁，游戏线程可以在两个任务之间进入env
+            JsEnv->RunInIsolate([&Job](v8::Isolate* Isolate, v8::Local<v8::Context> Context) { Job(Isolate, Context); });
+        }
+    }
+
+    FJsEnvImpl* JsEnv;
+
+    FEvent* WakeUp;
+
+    std::atomic<bool> Stopping;
+
+    TQueue<FJsEnvGroup::FJob, EQueueMode::Mpsc> Jobs;
+
+    FRunnableThread* Thread;
+};
+
+struct FJsEnvGroupParallel
+{
+    std::vector<std::unique_ptr<FJsEnvWorker>> Workers;
+
+    // StopParallelExecution开始后为true，之后投递的任务都按串行模式处理
+    std::atomic<bool> Stopping{false};
+};
+
 class FGroupDynamicInvoker : public ITsDynamicInvoker, public IDynamicInvoker
 {
 public:
@@ -128,10 +207,21 @@ void FJsEnvGroup::Init()
         JsEnvs[i]->TsDynamicInvoker = GroupDynamicInvoker;
         JsEnvs[i]->MixinInvoker = GroupDynamicInvoker;
     }
+    SyncPointTickerHandle = FUETicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda(
+                                                                     [this](float)
+                                                                     {
+                                                                         SyncPoint();
+                                                                         return true;
+                                                                     }),
+        0);
 }
 
 FJsEnvGroup::~FJsEnvGroup()
 {
+    StopParallelExecution();
+    FUETicker::GetCoreTicker().RemoveTicker(SyncPointTickerHandle);
+    // 其它线程投递过来还没执行的任务和命令要在env销毁前跑完
+    SyncPoint();
     JsEnvList.clear();
 }
 
@@ -167,6 +257,17 @@ void FJsEnvGroup::ReloadModule(FName ModuleName, const FString& JsSource)
     }
 }
 
+void FJsEnvGroup::ConnectMessagePorts(int IndexA, int IndexB, const FString& Name, int Capacity)
+{
+    check(IsInGameThread());
+    check(IndexA >= 0 && IndexA < JsEnvList.size() && IndexB >= 0 && IndexB < JsEnvList.size() && IndexA != IndexB);
+    std::shared_ptr<MessagePort> PortA;
+    std::shared_ptr<MessagePort> PortB;
+    MessagePort::CreatePair(PortA, PortB, Capacity);
+    JsEnvList[IndexA]->AddMessagePort(Name, PortA);
+    JsEnvList[IndexB]->AddMessagePort(Name, PortB);
+}
+
 std::shared_ptr<IJsEnv> FJsEnvGroup::Get(int Index)
 {
     return JsEnvList[Index];
@@ -181,5 +282,112 @@ void FJsEnvGroup::SetJsEnvSelector(std::function<int(UObject*, int)> InSelector)
     }
 }
 
+bool FJsEnvGroup::StartParallelExecution()
+{
+    check(IsInGameThread());
+#ifdef THREAD_SAFE
+    // Parallel只在游戏线程修改，这里直接读；StopParallelExecution是同步的，不会看到正在停止的状态
+    if (Parallel.load())
+    {
+        return true;
+    }
+    auto NewParallel = std::make_unique<FJsEnvGroupParallel>();
+    for (int i = 0; i < JsEnvList.size(); i++)
+    {
+        auto JsEnv = static_cast<FJsEnvImpl*>(JsEnvList[i].get());
+        // 工作线程上gc触发的UnBind等要回到游戏线程做的事，在同步点执行
+        JsEnv->GameThreadDispatcher = [this](TUniqueFunction<void()> Command) { EnqueueSyncPointCommand(MoveTemp(Command)); };
+        NewParallel->Workers.push_back(std::make_unique<FJsEnvWorker>(JsEnv, i));
+    }
+    Parallel.store(NewParallel.release());
+    return true;
+#else
+    UE_LOG(Puerts, Error, TEXT("parallel execution of FJsEnvGroup requires THREAD_SAFE, set ThreadSafe = true in JsEnv.Build.cs"));
+    return false;
+#endif
+}
+
+void FJsEnvGroup::StopParallelExecution()
+{
+    check(IsInGameThread());
+    FJsEnvGroupParallel* Current = Parallel.load();
+    if (!Current)
+    {
+        return;
+    }
+    Current->Stopping = true;
+    // 等已经看到旧状态、正在往工作线程队列里投递的PostJob返回，之后的PostJob都会看到Stopping，不再访问Workers
+    WaitPostingJobs();
+    // 等工作线程把队列里的任务跑完：任务里还可能PostJob，这时都已经按串行模式交给游戏线程了
+    Current->Workers.clear();
+    for (int i = 0; i < JsEnvList.size(); i++)
+    {
+        static_cast<FJsEnvImpl*>(JsEnvList[i].get())->GameThreadDispatcher = nullptr;
+    }
+    Parallel.store(nullptr);
+    // 还拿着旧指针读Stopping的也要等它们走完才能释放
+    WaitPostingJobs();
+    delete Current;
+    SyncPoint();
+}
+
+bool FJsEnvGroup::IsParallelExecution() const
+{
+    ++PostingJobs;
+    FJsEnvGroupParallel* Current = Parallel.load();
+    const bool Result = Current && !Current->Stopping;
+    --PostingJobs;
+    return Result;
+}
+
+void FJsEnvGroup::WaitPostingJobs()
+{
+    while (PostingJobs.load() > 0)
+    {
+        FPlatformProcess::Yield();
+    }
+}
+
+void FJsEnvGroup::PostJob(int Index, FJob Job)
+{
+    check(Index >= 0 && Index < JsEnvList.size());
+    // 不拿锁：先登记正在投递再读Parallel，StopParallelExecution置Stopping后会等登记的都返回才停掉工作线程
+    ++PostingJobs;
+    FJsEnvGroupParallel* Current = Parallel.load();
+    if (Current && !Current->Stopping)
+    {
+        Current->Workers[Index]->Post(MoveTemp(Job));
+        --PostingJobs;
+        return;
+    }
+    --PostingJobs;
+    FJsEnvImpl* JsEnv = static_cast<FJsEnvImpl*>(JsEnvList[Index].get());
+    if (IsInGameThread())
+    {
+        JsEnv->RunInIsolate([&Job](v8::Isolate* Isolate, v8::Local<v8::Context> Context) { Job(Isolate, Context); });
+    }
+    else
+    {
+        EnqueueSyncPointCommand(
+            [JsEnv, Job = MoveTemp(Job)]() mutable
+            { JsEnv->RunInIsolate([&Job](v8::Isolate* Isolate, v8::Local<v8::Context> Context) { Job(Isolate, Context); }); });
+    }
+}
+
+void FJsEnvGroup::EnqueueSyncPointCommand(TUniqueFunction<void()> Command)
+{
+    SyncPointCommands.Enqueue(MoveTemp(Command));
+}
+
+void FJsEnvGroup::SyncPoint()
+{
+    check(IsInGameThread());
+    TUniqueFunction<void()> Command;
+    while (SyncPointCommands.Dequeue(Command))
+    {
+        Command();
+    }
+}
+
 }    // namespace puerts
 #endif
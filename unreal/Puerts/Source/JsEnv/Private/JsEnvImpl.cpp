@@ -11,6 +11,7 @@
 #include "DynamicDelegateProxy.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "HAL/FileManager.h"
 #include "StructWrapper.h"
 #include "DelegateWrapper.h"
 #include "ContainerWrapper.h"
@@ -38,6 +39,8 @@
 #pragma warning(pop)
 
 #include "V8InspectorImpl.h"
+#include "V8ProfilerImpl.h"
+#include "Misc/CoreDelegates.h"
 #if USE_WASM3
 #include "WasmModuleInstance.h"
 #endif
@@ -68,17 +71,6 @@
 
 #endif
 
-#else
-#if PLATFORM_WINDOWS
-#include <windows.h>
-#elif PLATFORM_LINUX
-#include <sys/epoll.h>
-#elif PLATFORM_MAC
-#include <sys/select.h>
-#include <sys/sysctl.h>
-#include <sys/time.h>
-#include <sys/types.h>
-#endif
 #endif
 
 #if !defined(ENGINE_INDEPENDENT_JSENV)
@@ -156,58 +148,53 @@ static void ToCPtrArray(const v8::FunctionCallbackInfo<v8::Value>& Info)
     Info.GetReturnValue().Set(Ret);
 }
 
-#if defined(WITH_NODEJS)
-void FJsEnvImpl::StartPolling()
+#ifdef PUERTS_CALL_STATISTICS
+// puerts.getCallStatistics(reset?: boolean): { ticksPerSecond, entries: { name, calls, totalMs, histogram }[] }
+static void GetCallStatisticsCallback(const v8::FunctionCallbackInfo<v8::Value>& Info)
 {
-    uv_async_init(&NodeUVLoop, &DummyUVHandle, nullptr);
-    uv_sem_init(&PollingSem, 0);
-    uv_thread_create(
-        &PollingThread,
-        [](void* arg)
-        {
-            auto* self = static_cast<FJsEnvImpl*>(arg);
-            while (true)
-            {
-                uv_sem_wait(&self->PollingSem);
-
-                if (self->PollingClosed)
-                    break;
-
-                self->PollEvents();
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
 
-                if (self->PollingClosed)
-                    break;
+    double TicksPerSecond = GetCallStatisticsTicksPerSecond();
+    int Count = 0;
+    const CallStatisticsEntry* Entries = GetCallStatistics(&Count);
 
-                self->LastJob = FFunctionGraphTask::CreateAndDispatchWhenReady(
-                    [self]() { self->UvRunOnce(); }, TStatId{}, nullptr, ENamedThreads::GameThread);
-            }
-        },
-        this);
+    v8::Local<v8::Array> EntryArray = v8::Array::New(Isolate);
+    for (int i = 0; i < Count; ++i)
+    {
+        const CallStatisticsEntry& Entry = Entries[i];
+        v8::Local<v8::Array> Histogram = v8::Array::New(Isolate);
+        for (int j = 0; j < PUERTS_CALL_STATISTICS_BUCKETS; ++j)
+        {
+            Histogram->Set(Context, j, v8::Number::New(Isolate, static_cast<double>(Entry.Histogram[j].load(std::memory_order_relaxed)))).Check();
+        }
+        v8::Local<v8::Object> Item = v8::Object::New(Isolate);
+        Item->Set(Context, FV8Utils::ToV8String(Isolate, "name"), FV8Utils::ToV8String(Isolate, Entry.Name)).Check();
+        Item->Set(Context, FV8Utils::ToV8String(Isolate, "calls"), v8::Number::New(Isolate, static_cast<double>(GetCallCount(Entry)))).Check();
+        Item->Set(Context, FV8Utils::ToV8String(Isolate, "totalMs"),
+                v8::Number::New(Isolate, GetEstimatedTotalTicks(Entry) * 1000.0 / TicksPerSecond))
+            .Check();
+        Item->Set(Context, FV8Utils::ToV8String(Isolate, "histogram"), Histogram).Check();
+        EntryArray->Set(Context, i, Item).Check();
+    }
+
+    v8::Local<v8::Object> Result = v8::Object::New(Isolate);
+    Result->Set(Context, FV8Utils::ToV8String(Isolate, "ticksPerSecond"), v8::Number::New(Isolate, TicksPerSecond)).Check();
+    Result->Set(Context, FV8Utils::ToV8String(Isolate, "entries"), EntryArray).Check();
+    Info.GetReturnValue().Set(Result);
 
-#if PLATFORM_WINDOWS
-    // on single-core the io comp port NumberOfConcurrentThreads needs to be 2
-    // to avoid cpu pegging likely caused by a busy loop in PollEvents
-    if (FPlatformMisc::NumberOfCores() == 1)
+    if (Info.Length() > 0 && Info[0]->BooleanValue(Isolate))
     {
-        if (NodeUVLoop.iocp && NodeUVLoop.iocp != INVALID_HANDLE_VALUE)
-            CloseHandle(NodeUVLoop.iocp);
-        NodeUVLoop.iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 2);
+        ResetCallStatistics();
     }
-#elif PLATFORM_LINUX
-    Epoll = epoll_create(1);
-    int backend_fd = uv_backend_fd(&NodeUVLoop);
-    struct epoll_event ev = {0};
-    ev.events = EPOLLIN;
-    ev.data.fd = backend_fd;
-    epoll_ctl(Epoll, EPOLL_CTL_ADD, backend_fd, &ev);
-    NodeUVLoop.data = this;
-    NodeUVLoop.on_watcher_queue_updated = OnWatcherQueueChanged;
-
-#elif PLATFORM_MAC
-    NodeUVLoop.data = this;
-    NodeUVLoop.on_watcher_queue_updated = OnWatcherQueueChanged;
+}
 #endif
+
+#if defined(WITH_NODEJS)
+bool FJsEnvImpl::UvPumpTick(float)
+{
     UvRunOnce();
+    return true;
 }
 
 void FJsEnvImpl::UvRunOnce()
@@ -224,7 +211,9 @@ void FJsEnvImpl::UvRunOnce()
     // TODO: catch uv_run可以让脚本错误不至于进程退出，但这不知道会不会对node有什么副作用
     v8::TryCatch TryCatch(Isolate);
 
-    uv_run(&NodeUVLoop, UV_RUN_NOWAIT);
+    // 只有libuv确实有事可做时才跑uv_run，空闲帧只是一次零超时的poll。
+    // v8的前台任务和延时任务不走uv loop（platform的async handle是unref的），所以DrainTasks每帧都要执行
+    NodeUVPump.RunIfReady();
     if (TryCatch.HasCaught())
     {
         Logger->Error(FString::Printf(TEXT("uv_run throw: %s"), *FV8Utils::TryCatchToString(Isolate, &TryCatch)));
@@ -233,92 +222,6 @@ void FJsEnvImpl::UvRunOnce()
     {
         static_cast<node::MultiIsolatePlatform*>(IJsEnvModule::Get().GetV8Platform())->DrainTasks(Isolate);
     }
-
-    LastJob = nullptr;
-
-    // Tell the Polling thread to continue.
-    uv_sem_post(&PollingSem);
-}
-
-void FJsEnvImpl::PollEvents()
-{
-#if PLATFORM_WINDOWS
-    DWORD bytes;
-    DWORD timeout = uv_backend_timeout(&NodeUVLoop);
-    ULONG_PTR key;
-    OVERLAPPED* overlapped;
-
-    timeout = timeout > 100 ? 100 : timeout;
-
-    GetQueuedCompletionStatus(NodeUVLoop.iocp, &bytes, &key, &overlapped, timeout);
-
-    // Give the event back so libuv can deal with it.
-    if (overlapped != NULL)
-        PostQueuedCompletionStatus(NodeUVLoop.iocp, bytes, key, overlapped);
-#elif PLATFORM_LINUX
-    int timeout = uv_backend_timeout(&NodeUVLoop);
-    timeout = (timeout > 100 || timeout < 0) ? 100 : timeout;
-
-    // Wait for new libuv events.
-    int r;
-    do
-    {
-        struct epoll_event ev;
-        r = epoll_wait(Epoll, &ev, 1, timeout);
-    } while (r == -1 && errno == EINTR);
-#elif PLATFORM_MAC
-    struct timeval tv;
-    int timeout = uv_backend_timeout(&NodeUVLoop);
-    timeout = (timeout > 100 || timeout < 0) ? 100 : timeout;
-    if (timeout != -1)
-    {
-        tv.tv_sec = timeout / 1000;
-        tv.tv_usec = (timeout % 1000) * 1000;
-    }
-
-    fd_set readset;
-    int fd = uv_backend_fd(&NodeUVLoop);
-    FD_ZERO(&readset);
-    FD_SET(fd, &readset);
-
-    // Wait for new libuv events.
-    int r;
-    do
-    {
-        r = select(fd + 1, &readset, nullptr, nullptr, timeout == -1 ? nullptr : &tv);
-    } while (r == -1 && errno == EINTR);
-#endif
-}
-
-void FJsEnvImpl::OnWatcherQueueChanged(uv_loop_t* loop)
-{
-#if !PLATFORM_WINDOWS
-    FJsEnvImpl* self = static_cast<FJsEnvImpl*>(loop->data);
-    self->WakeupPollingThread();
-#endif
-}
-
-void FJsEnvImpl::WakeupPollingThread()
-{
-    uv_async_send(&DummyUVHandle);
-}
-
-void FJsEnvImpl::StopPolling()
-{
-    PollingClosed = true;
-
-    uv_sem_post(&PollingSem);
-
-    WakeupPollingThread();
-
-    uv_thread_join(&PollingThread);
-
-    if (LastJob)
-    {
-        LastJob->Wait();
-    }
-
-    uv_sem_destroy(&PollingSem);
 }
 
 #endif
@@ -350,11 +253,18 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
         for (auto& Flag : Flags)
         {
             static FString Max_Old_Space_Size_Name(TEXT("--max-old-space-size="));
+            static FString Max_Semi_Space_Size_Name(TEXT("--max-semi-space-size="));
             if (Flag.StartsWith(Max_Old_Space_Size_Name))
             {
                 size_t Val = FCString::Atoi(*Flag.Mid(Max_Old_Space_Size_Name.Len()));
                 CreateParams.constraints.set_max_old_generation_size_in_bytes(Val * 1024 * 1024);
             }
+            else if (Flag.StartsWith(Max_Semi_Space_Size_Name))
+            {
+                // v8的新生代大小是semi space的3倍
+                uint32 Val = FCString::Atoi(*Flag.Mid(Max_Semi_Space_Size_Name.Len()));
+                GcScheduler::ApplyResourceConstraints(CreateParams, Val * 3, 0);
+            }
         }
 #else
         v8::V8::SetFlagsFromString(TCHAR_TO_UTF8(*InFlags));
@@ -364,6 +274,7 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
     Started = false;
     Inspector = nullptr;
     InspectorChannel = nullptr;
+    Profiler = nullptr;
 
     ModuleLoader = std::move(InModuleLoader);
     Logger = InLogger;
@@ -387,6 +298,7 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
     check(!InExternalRuntime && !InExternalContext);
     MainIsolate = v8::Isolate::New(CreateParams);
 #endif
+    GcScheduler.Attach(MainIsolate, static_cast<v8::Platform*>(IJsEnvModule::Get().GetV8Platform()));
     auto Isolate = MainIsolate;
 #ifdef THREAD_SAFE
     v8::Locker Locker(Isolate);
@@ -421,6 +333,7 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
 
     auto Platform = static_cast<node::MultiIsolatePlatform*>(IJsEnvModule::Get().GetV8Platform());
     MainIsolate = node::NewIsolate(NodeArrayBufferAllocator.get(), &NodeUVLoop, Platform);
+    GcScheduler.Attach(MainIsolate, Platform);
 
     auto Isolate = MainIsolate;
 #ifdef THREAD_SAFE
@@ -470,9 +383,12 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
     // the same as raw v8
     Isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
 
-    StartPolling();
+    UvRunOnce();
+    UvPumpTickerHandle = FUETicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FJsEnvImpl::UvPumpTick), 0);
 #endif
 
+    MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddRaw(this, &FJsEnvImpl::OnMemoryTrim);
+
     v8::Local<v8::Object> Global = Context->Global();
 
     v8::Local<v8::Object> PuertsObj = v8::Object::New(Isolate);
@@ -498,6 +414,8 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
 
     MethodBindingHelper<&FJsEnvImpl::MergeObject>::Bind(Isolate, Context, Global, "__tgjsMergeObject", This);
 
+    Global->Set(Context, FV8Utils::ToV8String(Isolate, "__tgjsRefCell"), CreateRefCellClass(Context)).Check();
+
     MethodBindingHelper<&FJsEnvImpl::NewObjectByClass>::Bind(Isolate, Context, Global, "__tgjsNewObject", This);
 
     MethodBindingHelper<&FJsEnvImpl::NewStructByScriptStruct>::Bind(Isolate, Context, Global, "__tgjsNewStruct", This);
@@ -515,6 +433,12 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
     MethodBindingHelper<&FJsEnvImpl::DispatchProtocolMessage>::Bind(
         Isolate, Context, Global, "__tgjsDispatchProtocolMessage", This);
 
+    MethodBindingHelper<&FJsEnvImpl::InvalidateModules>::Bind(Isolate, Context, Global, "__tgjsInvalidateModules", This);
+
+#ifndef WITH_QUICKJS
+    Isolate->SetHostInitializeImportMetaObjectCallback(&FJsEnvImpl::HostInitializeImportMetaObject);
+#endif
+
     Isolate->SetPromiseRejectCallback(&PromiseRejectCallback<FJsEnvImpl>);
     Global
         ->Set(Context, FV8Utils::ToV8String(Isolate, "__tgjsSetPromiseRejectCallback"),
@@ -545,6 +469,8 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
 
     MethodBindingHelper<&FJsEnvImpl::DumpStatisticsLog>::Bind(Isolate, Context, Global, "dumpStatisticsLog", This);
 
+    MethodBindingHelper<&FJsEnvImpl::GetMessagePort>::Bind(Isolate, Context, PuertsObj, "getMessagePort", This);
+
     Global
         ->Set(Context, FV8Utils::ToV8String(Isolate, "__tgjsFNameToArrayBuffer"),
             v8::FunctionTemplate::New(Isolate, FNameToArrayBuffer)->GetFunction(Context).ToLocalChecked())
@@ -560,6 +486,13 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
             v8::FunctionTemplate::New(Isolate, ToCPtrArray)->GetFunction(Context).ToLocalChecked())
         .Check();
 
+#ifdef PUERTS_CALL_STATISTICS
+    PuertsObj
+        ->Set(Context, FV8Utils::ToV8String(Isolate, "getCallStatistics"),
+            v8::FunctionTemplate::New(Isolate, GetCallStatisticsCallback)->GetFunction(Context).ToLocalChecked())
+        .Check();
+#endif
+
 #if !defined(WITH_QUICKJS)
     PuertsObj
         ->Set(Context, FV8Utils::ToV8String(Isolate, "load"),
@@ -625,6 +558,10 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
         Isolate, PuertsObj->Get(Context, FV8Utils::ToV8String(Isolate, "getESMMain")).ToLocalChecked().As<v8::Function>());
 
     ReloadJs.Reset(Isolate, PuertsObj->Get(Context, FV8Utils::ToV8String(Isolate, "__reload")).ToLocalChecked().As<v8::Function>());
+#ifndef WITH_QUICKJS
+    CreateHotContext.Reset(
+        Isolate, PuertsObj->Get(Context, FV8Utils::ToV8String(Isolate, "__createHotContext")).ToLocalChecked().As<v8::Function>());
+#endif
 #if !PUERTS_FORCE_CPP_UFUNCTION
     MergePrototype.Reset(
         Isolate, PuertsObj->Get(Context, FV8Utils::ToV8String(Isolate, "__mergePrototype")).ToLocalChecked().As<v8::Function>());
@@ -660,6 +597,19 @@ FJsEnvImpl::FJsEnvImpl(std::shared_ptr<IJSModuleLoader> InModuleLoader, std::sha
 FJsEnvImpl::~FJsEnvImpl()
 {
 #if USE_WASM3
+    {
+        auto Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+        v8::Locker Locker(Isolate);
+#endif
+        v8::Isolate::Scope IsolateScope(Isolate);
+        TArray<uint16> Seqs;
+        PuertsWasmMemoryBuffers.GetKeys(Seqs);
+        for (uint16 Seq : Seqs)
+        {
+            DetachWasmMemoryBuffer(Seq);
+        }
+    }
     PuertsWasmRuntimeList.Empty();
     PuertsWasmEnv.reset();
     for (auto Item : PuertsWasmCachedLinkFunctionList)
@@ -674,8 +624,9 @@ FJsEnvImpl::~FJsEnvImpl()
     ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
 #endif
 #if defined(WITH_NODEJS)
-    StopPolling();
+    FUETicker::GetCoreTicker().RemoveTicker(UvPumpTickerHandle);
 #endif
+    FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
 
 #ifndef WITH_QUICKJS
     for (auto& KV : HashToModuleInfo)
@@ -684,6 +635,8 @@ FJsEnvImpl::~FJsEnvImpl()
     }
     HashToModuleInfo.clear();
     PathToModule.Empty();
+    ModuleImporters.Empty();
+    ModuleImports.Empty();
 #endif
 
     for (int i = 0; i < ManualReleaseCallbackList.size(); i++)
@@ -698,10 +651,15 @@ FJsEnvImpl::~FJsEnvImpl()
     Require.Reset();
     GetESMMain.Reset();
     ReloadJs.Reset();
+#ifndef WITH_QUICKJS
+    CreateHotContext.Reset();
+#endif
     JsPromiseRejectCallback.Reset();
 
     FUETicker::GetCoreTicker().RemoveTicker(DelegateProxiesCheckerHandler);
 
+    FUETicker::GetCoreTicker().RemoveTicker(MessagePortTickerHandle);
+
     {
         auto Isolate = MainIsolate;
 #ifdef THREAD_SAFE
@@ -710,6 +668,8 @@ FJsEnvImpl::~FJsEnvImpl()
         v8::Isolate::Scope IsolateScope(Isolate);
         v8::HandleScope HandleScope(Isolate);
 
+        MessagePorts.clear();
+
         TypeToTemplateInfoMap.Empty();
 
         CppObjectMapper.UnInitialize(Isolate);
@@ -718,12 +678,7 @@ FJsEnvImpl::~FJsEnvImpl()
 
         for (auto& KV : StructCache)
         {
-            FObjectCacheNode* PNode = &KV.Value;
-            while (PNode)
-            {
-                PNode->Value.Reset();
-                PNode = PNode->Next;
-            }
+            KV.Value.ForEach([](FObjectCacheNode::FEntry& Entry) { Entry.Value.Reset(); });
         }
 
         for (auto& KV : ContainerCache)
@@ -836,6 +791,12 @@ FJsEnvImpl::~FJsEnvImpl()
             Inspector = nullptr;
         }
 
+        if (Profiler)
+        {
+            delete Profiler;
+            Profiler = nullptr;
+        }
+
         DynamicInvoker.Reset();
         MixinInvoker.Reset();
 
@@ -870,7 +831,9 @@ FJsEnvImpl::~FJsEnvImpl()
     }
 #endif
 
+    PropertyStringCache.Clear();
     DefaultContext.Reset();
+    GcScheduler.Detach();
     MainIsolate->Dispose();
     MainIsolate = nullptr;
     delete CreateParams.array_buffer_allocator;
@@ -880,16 +843,15 @@ FJsEnvImpl::~FJsEnvImpl()
     // quickjs will call UnBind in vm dispose, so cleanup move to here
     for (auto& KV : StructCache)
     {
-        FObjectCacheNode* PNode = &KV.Value;
-        while (PNode)
-        {
-            if (PNode->UserData)
+        KV.Value.ForEach(
+            [&KV](FObjectCacheNode::FEntry& Entry)
             {
-                FScriptStructWrapper* ScriptStructWrapper = (FScriptStructWrapper*) (PNode->UserData);
-                ScriptStructWrapper->Free(KV.Key);
-            }
-            PNode = PNode->Next;
-        }
+                if (Entry.UserData)
+                {
+                    FScriptStructWrapper* ScriptStructWrapper = (FScriptStructWrapper*) (Entry.UserData);
+                    ScriptStructWrapper->Free(KV.Key, &StructAllocator);
+                }
+            });
     }
     StructCache.Empty();
 }
@@ -1083,7 +1045,7 @@ void FJsEnvImpl::NewStructByScriptStruct(const v8::FunctionCallbackInfo<v8::Valu
 
     if (ScriptStruct)
     {
-        void* Ptr = FScriptStructWrapper::Alloc(ScriptStruct);
+        void* Ptr = FScriptStructWrapper::Alloc(ScriptStruct, &StructAllocator);
 
         Info.GetReturnValue().Set(
             FV8Utils::IsolateData<IObjectMapper>(Isolate)->FindOrAddStruct(Isolate, Context, ScriptStruct, Ptr, false));
@@ -1137,6 +1099,325 @@ void FJsEnvImpl::RequestFullGarbageCollectionForTesting()
 #endif
 }
 
+static std::string ProfileOutputPath(const FString& Path)
+{
+    const FString FullPath = FPaths::ConvertRelativePathToFull(Path);
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(FullPath), true);
+    return TCHAR_TO_UTF8(*FullPath);
+}
+
+V8Profiler* FJsEnvImpl::GetProfiler()
+{
+    if (!Profiler)
+    {
+        Profiler = CreateV8Profiler(MainIsolate);
+    }
+    return Profiler;
+}
+
+bool FJsEnvImpl::StartCpuProfile(int32 SamplingIntervalUs)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+
+    auto P = GetProfiler();
+    if (!P || !P->StartCpuProfile(SamplingIntervalUs))
+    {
+        Logger->Warn(TEXT("StartCpuProfile failed, not supported by backend or already started"));
+        return false;
+    }
+    return true;
+}
+
+bool FJsEnvImpl::StopCpuProfile(const FString& Path)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+    if (!Profiler || !Profiler->IsCpuProfiling())
+    {
+        return false;
+    }
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+
+    if (!Profiler->StopCpuProfile(ProfileOutputPath(Path)))
+    {
+        Logger->Error(FString::Printf(TEXT("StopCpuProfile: can not write %s"), *Path));
+        return false;
+    }
+    return true;
+}
+
+bool FJsEnvImpl::TakeHeapSnapshot(const FString& Path)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+
+    auto P = GetProfiler();
+    if (!P)
+    {
+        Logger->Warn(TEXT("TakeHeapSnapshot not supported by backend"));
+        return false;
+    }
+    if (!P->TakeHeapSnapshot(ProfileOutputPath(Path)))
+    {
+        Logger->Error(FString::Printf(TEXT("TakeHeapSnapshot: can not write %s"), *Path));
+        return false;
+    }
+    return true;
+}
+
+bool FJsEnvImpl::StartSamplingHeapProfiler(uint64 SampleInterval, int32 StackDepth)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+
+    auto P = GetProfiler();
+    if (!P || !P->StartSamplingHeapProfiler(SampleInterval, StackDepth))
+    {
+        Logger->Warn(TEXT("StartSamplingHeapProfiler failed, not supported by backend or already started"));
+        return false;
+    }
+    return true;
+}
+
+bool FJsEnvImpl::StopSamplingHeapProfiler(const FString& Path)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+    if (!Profiler || !Profiler->IsSamplingHeapProfiling())
+    {
+        return false;
+    }
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+
+    if (!Profiler->StopSamplingHeapProfiler(ProfileOutputPath(Path)))
+    {
+        Logger->Error(FString::Printf(TEXT("StopSamplingHeapProfiler: can not write %s"), *Path));
+        return false;
+    }
+    return true;
+}
+
+void FJsEnvImpl::RunOnGameThread(TUniqueFunction<void()> Func)
+{
+    if (GameThreadDispatcher && !IsInGameThread())
+    {
+        GameThreadDispatcher(MoveTemp(Func));
+    }
+    else
+    {
+        Func();
+    }
+}
+
+void FJsEnvImpl::RunInIsolate(TFunctionRef<void(v8::Isolate*, v8::Local<v8::Context>)> Job)
+{
+    auto Isolate = MainIsolate;
+#ifdef THREAD_SAFE
+    v8::Locker Locker(Isolate);
+#endif
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    auto Context = v8::Local<v8::Context>::New(Isolate, DefaultContext);
+    v8::Context::Scope ContextScope(Context);
+    v8::TryCatch TryCatch(Isolate);
+
+    Job(Isolate, Context);
+
+    if (TryCatch.HasCaught())
+    {
+        Logger->Error(FString::Printf(TEXT("js job exception %s"), *FV8Utils::TryCatchToString(Isolate, &TryCatch)));
+    }
+}
+
+bool FJsEnvImpl::NotifyIdle(double BudgetSeconds)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate::Scope IsolateScope(MainIsolate);
+    return GcScheduler.NotifyIdle(BudgetSeconds);
+}
+
+// v8允许在其它线程调用MemoryPressureNotification，这里不加锁也不校验线程
+void FJsEnvImpl::MemoryPressureNotification(int32 Level)
+{
+    GcScheduler.MemoryPressure(Level);
+}
+
+void FJsEnvImpl::OnMemoryTrim()
+{
+    GcScheduler.MemoryPressure(2);    // critical
+}
+
+#if !defined(WITH_QUICKJS)
+class FUObjectMessageHost : public MessageHostDelegate
+{
+public:
+    explicit FUObjectMessageHost(FJsEnvImpl* InEnv) : Env(InEnv)
+    {
+    }
+
+    virtual bool WriteHostObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Object> Object,
+        v8::ValueSerializer& Serializer, Message& Msg) override
+    {
+        // struct、容器等其它带internal field的对象不支持，只认ObjectMap里的UObject包装
+        UObject* Ptr = static_cast<UObject*>(FV8Utils::GetPointer(Object));
+        if (!Ptr || !Env->IsUObjectWrapper(Isolate, Ptr, Object) || UEObjectIsPendingKill(Ptr))
+        {
+            return false;
+        }
+        const int32 Index = GUObjectArray.ObjectToIndex(Ptr);
+        Serializer.WriteUint32(static_cast<uint32>(Index));
+        Serializer.WriteUint32(static_cast<uint32>(GUObjectArray.AllocateSerialNumber(Index)));
+        return true;
+    }
+
+    virtual v8::MaybeLocal<v8::Object> ReadHostObject(
+        v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::ValueDeserializer& Deserializer) override
+    {
+        uint32 Index;
+        uint32 SerialNumber;
+        if (!Deserializer.ReadUint32(&Index) || !Deserializer.ReadUint32(&SerialNumber))
+        {
+            FV8Utils::ThrowException(Isolate, "invalid UObject in message");
+            return v8::MaybeLocal<v8::Object>();
+        }
+        // 和FWeakObjectPtr::Get一样的判断：下标被复用或者已经不可达时当作null
+        FUObjectItem* Item = GUObjectArray.IndexToObject(static_cast<int32>(Index));
+        UObject* Object = (Item && Item->GetSerialNumber() == static_cast<int32>(SerialNumber) && !Item->IsUnreachable())
+                              ? static_cast<UObject*>(Item->Object)
+                              : nullptr;
+        if (!Object || UEObjectIsPendingKill(Object))
+        {
+            // ReadHostObject必须返回对象，用一个空对象占位
+            return v8::Object::New(Isolate);
+        }
+        return Env->FindOrAdd(Isolate, Context, Object->GetClass(), Object).As<v8::Object>();
+    }
+
+    FJsEnvImpl* Env;
+};
+#endif
+
+bool FJsEnvImpl::IsUObjectWrapper(v8::Isolate* Isolate, UObject* Object, v8::Local<v8::Object> JsObject)
+{
+    auto Cached = ObjectMap.Find(Object);
+    return Cached && Cached->Get(Isolate) == JsObject;
+}
+
+void FJsEnvImpl::AddMessagePort(const FString& Name, std::shared_ptr<MessagePort> Port)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+    if (MessagePorts.empty())
+    {
+#if !defined(WITH_QUICKJS)
+        MessageHost = std::make_unique<FUObjectMessageHost>(this);
+#endif
+        MessagePortTickerHandle =
+            FUETicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FJsEnvImpl::DispatchMessages), 0);
+    }
+    {
+#ifdef THREAD_SAFE
+        v8::Locker Locker(MainIsolate);
+#endif
+        v8::Isolate::Scope IsolateScope(MainIsolate);
+        MessagePorts[Name] = std::make_unique<MessagePortBinding>(Port, MessageHost.get());
+    }
+}
+
+void FJsEnvImpl::GetMessagePort(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    v8::Context::Scope ContextScope(Context);
+
+    CHECK_V8_ARGS(EArgString);
+
+    auto Iter = MessagePorts.find(FV8Utils::ToFString(Isolate, Info[0]));
+    if (Iter == MessagePorts.end())
+    {
+        return;
+    }
+    Info.GetReturnValue().Set(Iter->second->GetJsObject(Isolate, Context));
+}
+
+bool FJsEnvImpl::DispatchMessages(float)
+{
+#ifdef SINGLE_THREAD_VERIFY
+    ensureMsgf(BoundThreadId == FPlatformTLS::GetCurrentThreadId(), TEXT("Access by illegal thread!"));
+#endif
+#ifdef THREAD_SAFE
+    v8::Locker Locker(MainIsolate);
+#endif
+    v8::Isolate* Isolate = MainIsolate;
+    v8::Isolate::Scope IsolateScope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = DefaultContext.Get(Isolate);
+    v8::Context::Scope ContextScope(Context);
+
+    for (auto& KV : MessagePorts)
+    {
+        std::string Error;
+        KV.second->Dispatch(Isolate, Context, Error);
+        if (!Error.empty())
+        {
+            Logger->Error(
+                FString::Printf(TEXT("Exception in onmessage of port %s: %s"), *KV.first, UTF8_TO_TCHAR(Error.c_str())));
+        }
+    }
+    return true;
+}
+
+void FJsEnvImpl::GetGcPauseStatistics(
+    int32 Kind, uint64& OutCount, uint64& OutTotalMicroseconds, uint64& OutMaxMicroseconds, TArray<uint64>& OutHistogram)
+{
+    GcPauseStatistics Statistics = GcScheduler.GetStatistics(Kind);
+    OutCount = Statistics.Count;
+    OutTotalMicroseconds = Statistics.TotalMicroseconds;
+    OutMaxMicroseconds = Statistics.MaxMicroseconds;
+    OutHistogram.SetNumUninitialized(PUERTS_GC_HISTOGRAM_BUCKETS);
+    for (int32 i = 0; i < PUERTS_GC_HISTOGRAM_BUCKETS; ++i)
+    {
+        OutHistogram[i] = Statistics.Histogram[i];
+    }
+}
+
+void FJsEnvImpl::ResetGcPauseStatistics()
+{
+    GcScheduler.ResetStatistics();
+}
+
 #if !defined(ENGINE_INDEPENDENT_JSENV)
 void FJsEnvImpl::FinishInjection(UClass* InClass)
 {
@@ -1719,7 +2000,26 @@ void FJsEnvImpl::UnBind(UClass* Class, UObject* UEObject, bool ResetPointer)
             DataTransfer::SetPointer(Isolate, JsObject, nullptr, 1);
         }
         ObjectMap.Remove(UEObject);
-        UserObjectRetainer.Release(UEObject);
+        if (GameThreadDispatcher && !IsInGameThread())
+        {
+            // 并行模式下gc发生在工作线程，UObject的引用回到游戏线程再释放。
+            // 在那之前同一个UObject可能又被绑定了，这时引用要留给新的js对象
+            GameThreadDispatcher(
+                [this, UEObject]()
+                {
+#ifdef THREAD_SAFE
+                    v8::Locker Locker(MainIsolate);
+#endif
+                    if (!ObjectMap.Contains(UEObject))
+                    {
+                        UserObjectRetainer.Release(UEObject);
+                    }
+                });
+        }
+        else
+        {
+            UserObjectRetainer.Release(UEObject);
+        }
     }
 }
 
@@ -2182,6 +2482,7 @@ void FJsEnvImpl::InvokeMixinMethod(UObject* ContextObject, UJSGeneratedFunction*
 
     v8::TryCatch TryCatch(Isolate);
 
+    PUERTS_CALL_STATISTICS_SCOPE(Function->FunctionTranslator->Statistics);
     Function->FunctionTranslator->CallJs(Isolate, Context, JsFuncPtr->Get(Isolate), Self, ContextObject, Stack, RESULT_PARAM);
 
     if (TryCatch.HasCaught())
@@ -2762,14 +3063,15 @@ void FJsEnvImpl::BindStruct(
 
     if (!PassByPointer)
     {
-        auto CacheNodePtr = StructCache.Find(Ptr);
-        if (CacheNodePtr)
+        auto HeaderPtr = StructCache.Find(Ptr);
+        FObjectCacheNode::FEntry* CacheNodePtr;
+        if (HeaderPtr)
         {
-            CacheNodePtr = CacheNodePtr->Add(ScriptStructWrapper->Struct.Get());
+            CacheNodePtr = HeaderPtr->Add(ScriptStructWrapper->Struct.Get());
         }
         else
         {
-            CacheNodePtr = &StructCache.Emplace(Ptr, FObjectCacheNode(ScriptStructWrapper->Struct.Get()));
+            CacheNodePtr = StructCache.Emplace(Ptr, FObjectCacheNode(ScriptStructWrapper->Struct.Get())).Find(ScriptStructWrapper->Struct.Get());
         }
         CacheNodePtr->Value.Reset(MainIsolate, JSObject);
         CacheNodePtr->UserData = ScriptStructWrapper;
@@ -2778,14 +3080,15 @@ void FJsEnvImpl::BindStruct(
     }
     else
     {
-        auto CacheNodePtr = StructCache.Find(Ptr);
-        if (CacheNodePtr)
+        auto HeaderPtr = StructCache.Find(Ptr);
+        FObjectCacheNode::FEntry* CacheNodePtr;
+        if (HeaderPtr)
         {
-            CacheNodePtr = CacheNodePtr->Add(ScriptStructWrapper->Struct.Get());
+            CacheNodePtr = HeaderPtr->Add(ScriptStructWrapper->Struct.Get());
         }
         else
         {
-            CacheNodePtr = &StructCache.Emplace(Ptr, FObjectCacheNode(ScriptStructWrapper->Struct.Get()));
+            CacheNodePtr = StructCache.Emplace(Ptr, FObjectCacheNode(ScriptStructWrapper->Struct.Get())).Find(ScriptStructWrapper->Struct.Get());
         }
         CacheNodePtr->Value.Reset(MainIsolate, JSObject);
         CacheNodePtr->Value.SetWeak<FScriptStructWrapper>(
@@ -2804,8 +3107,8 @@ void FJsEnvImpl::UnBindStruct(FScriptStructWrapper* ScriptStructWrapper, void* P
     auto CacheNodePtr = StructCache.Find(Ptr);
     if (CacheNodePtr)
     {
-        (void) (CacheNodePtr->Remove(ScriptStructWrapper->Struct.Get(), true));
-        if (!CacheNodePtr->TypeId)    // last one
+        CacheNodePtr->Remove(ScriptStructWrapper->Struct.Get());
+        if (CacheNodePtr->IsEmpty())    // last one
         {
             StructCache.Remove(Ptr);
         }
@@ -3413,6 +3716,60 @@ v8::MaybeLocal<v8::Module> FJsEnvImpl::ResolveModuleCallback(
     return (*ItRefModule).Get(Context->GetIsolate());
 }
 
+void FJsEnvImpl::HostInitializeImportMetaObject(
+    v8::Local<v8::Context> Context, v8::Local<v8::Module> Module, v8::Local<v8::Object> Meta)
+{
+    const auto Isolate = Context->GetIsolate();
+    auto Self = static_cast<FJsEnvImpl*>(FV8Utils::IsolateData<IObjectMapper>(Isolate));
+    const auto ItModuleInfo = Self->FindModuleInfo(Module);
+    if (ItModuleInfo == Self->HashToModuleInfo.end() || ItModuleInfo->second->Path.IsEmpty() || Self->CreateHotContext.IsEmpty())
+    {
+        return;
+    }
+    v8::Local<v8::Value> Args[] = {FV8Utils::ToV8String(Isolate, ItModuleInfo->second->Path)};
+    v8::Local<v8::Value> Hot;
+    if (Self->CreateHotContext.Get(Isolate)->Call(Context, v8::Undefined(Isolate), 1, Args).ToLocal(&Hot))
+    {
+        __USE(Meta->CreateDataProperty(Context, FV8Utils::ToV8String(Isolate, "hot"), Hot));
+    }
+}
+
+void FJsEnvImpl::ForgetModuleImports(const FString& Path)
+{
+    TSet<FString> Imports;
+    if (!ModuleImports.RemoveAndCopyValue(Path, Imports))
+    {
+        return;
+    }
+    for (const FString& Importee : Imports)
+    {
+        if (TSet<FString>* Importers = ModuleImporters.Find(Importee))
+        {
+            Importers->Remove(Path);
+            if (Importers->Num() == 0)
+            {
+                ModuleImporters.Remove(Importee);
+            }
+        }
+    }
+}
+
+void FJsEnvImpl::RemoveESModule(v8::Isolate* Isolate, const FString& Path)
+{
+    v8::Global<v8::Module>* Module = PathToModule.Find(Path);
+    if (!Module)
+    {
+        return;
+    }
+    const auto ItModuleInfo = FindModuleInfo(Module->Get(Isolate));
+    if (ItModuleInfo != HashToModuleInfo.end())
+    {
+        delete ItModuleInfo->second;
+        HashToModuleInfo.erase(ItModuleInfo);
+    }
+    PathToModule.Remove(Path);
+}
+
 v8::MaybeLocal<v8::Module> FJsEnvImpl::FetchCJSModuleAsESModule(v8::Local<v8::Context> Context, const FString& ModuleName)
 {
 #if V8_MAJOR_VERSION < 8
@@ -3534,6 +3891,7 @@ v8::MaybeLocal<v8::Module> FJsEnvImpl::FetchESModuleTree(v8::Local<v8::Context>
     PathToModule.Add(FileName, v8::Global<v8::Module>(Isolate, Module));
     FModuleInfo* Info = new FModuleInfo;
     Info->Module.Reset(Isolate, Module);
+    Info->Path = FileName;
     HashToModuleInfo.emplace(Module->GetIdentityHash(), Info);
 
     auto DirName = FPaths::GetPath(FileName);
@@ -3578,6 +3936,11 @@ v8::MaybeLocal<v8::Module> FJsEnvImpl::FetchESModuleTree(v8::Local<v8::Context>
                     return v8::MaybeLocal<v8::Module>();
                 }
                 Info->ResolveCache.Add(RefModuleName, v8::Global<v8::Module>(Isolate, RefModule.ToLocalChecked()));
+                if (OutPath != FileName)
+                {
+                    ModuleImports.FindOrAdd(FileName).Add(OutPath);
+                    ModuleImporters.FindOrAdd(OutPath).Add(FileName);
+                }
                 continue;
             }
         }
@@ -4126,6 +4489,14 @@ void FJsEnvImpl::Mixin(const v8::FunctionCallbackInfo<v8::Value>& Info)
         {
             auto JsFunc = MixinMethods->Get(Context, Key).ToLocalChecked();
             auto MixinedFunc = UJSGeneratedClass::Mixin(Isolate, New, Function, MixinInvoker, TakeJsObjectRef, !NoWarning);
+#ifdef PUERTS_CALL_STATISTICS
+            // 被替换的函数和js调用ue共用同名的翻译器条目，mixin方向（ue调用js）单独统计
+            if (auto JSGeneratedFunction = Cast<UJSGeneratedFunction>(MixinedFunc))
+            {
+                JSGeneratedFunction->FunctionTranslator->Statistics =
+                    RegisterCallStatistics(TCHAR_TO_UTF8(*(TEXT("mixin ") + To->GetName() + TEXT(".") + MethodName.ToString())));
+            }
+#endif
             MixinFunctionMap.Emplace(
                 MixinedFunc, v8::UniquePersistent<v8::Function>(Isolate, v8::Local<v8::Function>::Cast(JsFunc)));
             ReplaceMethodNames.Add(MethodName);
@@ -4208,8 +4579,12 @@ void FJsEnvImpl::SetInspectorCallback(const v8::FunctionCallbackInfo<v8::Value>&
     v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
     v8::Context::Scope ContextScope(Context);
 
+    // 返回false表示没有开inspector，hot_reload.js据此不走Debugger.setScriptSource
     if (!Inspector)
+    {
+        Info.GetReturnValue().Set(false);
         return;
+    }
 
     CHECK_V8_ARGS(EArgFunction);
 
@@ -4240,6 +4615,7 @@ void FJsEnvImpl::SetInspectorCallback(const v8::FunctionCallbackInfo<v8::Value>&
     }
 
     InspectorMessageHandler.Reset(Isolate, v8::Local<v8::Function>::Cast(Info[0]));
+    Info.GetReturnValue().Set(true);
 #endif    // !WITH_QUICKJS
 }
 
@@ -4263,6 +4639,102 @@ void FJsEnvImpl::DispatchProtocolMessage(const v8::FunctionCallbackInfo<v8::Valu
 #endif    // !WITH_QUICKJS
 }
 
+static void ToFStringArray(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Value> Value, TArray<FString>& Out)
+{
+    if (!Value->IsArray())
+    {
+        return;
+    }
+    v8::Local<v8::Array> Array = Value.As<v8::Array>();
+    for (uint32_t i = 0, Length = Array->Length(); i < Length; i++)
+    {
+        v8::Local<v8::Value> Element;
+        if (Array->Get(Context, i).ToLocal(&Element) && Element->IsString())
+        {
+            Out.Add(FV8Utils::ToFString(Isolate, Element));
+        }
+    }
+}
+
+static v8::Local<v8::Array> ToV8Array(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const TArray<FString>& Strings)
+{
+    v8::Local<v8::Array> Array = v8::Array::New(Isolate, Strings.Num());
+    for (int32 i = 0; i < Strings.Num(); i++)
+    {
+        __USE(Array->Set(Context, i, FV8Utils::ToV8String(Isolate, Strings[i])));
+    }
+    return Array;
+}
+
+void FJsEnvImpl::InvalidateModules(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+#ifndef WITH_QUICKJS
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Isolate::Scope Isolatescope(Isolate);
+    v8::HandleScope HandleScope(Isolate);
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    v8::Context::Scope ContextScope(Context);
+
+    CHECK_V8_ARGS(EArgObject, EArgObject);
+
+    TArray<FString> Changed;
+    ToFStringArray(Isolate, Context, Info[0], Changed);
+    TArray<FString> AcceptedList;
+    ToFStringArray(Isolate, Context, Info[1], AcceptedList);
+    TSet<FString> Accepted;
+    Accepted.Append(AcceptedList);
+
+    // 文件监听给的可能是绝对路径，PathToModule的key是ModuleLoader搜出来的路径
+    TArray<FString> Queue;
+    for (const FString& ChangedPath : Changed)
+    {
+        for (auto& KV : PathToModule)
+        {
+            if (FPaths::IsSamePath(KV.Key, ChangedPath))
+            {
+                Queue.Add(KV.Key);
+                break;
+            }
+        }
+    }
+
+    TSet<FString> Visited;
+    TArray<FString> Invalidated;
+    TArray<FString> Boundaries;
+    for (int32 i = 0; i < Queue.Num(); i++)
+    {
+        // Queue在循环里会扩容，先复制出来
+        const FString Path = Queue[i];
+        // 没加载过的模块不用处理，之后import时自然会读新的内容
+        if (Visited.Contains(Path) || !PathToModule.Contains(Path))
+        {
+            continue;
+        }
+        Visited.Add(Path);
+        Invalidated.Add(Path);
+
+        const TSet<FString>* Importers = ModuleImporters.Find(Path);
+        if (Accepted.Contains(Path) || !Importers)
+        {
+            Boundaries.Add(Path);
+            continue;
+        }
+        Queue.Append(Importers->Array());
+    }
+
+    for (const FString& Path : Invalidated)
+    {
+        ForgetModuleImports(Path);
+        RemoveESModule(Isolate, Path);
+    }
+
+    auto Result = v8::Object::New(Isolate);
+    __USE(Result->Set(Context, FV8Utils::ToV8String(Isolate, "invalidated"), ToV8Array(Isolate, Context, Invalidated)));
+    __USE(Result->Set(Context, FV8Utils::ToV8String(Isolate, "boundaries"), ToV8Array(Isolate, Context, Boundaries)));
+    Info.GetReturnValue().Set(Result);
+#endif    // !WITH_QUICKJS
+}
+
 void FJsEnvImpl::DumpStatisticsLog(const v8::FunctionCallbackInfo<v8::Value>& Info)
 {
 #ifndef WITH_QUICKJS
@@ -4296,6 +4768,59 @@ void FJsEnvImpl::DumpStatisticsLog(const v8::FunctionCallbackInfo<v8::Value>& In
         Statistics.external_memory(), Statistics.peak_malloced_memory(), Statistics.number_of_native_contexts(),
         Statistics.number_of_detached_contexts(), Statistics.does_zap_garbage());
 
+#ifdef WITH_V8_FAST_CALL
+    StatisticsLog += TEXT("Fast Call Statistics (fast/slow):\n");
+    auto DumpFastCallStatistics = [&StatisticsLog](const char* ClassName, const JSFunctionInfo* FunctionInfo)
+    {
+        while (FunctionInfo && FunctionInfo->Name && FunctionInfo->Callback)
+        {
+            const FastCallStatistics* Stats = FunctionInfo->ReflectionInfo ? FunctionInfo->ReflectionInfo->FastCallStats() : nullptr;
+            if (Stats && (Stats->FastHits.load() > 0 || Stats->SlowHits.load() > 0))
+            {
+                StatisticsLog += FString::Printf(TEXT("%s.%s: %llu/%llu\n"), UTF8_TO_TCHAR(ClassName),
+                    UTF8_TO_TCHAR(FunctionInfo->Name), Stats->FastHits.load(), Stats->SlowHits.load());
+            }
+            ++FunctionInfo;
+        }
+    };
+    puerts::ForeachRegisterClass(
+        [&](const JSClassDefinition* ClassDefinition)
+        {
+            const char* ClassName = ClassDefinition->ScriptName ? ClassDefinition->ScriptName : ClassDefinition->UETypeName;
+            if (!ClassName)
+                return;
+            DumpFastCallStatistics(ClassName, ClassDefinition->Methods);
+            DumpFastCallStatistics(ClassName, ClassDefinition->Functions);
+        });
+    StatisticsLog += TEXT("------------------------\n");
+#endif
+
+#ifdef PUERTS_CALL_STATISTICS
+    {
+        // 按总耗时排序，只输出前32个
+        int Count = 0;
+        const CallStatisticsEntry* Entries = GetCallStatistics(&Count);
+        TArray<const CallStatisticsEntry*> Sorted;
+        for (int i = 0; i < Count; ++i)
+        {
+            if (GetCallCount(Entries[i]) > 0)
+            {
+                Sorted.Add(&Entries[i]);
+            }
+        }
+        Sorted.Sort([](const CallStatisticsEntry& A, const CallStatisticsEntry& B)
+            { return GetEstimatedTotalTicks(A) > GetEstimatedTotalTicks(B); });
+        double TicksPerSecond = GetCallStatisticsTicksPerSecond();
+        StatisticsLog += TEXT("Call Statistics (calls/total ms):\n");
+        for (int i = 0; i < Sorted.Num() && i < 32; ++i)
+        {
+            StatisticsLog += FString::Printf(TEXT("%s: %llu/%.3f\n"), UTF8_TO_TCHAR(Sorted[i]->Name), GetCallCount(*Sorted[i]),
+                GetEstimatedTotalTicks(*Sorted[i]) * 1000.0 / TicksPerSecond);
+        }
+        StatisticsLog += TEXT("------------------------\n");
+    }
+#endif
+
     Logger->Info(StatisticsLog);
 #endif    // !WITH_QUICKJS
 }
@@ -4360,11 +4885,18 @@ void FJsEnvImpl::Wasm_MemoryBuffer(const v8::FunctionCallbackInfo<v8::Value>& In
     {
         if (Runtime->GetRuntimeSeq() == Seq)
         {
+            if (auto Cached = PuertsWasmMemoryBuffers.Find(Seq))
+            {
+                Info.GetReturnValue().Set(Cached->Get(Isolate));
+                return;
+            }
             int Length = 0;
             uint8* Ptr = Runtime->GetBuffer(Length);
             if (Ptr)
             {
                 auto Buffer = DataTransfer::NewArrayBuffer(Context, Ptr, Length);
+                PuertsWasmMemoryBuffers.Add(Seq, v8::Global<v8::ArrayBuffer>(Isolate, Buffer));
+                Runtime->SetMemoryResizeCallback([this](WasmRuntime* Resized) { DetachWasmMemoryBuffer(Resized->GetRuntimeSeq()); });
                 Info.GetReturnValue().Set(Buffer);
             }
             else
@@ -4378,6 +4910,25 @@ void FJsEnvImpl::Wasm_MemoryBuffer(const v8::FunctionCallbackInfo<v8::Value>& In
     return;
 }
 
+// grow之后旧的ArrayBuffer指向已经释放的内存，跟浏览器一样把它Detach掉（byteLength变为0），js侧再取memory.buffer会拿到新的
+void FJsEnvImpl::DetachWasmMemoryBuffer(uint16 Seq)
+{
+    auto Found = PuertsWasmMemoryBuffers.Find(Seq);
+    if (!Found)
+    {
+        return;
+    }
+    v8::Global<v8::ArrayBuffer> Buffer = std::move(*Found);
+    PuertsWasmMemoryBuffers.Remove(Seq);
+    v8::HandleScope HandleScope(MainIsolate);
+    auto ArrayBuffer = Buffer.Get(MainIsolate);
+    if (ArrayBuffer->IsDetachable())
+    {
+        ArrayBuffer->Detach();
+    }
+    Buffer.Reset();
+}
+
 void FJsEnvImpl::Wasm_TableGrowth(const v8::FunctionCallbackInfo<v8::Value>& Info)
 {
     v8::Isolate* Isolate = Info.GetIsolate();
@@ -4503,23 +5054,9 @@ void FJsEnvImpl::Wasm_Instance(const v8::FunctionCallbackInfo<v8::Value>& Info)
     }
     v8::Local<v8::Object> ExportsObject = Info[2].As<v8::Object>();
 
-    v8::Local<v8::ArrayBuffer> InArrayBuffer;
-    if (Info[0]->IsArrayBuffer())
-    {
-        InArrayBuffer = Info[0].As<v8::ArrayBuffer>();
-    }
-    else if (Info[0]->IsTypedArray())
-    {
-        InArrayBuffer = Info[0].As<v8::TypedArray>()->Buffer();
-    }
-
-    void* Buffer = static_cast<char*>(DataTransfer::GetArrayBufferData(InArrayBuffer));
-    int BufferLength = InArrayBuffer->ByteLength();
-
-    TArray<uint8> InData;
-    InData.Append((uint8*) Buffer, BufferLength);
-    auto Runtime = NormalInstanceModule(
-        Isolate, Context, InData, ExportsObject, Info[1], PuertsWasmRuntimeList, PuertsWasmCachedLinkFunctionList);
+    // 字节码不拷贝，NormalInstanceModule在执行完导入对象上的js之后才去取
+    auto Runtime = NormalInstanceModule(Isolate, Context, Info[0], ExportsObject, Info[1], PuertsWasmRuntimeList,
+        PuertsWasmCachedLinkFunctionList);
     if (Runtime)
     {
         Info.GetReturnValue().Set(Runtime->GetRuntimeSeq());
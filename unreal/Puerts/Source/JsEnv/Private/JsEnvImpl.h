@@ -33,12 +33,16 @@
 #pragma warning(pop)
 
 #include "V8InspectorImpl.h"
+#include "V8ProfilerImpl.h"
+#include "GcScheduler.h"
+#include "MessagePort.h"
 
 #if defined(WITH_NODEJS)
 #pragma warning(push, 0)
 #include "node.h"
 #include "uv.h"
 #pragma warning(pop)
+#include "UvPump.h"
 #endif
 
 #if USE_WASM3
@@ -90,6 +94,25 @@ public:
 
     virtual void RequestFullGarbageCollectionForTesting() override;
 
+    virtual bool StartCpuProfile(int32 SamplingIntervalUs) override;
+
+    virtual bool StopCpuProfile(const FString& Path) override;
+
+    virtual bool TakeHeapSnapshot(const FString& Path) override;
+
+    virtual bool StartSamplingHeapProfiler(uint64 SampleInterval, int32 StackDepth) override;
+
+    virtual bool StopSamplingHeapProfiler(const FString& Path) override;
+
+    virtual bool NotifyIdle(double BudgetSeconds) override;
+
+    virtual void MemoryPressureNotification(int32 Level) override;
+
+    virtual void GetGcPauseStatistics(
+        int32 Kind, uint64& OutCount, uint64& OutTotalMicroseconds, uint64& OutMaxMicroseconds, TArray<uint64>& OutHistogram) override;
+
+    virtual void ResetGcPauseStatistics() override;
+
     virtual void WaitDebugger(double timeout) override
     {
 #ifdef THREAD_SAFE
@@ -129,6 +152,8 @@ public:
 
     virtual void OnSourceLoaded(std::function<void(const FString&)> Callback) override;
 
+    virtual void AddMessagePort(const FString& Name, std::shared_ptr<MessagePort> Port) override;
+
 public:
     bool IsTypeScriptGeneratedClass(UClass* Class);
 
@@ -154,6 +179,18 @@ public:
     virtual v8::Local<v8::Value> FindOrAddStruct(
         v8::Isolate* Isolate, v8::Local<v8::Context>& Context, UScriptStruct* ScriptStruct, void* Ptr, bool PassByPointer) override;
 
+    virtual FStructSlabAllocator* GetStructAllocator() override
+    {
+        return &StructAllocator;
+    }
+
+    virtual FPropertyStringCache* GetPropertyStringCache() override
+    {
+        return &PropertyStringCache;
+    }
+
+    virtual void RunOnGameThread(TUniqueFunction<void()> Func) override;
+
     virtual void BindCppObject(v8::Isolate* InIsolate, JSClassDefinition* ClassDefinition, void* Ptr,
         v8::Local<v8::Object> JSObject, bool PassByPointer) override;
 
@@ -221,6 +258,13 @@ public:
 
     void InvokeDelegateCallback(UDynamicDelegateProxy* Proxy, void* Params);
 
+    // 在调用线程上进入isolate和默认context执行Job，THREAD_SAFE下先拿v8::Locker，脚本异常写到Logger
+    void RunInIsolate(TFunctionRef<void(v8::Isolate*, v8::Local<v8::Context>)> Job);
+
+    // FJsEnvGroup并行模式下由它设置，把命令交给游戏线程的同步点执行，见RunOnGameThread。
+    // 只在工作线程都没启动的时候修改
+    TFunction<void(TUniqueFunction<void()>)> GameThreadDispatcher;
+
 #if !defined(ENGINE_INDEPENDENT_JSENV)
     void JsConstruct(UClass* Class, UObject* Object, const v8::UniquePersistent<v8::Function>& Constructor,
         const v8::UniquePersistent<v8::Object>& Prototype);
@@ -329,6 +373,11 @@ private:
 
     void DispatchProtocolMessage(const v8::FunctionCallbackInfo<v8::Value>& Info);
 
+    // __tgjsInvalidateModules(changed: string[], accepted: string[]): { invalidated: string[], boundaries: string[] }
+    // 从changed出发沿importer向上找出需要失效的es模块并移出缓存。accepted里的模块（import.meta.hot.accept过）以及
+    // 没有importer的模块是边界：自己失效但不再往上传播，重新执行这些边界就能把失效的模块重新加载一遍，见hot_reload.js
+    void InvalidateModules(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
 #ifndef WITH_QUICKJS
     v8::MaybeLocal<v8::Module> FetchESModuleTree(v8::Local<v8::Context> Context, const FString& FileName);
 
@@ -339,12 +388,21 @@ private:
         v8::Global<v8::Module> Module;
         TMap<FString, v8::Global<v8::Module>> ResolveCache;
         v8::Global<v8::Value> CJSValue;
+        // es模块是PathToModule里的key，commonjs包装出来的synthetic module为空
+        FString Path;
     };
 
     std::unordered_multimap<int, FModuleInfo*>::iterator FindModuleInfo(v8::Local<v8::Module> Module);
 
     static v8::MaybeLocal<v8::Module> ResolveModuleCallback(
         v8::Local<v8::Context> Context, v8::Local<v8::String> Specifier, v8::Local<v8::Module> Referrer);
+
+    static void HostInitializeImportMetaObject(v8::Local<v8::Context> Context, v8::Local<v8::Module> Module, v8::Local<v8::Object> Meta);
+
+    // 删掉Path指向其依赖的边，重新fetch时会再记录；指向Path的边保留
+    void ForgetModuleImports(const FString& Path);
+
+    void RemoveESModule(v8::Isolate* Isolate, const FString& Path);
 #endif
 
     struct ObjectMerger;
@@ -429,6 +487,10 @@ private:
     //在执行module.instance的时候,如果有指定memory,那么这个module对应会创建一个runtime
     TArray<std::shared_ptr<WasmRuntime>> PuertsWasmRuntimeList;
     TArray<WasmNormalLinkInfo*> PuertsWasmCachedLinkFunctionList;
+    // 直接指向wasm线性内存的ArrayBuffer，按runtime seq缓存；内存被realloc或者runtime销毁前会被Detach，下次访问buffer时重新创建
+    TMap<uint16, v8::Global<v8::ArrayBuffer>> PuertsWasmMemoryBuffers;
+
+    void DetachWasmMemoryBuffer(uint16 Seq);
 
 protected:
     void Wasm_NewMemory(const v8::FunctionCallbackInfo<v8::Value>& Info);
@@ -499,31 +561,13 @@ private:
 
     node::Environment* NodeEnv;
 
-    uv_thread_t PollingThread;
+    UvPump NodeUVPump{&NodeUVLoop};
 
-    uv_sem_t PollingSem;
+    FUETickDelegateHandle UvPumpTickerHandle;
 
-    uv_async_t DummyUVHandle;
-
-    bool PollingClosed = false;
-
-    FGraphEventRef LastJob;
-
-#if PLATFORM_LINUX
-    int Epoll;
-#endif
-
-    void StartPolling();
+    bool UvPumpTick(float);
 
     void UvRunOnce();
-
-    void PollEvents();
-
-    static void OnWatcherQueueChanged(uv_loop_t* loop);
-
-    void WakeupPollingThread();
-
-    void StopPolling();
 #endif
 
     v8::Isolate* MainIsolate;
@@ -536,6 +580,11 @@ private:
 
     v8::Global<v8::Function> ReloadJs;
 
+#ifndef WITH_QUICKJS
+    // hot_reload.js里的createHotContext，用来生成import.meta.hot
+    v8::Global<v8::Function> CreateHotContext;
+#endif
+
 #if !PUERTS_FORCE_CPP_UFUNCTION
     v8::Global<v8::Function> MergePrototype;
 #endif
@@ -552,6 +601,10 @@ private:
 
     TMap<void*, FObjectCacheNode> StructCache;
 
+    FStructSlabAllocator StructAllocator;
+
+    FPropertyStringCache PropertyStringCache;
+
     struct ContainerCacheItem
     {
         v8::UniquePersistent<v8::Value> Container;
@@ -692,6 +745,32 @@ private:
 
     v8::Global<v8::Function> InspectorMessageHandler;
 
+    V8Profiler* GetProfiler();
+
+    V8Profiler* Profiler;
+
+    puerts::GcScheduler GcScheduler;
+
+    FDelegateHandle MemoryTrimHandle;
+
+    void GetMessagePort(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+public:
+    bool IsUObjectWrapper(v8::Isolate* Isolate, UObject* Object, v8::Local<v8::Object> JsObject);
+
+private:
+
+    bool DispatchMessages(float);
+
+    // UObject按GUObjectArray的下标和序列号传递，收到时对象已经销毁就是null
+    std::unique_ptr<MessageHostDelegate> MessageHost;
+
+    std::map<FString, std::unique_ptr<MessagePortBinding>> MessagePorts;
+
+    FUETickDelegateHandle MessagePortTickerHandle;
+
+    void OnMemoryTrim();
+
     FContainerMeta ContainerMeta;
 
     v8::Global<v8::Map> ManualReleaseCallbackMap;
@@ -704,6 +783,10 @@ private:
     TMap<FString, v8::Global<v8::Module>> PathToModule;
 
     std::unordered_multimap<int, FModuleInfo*> HashToModuleInfo;
+
+    // es模块依赖图，FetchESModuleTree时记录，key和PathToModule一样
+    TMap<FString, TSet<FString>> ModuleImporters;    // importee -> importers
+    TMap<FString, TSet<FString>> ModuleImports;      // importer -> importees
 #endif
 
 #ifdef SINGLE_THREAD_VERIFY
@@ -0,0 +1,393 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "MessagePort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace puerts
+{
+struct MessagePort::Channel
+{
+    explicit Channel(size_t Capacity) : AToB(Capacity), BToA(Capacity), Closed(false)
+    {
+    }
+
+    SpscRing<Message>& Outgoing(int Side)
+    {
+        return Side == 0 ? AToB : BToA;
+    }
+
+    SpscRing<Message>& Incoming(int Side)
+    {
+        return Side == 0 ? BToA : AToB;
+    }
+
+    SpscRing<Message> AToB;
+
+    SpscRing<Message> BToA;
+
+    std::atomic<bool> Closed;
+};
+
+void MessagePort::CreatePair(std::shared_ptr<MessagePort>& OutA, std::shared_ptr<MessagePort>& OutB, size_t Capacity)
+{
+    auto Shared = std::make_shared<Channel>(Capacity);
+    OutA.reset(new MessagePort(Shared, 0));
+    OutB.reset(new MessagePort(Shared, 1));
+}
+
+bool MessagePort::Post(Message&& Msg)
+{
+    if (Shared->Closed.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return Shared->Outgoing(Side).Push(std::move(Msg));
+}
+
+bool MessagePort::Receive(Message& OutMsg)
+{
+    return Shared->Incoming(Side).Pop(OutMsg);
+}
+
+void MessagePort::Close()
+{
+    Shared->Closed.store(true, std::memory_order_release);
+}
+
+bool MessagePort::IsClosed() const
+{
+    return Shared->Closed.load(std::memory_order_acquire);
+}
+
+size_t MessagePort::Capacity() const
+{
+    return Shared->Incoming(Side).Capacity();
+}
+
+static void ThrowError(v8::Isolate* Isolate, const char* Message)
+{
+    Isolate->ThrowException(
+        v8::Exception::Error(v8::String::NewFromUtf8(Isolate, Message, v8::NewStringType::kNormal).ToLocalChecked()));
+}
+
+static void* GetBufferData(v8::Local<v8::ArrayBuffer> Buffer)
+{
+#if defined(HAS_ARRAYBUFFER_NEW_WITHOUT_STL)
+    size_t Length;
+    return v8::ArrayBuffer_Get_Data(Buffer, Length);
+#elif USING_IN_UNREAL_ENGINE
+    return Buffer->GetContents().Data();
+#else
+    return Buffer->GetBackingStore()->Data();
+#endif
+}
+
+#if !defined(WITH_QUICKJS)
+class SerializerDelegate : public v8::ValueSerializer::Delegate
+{
+public:
+    SerializerDelegate(v8::Isolate* InIsolate, v8::Local<v8::Context> InContext, MessageHostDelegate* InHost)
+        : Isolate(InIsolate), Context(InContext), Host(InHost), Serializer(nullptr), Msg(nullptr)
+    {
+    }
+
+    virtual void ThrowDataCloneError(v8::Local<v8::String> Message) override
+    {
+        Isolate->ThrowException(v8::Exception::Error(Message));
+    }
+
+    virtual v8::Maybe<bool> WriteHostObject(v8::Isolate* InIsolate, v8::Local<v8::Object> Object) override
+    {
+        if (Host && Host->WriteHostObject(InIsolate, Context, Object, *Serializer, *Msg))
+        {
+            return v8::Just(true);
+        }
+        ThrowError(InIsolate, "DataCloneError: this native object can not be posted");
+        return v8::Nothing<bool>();
+    }
+
+    v8::Isolate* Isolate;
+
+    v8::Local<v8::Context> Context;
+
+    MessageHostDelegate* Host;
+
+    v8::ValueSerializer* Serializer;
+
+    Message* Msg;
+};
+
+class DeserializerDelegate : public v8::ValueDeserializer::Delegate
+{
+public:
+    DeserializerDelegate(v8::Local<v8::Context> InContext, MessageHostDelegate* InHost)
+        : Context(InContext), Host(InHost), Deserializer(nullptr)
+    {
+    }
+
+    virtual v8::MaybeLocal<v8::Object> ReadHostObject(v8::Isolate* Isolate) override
+    {
+        if (Host)
+        {
+            return Host->ReadHostObject(Isolate, Context, *Deserializer);
+        }
+        ThrowError(Isolate, "DataCloneError: no host to read native object");
+        return v8::MaybeLocal<v8::Object>();
+    }
+
+    v8::Local<v8::Context> Context;
+
+    MessageHostDelegate* Host;
+
+    v8::ValueDeserializer* Deserializer;
+};
+#endif
+
+bool MessagePort::Serialize(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Value> Value,
+    v8::Local<v8::Value> TransferList, MessageHostDelegate* Host, Message& OutMsg,
+    std::vector<v8::Local<v8::ArrayBuffer>>& OutTransferred)
+{
+#if defined(WITH_QUICKJS)
+    ThrowError(Isolate, "postMessage is not supported by quickjs backend, use postRaw");
+    return false;
+#else
+    SerializerDelegate Delegate(Isolate, Context, Host);
+    v8::ValueSerializer Serializer(Isolate, &Delegate);
+    Delegate.Serializer = &Serializer;
+    Delegate.Msg = &OutMsg;
+    OutMsg.HostObjects.clear();
+    OutTransferred.clear();
+
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+    if (!TransferList.IsEmpty() && TransferList->IsArray())
+    {
+        auto Array = TransferList.As<v8::Array>();
+        for (uint32_t i = 0; i < Array->Length(); ++i)
+        {
+            v8::Local<v8::Value> Item;
+            if (!Array->Get(Context, i).ToLocal(&Item))
+            {
+                return false;
+            }
+            if (!Item->IsArrayBuffer() || !Item.As<v8::ArrayBuffer>()->IsDetachable())
+            {
+                ThrowError(Isolate, "DataCloneError: transferList only accept detachable ArrayBuffer");
+                return false;
+            }
+            Serializer.TransferArrayBuffer(static_cast<uint32_t>(OutTransferred.size()), Item.As<v8::ArrayBuffer>());
+            OutTransferred.push_back(Item.As<v8::ArrayBuffer>());
+        }
+    }
+#endif
+
+    Serializer.WriteHeader();
+    if (!Serializer.WriteValue(Context, Value).FromMaybe(false))
+    {
+        return false;
+    }
+
+    std::pair<uint8_t*, size_t> Buffer = Serializer.Release();
+    OutMsg.Raw = false;
+    OutMsg.Data.assign(Buffer.first, Buffer.first + Buffer.second);
+    // Delegate没有重载ReallocateBufferMemory，缓冲区是realloc出来的
+    free(Buffer.first);
+
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+    OutMsg.ArrayBuffers.clear();
+    for (auto& Item : OutTransferred)
+    {
+        OutMsg.ArrayBuffers.push_back(Item->GetBackingStore());
+    }
+#endif
+    return true;
+#endif
+}
+
+void MessagePort::DetachTransferred(const std::vector<v8::Local<v8::ArrayBuffer>>& Transferred)
+{
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+    for (auto& Item : Transferred)
+    {
+#if V8_MAJOR_VERSION >= 11
+        Item->Detach(v8::Local<v8::Value>()).Check();
+#else
+        Item->Detach();
+#endif
+    }
+#endif
+}
+
+v8::MaybeLocal<v8::Value> MessagePort::Deserialize(
+    v8::Isolate* Isolate, v8::Local<v8::Context> Context, Message& Msg, MessageHostDelegate* Host)
+{
+    if (Msg.Raw)
+    {
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+        // 把vector整个交给BackingStore，js侧的ArrayBuffer直接指向它
+        auto Bytes = new std::vector<uint8_t>(std::move(Msg.Data));
+        auto Backing = v8::ArrayBuffer::NewBackingStore(
+            Bytes->data(), Bytes->size(),
+            [](void*, size_t, void* DeleterData) { delete static_cast<std::vector<uint8_t>*>(DeleterData); }, Bytes);
+        return v8::ArrayBuffer::New(Isolate, std::move(Backing));
+#else
+        auto Buffer = v8::ArrayBuffer::New(Isolate, Msg.Data.size());
+        if (!Msg.Data.empty())
+        {
+            memcpy(GetBufferData(Buffer), Msg.Data.data(), Msg.Data.size());
+        }
+        return Buffer;
+#endif
+    }
+
+#if defined(WITH_QUICKJS)
+    ThrowError(Isolate, "structured message is not supported by quickjs backend");
+    return v8::MaybeLocal<v8::Value>();
+#else
+    DeserializerDelegate Delegate(Context, Host);
+    v8::ValueDeserializer Deserializer(Isolate, Msg.Data.data(), Msg.Data.size(), &Delegate);
+    Delegate.Deserializer = &Deserializer;
+
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+    for (size_t i = 0; i < Msg.ArrayBuffers.size(); ++i)
+    {
+        Deserializer.TransferArrayBuffer(
+            static_cast<uint32_t>(i), v8::ArrayBuffer::New(Isolate, std::move(Msg.ArrayBuffers[i])));
+    }
+    Msg.ArrayBuffers.clear();
+#endif
+
+    if (!Deserializer.ReadHeader(Context).FromMaybe(false))
+    {
+        return v8::MaybeLocal<v8::Value>();
+    }
+    return Deserializer.ReadValue(Context);
+#endif
+}
+
+v8::Local<v8::Object> MessagePortBinding::GetJsObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+{
+    if (!JsObject.IsEmpty())
+    {
+        return JsObject.Get(Isolate);
+    }
+    auto Self = v8::External::New(Isolate, this);
+    auto Object = v8::Object::New(Isolate);
+    auto SetMethod = [&](const char* Name, v8::FunctionCallback Callback)
+    {
+        auto Func = v8::FunctionTemplate::New(Isolate, Callback, Self)->GetFunction(Context).ToLocalChecked();
+        Object->Set(Context, v8::String::NewFromUtf8(Isolate, Name, v8::NewStringType::kNormal).ToLocalChecked(), Func)
+            .Check();
+    };
+    SetMethod("postMessage", OnPostMessage);
+    SetMethod("postRaw", OnPostRaw);
+    SetMethod("close", OnClose);
+    Object
+        ->Set(Context, v8::String::NewFromUtf8(Isolate, "onmessage", v8::NewStringType::kNormal).ToLocalChecked(),
+            v8::Null(Isolate))
+        .Check();
+    JsObject.Reset(Isolate, Object);
+    return Object;
+}
+
+int MessagePortBinding::Dispatch(v8::Isolate* Isolate, v8::Local<v8::Context> Context, std::string& OutError)
+{
+    if (JsObject.IsEmpty())
+    {
+        return 0;
+    }
+    auto Object = JsObject.Get(Isolate);
+    v8::Local<v8::Value> OnMessage;
+    if (!Object->Get(Context, v8::String::NewFromUtf8(Isolate, "onmessage", v8::NewStringType::kNormal).ToLocalChecked())
+             .ToLocal(&OnMessage) ||
+        !OnMessage->IsFunction())
+    {
+        return 0;
+    }
+
+    // 对端可能一直在发，限定本次最多处理的条数，避免卡在这里
+    const size_t Limit = Port->Capacity();
+    int Count = 0;
+    Message Msg;
+    while (static_cast<size_t>(Count) < Limit && Port->Receive(Msg))
+    {
+        ++Count;
+        v8::TryCatch TryCatch(Isolate);
+        v8::Local<v8::Value> Value;
+        if (MessagePort::Deserialize(Isolate, Context, Msg, Host).ToLocal(&Value))
+        {
+            v8::Local<v8::Value> Args[] = {Value};
+            (void) (OnMessage.As<v8::Function>()->Call(Context, Object, 1, Args));
+        }
+        if (TryCatch.HasCaught())
+        {
+            v8::String::Utf8Value Info(Isolate, TryCatch.Exception());
+            OutError = *Info ? *Info : "unknown exception in onmessage";
+            break;
+        }
+    }
+    return Count;
+}
+
+void MessagePortBinding::OnPostMessage(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    v8::Local<v8::Context> Context = Isolate->GetCurrentContext();
+    auto Self = static_cast<MessagePortBinding*>(Info.Data().As<v8::External>()->Value());
+
+    Message Msg;
+    std::vector<v8::Local<v8::ArrayBuffer>> Transferred;
+    if (!MessagePort::Serialize(Isolate, Context, Info[0],
+            Info.Length() > 1 ? Info[1] : v8::Local<v8::Value>(v8::Undefined(Isolate)), Self->Host, Msg, Transferred))
+    {
+        return;
+    }
+    // 队列满或者已经关闭时返回false，由调用方决定丢弃还是稍后重发，这时transferList里的ArrayBuffer还能继续用
+    const bool Posted = Self->Port->Post(std::move(Msg));
+    if (Posted)
+    {
+        MessagePort::DetachTransferred(Transferred);
+    }
+    Info.GetReturnValue().Set(Posted);
+}
+
+void MessagePortBinding::OnPostRaw(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    auto Self = static_cast<MessagePortBinding*>(Info.Data().As<v8::External>()->Value());
+
+    Message Msg;
+    Msg.Raw = true;
+    if (Info[0]->IsArrayBufferView())
+    {
+        auto View = Info[0].As<v8::ArrayBufferView>();
+        auto Data = static_cast<uint8_t*>(GetBufferData(View->Buffer())) + View->ByteOffset();
+        Msg.Data.assign(Data, Data + View->ByteLength());
+    }
+    else if (Info[0]->IsArrayBuffer())
+    {
+        auto Buffer = Info[0].As<v8::ArrayBuffer>();
+        auto Data = static_cast<uint8_t*>(GetBufferData(Buffer));
+        Msg.Data.assign(Data, Data + Buffer->ByteLength());
+    }
+    else
+    {
+        ThrowError(Isolate, "postRaw expect an ArrayBuffer or ArrayBufferView");
+        return;
+    }
+    Info.GetReturnValue().Set(Self->Port->Post(std::move(Msg)));
+}
+
+void MessagePortBinding::OnClose(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    auto Self = static_cast<MessagePortBinding*>(Info.Data().As<v8::External>()->Value());
+    Self->Port->Close();
+}
+}    // namespace puerts
@@ -8,111 +8,288 @@
 
 #pragma once
 
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
 #pragma warning(push, 0)
 #include "v8.h"
 #pragma warning(pop)
 
+#ifndef PUERTS_OBJECT_CACHE_INLINE_SIZE
+#define PUERTS_OBJECT_CACHE_INLINE_SIZE 2
+#endif
+
 namespace puerts
 {
+// 同一个地址（比如结构体和它偏移为0的成员）可能以多个类型绑定到js对象。
+// 前PUERTS_OBJECT_CACHE_INLINE_SIZE个直接存在map的value里，更多的放到一块连续的溢出数组，最小的溢出块走线程局部的池。
+// 条目的逻辑顺序与原来的链表一致：头一个，然后是从新到旧的其它条目；Find返回、Remove删除的都是顺序上的第一个匹配。
+// 成员里没有指向自身的指针，可以被TMap按位搬移。Add/Remove会使其它条目的指针失效。
 class FObjectCacheNode
 {
 public:
-    V8_INLINE FObjectCacheNode(const void* TypeId_) : TypeId(TypeId_), UserData(nullptr), Next(nullptr)
+    struct FEntry
     {
-    }
+        const void* TypeId = nullptr;
 
-    V8_INLINE FObjectCacheNode(const void* TypeId_, FObjectCacheNode* Next_) : TypeId(TypeId_), UserData(nullptr), Next(Next_)
+        const void* UserData = nullptr;
+
+        v8::UniquePersistent<v8::Value> Value;
+    };
+
+    V8_INLINE FObjectCacheNode(const void* TypeId_) : Count(1), Overflow(nullptr)
     {
+        Inline[0].TypeId = TypeId_;
     }
 
-    V8_INLINE FObjectCacheNode(FObjectCacheNode&& other) noexcept
-        : TypeId(other.TypeId), UserData(other.UserData), Next(other.Next), Value(std::move(other.Value))
+    V8_INLINE FObjectCacheNode(FObjectCacheNode&& Other) noexcept : Count(Other.Count), Overflow(Other.Overflow)
     {
-        other.TypeId = nullptr;
-        other.UserData = nullptr;
-        other.Next = nullptr;
+        for (uint32_t i = 0; i < PUERTS_OBJECT_CACHE_INLINE_SIZE; ++i)
+        {
+            MoveEntry(Inline[i], Other.Inline[i]);
+        }
+        Other.Count = 0;
+        Other.Overflow = nullptr;
     }
 
-    V8_INLINE FObjectCacheNode& operator=(FObjectCacheNode&& rhs) noexcept
+    V8_INLINE FObjectCacheNode& operator=(FObjectCacheNode&& Other) noexcept
     {
-        TypeId = rhs.TypeId;
-        Next = rhs.Next;
-        Value = std::move(rhs.Value);
-        rhs.TypeId = nullptr;
-        rhs.Next = nullptr;
+        if (this != &Other)
+        {
+            Clear();
+            for (uint32_t i = 0; i < PUERTS_OBJECT_CACHE_INLINE_SIZE; ++i)
+            {
+                MoveEntry(Inline[i], Other.Inline[i]);
+            }
+            Count = Other.Count;
+            Overflow = Other.Overflow;
+            Other.Count = 0;
+            Other.Overflow = nullptr;
+        }
         return *this;
     }
 
     ~FObjectCacheNode()
     {
-        if (Next)
-            delete Next;
+        Clear();
     }
 
-    V8_INLINE FObjectCacheNode* Find(const void* TypeId_)
+    V8_INLINE FEntry* Find(const void* TypeId_)
     {
-        if (TypeId_ == TypeId)
+        for (uint32_t i = 0; i < Count; ++i)
         {
-            return this;
-        }
-        if (Next)
-        {
-            return Next->Find(TypeId_);
+            FEntry& Entry = At(i);
+            if (Entry.TypeId == TypeId_)
+            {
+                return &Entry;
+            }
         }
         return nullptr;
     }
 
-    FObjectCacheNode* Remove(const void* TypeId_, bool IsHead)
+    // 删除第一个匹配的条目，返回是否找到
+    bool Remove(const void* TypeId_)
     {
-        if (TypeId_ == TypeId)
+        for (uint32_t i = 0; i < Count; ++i)
         {
-            if (IsHead)
+            if (At(i).TypeId == TypeId_)
             {
-                if (Next)
+                for (uint32_t j = i + 1; j < Count; ++j)
                 {
-                    auto PreNext = Next;
-                    *this = std::move(*Next);
-                    delete PreNext;
+                    MoveEntry(At(j - 1), At(j));
                 }
-                else
+                --Count;
+                FEntry& Last = At(Count);
+                Last.Value.Reset();
+                Last.TypeId = nullptr;
+                Last.UserData = nullptr;
+                if (Count <= PUERTS_OBJECT_CACHE_INLINE_SIZE && Overflow)
                 {
-                    TypeId = nullptr;
-                    Next = nullptr;
-                    Value.Reset();
+                    FreeOverflow(Overflow);
+                    Overflow = nullptr;
                 }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 新条目排在头一个之后
+    FEntry* Add(const void* TypeId_)
+    {
+        if (Count == 0)
+        {
+            Count = 1;
+            Inline[0].TypeId = TypeId_;
+            return &Inline[0];
+        }
+        if (Count >= PUERTS_OBJECT_CACHE_INLINE_SIZE && (!Overflow || Count - PUERTS_OBJECT_CACHE_INLINE_SIZE == Overflow->Capacity))
+        {
+            Grow();
+        }
+        ++Count;
+        for (uint32_t i = Count - 1; i > 1; --i)
+        {
+            MoveEntry(At(i), At(i - 1));
+        }
+        FEntry& Entry = At(1);
+        Entry.TypeId = TypeId_;
+        return &Entry;
+    }
+
+    V8_INLINE bool IsEmpty() const
+    {
+        return Count == 0;
+    }
+
+    template <typename Func>
+    void ForEach(Func&& F)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            F(At(i));
+        }
+    }
+
+    FObjectCacheNode(const FObjectCacheNode&) = delete;
+    void operator=(const FObjectCacheNode&) = delete;
+
+private:
+    struct FOverflowBlock
+    {
+        uint32_t Capacity;
+
+        FOverflowBlock* NextFree;
+
+        FEntry* Entries()
+        {
+            return reinterpret_cast<FEntry*>(this + 1);
+        }
+    };
+
+    static constexpr uint32_t MinOverflowCapacity = 4;
+
+    static constexpr uint32_t MaxPooledBlocks = 256;
+
+    struct FOverflowPool
+    {
+        FOverflowBlock* FreeList = nullptr;
+
+        uint32_t Size = 0;
+
+        ~FOverflowPool()
+        {
+            while (FreeList)
+            {
+                FOverflowBlock* Next = FreeList->NextFree;
+                ::free(FreeList);
+                FreeList = Next;
             }
-            return this;
         }
-        if (Next)
+    };
+
+    static FOverflowPool& GetOverflowPool()
+    {
+        static thread_local FOverflowPool Pool;
+        return Pool;
+    }
+
+    static FOverflowBlock* AllocOverflow(uint32_t Capacity)
+    {
+        FOverflowBlock* Block = nullptr;
+        if (Capacity == MinOverflowCapacity)
         {
-            auto Removed = Next->Remove(TypeId_, false);
-            if (Removed && Removed == Next)    // detach & delete by prev node
+            FOverflowPool& Pool = GetOverflowPool();
+            if (Pool.FreeList)
             {
-                Next = Removed->Next;
-                Removed->Next = nullptr;
-                delete Removed;
+                Block = Pool.FreeList;
+                Pool.FreeList = Block->NextFree;
+                --Pool.Size;
             }
-            return Removed;
         }
-        return nullptr;
+        if (!Block)
+        {
+            Block = static_cast<FOverflowBlock*>(::malloc(sizeof(FOverflowBlock) + sizeof(FEntry) * Capacity));
+        }
+        Block->Capacity = Capacity;
+        Block->NextFree = nullptr;
+        for (uint32_t i = 0; i < Capacity; ++i)
+        {
+            new (&Block->Entries()[i]) FEntry();
+        }
+        return Block;
+    }
+
+    static void FreeOverflow(FOverflowBlock* Block)
+    {
+        for (uint32_t i = 0; i < Block->Capacity; ++i)
+        {
+            Block->Entries()[i].~FEntry();
+        }
+        FOverflowPool& Pool = GetOverflowPool();
+        if (Block->Capacity == MinOverflowCapacity && Pool.Size < MaxPooledBlocks)
+        {
+            Block->NextFree = Pool.FreeList;
+            Pool.FreeList = Block;
+            ++Pool.Size;
+        }
+        else
+        {
+            ::free(Block);
+        }
     }
 
-    V8_INLINE FObjectCacheNode* Add(const void* TypeId_)
+    V8_INLINE static void MoveEntry(FEntry& Dst, FEntry& Src)
     {
-        Next = new FObjectCacheNode(TypeId_, Next);
-        return Next;
+        Dst.TypeId = Src.TypeId;
+        Dst.UserData = Src.UserData;
+        Dst.Value = std::move(Src.Value);
+        Src.TypeId = nullptr;
+        Src.UserData = nullptr;
     }
 
-    const void* TypeId;
+    V8_INLINE FEntry& At(uint32_t Index)
+    {
+        return Index < PUERTS_OBJECT_CACHE_INLINE_SIZE ? Inline[Index] : Overflow->Entries()[Index - PUERTS_OBJECT_CACHE_INLINE_SIZE];
+    }
+
+    void Grow()
+    {
+        uint32_t Capacity = Overflow ? Overflow->Capacity * 2 : MinOverflowCapacity;
+        FOverflowBlock* Block = AllocOverflow(Capacity);
+        if (Overflow)
+        {
+            for (uint32_t i = 0; i < Overflow->Capacity; ++i)
+            {
+                MoveEntry(Block->Entries()[i], Overflow->Entries()[i]);
+            }
+            FreeOverflow(Overflow);
+        }
+        Overflow = Block;
+    }
 
-    const void* UserData;
+    void Clear()
+    {
+        if (Overflow)
+        {
+            FreeOverflow(Overflow);
+            Overflow = nullptr;
+        }
+        for (uint32_t i = 0; i < PUERTS_OBJECT_CACHE_INLINE_SIZE; ++i)
+        {
+            Inline[i].Value.Reset();
+            Inline[i].TypeId = nullptr;
+            Inline[i].UserData = nullptr;
+        }
+        Count = 0;
+    }
 
-    FObjectCacheNode* Next;
+    FEntry Inline[PUERTS_OBJECT_CACHE_INLINE_SIZE];
 
-    v8::UniquePersistent<v8::Value> Value;
+    uint32_t Count;
 
-    FObjectCacheNode(const FObjectCacheNode&) = delete;
-    void operator=(const FObjectCacheNode&) = delete;
+    FOverflowBlock* Overflow;
 };
 
 }    // namespace puerts
@@ -12,6 +12,7 @@
 #include "CoreMinimal.h"
 #include "PropertyTranslator.h"
 #include "StructWrapper.h"
+#include "PropertyStringCache.h"
 #endif
 #include "JSClassRegister.h"
 
@@ -64,6 +65,16 @@ public:
     virtual v8::Local<v8::Value> FindOrAddStruct(
         v8::Isolate* Isolate, v8::Local<v8::Context>& Context, UScriptStruct* ScriptStruct, void* Ptr, bool PassByPointer) = 0;
 
+    // 按值传给js的struct从这里分配，见FScriptStructWrapper::Alloc
+    virtual FStructSlabAllocator* GetStructAllocator() = 0;
+
+    // FString/FText属性读写的缓存，见PUERTS_PROPERTY_STRING_CACHE
+    virtual FPropertyStringCache* GetPropertyStringCache() = 0;
+
+    // 并行执行的FJsEnvGroup里gc会发生在工作线程，weak callback里销毁UStruct/容器这类要在游戏线程做的事交给这里，
+    // 已经在游戏线程或者不在并行模式时直接执行
+    virtual void RunOnGameThread(TUniqueFunction<void()> Func) = 0;
+
     virtual void Merge(
         v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Object> Src, UStruct* DesType, void* Des) = 0;
 
@@ -371,7 +371,7 @@ pesapi_value pesapi_get_value_ref(pesapi_env env, pesapi_value pvalue)
     auto value = v8impl::V8LocalValueFromPesapiValue(pvalue);
 
     auto outer = value->ToObject(context).ToLocalChecked();
-    auto realvalue = outer->Get(context, 0).ToLocalChecked();
+    auto realvalue = ::puerts::GetRefValue(context, outer);
     return v8impl::PesapiValueFromV8LocalValue(realvalue);
 }
 
@@ -382,8 +382,7 @@ void pesapi_update_value_ref(pesapi_env env, pesapi_value ref, pesapi_value pval
     auto value = v8impl::V8LocalValueFromPesapiValue(pvalue);
     if (holder->IsObject())
     {
-        auto outer = holder->ToObject(context).ToLocalChecked();
-        auto _unused = outer->Set(context, 0, value);
+        ::puerts::SetRefValue(context, holder.As<v8::Object>(), value);
     }
 }
 
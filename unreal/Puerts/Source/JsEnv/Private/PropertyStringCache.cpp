@@ -0,0 +1,93 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "PropertyStringCache.h"
+#include "V8Utils.h"
+#include "Misc/Crc.h"
+#include "Internationalization/TextLocalizationManager.h"
+
+namespace puerts
+{
+v8::Local<v8::String> FPropertyStringCache::ToV8String(v8::Isolate* Isolate, const void* Owner, const FString& Value)
+{
+    FStringSlot& Slot = StringSlots[SlotOf(Owner)];
+    const int32 Len = Value.Len();
+    if (!Slot.JsValue.IsEmpty() && Slot.Value.Len() == Len &&
+        (Len == 0 || FMemory::Memcmp(*Slot.Value, *Value, Len * sizeof(TCHAR)) == 0))
+    {
+        return Slot.JsValue.Get(Isolate);
+    }
+    auto Result = FV8Utils::ToV8String(Isolate, Value);
+    const uint32 Crc = FCrc::MemCrc32(*Value, Len * sizeof(TCHAR));
+    if (Slot.MissLen != Len || Slot.MissCrc != Crc)
+    {
+        Slot.MissLen = Len;
+        Slot.MissCrc = Crc;
+        return Result;
+    }
+    Slot.Value = Value;
+    Slot.JsValue.Reset(Isolate, Result);
+    return Result;
+}
+
+v8::Local<v8::String> FPropertyStringCache::ToV8String(v8::Isolate* Isolate, const void* Owner, const FText& Value)
+{
+    FTextSlot& Slot = TextSlots[SlotOf(Owner)];
+    // 切换语言时本地化文本的display string会被原地更新，TextRevision随之变化
+    const int32 Revision = static_cast<int32>(FTextLocalizationManager::Get().GetTextRevision());
+    if (!Slot.JsValue.IsEmpty() && Slot.Revision == Revision && Slot.Value.IdenticalTo(Value))
+    {
+        return Slot.JsValue.Get(Isolate);
+    }
+    auto Result = FV8Utils::ToV8String(Isolate, Value);
+    if (Slot.MissRevision != Revision || !Slot.MissValue.IdenticalTo(Value))
+    {
+        Slot.MissValue = Value;
+        Slot.MissRevision = Revision;
+        return Result;
+    }
+    Slot.Value = Value;
+    Slot.Revision = Revision;
+    Slot.JsValue.Reset(Isolate, Result);
+    return Result;
+}
+
+FText FPropertyStringCache::ToFText(v8::Isolate* Isolate, const void* Owner, v8::Local<v8::Value> Value)
+{
+    if (!Value->IsString())
+    {
+        return FText::FromString(FV8Utils::ToFString(Isolate, Value));
+    }
+    FJsToTextSlot& Slot = JsToTextSlots[SlotOf(Owner)];
+    // 同一个字符串对象（比如字面量）直接是同一个指针，否则按内容比较，都比FText::FromString便宜
+    if (!Slot.JsValue.IsEmpty() && Value->StrictEquals(Slot.JsValue.Get(Isolate)))
+    {
+        return Slot.Value;
+    }
+    Slot.Value = FText::FromString(FV8Utils::ToFString(Isolate, Value));
+    Slot.JsValue.Reset(Isolate, Value.As<v8::String>());
+    return Slot.Value;
+}
+
+void FPropertyStringCache::Clear()
+{
+    for (uint32 i = 0; i < NumSlots; ++i)
+    {
+        StringSlots[i].JsValue.Reset();
+        StringSlots[i].Value.Empty();
+        StringSlots[i].MissLen = -1;
+        TextSlots[i].JsValue.Reset();
+        TextSlots[i].Value = FText();
+        TextSlots[i].Revision = -1;
+        TextSlots[i].MissValue = FText();
+        TextSlots[i].MissRevision = -1;
+        JsToTextSlots[i].JsValue.Reset();
+        JsToTextSlots[i].Value = FText();
+    }
+}
+}    // namespace puerts
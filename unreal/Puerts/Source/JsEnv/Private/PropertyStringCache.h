@@ -0,0 +1,82 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
+
+// 槽位数，必须是2的幂
+#ifndef PUERTS_PROPERTY_STRING_CACHE_SIZE
+#define PUERTS_PROPERTY_STRING_CACHE_SIZE 256
+#endif
+
+namespace puerts
+{
+// FString/FText属性读写时的last-value缓存，UI绑定每帧读同一个没变过的文本时不用每次都新建v8::String。
+// 以translator指针为key直接映射到槽位，冲突了就覆盖，命中与否只看值：
+// FString逐字符比较（同一个buffer可能被原地改写，只比指针和长度不安全），
+// FText比较共享的TextData指针（缓存里持有一份FText，指针不会被重用）以及本地化的TextRevision。
+// 同一个translator的不同对象值不同时会一直不命中，所以没命中时只记下这个值（FString只记长度和crc），
+// 连续两次读到同一个值才拷贝进槽位、Reset Global。
+// per env, only touched on the thread which owns the isolate. must be cleared before the isolate is disposed
+class FPropertyStringCache
+{
+public:
+    v8::Local<v8::String> ToV8String(v8::Isolate* Isolate, const void* Owner, const FString& Value);
+
+    v8::Local<v8::String> ToV8String(v8::Isolate* Isolate, const void* Owner, const FText& Value);
+
+    // 同一个js字符串重复赋值时复用上次FText::FromString的结果
+    FText ToFText(v8::Isolate* Isolate, const void* Owner, v8::Local<v8::Value> Value);
+
+    void Clear();
+
+private:
+    static constexpr uint32 NumSlots = PUERTS_PROPERTY_STRING_CACHE_SIZE;
+
+    static_assert((NumSlots & (NumSlots - 1)) == 0, "PUERTS_PROPERTY_STRING_CACHE_SIZE must be a power of two");
+
+    FORCEINLINE static uint32 SlotOf(const void* Owner)
+    {
+        return static_cast<uint32>(reinterpret_cast<UPTRINT>(Owner) >> 4) & (NumSlots - 1);
+    }
+
+    struct FStringSlot
+    {
+        FString Value;
+        v8::Global<v8::String> JsValue;
+        int32 MissLen = -1;
+        uint32 MissCrc = 0;
+    };
+
+    struct FTextSlot
+    {
+        FText Value;
+        int32 Revision = -1;
+        v8::Global<v8::String> JsValue;
+        FText MissValue;
+        int32 MissRevision = -1;
+    };
+
+    struct FJsToTextSlot
+    {
+        v8::Global<v8::String> JsValue;
+        FText Value;
+    };
+
+    FStringSlot StringSlots[NumSlots];
+
+    FTextSlot TextSlots[NumSlots];
+
+    FJsToTextSlot JsToTextSlots[NumSlots];
+};
+}    // namespace puerts
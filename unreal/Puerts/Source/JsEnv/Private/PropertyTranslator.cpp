@@ -373,7 +373,12 @@ public:
     v8::Local<v8::Value> UEToJs(
         v8::Isolate* Isolate, v8::Local<v8::Context>& Context, const void* ValuePtr, bool PassByPointer) const override
     {
+#ifdef PUERTS_PROPERTY_STRING_CACHE
+        return FV8Utils::IsolateData<IObjectMapper>(Isolate)->GetPropertyStringCache()->ToV8String(
+            Isolate, this, StringProperty->GetPropertyValue(ValuePtr));
+#else
         return FV8Utils::ToV8String(Isolate, StringProperty->GetPropertyValue(ValuePtr));
+#endif
     }
 
     bool JsToUE(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, const v8::Local<v8::Value>& Value, void* ValuePtr,
@@ -428,7 +433,10 @@ public:
     v8::Local<v8::Value> UEToJs(
         v8::Isolate* Isolate, v8::Local<v8::Context>& Context, const void* ValuePtr, bool PassByPointer) const override
     {
-#ifndef PUERTS_FTEXT_AS_OBJECT
+#if !defined(PUERTS_FTEXT_AS_OBJECT) && defined(PUERTS_PROPERTY_STRING_CACHE)
+        return FV8Utils::IsolateData<IObjectMapper>(Isolate)->GetPropertyStringCache()->ToV8String(
+            Isolate, this, TextProperty->GetPropertyValue(ValuePtr));
+#elif !defined(PUERTS_FTEXT_AS_OBJECT)
         return FV8Utils::ToV8String(Isolate, TextProperty->GetPropertyValue(ValuePtr));
 #else
         return DataTransfer::FindOrAddCData(Context->GetIsolate(), Context, puerts::StaticTypeId<FText>::get(),
@@ -439,7 +447,10 @@ public:
     bool JsToUE(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, const v8::Local<v8::Value>& Value, void* ValuePtr,
         bool DeepCopy) const override
     {
-#ifndef PUERTS_FTEXT_AS_OBJECT
+#if !defined(PUERTS_FTEXT_AS_OBJECT) && defined(PUERTS_PROPERTY_STRING_CACHE)
+        TextProperty->SetPropertyValue(
+            ValuePtr, FV8Utils::IsolateData<IObjectMapper>(Isolate)->GetPropertyStringCache()->ToFText(Isolate, this, Value));
+#elif !defined(PUERTS_FTEXT_AS_OBJECT)
         TextProperty->SetPropertyValue(ValuePtr, FText::FromString(FV8Utils::ToFString(Isolate, Value)));
 #else
         auto TextPtr = DataTransfer::GetPointerFast<FText>(Value.As<v8::Object>());
@@ -655,15 +666,15 @@ public:
         override    //还是得有个指针模式，否则不能通过obj.xx.xx直接修改struct值，倒是和性能无关，应该强制js测不许保存指针型对象的引用（从native侧进入，最后一层退出时清空？）
     {
         void* Ptr = const_cast<void*>(ValuePtr);
+        auto ObjectMapper = FV8Utils::IsolateData<IObjectMapper>(Isolate);
 
         if (!PassByPointer)
         {
-            // FScriptStructWrapper::Alloc using new, so delete in static wrapper is safe
-            Ptr = FScriptStructWrapper::Alloc(StructProperty->Struct);
+            // slab分配的内存由FScriptStructWrapper::Free识别并归还，不会交给静态绑定的Finalize去delete
+            Ptr = FScriptStructWrapper::Alloc(StructProperty->Struct, ObjectMapper->GetStructAllocator());
             StructProperty->CopySingleValue(Ptr, ValuePtr);
         }
-        return FV8Utils::IsolateData<IObjectMapper>(Isolate)->FindOrAddStruct(
-            Isolate, Context, StructProperty->Struct, Ptr, PassByPointer);
+        return ObjectMapper->FindOrAddStruct(Isolate, Context, StructProperty->Struct, Ptr, PassByPointer);
     }
 
     bool JsToUE(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, const v8::Local<v8::Value>& Value, void* ValuePtr,
@@ -1150,7 +1161,7 @@ public:
         if (Value->IsObject())
         {
             auto Outer = Value->ToObject(Context).ToLocalChecked();
-            auto Realvalue = Outer->Get(Context, 0).ToLocalChecked();
+            auto Realvalue = GetRefValue(Context, Outer);
             return Inner->JsToUE(Isolate, Context, Realvalue, ValuePtr, DeepCopy);
         }
         return true;
@@ -1162,7 +1173,7 @@ public:
         if (Value->IsObject())
         {
             auto Outer = Value->ToObject(Context).ToLocalChecked();
-            auto Realvalue = Outer->Get(Context, 0).ToLocalChecked();
+            auto Realvalue = GetRefValue(Context, Outer);
             return Inner->JsToUEFast(Isolate, Context, Realvalue, TempBuff, OutValuePtr);
         }
         *OutValuePtr = TempBuff;
@@ -1177,7 +1188,7 @@ public:
             auto Outer = Value->ToObject(Context).ToLocalChecked();
             if (Inner->ParamShallowCopySize)
             {
-                auto Realvalue = Outer->Get(Context, 0).ToLocalChecked();
+                auto Realvalue = GetRefValue(Context, Outer);
                 auto Ptr = FV8Utils::GetPointer(Context, Realvalue);
                 if (Ptr && Ptr != ValuePtr)
                 {
@@ -1186,7 +1197,7 @@ public:
                 }
             }
 
-            auto ReturnVal = Outer->Set(Context, 0, Inner->UEToJs(Isolate, Context, ValuePtr, PassByPointer));
+            SetRefValue(Context, Outer, Inner->UEToJs(Isolate, Context, ValuePtr, PassByPointer));
             if (Inner->ParamShallowCopySize)    // $ref(undefined) for shallow copy type
             {
                 Property->DestroyValue(const_cast<void*>(ValuePtr));
@@ -17,6 +17,9 @@
 #include "UECompatible.h"
 #include "WasmModuleInstance.h"
 #include "GenericPlatform/GenericPlatformMemory.h"
+#include "DataTransfer.h"
+
+#include <string>
 
 namespace puerts
 {
@@ -168,10 +171,23 @@ static const void* NormalInstanceLink(IM3Runtime runtime, IM3ImportContext _ctx,
     return nullptr;
 }
 
-WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, TArray<uint8>& InData,
+struct WasmImportFunction
+{
+    std::string ModuleName;
+    std::string FunctionName;
+    v8::Local<v8::Function> Function;
+};
+
+WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, v8::Local<v8::Value> ModuleBytes,
     v8::Local<v8::Object>& ExportsObject, v8::Local<v8::Value> ImportsValue,
     const TArray<std::shared_ptr<WasmRuntime>>& RuntimeList, TArray<WasmNormalLinkInfo*>& CachedLinkFunctionList)
 {
+    if (!ModuleBytes->IsArrayBuffer() && !ModuleBytes->IsArrayBufferView())
+    {
+        FV8Utils::ThrowException(Isolate, "params at 1 must be ArrayBuffer or TypedArray");
+        return nullptr;
+    }
+
     WasmRuntime* UsedRuntime = RuntimeList[0].get();
 
     v8::Local<v8::Object> MemoryObject;
@@ -241,49 +257,75 @@ WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>&
         }
     }
 
-    auto CustomLinkFunc = [&](IM3Module _Module) -> bool
+    // 导入对象上的getter可能执行任意js（包括detach字节码所在的ArrayBuffer），所以在取字节码之前把所有导入都解析出来，
+    // 之后解析、链接、编译的过程中不再执行js
+    TArray<WasmImportFunction> ImportFunctions;
+    if (!ImportsObject.IsEmpty())
     {
-        if (!ImportsObject.IsEmpty())
+        auto ModuleNames = ImportsObject->GetOwnPropertyNames(Context).ToLocalChecked();
+        for (decltype(ModuleNames->Length()) j = 0; j < ModuleNames->Length(); ++j)
         {
-            auto ModuleNames = ImportsObject->GetOwnPropertyNames(Context).ToLocalChecked();
-            for (decltype(ModuleNames->Length()) j = 0; j < ModuleNames->Length(); ++j)
+            v8::Local<v8::Value> ModuleName;
+            v8::Local<v8::Value> ModuleValue;
+            if (ModuleNames->Get(Context, j).ToLocal(&ModuleName) && ImportsObject->Get(Context, ModuleName).ToLocal(&ModuleValue) &&
+                ModuleValue->IsObject())
             {
-                v8::Local<v8::Value> ModuleName;
-                v8::Local<v8::Value> ModuleValue;
-                if (ModuleNames->Get(Context, j).ToLocal(&ModuleName) &&
-                    ImportsObject->Get(Context, ModuleName).ToLocal(&ModuleValue))
+                auto Module = ModuleValue.As<v8::Object>();
+                v8::String::Utf8Value UtfModuleName(Isolate, ModuleName);
+                auto FunctionNames = Module->GetOwnPropertyNames(Context).ToLocalChecked();
+                for (decltype(FunctionNames->Length()) i = 0; i < FunctionNames->Length(); ++i)
                 {
-                    auto Module = ModuleValue.As<v8::Object>();
-                    v8::String::Utf8Value UtfModuleName(Isolate, ModuleName);
-                    auto FunctionNames = Module->GetOwnPropertyNames(Context).ToLocalChecked();
-                    for (decltype(FunctionNames->Length()) i = 0; i < FunctionNames->Length(); ++i)
+                    v8::Local<v8::Value> FunctionName;
+                    v8::Local<v8::Value> FunctionValue;
+                    if (FunctionNames->Get(Context, i).ToLocal(&FunctionName) && Module->Get(Context, FunctionName).ToLocal(&FunctionValue) &&
+                        FunctionValue->IsFunction())
                     {
-                        v8::Local<v8::Value> FunctionName;
-                        v8::Local<v8::Value> FunctionValue;
-                        if (FunctionNames->Get(Context, i).ToLocal(&FunctionName) &&
-                            Module->Get(Context, FunctionName).ToLocal(&FunctionValue))
-                        {
-                            if (FunctionValue->IsFunction())
-                            {
-                                WasmNormalLinkInfo* NewInfo = new WasmNormalLinkInfo();
-                                NewInfo->CachedFunction.Reset(Isolate, FunctionValue.As<v8::Function>());
-                                NewInfo->Isolate = Isolate;
-                                CachedLinkFunctionList.Add(NewInfo);
-                                if (!Export_m3_LinkRawFunctionEx(_Module, *UtfModuleName,
-                                        (*(v8::String::Utf8Value(Isolate, FunctionName))), nullptr, &NormalInstanceLink, NewInfo))
-                                {
-                                    return false;
-                                }
-                            }
-                        }
+                        ImportFunctions.Add({*UtfModuleName, *v8::String::Utf8Value(Isolate, FunctionName), FunctionValue.As<v8::Function>()});
                     }
                 }
             }
         }
+    }
+
+    // 字节码只在解析和编译时用到，这期间不会再执行js，Info[0]也一直被引用着，所以直接借用不再拷贝
+    const uint8* InData = nullptr;
+    int InDataLength = 0;
+    if (ModuleBytes->IsArrayBuffer())
+    {
+        size_t Length = 0;
+        InData = static_cast<const uint8*>(DataTransfer::GetArrayBufferData(ModuleBytes.As<v8::ArrayBuffer>(), Length));
+        InDataLength = static_cast<int>(Length);
+    }
+    else
+    {
+        auto View = ModuleBytes.As<v8::ArrayBufferView>();
+        InData = static_cast<const uint8*>(DataTransfer::GetArrayBufferData(View->Buffer())) + View->ByteOffset();
+        InDataLength = static_cast<int>(View->ByteLength());
+    }
+    if (!InData || InDataLength <= 0)
+    {
+        FV8Utils::ThrowException(Isolate, "wasm module bytes are empty or were detached while reading the import object");
+        return nullptr;
+    }
+
+    auto CustomLinkFunc = [&](IM3Module _Module) -> bool
+    {
+        for (const auto& Import : ImportFunctions)
+        {
+            WasmNormalLinkInfo* NewInfo = new WasmNormalLinkInfo();
+            NewInfo->CachedFunction.Reset(Isolate, Import.Function);
+            NewInfo->Isolate = Isolate;
+            CachedLinkFunctionList.Add(NewInfo);
+            if (!Export_m3_LinkRawFunctionEx(
+                    _Module, Import.ModuleName.c_str(), Import.FunctionName.c_str(), nullptr, &NormalInstanceLink, NewInfo))
+            {
+                return false;
+            }
+        }
         return true;
     };
 
-    WasmModuleInstance* NewInstance = new WasmModuleInstance(InData);
+    WasmModuleInstance* NewInstance = new WasmModuleInstance(InData, InDataLength);
     if (NewInstance->ParseModule(UsedRuntime->GetEnv()))
     {
         //如果没有指明需要import memory,那么使用默认的runtime即可,即便外面传入了memory也不生效
@@ -318,12 +360,12 @@ WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>&
             }
         }
     }
-    if (NewInstance->GetModule()->memoryExportName)
+    if (NewInstance && NewInstance->GetModule()->memoryExportName)
     {
         (void) ExportsObject->Set(Context, FV8Utils::ToV8String(Isolate, "__memoryExport"),
             FV8Utils::ToV8String(Isolate, NewInstance->GetModule()->memoryExportName));
     }
-    if (NewInstance->GetModule()->tableExportName)
+    if (NewInstance && NewInstance->GetModule()->tableExportName)
     {
         (void) ExportsObject->Set(Context, FV8Utils::ToV8String(Isolate, "__tableExport"),
             FV8Utils::ToV8String(Isolate, NewInstance->GetModule()->tableExportName));
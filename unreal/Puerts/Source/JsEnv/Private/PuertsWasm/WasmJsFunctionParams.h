@@ -27,7 +27,8 @@ struct WasmNormalLinkInfo
     v8::Isolate* Isolate;
 };
 
-WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, TArray<uint8>& InData,
+// ModuleBytes: ArrayBuffer或TypedArray，在读完ImportsValue之后才取数据，不需要调用方拷贝
+WasmRuntime* NormalInstanceModule(v8::Isolate* Isolate, v8::Local<v8::Context>& Context, v8::Local<v8::Value> ModuleBytes,
     v8::Local<v8::Object>& ExportsObject, v8::Local<v8::Value> ImportsValue,
     const TArray<std::shared_ptr<WasmRuntime>>& RuntimeList, TArray<WasmNormalLinkInfo*>& CachedLinkFunctionList);
 };    // namespace puerts
@@ -9,13 +9,46 @@
 #include "SourceFileWatcher.h"
 #include "DirectoryWatcherModule.h"
 #include "Modules/ModuleManager.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#if (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1) || ENGINE_MAJOR_VERSION > 5
+#include "Hash/xxhash.h"
+#else
+#include "Hash/CityHash.h"
+#endif
 #include "JSLogger.h"
 
 namespace puerts
 {
+static uint64 HashSource(const TArray<uint8>& Data)
+{
+#if (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1) || ENGINE_MAJOR_VERSION > 5
+    return FXxHash64::HashBuffer(Data.GetData(), Data.Num()).Hash;
+#else
+    return CityHash64(reinterpret_cast<const char*>(Data.GetData()), Data.Num());
+#endif
+}
+
 FSourceFileWatcher::FSourceFileWatcher(std::function<void(const FString&)> InOnWatchedFileChanged)
-    : OnWatchedFileChanged(InOnWatchedFileChanged)
+    : FSourceFileWatcher(
+          [InOnWatchedFileChanged](const TArray<FString>& Paths)
+          {
+              for (const FString& Path : Paths)
+              {
+                  InOnWatchedFileChanged(Path);
+              }
+          },
+          DefaultDebounceSeconds)
+{
+}
+
+FSourceFileWatcher::FSourceFileWatcher(
+    std::function<void(const TArray<FString>&)> InOnWatchedFilesChanged, float InDebounceSeconds)
+    : OnWatchedFilesChanged(InOnWatchedFilesChanged), DebounceSeconds(InDebounceSeconds)
 {
+    TickerHandle = FUETicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSourceFileWatcher::Tick), 0);
 }
 
 void FSourceFileWatcher::OnSourceLoaded(const FString& InPath)
@@ -38,20 +71,30 @@ void FSourceFileWatcher::OnSourceLoaded(const FString& InPath)
     }
     if (!WatchedFiles.Contains(Dir))
     {
-        WatchedFiles.Emplace(Dir, TMap<FString, FMD5Hash>());
+        WatchedFiles.Emplace(Dir, TMap<FString, FWatchedFile>());
     }
     if (!WatchedFiles[Dir].Contains(FileName))
     {
         UE_LOG(Puerts, Log, TEXT("add watched file: %s"), *InPath);
-        FMD5Hash Hash = FMD5Hash::HashFile(*InPath);
-        WatchedFiles[Dir].Add(FileName, Hash);
+        FWatchedFile WatchedFile;
+        WatchedFile.LoadOrder = NextLoadOrder++;
+        // the baseline hash is taken on the thread pool, loading a module must not wait for it; size and timestamp are
+        // taken now, so an edit landing before the baseline is hashed is still reported
+        FFileStatData StatData = IFileManager::Get().GetStatData(*InPath);
+        if (StatData.bIsValid)
+        {
+            WatchedFile.Size = StatData.FileSize;
+            WatchedFile.ModificationTime = StatData.ModificationTime;
+        }
+        WatchedFiles[Dir].Add(FileName, WatchedFile);
+        PendingBaselines.Add(InPath, Dir);
     }
 }
 
 void FSourceFileWatcher::OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
 {
     FScopeLock ScopeLock(&SourceFileWatcherCritical);
-    if (!OnWatchedFileChanged)
+    if (!OnWatchedFilesChanged)
         return;
     for (auto Change : FileChanges)
     {
@@ -71,13 +114,8 @@ void FSourceFileWatcher::OnDirectoryChanged(const TArray<FFileChangeData>& FileC
             {
                 if (WatchedFiles[Dir].Contains(FileName))
                 {
-                    FString NotifyPath = Dir + Splitter + FileName;
-                    FMD5Hash Hash = FMD5Hash::HashFile(*NotifyPath);
-                    if (WatchedFiles[Dir][FileName] != Hash)
-                    {
-                        OnWatchedFileChanged(NotifyPath);
-                        WatchedFiles[Dir][FileName] = Hash;
-                    }
+                    PendingChanges.Add(Dir + Splitter + FileName, Dir);
+                    LastChangeTime = FPlatformTime::Seconds();
                 }
             }
             else
@@ -88,8 +126,143 @@ void FSourceFileWatcher::OnDirectoryChanged(const TArray<FFileChangeData>& FileC
     }
 }
 
+void FSourceFileWatcher::RunHashJobs(TArray<FHashJob>& Jobs)
+{
+    for (FHashJob& Job : Jobs)
+    {
+        Job.Result = Job.Known;
+        Job.Changed = false;
+
+        FFileStatData StatData = IFileManager::Get().GetStatData(*Job.Path);
+        if (!StatData.bIsValid)
+        {
+            continue;
+        }
+        // tsc rewrites unchanged outputs too, so an updated timestamp alone is not a change; an untouched one is trusted
+        if (Job.Known.Hashed && StatData.FileSize == Job.Known.Size && StatData.ModificationTime == Job.Known.ModificationTime)
+        {
+            continue;
+        }
+        TArray<uint8> Data;
+        if (!FFileHelper::LoadFileToArray(Data, *Job.Path, FILEREAD_Silent))
+        {
+            continue;
+        }
+        Job.Result.Size = StatData.FileSize;
+        Job.Result.ModificationTime = StatData.ModificationTime;
+        Job.Result.Hash = HashSource(Data);
+        Job.Result.Hashed = true;
+        const bool EditedSinceLoad = !Job.Known.Hashed && Job.Known.Size >= 0 &&
+                                     (StatData.FileSize != Job.Known.Size || StatData.ModificationTime != Job.Known.ModificationTime);
+        Job.Changed = EditedSinceLoad || (Job.Report && (!Job.Known.Hashed || Job.Known.Hash != Job.Result.Hash));
+    }
+}
+
+bool FSourceFileWatcher::Tick(float DeltaTime)
+{
+    if (HashingTask.IsValid())
+    {
+        if (!HashingTask.IsReady())
+        {
+            return true;
+        }
+        FinishHashing();
+    }
+    StartHashing();
+    return true;
+}
+
+void FSourceFileWatcher::StartHashing()
+{
+    TArray<FHashJob> Jobs;
+    {
+        FScopeLock ScopeLock(&SourceFileWatcherCritical);
+        auto AddJobs = [&](TMap<FString, FString>& Pending, bool Report)
+        {
+            for (auto& KV : Pending)
+            {
+                const FString FileName = FPaths::GetCleanFilename(KV.Key);
+                const FWatchedFile* WatchedFile = WatchedFiles.Contains(KV.Value) ? WatchedFiles[KV.Value].Find(FileName) : nullptr;
+                if (WatchedFile)
+                {
+                    FHashJob Job;
+                    Job.Dir = KV.Value;
+                    Job.FileName = FileName;
+                    Job.Path = KV.Key;
+                    Job.Known = *WatchedFile;
+                    Job.Report = Report;
+                    Jobs.Add(MoveTemp(Job));
+                }
+            }
+            Pending.Empty();
+        };
+        AddJobs(PendingBaselines, false);
+        if (PendingChanges.Num() > 0 && FPlatformTime::Seconds() - LastChangeTime >= DebounceSeconds)
+        {
+            AddJobs(PendingChanges, true);
+        }
+    }
+    if (Jobs.Num() > 0)
+    {
+        HashingTask = Async(EAsyncExecution::ThreadPool,
+            [Jobs = MoveTemp(Jobs)]() mutable
+            {
+                RunHashJobs(Jobs);
+                return MoveTemp(Jobs);
+            });
+    }
+}
+
+void FSourceFileWatcher::FinishHashing()
+{
+    TArray<FHashJob> Jobs = HashingTask.Get();
+    HashingTask = TFuture<TArray<FHashJob>>();
+
+    TArray<TPair<int32, FString>> Changed;
+    // a file edited right after loading can show up both as its baseline and as a change in the same batch
+    TSet<FString> ChangedPaths;
+    {
+        FScopeLock ScopeLock(&SourceFileWatcherCritical);
+        for (FHashJob& Job : Jobs)
+        {
+            FWatchedFile* WatchedFile = WatchedFiles.Contains(Job.Dir) ? WatchedFiles[Job.Dir].Find(Job.FileName) : nullptr;
+            if (!WatchedFile)
+            {
+                continue;
+            }
+            Job.Result.LoadOrder = WatchedFile->LoadOrder;
+            *WatchedFile = Job.Result;
+            if (Job.Changed && !ChangedPaths.Contains(Job.Path))
+            {
+                ChangedPaths.Add(Job.Path);
+                Changed.Emplace(WatchedFile->LoadOrder, Job.Path);
+            }
+        }
+    }
+    if (Changed.Num() == 0 || !OnWatchedFilesChanged)
+    {
+        return;
+    }
+
+    // a module is loaded before the modules it requires, so reverse load order puts dependencies first
+    Changed.Sort([](const TPair<int32, FString>& A, const TPair<int32, FString>& B) { return A.Key > B.Key; });
+    TArray<FString> Paths;
+    for (auto& Item : Changed)
+    {
+        Paths.Add(Item.Value);
+    }
+    UE_LOG(Puerts, Log, TEXT("%d watched files changed"), Paths.Num());
+    OnWatchedFilesChanged(Paths);
+}
+
 FSourceFileWatcher::~FSourceFileWatcher()
 {
+    FUETicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    if (HashingTask.IsValid())
+    {
+        HashingTask.Wait();
+    }
+
     FDirectoryWatcherModule& DirectoryWatcherModule =
         FModuleManager::Get().LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
     IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get();
@@ -0,0 +1,76 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "StructSlabAllocator.h"
+
+namespace puerts
+{
+FStructSlabAllocator::FStructSlabAllocator()
+{
+    FMemory::Memzero(FreeLists, sizeof(FreeLists));
+    FMemory::Memzero(BumpCursor, sizeof(BumpCursor));
+    FMemory::Memzero(BumpEnd, sizeof(BumpEnd));
+    Disabled = false;
+}
+
+FStructSlabAllocator::~FStructSlabAllocator()
+{
+    for (auto& KV : ChunkSizeClass)
+    {
+        FMemory::Free(reinterpret_cast<void*>(KV.Key));
+    }
+    ChunkSizeClass.Empty();
+}
+
+void* FStructSlabAllocator::Alloc(int32 Size, int32 Alignment)
+{
+    if (Disabled || Size <= 0 || Size > PUERTS_STRUCT_SLAB_MAX_SIZE || Alignment > Granularity)
+    {
+        return nullptr;
+    }
+    const int32 SizeClass = (Size - 1) / Granularity;
+
+    if (FFreeBlock* Block = FreeLists[SizeClass])
+    {
+        FreeLists[SizeClass] = Block->Next;
+        return Block;
+    }
+
+    const int32 BlockSize = (SizeClass + 1) * Granularity;
+    if (BumpEnd[SizeClass] - BumpCursor[SizeClass] < BlockSize)
+    {
+        uint8* Chunk = static_cast<uint8*>(FMemory::Malloc(ChunkSize, ChunkSize));
+        // Owns靠chunk对齐反查，分配器给不了这么大的对齐就整体退回new char[]
+        if (!IsAligned(Chunk, ChunkSize))
+        {
+            FMemory::Free(Chunk);
+            Disabled = true;
+            return nullptr;
+        }
+        ChunkSizeClass.Add(reinterpret_cast<UPTRINT>(Chunk), SizeClass);
+        BumpCursor[SizeClass] = Chunk;
+        BumpEnd[SizeClass] = Chunk + ChunkSize;
+    }
+    void* Result = BumpCursor[SizeClass];
+    BumpCursor[SizeClass] += BlockSize;
+    return Result;
+}
+
+bool FStructSlabAllocator::Free(void* Ptr)
+{
+    const int32* SizeClass = ChunkSizeClass.Find(reinterpret_cast<UPTRINT>(Ptr) & ~(UPTRINT) (ChunkSize - 1));
+    if (!SizeClass)
+    {
+        return false;
+    }
+    FFreeBlock* Block = static_cast<FFreeBlock*>(Ptr);
+    Block->Next = FreeLists[*SizeClass];
+    FreeLists[*SizeClass] = Block;
+    return true;
+}
+}    // namespace puerts
@@ -0,0 +1,65 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 按16字节分级，超过上限的struct仍然走new char[]
+#ifndef PUERTS_STRUCT_SLAB_MAX_SIZE
+#define PUERTS_STRUCT_SLAB_MAX_SIZE 256
+#endif
+
+namespace puerts
+{
+// 给按值传到js的struct（返回值、out参数、new出来的struct）分配内存，js对象gc后内存回到对应size class的空闲链表重用。
+// per env, not thread safe: only touched on the thread which owns the isolate.
+// chunk按自身大小对齐，Owns只需要查一次chunk表，所以Free可以接受任何指针，不是这里分配的返回false由调用方处理。
+// chunk在env销毁时才整体释放，常驻内存等于峰值时的用量
+class FStructSlabAllocator
+{
+public:
+    FStructSlabAllocator();
+
+    ~FStructSlabAllocator();
+
+    // 返回nullptr表示这个大小/对齐不由slab负责
+    void* Alloc(int32 Size, int32 Alignment);
+
+    bool Owns(const void* Ptr) const
+    {
+        return ChunkSizeClass.Contains(reinterpret_cast<UPTRINT>(Ptr) & ~(UPTRINT) (ChunkSize - 1));
+    }
+
+    // 只归还内存，析构由调用方负责
+    bool Free(void* Ptr);
+
+    static constexpr int32 Granularity = 16;
+
+    static constexpr int32 NumSizeClasses = PUERTS_STRUCT_SLAB_MAX_SIZE / Granularity;
+
+    static constexpr int32 ChunkSize = 64 * 1024;
+
+private:
+    struct FFreeBlock
+    {
+        FFreeBlock* Next;
+    };
+
+    FFreeBlock* FreeLists[NumSizeClasses];
+
+    // 每个size class当前切分中的chunk
+    uint8* BumpCursor[NumSizeClasses];
+
+    uint8* BumpEnd[NumSizeClasses];
+
+    TMap<UPTRINT, int32> ChunkSizeClass;
+
+    bool Disabled;
+};
+}    // namespace puerts
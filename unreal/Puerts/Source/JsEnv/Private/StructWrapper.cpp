@@ -539,7 +539,8 @@ void FScriptStructWrapper::New(
             }
             else
             {
-                Memory = Alloc(static_cast<UScriptStruct*>(Struct.Get()));
+                Memory = Alloc(static_cast<UScriptStruct*>(Struct.Get()),
+                    FV8Utils::IsolateData<IObjectMapper>(Isolate)->GetStructAllocator());
                 const int Count = Info.Length() < Properties.size() ? Info.Length() : Properties.size();
                 for (int i = 0; i < Count; ++i)
                 {
@@ -555,16 +556,29 @@ void FScriptStructWrapper::New(
     }
 }
 
-void* FScriptStructWrapper::Alloc(UScriptStruct* InScriptStruct)
+void* FScriptStructWrapper::Alloc(UScriptStruct* InScriptStruct, FStructSlabAllocator* Allocator)
 {
-    void* ScriptStructMemory = new char[InScriptStruct->GetStructureSize()];
+    void* ScriptStructMemory =
+        Allocator ? Allocator->Alloc(InScriptStruct->GetStructureSize(), InScriptStruct->GetMinAlignment()) : nullptr;
+    if (!ScriptStructMemory)
+    {
+        ScriptStructMemory = new char[InScriptStruct->GetStructureSize()];
+    }
     InScriptStruct->InitializeStruct(ScriptStructMemory);
     return ScriptStructMemory;
 }
 
-void FScriptStructWrapper::Free(TWeakObjectPtr<UStruct> InStruct, FinalizeFunc InExternalFinalize, void* Ptr)
+void FScriptStructWrapper::Free(
+    TWeakObjectPtr<UStruct> InStruct, FinalizeFunc InExternalFinalize, void* Ptr, FStructSlabAllocator* Allocator)
 {
-    if (InExternalFinalize)
+    // slab里的内存即使类型有静态绑定的Finalize也不能交给它delete
+    if (Allocator && Allocator->Owns(Ptr))
+    {
+        if (InStruct.IsValid())
+            InStruct->DestroyStruct(Ptr);
+        Allocator->Free(Ptr);
+    }
+    else if (InExternalFinalize)
     {
         InExternalFinalize(Ptr);
     }
@@ -580,8 +594,19 @@ void FScriptStructWrapper::OnGarbageCollectedWithFree(const v8::WeakCallbackInfo
 {
     FScriptStructWrapper* ScriptStructWrapper = Data.GetParameter();
     void* ScriptStructMemory = DataTransfer::MakeAddressWithHighPartOfTwo(Data.GetInternalField(0), Data.GetInternalField(1));
-    FV8Utils::IsolateData<IObjectMapper>(Data.GetIsolate())->UnBindStruct(ScriptStructWrapper, ScriptStructMemory);
-    Free(ScriptStructWrapper->Struct, ScriptStructWrapper->ExternalFinalize, ScriptStructMemory);
+    v8::Isolate* Isolate = Data.GetIsolate();
+    auto ObjectMapper = FV8Utils::IsolateData<IObjectMapper>(Isolate);
+    ObjectMapper->UnBindStruct(ScriptStructWrapper, ScriptStructMemory);
+    // DestroyStruct要在游戏线程做，slab和工作线程共用，要拿着Locker
+    ObjectMapper->RunOnGameThread(
+        [Isolate, Struct = ScriptStructWrapper->Struct, ExternalFinalize = ScriptStructWrapper->ExternalFinalize, ScriptStructMemory,
+            Allocator = ObjectMapper->GetStructAllocator()]()
+        {
+#ifdef THREAD_SAFE
+            v8::Locker Locker(Isolate);
+#endif
+            Free(Struct, ExternalFinalize, ScriptStructMemory, Allocator);
+        });
 }
 
 void FScriptStructWrapper::OnGarbageCollected(const v8::WeakCallbackInfo<FScriptStructWrapper>& Data)
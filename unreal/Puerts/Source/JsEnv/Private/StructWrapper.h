@@ -17,6 +17,7 @@
 #include "PropertyTranslator.h"
 #include "FunctionTranslator.h"
 #include "JSClassRegister.h"
+#include "StructSlabAllocator.h"
 
 #pragma warning(push, 0)
 #include "libplatform/libplatform.h"
@@ -109,13 +110,15 @@ public:
 
     static void OnGarbageCollected(const v8::WeakCallbackInfo<FScriptStructWrapper>& Data);
 
-    static void* Alloc(UScriptStruct* InScriptStruct);
+    // Allocator为空或者struct太大时用new char[]
+    static void* Alloc(UScriptStruct* InScriptStruct, FStructSlabAllocator* Allocator = nullptr);
 
-    static void Free(TWeakObjectPtr<UStruct> InStruct, FinalizeFunc InExternalFinalize, void* Ptr);
+    static void Free(
+        TWeakObjectPtr<UStruct> InStruct, FinalizeFunc InExternalFinalize, void* Ptr, FStructSlabAllocator* Allocator = nullptr);
 
-    void Free(void* Ptr)
+    void Free(void* Ptr, FStructSlabAllocator* Allocator = nullptr)
     {
-        Free(Struct, ExternalFinalize, Ptr);
+        Free(Struct, ExternalFinalize, Ptr, Allocator);
     }
 
     static void New(const v8::FunctionCallbackInfo<v8::Value>& Info);
@@ -0,0 +1,112 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && defined(THREAD_SAFE) && !defined(ENGINE_INDEPENDENT_JSENV)
+
+#include <atomic>
+
+#include "HAL/PlatformProcess.h"
+#include "JsEnvGroup.h"
+#include "V8Utils.h"
+
+namespace puerts
+{
+static int32 EvalInt(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const TCHAR* Code)
+{
+    auto Script = v8::Script::Compile(Context, FV8Utils::ToV8String(Isolate, Code)).ToLocalChecked();
+    return Script->Run(Context).ToLocalChecked()->Int32Value(Context).ToChecked();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJsEnvGroupParallelTest, "Puerts.JsEnvGroup.Parallel",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FJsEnvGroupParallelTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 JobCount = 200;
+    FJsEnvGroup Group(2);
+
+    if (!TestTrue(TEXT("StartParallelExecution"), Group.StartParallelExecution()))
+    {
+        return false;
+    }
+    TestTrue(TEXT("IsParallelExecution after start"), Group.IsParallelExecution());
+
+    // 每个env的任务都在自己的工作线程上按投递顺序执行
+    std::atomic<int32> RunOnGameThread(0);
+    std::atomic<int32> UnmarkedWorker(0);
+    TArray<TFuture<int32>> Futures[2];
+    for (int32 i = 0; i < JobCount; i++)
+    {
+        for (int32 Index = 0; Index < 2; Index++)
+        {
+            Futures[Index].Add(Group.Post<int32>(Index,
+                [&RunOnGameThread, &UnmarkedWorker](v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+                {
+                    if (IsInGameThread())
+                    {
+                        ++RunOnGameThread;
+                    }
+                    // 工作线程做了标记，在上面访问UObject会被FV8Utils::GetUObject里的check拦下
+                    if (!FV8Utils::IsJsEnvWorkerThread())
+                    {
+                        ++UnmarkedWorker;
+                    }
+                    return EvalInt(Isolate, Context, TEXT("globalThis.__counter = (globalThis.__counter || 0) + 1"));
+                }));
+        }
+    }
+    for (int32 Index = 0; Index < 2; Index++)
+    {
+        for (int32 i = 0; i < JobCount; i++)
+        {
+            TestEqual(TEXT("job result in posting order"), Futures[Index][i].Get(), i + 1);
+        }
+    }
+    TestEqual(TEXT("jobs run off the game thread"), RunOnGameThread.load(), 0);
+    TestEqual(TEXT("worker threads are marked for the UObject check"), UnmarkedWorker.load(), 0);
+    TestFalse(TEXT("game thread is not marked"), FV8Utils::IsJsEnvWorkerThread());
+
+    // 停止过程中任务里投递给另一个env的任务和同步点命令都不能丢
+    std::atomic<bool> CrossPostRun(false);
+    std::atomic<bool> CommandRun(false);
+    std::atomic<bool> CommandOnGameThread(false);
+    Group.PostJob(0,
+        [&Group, &CrossPostRun, &CommandRun, &CommandOnGameThread](v8::Isolate*, v8::Local<v8::Context>)
+        {
+            FPlatformProcess::Sleep(0.05f);
+            Group.PostJob(1, [&CrossPostRun](v8::Isolate*, v8::Local<v8::Context>) { CrossPostRun = true; });
+            Group.EnqueueSyncPointCommand(
+                [&CommandRun, &CommandOnGameThread]()
+                {
+                    CommandOnGameThread = IsInGameThread();
+                    CommandRun = true;
+                });
+        });
+    Group.StopParallelExecution();
+    TestFalse(TEXT("IsParallelExecution after stop"), Group.IsParallelExecution());
+    TestTrue(TEXT("job posted while stopping has run"), CrossPostRun.load());
+    TestTrue(TEXT("sync point command has run"), CommandRun.load());
+    TestTrue(TEXT("sync point command runs on the game thread"), CommandOnGameThread.load());
+
+    // 串行模式下游戏线程投递的任务立即执行
+    bool SerialRun = false;
+    Group.PostJob(0,
+        [&SerialRun](v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+        {
+            SerialRun = IsInGameThread() && EvalInt(Isolate, Context, TEXT("globalThis.__counter")) == JobCount;
+        });
+    TestTrue(TEXT("serial job runs inline with the state left by the workers"), SerialRun);
+
+    return true;
+}
+}    // namespace puerts
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && USE_WASM3 && !defined(ENGINE_INDEPENDENT_JSENV)
+
+#include "DataTransfer.h"
+#include "JsEnvGroup.h"
+#include "MessagePort.h"
+#include "V8Utils.h"
+#include "WasmEnv.h"
+#include "WasmRuntime.h"
+#include "PuertsWasm/WasmJsFunctionParams.h"
+
+namespace puerts
+{
+// (module (import "env" "f" (func)) (func (export "g") call 0))
+static const uint8 CallImportWasm[] = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x04, 0x01, 0x60, 0x00, 0x00, 0x02,
+    0x09, 0x01, 0x03, 0x65, 0x6e, 0x76, 0x01, 0x66, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x07, 0x05, 0x01, 0x01, 0x67, 0x00, 0x01,
+    0x0a, 0x06, 0x01, 0x04, 0x00, 0x10, 0x00, 0x0b};
+
+static v8::Local<v8::Value> EvalValue(v8::Isolate* Isolate, v8::Local<v8::Context> Context, const TCHAR* Code)
+{
+    auto Script = v8::Script::Compile(Context, FV8Utils::ToV8String(Isolate, Code)).ToLocalChecked();
+    return Script->Run(Context).ToLocalChecked();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWasmInstanceDetachTest, "Puerts.Wasm.InstanceImportGetterDetachesBytes",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FWasmInstanceDetachTest::RunTest(const FString& Parameters)
+{
+    FJsEnvGroup Group(1);
+    Group.PostJob(0,
+        [this](v8::Isolate* Isolate, v8::Local<v8::Context> Context)
+        {
+            WasmEnv Env;
+            TArray<std::shared_ptr<WasmRuntime>> RuntimeList;
+            RuntimeList.Add(std::make_shared<WasmRuntime>(&Env));
+            TArray<WasmNormalLinkInfo*> LinkInfos;
+
+            auto Global = Context->Global();
+            (void) Global->Set(Context, FV8Utils::ToV8String(Isolate, "__detach"),
+                v8::Function::New(Context,
+                    [](const v8::FunctionCallbackInfo<v8::Value>& Info)
+                    { MessagePort::DetachTransferred({Info[0].As<v8::ArrayBuffer>()}); })
+                    .ToLocalChecked());
+
+            auto Instance = [&](const TCHAR* ImportsCode, v8::Local<v8::Object> Exports) -> bool
+            {
+                auto Bytes = v8::ArrayBuffer::New(Isolate, sizeof(CallImportWasm));
+                FMemory::Memcpy(DataTransfer::GetArrayBufferData(Bytes), CallImportWasm, sizeof(CallImportWasm));
+                (void) Global->Set(Context, FV8Utils::ToV8String(Isolate, "__bytes"), Bytes);
+                auto Imports = EvalValue(Isolate, Context, ImportsCode);
+                v8::TryCatch TryCatch(Isolate);
+                NormalInstanceModule(Isolate, Context, Bytes, Exports, Imports, RuntimeList, LinkInfos);
+                return !TryCatch.HasCaught();
+            };
+
+            // 导入对象的getter把字节码detach了：不能再去读已经释放的内存，要抛异常
+            auto DetachedExports = v8::Object::New(Isolate);
+            TestFalse(TEXT("instance with bytes detached by an import getter throws"),
+                Instance(TEXT("({ env: { get f() { __detach(__bytes); return () => {}; } } })"), DetachedExports));
+            TestTrue(TEXT("no exports from detached bytes"),
+                DetachedExports->Get(Context, FV8Utils::ToV8String(Isolate, "g")).ToLocalChecked()->IsUndefined());
+
+            // 同样的getter不detach时正常链接，导出函数调用到getter返回的函数
+            auto Exports = v8::Object::New(Isolate);
+            TestTrue(TEXT("instance with a plain import getter"),
+                Instance(TEXT("globalThis.__called = 0; ({ env: { get f() { return () => { ++__called; }; } } })"), Exports));
+            (void) Global->Set(Context, FV8Utils::ToV8String(Isolate, "__exports"), Exports);
+            TestEqual(TEXT("import called through the export"),
+                EvalValue(Isolate, Context, TEXT("__exports.g(); __called"))->Int32Value(Context).ToChecked(), 1);
+
+            RuntimeList.Empty();
+            for (auto Item : LinkInfos)
+            {
+                delete Item;
+            }
+        });
+
+    return true;
+}
+}    // namespace puerts
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "UvPump.h"
+
+#if defined(WITH_NODEJS)
+
+#if defined(_WIN32)
+#if defined(USING_IN_UNREAL_ENGINE)
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <windows.h>
+#endif
+#else
+#include <errno.h>
+#include <poll.h>
+#endif
+
+namespace puerts
+{
+int UvPump::BackendFd() const
+{
+#if defined(_WIN32)
+    return -1;
+#else
+    return uv_backend_fd(Loop);
+#endif
+}
+
+int UvPump::NextTimeout()
+{
+    if (!uv_loop_alive(Loop))
+    {
+        return -1;
+    }
+    if (HasPendingWatchers())
+    {
+        return 0;
+    }
+    uv_update_time(Loop);
+    return uv_backend_timeout(Loop);
+}
+
+bool UvPump::IsReady()
+{
+    // loop不活跃时uv_run(UV_RUN_NOWAIT)本身也什么都不做
+    if (!uv_loop_alive(Loop))
+    {
+        return false;
+    }
+    return NextTimeout() == 0 || PollBackend(0);
+}
+
+bool UvPump::Wait(int MaxWaitMs)
+{
+    if (!uv_loop_alive(Loop))
+    {
+        return false;
+    }
+    int Timeout = NextTimeout();
+    if (Timeout == 0)
+    {
+        return true;
+    }
+    if (MaxWaitMs >= 0 && (Timeout < 0 || Timeout > MaxWaitMs))
+    {
+        Timeout = MaxWaitMs;
+    }
+    if (PollBackend(Timeout))
+    {
+        return true;
+    }
+    return NextTimeout() == 0;
+}
+
+bool UvPump::RunIfReady()
+{
+    if (!IsReady())
+    {
+        return false;
+    }
+    uv_run(Loop, UV_RUN_NOWAIT);
+    return true;
+}
+
+bool UvPump::HasPendingWatchers() const
+{
+    // 新的io watcher要等下一次uv_run才会注册进epoll/kqueue，在那之前backend fd不会可读，所以要单独检查
+#if defined(_WIN32)
+    return false;
+#elif UV_VERSION_HEX >= 0x012D00    // 1.45.0 changed QUEUE to struct uv__queue
+    return Loop->watcher_queue.next != &Loop->watcher_queue;
+#else
+    return Loop->watcher_queue[0] != static_cast<void*>(&Loop->watcher_queue);
+#endif
+}
+
+bool UvPump::PollBackend(int TimeoutMs)
+{
+#if defined(_WIN32)
+    DWORD Bytes;
+    ULONG_PTR Key;
+    OVERLAPPED* Overlapped = nullptr;
+    GetQueuedCompletionStatus(Loop->iocp, &Bytes, &Key, &Overlapped, TimeoutMs < 0 ? INFINITE : static_cast<DWORD>(TimeoutMs));
+    if (Overlapped == nullptr)
+    {
+        return false;
+    }
+    // Give the event back so libuv can deal with it.
+    PostQueuedCompletionStatus(Loop->iocp, Bytes, Key, Overlapped);
+    return true;
+#else
+    struct pollfd Pfd;
+    Pfd.fd = uv_backend_fd(Loop);
+    Pfd.events = POLLIN;
+    Pfd.revents = 0;
+    int Ret;
+    do
+    {
+        Ret = poll(&Pfd, 1, TimeoutMs);
+    } while (Ret == -1 && errno == EINTR);
+    return Ret > 0;
+#endif
+}
+}    // namespace puerts
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#if defined(WITH_NODEJS)
+
+#pragma warning(push, 0)
+#include "uv.h"
+#pragma warning(pop)
+
+namespace puerts
+{
+// 按需驱动libuv：只有loop还活着并且确实有事可做（到期的timer、pending回调、待注册的watcher、backend fd可读）时才uv_run，
+// 用来替代每帧无条件的uv_run(UV_RUN_NOWAIT)和专门阻塞在epoll上再往主线程投递任务的轮询线程。
+// drive libuv on demand from the host's tick. all methods must be called on the thread which owns the loop.
+// only the libuv side is covered: v8 foreground/delayed tasks never keep the loop alive, the host still has to
+// DrainTasks on every tick.
+class UvPump
+{
+public:
+    explicit UvPump(uv_loop_t* InLoop) : Loop(InLoop)
+    {
+    }
+
+    // linux上是epoll fd，mac上是kqueue fd，可以交给宿主自己的事件循环监听；windows上没有可poll的fd，返回-1
+    int BackendFd() const;
+
+    // 距离下一个timer到期的毫秒数，0表示现在就有事可做，-1表示没有timer（只等io）
+    int NextTimeout();
+
+    // 零超时检查是否需要uv_run
+    bool IsReady();
+
+    // 阻塞直到IsReady或者超时，MaxWaitMs < 0表示只以下一个timer为准，给不需要每帧tick的专用服务器精确休眠用
+    bool Wait(int MaxWaitMs);
+
+    // 需要时执行一次uv_run(UV_RUN_NOWAIT)并返回true，否则什么都不做；调用者负责进入isolate和context
+    bool RunIfReady();
+
+private:
+    bool HasPendingWatchers() const;
+
+    bool PollBackend(int TimeoutMs);
+
+    uv_loop_t* Loop;
+};
+}    // namespace puerts
+
+#endif
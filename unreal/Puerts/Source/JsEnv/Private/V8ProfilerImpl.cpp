@@ -0,0 +1,480 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#include "V8ProfilerImpl.h"
+
+#if !defined(WITH_QUICKJS)
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+#if PLATFORM_WINDOWS
+#include <locale>
+#include <codecvt>
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#include "v8.h"
+#include "v8-profiler.h"
+#pragma warning(pop)
+
+// AllocationProfile::GetSamples()和Node::node_id是v8 7.x后期才加的
+#if V8_MAJOR_VERSION >= 8
+#define PUERTS_ALLOCATION_PROFILE_SAMPLES 1
+#else
+#define PUERTS_ALLOCATION_PROFILE_SAMPLES 0
+#endif
+
+namespace puerts
+{
+static FILE* OpenFileForWrite(const std::string& Path)
+{
+#if PLATFORM_WINDOWS
+#pragma warning(push)
+#pragma warning(disable : 4996)    // std::wstring_convert is deprecated in c++17
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> Conv;
+    FILE* File = _wfopen(Conv.from_bytes(Path).c_str(), L"wb");
+#pragma warning(pop)
+    return File;
+#else
+    return fopen(Path.c_str(), "wb");
+#endif
+}
+
+// 流式写json，避免大profile在内存里再拼一份字符串
+class FProfileJsonWriter
+{
+public:
+    explicit FProfileJsonWriter(FILE* InFile) : File(InFile)
+    {
+    }
+
+    void Raw(const char* Str)
+    {
+        fputs(Str, File);
+    }
+
+    void Int(int64_t Value)
+    {
+        fprintf(File, "%lld", static_cast<long long>(Value));
+    }
+
+    void String(const char* Str, size_t Len)
+    {
+        fputc('"', File);
+        for (size_t i = 0; i < Len; ++i)
+        {
+            unsigned char C = static_cast<unsigned char>(Str[i]);
+            switch (C)
+            {
+                case '"':
+                    fputs("\\\"", File);
+                    break;
+                case '\\':
+                    fputs("\\\\", File);
+                    break;
+                case '\n':
+                    fputs("\\n", File);
+                    break;
+                case '\r':
+                    fputs("\\r", File);
+                    break;
+                case '\t':
+                    fputs("\\t", File);
+                    break;
+                default:
+                    if (C < 0x20)
+                    {
+                        fprintf(File, "\\u%04x", C);
+                    }
+                    else
+                    {
+                        fputc(C, File);
+                    }
+            }
+        }
+        fputc('"', File);
+    }
+
+    void String(v8::Isolate* Isolate, v8::Local<v8::Value> Value)
+    {
+        if (Value.IsEmpty())
+        {
+            String("", 0);
+            return;
+        }
+        v8::String::Utf8Value Utf8(Isolate, Value);
+        String(*Utf8 ? *Utf8 : "", *Utf8 ? Utf8.length() : 0);
+    }
+
+    bool Close()
+    {
+        bool Ok = ferror(File) == 0;
+        return fclose(File) == 0 && Ok;
+    }
+
+private:
+    FILE* File;
+};
+
+class FProfileOutputStream : public v8::OutputStream
+{
+public:
+    explicit FProfileOutputStream(FILE* InFile) : File(InFile), Failed(false)
+    {
+    }
+
+    void EndOfStream() override
+    {
+    }
+
+    int GetChunkSize() override
+    {
+        return 64 * 1024;
+    }
+
+    WriteResult WriteAsciiChunk(char* Data, int Size) override
+    {
+        if (fwrite(Data, 1, Size, File) != static_cast<size_t>(Size))
+        {
+            Failed = true;
+            return kAbort;
+        }
+        return kContinue;
+    }
+
+    FILE* File;
+    bool Failed;
+};
+
+class V8ProfilerImpl : public V8Profiler
+{
+public:
+    explicit V8ProfilerImpl(v8::Isolate* InIsolate) : Isolate(InIsolate), CpuProfiler(nullptr), SamplingHeap(false)
+    {
+    }
+
+    ~V8ProfilerImpl() override
+    {
+        if (CpuProfiler)
+        {
+            CpuProfiler->Dispose();
+            CpuProfiler = nullptr;
+        }
+        if (SamplingHeap)
+        {
+            Isolate->GetHeapProfiler()->StopSamplingHeapProfiler();
+        }
+    }
+
+    bool StartCpuProfile(int32_t SamplingIntervalUs) override
+    {
+        if (CpuProfiler)
+        {
+            return false;
+        }
+        v8::HandleScope HandleScope(Isolate);
+        CpuProfiler = v8::CpuProfiler::New(Isolate);
+        if (SamplingIntervalUs > 0)
+        {
+            CpuProfiler->SetSamplingInterval(SamplingIntervalUs);
+        }
+        CpuProfiler->StartProfiling(ProfileTitle(), true);
+        return true;
+    }
+
+    bool StopCpuProfile(const std::string& Path) override
+    {
+        if (!CpuProfiler)
+        {
+            return false;
+        }
+        v8::HandleScope HandleScope(Isolate);
+        v8::CpuProfile* Profile = CpuProfiler->StopProfiling(ProfileTitle());
+        bool Ok = false;
+        if (Profile)
+        {
+            Ok = WriteCpuProfile(Profile, Path);
+            Profile->Delete();
+        }
+        CpuProfiler->Dispose();
+        CpuProfiler = nullptr;
+        return Ok;
+    }
+
+    bool IsCpuProfiling() const override
+    {
+        return CpuProfiler != nullptr;
+    }
+
+    bool TakeHeapSnapshot(const std::string& Path) override
+    {
+        FILE* File = OpenFileForWrite(Path);
+        if (!File)
+        {
+            return false;
+        }
+        v8::HandleScope HandleScope(Isolate);
+        const v8::HeapSnapshot* Snapshot = Isolate->GetHeapProfiler()->TakeHeapSnapshot();
+        if (!Snapshot)
+        {
+            fclose(File);
+            return false;
+        }
+        FProfileOutputStream Stream(File);
+        Snapshot->Serialize(&Stream, v8::HeapSnapshot::kJSON);
+        const_cast<v8::HeapSnapshot*>(Snapshot)->Delete();
+        return fclose(File) == 0 && !Stream.Failed;
+    }
+
+    bool StartSamplingHeapProfiler(uint64_t SampleInterval, int32_t StackDepth) override
+    {
+        if (SamplingHeap)
+        {
+            return false;
+        }
+        SamplingHeap = Isolate->GetHeapProfiler()->StartSamplingHeapProfiler(
+            SampleInterval > 0 ? SampleInterval : 512 * 1024, StackDepth > 0 ? StackDepth : 16);
+        return SamplingHeap;
+    }
+
+    bool StopSamplingHeapProfiler(const std::string& Path) override
+    {
+        if (!SamplingHeap)
+        {
+            return false;
+        }
+        v8::HandleScope HandleScope(Isolate);
+        v8::HeapProfiler* HeapProfiler = Isolate->GetHeapProfiler();
+        std::unique_ptr<v8::AllocationProfile> Profile(HeapProfiler->GetAllocationProfile());
+        HeapProfiler->StopSamplingHeapProfiler();
+        SamplingHeap = false;
+        return Profile && WriteAllocationProfile(Profile.get(), Path);
+    }
+
+    bool IsSamplingHeapProfiling() const override
+    {
+        return SamplingHeap;
+    }
+
+private:
+    v8::Local<v8::String> ProfileTitle()
+    {
+        return v8::String::NewFromUtf8(Isolate, "puerts", v8::NewStringType::kNormal).ToLocalChecked();
+    }
+
+    void WriteCallFrame(FProfileJsonWriter& Writer, v8::Local<v8::String> FunctionName, int ScriptId,
+        v8::Local<v8::Value> Url, int LineNumber, int ColumnNumber)
+    {
+        // DevTools的行列号从0开始，v8 profiler的从1开始，0表示没有位置信息
+        Writer.Raw("{\"functionName\":");
+        Writer.String(Isolate, FunctionName);
+        Writer.Raw(",\"scriptId\":\"");
+        Writer.Int(ScriptId);
+        Writer.Raw("\",\"url\":");
+        Writer.String(Isolate, Url);
+        Writer.Raw(",\"lineNumber\":");
+        Writer.Int(LineNumber - 1);
+        Writer.Raw(",\"columnNumber\":");
+        Writer.Int(ColumnNumber - 1);
+        Writer.Raw("}");
+    }
+
+    void WriteCpuProfileNode(FProfileJsonWriter& Writer, const v8::CpuProfileNode* Node, bool& First)
+    {
+        if (!First)
+        {
+            Writer.Raw(",");
+        }
+        First = false;
+        Writer.Raw("{\"id\":");
+        Writer.Int(Node->GetNodeId());
+        Writer.Raw(",\"callFrame\":");
+        WriteCallFrame(Writer, Node->GetFunctionName(), Node->GetScriptId(), Node->GetScriptResourceName(), Node->GetLineNumber(),
+            Node->GetColumnNumber());
+        Writer.Raw(",\"hitCount\":");
+        Writer.Int(Node->GetHitCount());
+        Writer.Raw(",\"children\":[");
+        const int ChildrenCount = Node->GetChildrenCount();
+        for (int i = 0; i < ChildrenCount; ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            Writer.Int(Node->GetChild(i)->GetNodeId());
+        }
+        Writer.Raw("]}");
+
+        for (int i = 0; i < ChildrenCount; ++i)
+        {
+            WriteCpuProfileNode(Writer, Node->GetChild(i), First);
+        }
+    }
+
+    bool WriteCpuProfile(v8::CpuProfile* Profile, const std::string& Path)
+    {
+        FILE* File = OpenFileForWrite(Path);
+        if (!File)
+        {
+            return false;
+        }
+        FProfileJsonWriter Writer(File);
+
+        Writer.Raw("{\"nodes\":[");
+        bool First = true;
+        WriteCpuProfileNode(Writer, Profile->GetTopDownRoot(), First);
+        Writer.Raw("],\"startTime\":");
+        Writer.Int(Profile->GetStartTime());
+        Writer.Raw(",\"endTime\":");
+        Writer.Int(Profile->GetEndTime());
+
+        const int SamplesCount = Profile->GetSamplesCount();
+        Writer.Raw(",\"samples\":[");
+        for (int i = 0; i < SamplesCount; ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            Writer.Int(Profile->GetSample(i)->GetNodeId());
+        }
+        Writer.Raw("],\"timeDeltas\":[");
+        int64_t LastTimestamp = Profile->GetStartTime();
+        for (int i = 0; i < SamplesCount; ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            int64_t Timestamp = Profile->GetSampleTimestamp(i);
+            Writer.Int(Timestamp - LastTimestamp);
+            LastTimestamp = Timestamp;
+        }
+        Writer.Raw("]}");
+
+        return Writer.Close();
+    }
+
+    struct FAllocationSample
+    {
+        int64_t Size;
+        uint32_t NodeId;
+    };
+
+    // 老版本没有node_id和samples：按遍历顺序编号，samples由各节点的allocations还原（没有分配顺序）
+    void WriteAllocationNode(FProfileJsonWriter& Writer, const v8::AllocationProfile::Node* Node, uint32_t& LastNodeId,
+        std::vector<FAllocationSample>& OutSamples)
+    {
+#if PUERTS_ALLOCATION_PROFILE_SAMPLES
+        const uint32_t NodeId = Node->node_id;
+#else
+        const uint32_t NodeId = ++LastNodeId;
+#endif
+        int64_t SelfSize = 0;
+        for (const auto& Allocation : Node->allocations)
+        {
+            SelfSize += static_cast<int64_t>(Allocation.size) * Allocation.count;
+#if !PUERTS_ALLOCATION_PROFILE_SAMPLES
+            OutSamples.push_back({static_cast<int64_t>(Allocation.size) * Allocation.count, NodeId});
+#endif
+        }
+        Writer.Raw("{\"callFrame\":");
+        WriteCallFrame(Writer, Node->name, Node->script_id, Node->script_name, Node->line_number, Node->column_number);
+        Writer.Raw(",\"selfSize\":");
+        Writer.Int(SelfSize);
+        Writer.Raw(",\"id\":");
+        Writer.Int(NodeId);
+        Writer.Raw(",\"children\":[");
+        for (size_t i = 0; i < Node->children.size(); ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            WriteAllocationNode(Writer, Node->children[i], LastNodeId, OutSamples);
+        }
+        Writer.Raw("]}");
+    }
+
+    bool WriteAllocationProfile(v8::AllocationProfile* Profile, const std::string& Path)
+    {
+        FILE* File = OpenFileForWrite(Path);
+        if (!File)
+        {
+            return false;
+        }
+        FProfileJsonWriter Writer(File);
+
+        uint32_t LastNodeId = 0;
+        std::vector<FAllocationSample> NodeSamples;
+        Writer.Raw("{\"head\":");
+        WriteAllocationNode(Writer, Profile->GetRootNode(), LastNodeId, NodeSamples);
+        Writer.Raw(",\"samples\":[");
+#if PUERTS_ALLOCATION_PROFILE_SAMPLES
+        const auto& Samples = Profile->GetSamples();
+        for (size_t i = 0; i < Samples.size(); ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            Writer.Raw("{\"size\":");
+            Writer.Int(static_cast<int64_t>(Samples[i].size) * Samples[i].count);
+            Writer.Raw(",\"nodeId\":");
+            Writer.Int(Samples[i].node_id);
+            Writer.Raw(",\"ordinal\":");
+            Writer.Int(static_cast<int64_t>(Samples[i].sample_id));
+            Writer.Raw("}");
+        }
+#else
+        for (size_t i = 0; i < NodeSamples.size(); ++i)
+        {
+            if (i > 0)
+            {
+                Writer.Raw(",");
+            }
+            Writer.Raw("{\"size\":");
+            Writer.Int(NodeSamples[i].Size);
+            Writer.Raw(",\"nodeId\":");
+            Writer.Int(NodeSamples[i].NodeId);
+            Writer.Raw(",\"ordinal\":");
+            Writer.Int(static_cast<int64_t>(i + 1));
+            Writer.Raw("}");
+        }
+#endif
+        Writer.Raw("]}");
+
+        return Writer.Close();
+    }
+
+    v8::Isolate* Isolate;
+
+    v8::CpuProfiler* CpuProfiler;
+
+    bool SamplingHeap;
+};
+
+V8Profiler* CreateV8Profiler(void* InIsolatePtr)
+{
+    return new V8ProfilerImpl(static_cast<v8::Isolate*>(InIsolatePtr));
+}
+}    // namespace puerts
+
+#else
+
+namespace puerts
+{
+V8Profiler* CreateV8Profiler(void* InIsolatePtr)
+{
+    return nullptr;
+}
+}    // namespace puerts
+
+#endif
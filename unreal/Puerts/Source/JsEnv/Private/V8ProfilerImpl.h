@@ -0,0 +1,48 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+namespace puerts
+{
+// 不依赖调试器的profile抓取，输出的文件可以直接拖进Chrome DevTools
+// capture profiles without an attached debugger, the output files can be loaded by Chrome DevTools directly.
+// all methods must be called with the isolate entered (Locker + Isolate::Scope), paths are utf8.
+class V8Profiler
+{
+public:
+    // SamplingIntervalUs <= 0 means v8 default interval
+    virtual bool StartCpuProfile(int32_t SamplingIntervalUs) = 0;
+
+    // write a .cpuprofile file
+    virtual bool StopCpuProfile(const std::string& Path) = 0;
+
+    virtual bool IsCpuProfiling() const = 0;
+
+    // write a .heapsnapshot file
+    virtual bool TakeHeapSnapshot(const std::string& Path) = 0;
+
+    // SampleInterval: average bytes between samples
+    virtual bool StartSamplingHeapProfiler(uint64_t SampleInterval, int32_t StackDepth) = 0;
+
+    // write a .heapprofile file
+    virtual bool StopSamplingHeapProfiler(const std::string& Path) = 0;
+
+    virtual bool IsSamplingHeapProfiling() const = 0;
+
+    virtual ~V8Profiler()
+    {
+    }
+};
+
+// 接受v8::Isolate指针，返回一个新的V8Profiler指针，不支持的后端(quickjs)返回nullptr
+V8Profiler* CreateV8Profiler(void* InIsolatePtr);
+};    // namespace puerts
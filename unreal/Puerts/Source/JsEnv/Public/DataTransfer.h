@@ -20,6 +20,8 @@
 #include "v8.h"
 #pragma warning(pop)
 
+#include "RefCell.h"
+
 #if !defined(MAPPER_ISOLATE_DATA_POS)
 #define MAPPER_ISOLATE_DATA_POS 0
 #endif
@@ -269,6 +271,9 @@ public:
 
     static bool IsInstanceOf(v8::Isolate* Isolate, const void* TypeId, v8::Local<v8::Object> JsObject);
 
+    // walks the SuperTypeId chain of the registered classes, touches no v8 heap
+    static bool IsCppSubclassOf(const void* TypeId, const void* BaseTypeId);
+
     static v8::Local<v8::Value> UnRef(v8::Isolate* Isolate, const v8::Local<v8::Value>& Value);
 
     static void UpdateRef(v8::Isolate* Isolate, v8::Local<v8::Value> Outer, const v8::Local<v8::Value>& Value);
@@ -20,6 +20,7 @@
 #include "ObjectRetainer.h"
 #include "JSLogger.h"
 #include "JSModuleLoader.h"
+#include "MessagePort.h"
 #if !defined(ENGINE_INDEPENDENT_JSENV)
 #include "ExtensionMethods.h"
 #endif
@@ -39,6 +40,25 @@ public:
 
     virtual void RequestFullGarbageCollectionForTesting() = 0;
 
+    virtual bool StartCpuProfile(int32 SamplingIntervalUs) = 0;
+
+    virtual bool StopCpuProfile(const FString& Path) = 0;
+
+    virtual bool TakeHeapSnapshot(const FString& Path) = 0;
+
+    virtual bool StartSamplingHeapProfiler(uint64 SampleInterval, int32 StackDepth) = 0;
+
+    virtual bool StopSamplingHeapProfiler(const FString& Path) = 0;
+
+    virtual bool NotifyIdle(double BudgetSeconds) = 0;
+
+    virtual void MemoryPressureNotification(int32 Level) = 0;
+
+    virtual void GetGcPauseStatistics(
+        int32 Kind, uint64& OutCount, uint64& OutTotalMicroseconds, uint64& OutMaxMicroseconds, TArray<uint64>& OutHistogram) = 0;
+
+    virtual void ResetGcPauseStatistics() = 0;
+
     virtual void WaitDebugger(double Timeout) = 0;
 
 #if !defined(ENGINE_INDEPENDENT_JSENV)
@@ -57,6 +77,8 @@ public:
 
     virtual void InitExtensionMethodsMap() = 0;
 
+    virtual void AddMessagePort(const FString& Name, std::shared_ptr<MessagePort> Port) = 0;
+
     virtual ~IJsEnv()
     {
     }
@@ -85,6 +107,35 @@ public:
     // equivalent to Isolate->RequestGarbageCollectionForTesting(v8::Isolate::kFullGarbageCollection)
     void RequestFullGarbageCollectionForTesting();
 
+    // 不需要调试器也能抓取profile，输出文件可以直接用Chrome DevTools打开，quickjs后端不支持，返回false
+    // SamplingIntervalUs <= 0 means the v8 default interval
+    bool StartCpuProfile(int32 SamplingIntervalUs = 0);
+
+    // write a .cpuprofile file
+    bool StopCpuProfile(const FString& Path);
+
+    // write a .heapsnapshot file
+    bool TakeHeapSnapshot(const FString& Path);
+
+    // SampleInterval: average bytes between samples, 0 means the v8 default
+    bool StartSamplingHeapProfiler(uint64 SampleInterval = 0, int32 StackDepth = 0);
+
+    // write a .heapprofile file
+    bool StopSamplingHeapProfiler(const FString& Path);
+
+    // 把这一帧剩余的时间交给v8做gc，比如在帧末尾传入目标帧时间减去已用时间，低于1ms的预算会被忽略
+    // BudgetSeconds is a duration, not an absolute deadline like IdleNotificationDeadline. quickjs后端是空操作
+    bool NotifyIdle(double BudgetSeconds);
+
+    // Level: 0 none, 1 moderate, 2 critical. FCoreDelegates::GetMemoryTrimDelegate已经自动转发为critical
+    void MemoryPressureNotification(int32 Level);
+
+    // Kind: 0 minor, 1 major, 2 incremental marking, 3 all. OutHistogram[i]是时长在[2^i, 2^(i+1))微秒的停顿次数
+    void GetGcPauseStatistics(
+        int32 Kind, uint64& OutCount, uint64& OutTotalMicroseconds, uint64& OutMaxMicroseconds, TArray<uint64>& OutHistogram);
+
+    void ResetGcPauseStatistics();
+
     void WaitDebugger(double Timeout = 0);
 
     void TryBindJs(const class UObjectBase* InObject);
@@ -101,6 +152,11 @@ public:
 
     void InitExtensionMethodsMap();
 
+    // js里用puerts.getMessagePort(Name)拿到这个端口，postMessage的值按结构化克隆序列化，UObject按引用传递。
+    // 另一端（MessagePort::CreatePair的另一个返回值）可以在任意一个线程收发，收到的消息每帧在游戏线程交给onmessage。
+    // 同名的端口会替换掉旧的
+    void AddMessagePort(const FString& Name, std::shared_ptr<MessagePort> Port);
+
 private:
     std::unique_ptr<IJsEnv> GameScript;
 };
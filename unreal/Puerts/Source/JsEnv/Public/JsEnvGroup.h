@@ -8,13 +8,25 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
+#include <memory>
 
 #include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
 #include "JsEnv.h"
+#include "UECompatible.h"
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
 
 namespace puerts
 {
+struct FJsEnvGroupParallel;
+
 class JSENV_API FJsEnvGroup
 {
 public:
@@ -38,10 +50,66 @@ public:
 
     void SetJsEnvSelector(std::function<int(UObject*, int)> InSelector);
 
+    // 在第IndexA和第IndexB个env之间建一个channel，两边都用puerts.getMessagePort(Name)拿到自己那端。
+    // 每个方向是一个无锁的单生产者单消费者队列，并行模式下各自的工作线程收发不会互相等待，队列满时postMessage返回false。
+    // 只能在游戏线程调用
+    void ConnectMessagePorts(int IndexA, int IndexB, const FString& Name, int Capacity = 1024);
+
+    // 并行模式：每个env固定到自己的工作线程，PostJob投递的任务在该线程上拿着v8::Locker执行，不同env的任务可以同时跑。
+    // 游戏线程经TsConstruct/InvokeTsMethod等进入env时会等待该env正在执行的任务，结果仍然正确，只是有争用。
+    // 需要THREAD_SAFE（JsEnv.Build.cs里的ThreadSafe），否则返回false并保持串行模式。只能在游戏线程调用
+    bool StartParallelExecution();
+
+    // 执行完已投递的任务、停掉工作线程并跑一次SyncPoint，回到串行模式。只能在游戏线程调用。
+    // 停止一开始新投递的任务就按串行模式处理（见PostJob），任务里再投递给其它env的任务不会丢失
+    void StopParallelExecution();
+
+    // 正在停止时已经返回false，可以在任意线程调用
+    bool IsParallelExecution() const;
+
+    typedef TUniqueFunction<void(v8::Isolate*, v8::Local<v8::Context>)> FJob;
+
+    // 把Job投递给第Index个env，可以在任意线程调用。并行模式下按投递顺序在该env的工作线程执行；
+    // 串行模式下（包括正在停止并行模式时）只在游戏线程执行：游戏线程调用时立即执行，其它线程投递的在下一个同步点执行。
+    // Job已经在isolate、HandleScope和默认context里，脚本异常会写到env的Logger。
+    // 工作线程上的Job不能访问UObject（开发版本里FV8Utils::GetUObject会check），需要时用EnqueueSyncPointCommand交给游戏线程。
+    // 不拿锁，任务直接进工作线程的无锁队列
+    void PostJob(int Index, FJob Job);
+
+    // 同PostJob，返回的future在Job执行完后就绪。不要在另一个Job里等待它，两个env互相等待会死锁
+    template <typename ResultType>
+    TFuture<ResultType> Post(int Index, TUniqueFunction<ResultType(v8::Isolate*, v8::Local<v8::Context>)> Job)
+    {
+        TPromise<ResultType> Promise;
+        TFuture<ResultType> Future = Promise.GetFuture();
+        PostJob(Index,
+            [Promise = MoveTemp(Promise), Job = MoveTemp(Job)](v8::Isolate* Isolate, v8::Local<v8::Context> Context) mutable
+            { SetPromise(Promise, [&]() { return Job(Isolate, Context); }); });
+        return Future;
+    }
+
+    // 工作线程上的Job要读写UObject时投递到这里，无锁，可以在任意线程调用。
+    // 命令在游戏线程的下一个同步点按投递顺序批量执行，不要在Job里等待它执行完
+    void EnqueueSyncPointCommand(TUniqueFunction<void()> Command);
+
+    // 在游戏线程批量执行已投递的命令，core ticker每帧自动调用一次
+    void SyncPoint();
+
 private:
     std::vector<std::shared_ptr<IJsEnv>> JsEnvList;
 
+    // 只在游戏线程修改。其它线程读它之前先把PostingJobs加一，用完减一，StopParallelExecution等它回到0后才释放
+    std::atomic<FJsEnvGroupParallel*> Parallel{nullptr};
+
+    mutable std::atomic<int32> PostingJobs{0};
+
+    FUETickDelegateHandle SyncPointTickerHandle;
+
+    TQueue<TUniqueFunction<void()>, EQueueMode::Mpsc> SyncPointCommands;
+
     void Init();
+
+    void WaitPostingJobs();
 };
 
 }    // namespace puerts
@@ -0,0 +1,213 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if USING_IN_UNREAL_ENGINE
+#include "CoreMinimal.h"
+#elif !defined(JSENV_API)
+#define JSENV_API
+#endif
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
+
+// transferList里的ArrayBuffer直接交出BackingStore，不拷贝；
+// 拿不到BackingStore的构建（UE里不跨dll传stl对象）退化为随消息拷贝一份
+#if !defined(WITH_QUICKJS) && !defined(HAS_ARRAYBUFFER_NEW_WITHOUT_STL) && !USING_IN_UNREAL_ENGINE && V8_MAJOR_VERSION >= 8
+#define PUERTS_MESSAGE_TRANSFER_BUFFER 1
+#else
+#define PUERTS_MESSAGE_TRANSFER_BUFFER 0
+#endif
+
+#ifndef PUERTS_MESSAGE_PORT_CAPACITY
+#define PUERTS_MESSAGE_PORT_CAPACITY 1024
+#endif
+
+namespace puerts
+{
+struct Message
+{
+    // true: Data是原始字节，到js侧是一个ArrayBuffer，给没有isolate的native代码收发用
+    // false: Data是v8::ValueSerializer的输出
+    bool Raw = false;
+
+    std::vector<uint8_t> Data;
+
+#if PUERTS_MESSAGE_TRANSFER_BUFFER
+    std::vector<std::shared_ptr<v8::BackingStore>> ArrayBuffers;
+#endif
+
+    // 宿主在WriteHostObject里为消息持有的资源，消息被读走、发送失败或者随队列丢弃时释放，可能在任意线程析构
+    std::vector<std::shared_ptr<void>> HostObjects;
+};
+
+// 单生产者单消费者的无锁环形队列，容量向上取2的幂。Push只能有一个线程在调用，Pop也是
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t InCapacity) : Head(0), Tail(0)
+    {
+        size_t Size = 1;
+        while (Size < InCapacity)
+        {
+            Size <<= 1;
+        }
+        Slots.reset(new T[Size]);
+        Mask = Size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // 满了返回false，Item保持不变
+    bool Push(T&& Item)
+    {
+        const size_t CurrentTail = Tail.load(std::memory_order_relaxed);
+        if (CurrentTail - Head.load(std::memory_order_acquire) > Mask)
+        {
+            return false;
+        }
+        Slots[CurrentTail & Mask] = std::move(Item);
+        Tail.store(CurrentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& Out)
+    {
+        const size_t CurrentHead = Head.load(std::memory_order_relaxed);
+        if (CurrentHead == Tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        Out = std::move(Slots[CurrentHead & Mask]);
+        Slots[CurrentHead & Mask] = T();
+        Head.store(CurrentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Capacity() const
+    {
+        return Mask + 1;
+    }
+
+private:
+    std::unique_ptr<T[]> Slots;
+
+    size_t Mask;
+
+    alignas(64) std::atomic<size_t> Head;
+
+    alignas(64) std::atomic<size_t> Tail;
+};
+
+// 序列化时遇到带internal field的对象（UObject、C#对象等）交给宿主处理，返回false会抛DataCloneError
+class MessageHostDelegate
+{
+public:
+#if !defined(WITH_QUICKJS)
+    virtual bool WriteHostObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Object> Object,
+        v8::ValueSerializer& Serializer, Message& Msg) = 0;
+
+    // 失败时需要自己抛异常
+    virtual v8::MaybeLocal<v8::Object> ReadHostObject(
+        v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::ValueDeserializer& Deserializer) = 0;
+#endif
+
+    virtual ~MessageHostDelegate()
+    {
+    }
+};
+
+// MessageChannel的一端，A端Post的消息由B端Receive，反之亦然。每个方向一个SpscRing，所以同一个端口的Post
+// 只能有一个线程在调用（Receive也是），两个线程分别持有两端时完全不用加锁
+class JSENV_API MessagePort
+{
+public:
+    static void CreatePair(
+        std::shared_ptr<MessagePort>& OutA, std::shared_ptr<MessagePort>& OutB, size_t Capacity = PUERTS_MESSAGE_PORT_CAPACITY);
+
+    // 队列满或者已经关闭时返回false，Msg保持不变
+    bool Post(Message&& Msg);
+
+    bool Receive(Message& OutMsg);
+
+    // 关闭整个channel，两端之后的Post都会失败，已经在队列里的消息仍然可以收
+    void Close();
+
+    bool IsClosed() const;
+
+    size_t Capacity() const;
+
+    // value按结构化克隆序列化到OutMsg，失败时isolate里有待处理的异常。
+    // transferList里的ArrayBuffer放到OutTransferred，不在这里detach，消息Post成功后再调用DetachTransferred
+    static bool Serialize(v8::Isolate* Isolate, v8::Local<v8::Context> Context, v8::Local<v8::Value> Value,
+        v8::Local<v8::Value> TransferList, MessageHostDelegate* Host, Message& OutMsg,
+        std::vector<v8::Local<v8::ArrayBuffer>>& OutTransferred);
+
+    static void DetachTransferred(const std::vector<v8::Local<v8::ArrayBuffer>>& Transferred);
+
+    // 会移走Msg里transfer的ArrayBuffer
+    static v8::MaybeLocal<v8::Value> Deserialize(
+        v8::Isolate* Isolate, v8::Local<v8::Context> Context, Message& Msg, MessageHostDelegate* Host);
+
+private:
+    struct Channel;
+
+    MessagePort(std::shared_ptr<Channel> InChannel, int InSide) : Shared(InChannel), Side(InSide)
+    {
+    }
+
+    std::shared_ptr<Channel> Shared;
+
+    int Side;
+};
+
+// 把端口暴露给js的对象：postMessage(value, transferList)、postRaw(arrayBufferOrView)、close()，
+// 收到的消息由宿主在自己的tick里调用Dispatch交给js对象的onmessage。must be destroyed before the isolate
+class JSENV_API MessagePortBinding
+{
+public:
+    MessagePortBinding(std::shared_ptr<MessagePort> InPort, MessageHostDelegate* InHost) : Port(InPort), Host(InHost)
+    {
+    }
+
+    ~MessagePortBinding()
+    {
+        JsObject.Reset();
+    }
+
+    v8::Local<v8::Object> GetJsObject(v8::Isolate* Isolate, v8::Local<v8::Context> Context);
+
+    // 还没设置onmessage时消息留在队列里。每次最多分发一个队列容量的消息，
+    // onmessage抛出的异常写到OutError并停止本次分发，返回分发的条数
+    int Dispatch(v8::Isolate* Isolate, v8::Local<v8::Context> Context, std::string& OutError);
+
+    std::shared_ptr<MessagePort> Port;
+
+private:
+    static void OnPostMessage(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    static void OnPostRaw(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    static void OnClose(const v8::FunctionCallbackInfo<v8::Value>& Info);
+
+    MessageHostDelegate* Host;
+
+    v8::Global<v8::Object> JsObject;
+};
+}    // namespace puerts
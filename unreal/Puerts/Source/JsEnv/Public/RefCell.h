@@ -0,0 +1,114 @@
+/*
+ * Tencent is pleased to support the open source community by making Puerts available.
+ * Copyright (C) 2020 THL A29 Limited, a Tencent company.  All rights reserved.
+ * Puerts is licensed under the BSD 3-Clause License, except for the third-party components listed in the file 'LICENSE' which may
+ * be subject to their corresponding license terms. This file is subject to the terms and conditions defined in file 'LICENSE',
+ * which is part of this source code package.
+ */
+
+#pragma once
+
+#pragma warning(push, 0)
+#include "v8.h"
+#pragma warning(pop)
+
+namespace puerts
+{
+// Cells created by puerts.$ref. The single internal field holds the value itself, so native code reads and writes a
+// ref/out argument without a property lookup and the value is traced by the gc like any other field. Holders that are not
+// cells (plain [value] arrays, objects built by old scripts) still go through element 0.
+// A cell has exactly one internal field: native wrappers keep a pointer pair in fields 0 and 1, and
+// DataTransfer::GetPointerFast only decodes objects with at least two, so a cell never reads as a native pointer.
+// The brand is the tag in the one internal field of RefCell.prototype, checked without any lookup. It is a constant rather
+// than the address of a static: this header is compiled into every module that converts arguments, and a per-module
+// static would make cells created by one module unrecognizable to the others.
+V8_INLINE void* RefCellTag()
+{
+    return reinterpret_cast<void*>(~static_cast<uintptr_t>(0xF));
+}
+
+V8_INLINE bool IsRefCell(v8::Local<v8::Object> Holder)
+{
+    if (Holder->InternalFieldCount() != 1)
+    {
+        return false;
+    }
+    v8::Local<v8::Value> Prototype = Holder->GetPrototype();
+    return Prototype->IsObject() && Prototype.As<v8::Object>()->InternalFieldCount() == 1 &&
+           Prototype.As<v8::Object>()->GetAlignedPointerFromInternalField(0) == RefCellTag();
+}
+
+V8_INLINE v8::Local<v8::Value> GetRefValue(v8::Local<v8::Context> Context, v8::Local<v8::Object> Holder)
+{
+    if (IsRefCell(Holder))
+    {
+        // GetInternalField returns Local<Data> since v8 11.6
+        return Holder->GetInternalField(0).As<v8::Value>();
+    }
+    v8::Local<v8::Value> Value;
+    if (!Holder->Get(Context, 0).ToLocal(&Value))
+    {
+        return v8::Undefined(Context->GetIsolate());
+    }
+    return Value;
+}
+
+V8_INLINE void SetRefValue(v8::Local<v8::Context> Context, v8::Local<v8::Object> Holder, v8::Local<v8::Value> Value)
+{
+    if (IsRefCell(Holder))
+    {
+        Holder->SetInternalField(0, Value);
+        return;
+    }
+    auto _unused = Holder->Set(Context, 0, Value);
+}
+
+inline void RefCellConstructor(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    v8::Isolate* Isolate = Info.GetIsolate();
+    if (!Info.IsConstructCall())
+    {
+        Isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(Isolate, "RefCell must be called with new", v8::NewStringType::kNormal).ToLocalChecked()));
+        return;
+    }
+    Info.This()->SetInternalField(0, Info.Length() > 0 ? Info[0] : v8::Local<v8::Value>(v8::Undefined(Isolate)));
+}
+
+inline void RefCellGet(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    if (Info.Length() > 0 && Info[0]->IsObject())
+    {
+        Info.GetReturnValue().Set(GetRefValue(Info.GetIsolate()->GetCurrentContext(), Info[0].As<v8::Object>()));
+    }
+}
+
+inline void RefCellSet(const v8::FunctionCallbackInfo<v8::Value>& Info)
+{
+    if (Info.Length() > 1 && Info[0]->IsObject())
+    {
+        SetRefValue(Info.GetIsolate()->GetCurrentContext(), Info[0].As<v8::Object>(), Info[1]);
+    }
+}
+
+// the returned constructor also carries static get(cell)/set(cell, value), the script side defines element 0, length and
+// Symbol.iterator on its prototype with them so a cell still reads like the one-element array $ref used to return
+inline v8::Local<v8::Function> CreateRefCellClass(v8::Local<v8::Context> Context)
+{
+    v8::Isolate* Isolate = Context->GetIsolate();
+    auto Template = v8::FunctionTemplate::New(Isolate, RefCellConstructor);
+    Template->SetClassName(v8::String::NewFromUtf8(Isolate, "RefCell", v8::NewStringType::kNormal).ToLocalChecked());
+    Template->InstanceTemplate()->SetInternalFieldCount(1);
+    Template->PrototypeTemplate()->SetInternalFieldCount(1);
+    Template->Set(v8::String::NewFromUtf8(Isolate, "get", v8::NewStringType::kNormal).ToLocalChecked(),
+        v8::FunctionTemplate::New(Isolate, RefCellGet));
+    Template->Set(v8::String::NewFromUtf8(Isolate, "set", v8::NewStringType::kNormal).ToLocalChecked(),
+        v8::FunctionTemplate::New(Isolate, RefCellSet));
+    auto Class = Template->GetFunction(Context).ToLocalChecked();
+    Class->Get(Context, v8::String::NewFromUtf8(Isolate, "prototype", v8::NewStringType::kNormal).ToLocalChecked())
+        .ToLocalChecked()
+        .As<v8::Object>()
+        ->SetAlignedPointerInInternalField(0, RefCellTag());
+    return Class;
+}
+}    // namespace puerts
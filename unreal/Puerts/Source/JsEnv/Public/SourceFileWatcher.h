@@ -10,30 +10,95 @@
 #if WITH_EDITOR
 #include "CoreMinimal.h"
 #include "IDirectoryWatcher.h"
-#include "Misc/SecureHash.h"
+#include "Async/Future.h"
+#include "UECompatible.h"
 #include <functional>
 
 namespace puerts
 {
+// A modified file is only hashed when its size or modification time differs from the last check, and hashing runs on the
+// thread pool. Bursts of events (tsc --watch rewrites many files at once) are coalesced: a batch is reported once no new
+// event arrived for DebounceSeconds.
+// All public methods must be called on the game thread.
 class JSENV_API FSourceFileWatcher
 {
 public:
+    // each changed file of a batch is reported by its own call, in the same order as the batched callback
     FSourceFileWatcher(std::function<void(const FString&)> InOnWatchedFileChanged);
 
+    // InOnWatchedFilesChanged is called once per batch, dependencies come before the modules that loaded them
+    FSourceFileWatcher(std::function<void(const TArray<FString>&)> InOnWatchedFilesChanged, float InDebounceSeconds);
+
     ~FSourceFileWatcher();
 
     void OnSourceLoaded(const FString& InPath);
 
     void OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges);
 
+    static constexpr float DefaultDebounceSeconds = 0.3f;
+
 private:
+    struct FWatchedFile
+    {
+        // until the first hash is taken, the size and timestamp seen when the file was loaded
+        int64 Size = -1;
+
+        FDateTime ModificationTime;
+
+        uint64 Hash = 0;
+
+        bool Hashed = false;
+
+        int32 LoadOrder = 0;
+    };
+
+    struct FHashJob
+    {
+        FString Dir;
+
+        FString FileName;
+
+        FString Path;
+
+        FWatchedFile Known;
+
+        bool Report = false;
+
+        FWatchedFile Result;
+
+        bool Changed = false;
+    };
+
+    static void RunHashJobs(TArray<FHashJob>& Jobs);
+
+    bool Tick(float DeltaTime);
+
+    void StartHashing();
+
+    void FinishHashing();
+
     TMap<FString, FDelegateHandle> WatchedDirs;
 
-    TMap<FString, TMap<FString, FMD5Hash>> WatchedFiles;
+    TMap<FString, TMap<FString, FWatchedFile>> WatchedFiles;
+
+    // notify path -> key of WatchedFiles
+    TMap<FString, FString> PendingBaselines;
+
+    TMap<FString, FString> PendingChanges;
+
+    double LastChangeTime = 0;
+
+    int32 NextLoadOrder = 0;
+
+    TFuture<TArray<FHashJob>> HashingTask;
+
+    FUETickDelegateHandle TickerHandle;
 
     FCriticalSection SourceFileWatcherCritical;
 
-    std::function<void(const FString&)> OnWatchedFileChanged;
+    std::function<void(const TArray<FString>&)> OnWatchedFilesChanged;
+
+    float DebounceSeconds;
 };
 }    // namespace puerts
 #endif
\ No newline at end of file
@@ -14,6 +14,12 @@
 #include "TypeInfo.hpp"
 #include <type_traits>
 
+#ifdef WITH_V8_FAST_CALL
+#define PUERTS_RECORD_SLOW_CALL(SIGNATURE, M) ::puerts::V8FastCall<SIGNATURE, M>::recordSlowCall()
+#else
+#define PUERTS_RECORD_SLOW_CALL(SIGNATURE, M)
+#endif
+
 namespace puerts
 {
 template <typename T, typename = void>
@@ -752,6 +758,7 @@ struct FuncCallWrapper<API, Ret (*)(Args...), func, ReturnByPointer, ScriptTypeP
 {
     static void call(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::call(func, info);
@@ -765,6 +772,7 @@ struct FuncCallWrapper<API, Ret (*)(Args...), func, ReturnByPointer, ScriptTypeP
     }
     static void checkedCall(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, true, ReturnByPointer, ScriptTypePtrAsRef,
             GetSelfFromData>;
         if (!Helper::call(func, info))
@@ -775,6 +783,7 @@ struct FuncCallWrapper<API, Ret (*)(Args...), func, ReturnByPointer, ScriptTypeP
     template <class... DefaultArguments>
     static void callWithDefaultValues(typename API::CallbackInfoType info, DefaultArguments&&... defaultValues)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::call(func, info, std::forward<DefaultArguments>(defaultValues)...);
@@ -819,6 +828,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...), func, ReturnByPointer, Script
 {
     static void call(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::template callMethod<Inc>(func, info);
@@ -832,6 +842,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...), func, ReturnByPointer, Script
     }
     static void checkedCall(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, true, ReturnByPointer, ScriptTypePtrAsRef,
             GetSelfFromData>;
         if (!Helper::template callMethod<Inc, decltype(func)>(func, info))
@@ -842,6 +853,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...), func, ReturnByPointer, Script
     template <class... DefaultArguments>
     static void callWithDefaultValues(typename API::CallbackInfoType info, DefaultArguments&&... defaultValues)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...), func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::template callMethod<Inc>(func, info, std::forward<DefaultArguments>(defaultValues)...);
@@ -866,6 +878,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...) const, func, ReturnByPointer,
 {
     static void call(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...) const, func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::template callMethod<Inc>(func, info);
@@ -879,6 +892,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...) const, func, ReturnByPointer,
     }
     static void checkedCall(typename API::CallbackInfoType info)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...) const, func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, true, ReturnByPointer, ScriptTypePtrAsRef,
             GetSelfFromData>;
         if (!Helper::template callMethod<Inc, decltype(func)>(func, info))
@@ -889,6 +903,7 @@ struct FuncCallWrapper<API, Ret (Inc::*)(Args...) const, func, ReturnByPointer,
     template <class... DefaultArguments>
     static void callWithDefaultValues(typename API::CallbackInfoType info, DefaultArguments&&... defaultValues)
     {
+        PUERTS_RECORD_SLOW_CALL(Ret (Inc::*)(Args...) const, func);
         using Helper = internal::FuncCallHelper<API, std::pair<Ret, std::tuple<Args...>>, false, ReturnByPointer,
             ScriptTypePtrAsRef, GetSelfFromData>;
         Helper::template callMethod<Inc>(func, info, std::forward<DefaultArguments>(defaultValues)...);
@@ -35,6 +35,8 @@ class CFunction;
 
 namespace puerts
 {
+struct FastCallStatistics;
+
 namespace internal
 {
 template <std::size_t N>
@@ -299,6 +301,7 @@ public:
     virtual const CTypeInfo* Argument(unsigned int index) const = 0;
     virtual const char* CustomSignature() const = 0;
     virtual const class v8::CFunction* FastCallInfo() const = 0;
+    virtual const FastCallStatistics* FastCallStats() const = 0;
 };
 
 template <typename T, bool ScriptTypePtrAsRef>
@@ -388,6 +391,10 @@ public:
     {
         return nullptr;
     };
+    virtual const FastCallStatistics* FastCallStats() const override
+    {
+        return nullptr;
+    };
 
     static const CFunctionInfo* get(unsigned int defaultCount)
     {
@@ -415,6 +422,10 @@ public:
     {
         return V8FastCall<Ret (*)(Args...), func>::info();
     };
+    virtual const FastCallStatistics* FastCallStats() const override
+    {
+        return V8FastCall<Ret (*)(Args...), func>::statistics();
+    };
 #endif
 
     static const CFunctionInfo* get(unsigned int defaultCount)
@@ -438,6 +449,10 @@ public:
     {
         return V8FastCall<Ret (Inc::*)(Args...), func>::info();
     };
+    virtual const FastCallStatistics* FastCallStats() const override
+    {
+        return V8FastCall<Ret (Inc::*)(Args...), func>::statistics();
+    };
 #endif
 
     static const CFunctionInfo* get(unsigned int defaultCount)
@@ -461,6 +476,10 @@ public:
     {
         return V8FastCall<Ret (Inc::*)(Args...) const, func>::info();
     };
+    virtual const FastCallStatistics* FastCallStats() const override
+    {
+        return V8FastCall<Ret (Inc::*)(Args...) const, func>::statistics();
+    };
 #endif
 
     static const CFunctionInfo* get(unsigned int defaultCount)
@@ -508,6 +527,10 @@ public:
     {
         return nullptr;
     };
+    virtual const FastCallStatistics* FastCallStats() const override
+    {
+        return nullptr;
+    };
 };
 
 struct NamedFunctionInfo
@@ -126,8 +126,7 @@ struct API
     {
         if (holder->IsObject())
         {
-            auto outer = holder->ToObject(context).ToLocalChecked();
-            (void) (outer->Set(context, 0, value));
+            SetRefValue(context, holder.As<v8::Object>(), value);
         }
     }
 
@@ -503,7 +502,7 @@ struct Converter<std::reference_wrapper<T>, typename std::enable_if<!is_objectty
         if (value->IsObject())
         {
             auto outer = value->ToObject(context).ToLocalChecked();
-            auto realvalue = outer->Get(context, 0).ToLocalChecked();
+            auto realvalue = GetRefValue(context, outer);
             return Converter<T>::toCpp(context, realvalue);
         }
         return {};
@@ -530,7 +529,7 @@ struct Converter<std::reference_wrapper<T>, typename std::enable_if<is_objecttyp
         if (!value.IsEmpty() && value->IsObject())
         {
             auto outer = value->ToObject(context).ToLocalChecked();
-            auto realvalue = outer->Get(context, 0).ToLocalChecked();
+            auto realvalue = GetRefValue(context, outer);
             return Converter<typename std::decay<T>::type*>::toCpp(context, realvalue);
         }
         return nullptr;
@@ -11,31 +11,80 @@
 #pragma warning(push, 0)
 #include <v8-fast-api-calls.h>
 #pragma warning(pop)
+#include <atomic>
+#include <cstdint>
 #include "DataTransfer.h"
 
 namespace puerts
 {
+template <typename T>
+struct StaticTypeId;
+
+template <typename T>
+struct is_uetype;
+
+struct FastCallStatistics
+{
+    std::atomic<uint64_t> FastHits{0};
+    std::atomic<uint64_t> SlowHits{0};
+};
+
+// v8 < 12: the call is replayed through the slow callback, which reports the error the usual way.
+// v8 >= 12 removed the fallback flag, so signatures whose checks can fail get no CFunction there (see IsFastCallInfallible)
+// and this is never reached; throwing would differ from the slow path, which accepts null and maps foreign objects to nullptr.
+template <int N>
+V8_INLINE void RequestSlowCall(v8::FastApiCallbackOptions& options, const char (&message)[N])
+{
+#if V8_MAJOR_VERSION < 12
+    options.fallback = true;
+#else
+    options.isolate->ThrowError(message);
+#endif
+}
+
+// same rule as the slow path accept(): the object must be a registered cpp object of TypeId or one of its subclasses.
+// only reads internal fields and the class register, so it is safe in a fast call (no allocation, no js execution)
+V8_INLINE bool IsFastCallInstanceOf(const void* TypeId, v8::Local<v8::Object> object)
+{
+    if (V8_UNLIKELY(object->InternalFieldCount() <= 3))
+    {
+        return false;
+    }
+    const void* ObjectTypeId = DataTransfer::GetPointerFast<const void>(object, 1);
+    return V8_LIKELY(ObjectTypeId == TypeId) || (ObjectTypeId && DataTransfer::IsCppSubclassOf(ObjectTypeId, TypeId));
+}
+
+// Get() converts the argument received by the fast path, Accept() returns false when the value can not be handled without the
+// slow callback (the call is then replayed through the slow path by v8). Infallible: Accept() always returns true.
 template <typename T, typename Enable = void>
 struct FastCallArgument
 {
 };
 
+// cpp object pointers only, null/undefined and objects of another class go the slow path (no fast path at all on v8 >= 12).
+// ue types are wrapped by the ue object mapper and carry no cpp type id, they always use the slow path
 template <typename T>
 struct FastCallArgument<T, typename std::enable_if<std::is_pointer<T>::value && !std::is_same<T, const char*>::value &&
                                                    !std::is_enum<typename std::remove_pointer<T>::type>::value &&
                                                    !std::is_integral<typename std::remove_pointer<T>::type>::value &&
-                                                   !std::is_floating_point<typename std::remove_pointer<T>::type>::value>::type>
+                                                   !std::is_floating_point<typename std::remove_pointer<T>::type>::value &&
+                                                   !std::is_void<typename std::remove_pointer<T>::type>::value &&
+                                                   !is_uetype<typename std::remove_cv<typename std::remove_pointer<T>::type>::type>::value>::type>
 {
+    using ClassType = typename std::remove_cv<typename std::remove_pointer<T>::type>::type;
+
     using DeclType = v8::Local<v8::Value>;
 
+    static constexpr bool Infallible = false;
+
+    static bool Accept(v8::Local<v8::Value> v)
+    {
+        return v->IsObject() && IsFastCallInstanceOf(StaticTypeId<ClassType>::get(), v.As<v8::Object>());
+    }
+
     static T Get(v8::Local<v8::Value> v)
     {
-        if (V8_LIKELY(v->IsObject()))
-        {
-            // return static_cast<T>(v.As<v8::Object>()->GetAlignedPointerFromInternalField(1));
-            return static_cast<T>(DataTransfer::GetPointerFast<void>(v.As<v8::Object>()));
-        }
-        return nullptr;
+        return static_cast<T>(DataTransfer::GetPointerFast<ClassType>(v.As<v8::Object>()));
     }
 };
 
@@ -47,20 +96,71 @@ struct FastCallArgument<std::string*>
 template <typename T>
 struct FastCallArgument<T, typename std::enable_if<std::is_enum<T>::value>::type>
 {
-    using DeclType = int;
+    using DeclType = int32_t;
+
+    static constexpr bool Infallible = true;
+
+    static bool Accept(int32_t i)
+    {
+        return true;
+    }
+
+    static T Get(int32_t i)
+    {
+        return static_cast<T>(i);
+    }
+};
+
+// v8 fast api only knows 32 bits integers, and 64 bits integers are BigInt in puerts, so they always take the slow path.
+template <typename T>
+struct FastCallArgument<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) < 8 && std::is_signed<T>::value>::type>
+{
+    using DeclType = int32_t;
 
-    static T Get(int i)
+    static constexpr bool Infallible = true;
+
+    static bool Accept(int32_t i)
+    {
+        return true;
+    }
+
+    static T Get(int32_t i)
     {
         return static_cast<T>(i);
     }
 };
 
 template <typename T>
-struct FastCallArgument<T, typename std::enable_if<std::is_integral<T>::value || std::is_floating_point<T>::value>::type>
+struct FastCallArgument<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) < 8 && !std::is_signed<T>::value>::type>
 {
-    using DeclType = typename std::decay<T>::type;
+    using DeclType = uint32_t;
+
+    static constexpr bool Infallible = true;
 
-    static T Get(typename std::decay<T>::type i)
+    static bool Accept(uint32_t i)
+    {
+        return true;
+    }
+
+    static T Get(uint32_t i)
+    {
+        return static_cast<T>(i);
+    }
+};
+
+template <typename T>
+struct FastCallArgument<T, typename std::enable_if<std::is_same<T, float>::value || std::is_same<T, double>::value>::type>
+{
+    using DeclType = T;
+
+    static constexpr bool Infallible = true;
+
+    static bool Accept(T i)
+    {
+        return true;
+    }
+
+    static T Get(T i)
     {
         return i;
     }
@@ -71,12 +171,111 @@ struct FastCallArgument<bool>
 {
     using DeclType = bool;
 
+    static constexpr bool Infallible = true;
+
+    static bool Accept(bool i)
+    {
+        return true;
+    }
+
     static bool Get(bool i)
     {
         return i;
     }
 };
 
+#if V8_MAJOR_VERSION >= 10
+template <typename T>
+struct FastCallTypedArrayElement : std::false_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<uint8_t> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<int32_t> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<uint32_t> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<int64_t> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<uint64_t> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<float> : std::true_type
+{
+};
+
+template <>
+struct FastCallTypedArrayElement<double> : std::true_type
+{
+};
+
+// only a typed array of the exact element type reaches here, ArrayBuffer, other views and [value] holders go the slow path
+template <typename T>
+struct FastCallArgument<T*, typename std::enable_if<FastCallTypedArrayElement<typename std::remove_const<T>::type>::value>::type>
+{
+    using ElementType = typename std::remove_const<T>::type;
+
+    using DeclType = const v8::FastApiTypedArray<ElementType>&;
+
+    static constexpr bool Infallible = false;
+
+    static bool Accept(const v8::FastApiTypedArray<ElementType>& arr)
+    {
+        ElementType* data = nullptr;
+        return arr.getStorageIfAligned(&data);
+    }
+
+    static T* Get(const v8::FastApiTypedArray<ElementType>& arr)
+    {
+        ElementType* data = nullptr;
+        arr.getStorageIfAligned(&data);
+        return data;
+    }
+};
+#endif
+
+template <typename T, typename Enable = void>
+struct FastCallReturn
+{
+    using DeclType = typename FastCallArgument<T>::DeclType;
+
+    // the return value is ignored by v8 in both cases: the slow callback replaces it, or the exception is pending
+    template <int N>
+    static DeclType Fallback(v8::FastApiCallbackOptions& options, const char (&message)[N])
+    {
+        RequestSlowCall(options, message);
+        return DeclType{};
+    }
+};
+
+template <>
+struct FastCallReturn<void>
+{
+    using DeclType = void;
+
+    template <int N>
+    static void Fallback(v8::FastApiCallbackOptions& options, const char (&message)[N])
+    {
+        RequestSlowCall(options, message);
+    }
+};
+
 namespace internal
 {
 namespace fastcallutil
@@ -106,9 +305,28 @@ struct Conjunction<_First, _Rest...> : _Conjunction<_First::value, _First, _Rest
 
 template <class...>
 using Void_t = void;
+
+V8_INLINE bool AllOf()
+{
+    return true;
+}
+
+template <typename... Rest>
+V8_INLINE bool AllOf(bool first, Rest... rest)
+{
+    return first && AllOf(rest...);
+}
 }    // namespace fastcallutil
 }    // namespace internal
 
+// on v8 >= 12 only these signatures get a CFunction: free functions whose arguments are all accepted unconditionally.
+// member functions always check the receiver
+template <typename... Args>
+struct IsFastCallInfallible
+    : internal::fastcallutil::Conjunction<std::integral_constant<bool, FastCallArgument<Args>::Infallible>...>
+{
+};
+
 template <typename T, typename = void>
 struct IsArgSupportedHelper : std::false_type
 {
@@ -159,56 +377,143 @@ struct V8FastCall
     {
         return nullptr;
     }
+
+    static const FastCallStatistics* statistics()
+    {
+        return nullptr;
+    }
+
+    V8_INLINE static void recordSlowCall()
+    {
+    }
+};
+
+template <typename Sig, Sig func>
+struct V8FastCallStatistics
+{
+    static FastCallStatistics* get()
+    {
+        static FastCallStatistics _statistics;
+        return &_statistics;
+    }
+
+    V8_INLINE static void recordFastCall()
+    {
+        get()->FastHits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    V8_INLINE static void recordSlowCall()
+    {
+        get()->SlowHits.fetch_add(1, std::memory_order_relaxed);
+    }
 };
 
 template <typename Ret, typename... Args, Ret (*func)(Args...)>
 struct V8FastCall<Ret (*)(Args...), func,
     typename std::enable_if<IsReturnSupportedHelper<Ret>::value && IsArgsSupportedHelper<std::tuple<Args...>>::value &&
-                            (sizeof...(Args) > 0)>::type>
+                            (sizeof...(Args) > 0)>::type> : V8FastCallStatistics<Ret (*)(Args...), func>
 {
-    static Ret Wrap(v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args)
+    static typename FastCallReturn<Ret>::DeclType Wrap(
+        v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args, v8::FastApiCallbackOptions& options)
     {
-        return func(FastCallArgument<Args>::Get(args)...);
+        if (V8_UNLIKELY(!internal::fastcallutil::AllOf(FastCallArgument<Args>::Accept(args)...)))
+        {
+            return FastCallReturn<Ret>::Fallback(options, "invalid arguments");
+        }
+        V8FastCall::recordFastCall();
+        return static_cast<typename FastCallReturn<Ret>::DeclType>(func(FastCallArgument<Args>::Get(args)...));
     }
 
     static const v8::CFunction* info()
     {
+#if V8_MAJOR_VERSION >= 12
+        if (!IsFastCallInfallible<Args...>::value)
+        {
+            return nullptr;
+        }
+#endif
         static v8::CFunction _info = v8::CFunction::Make(Wrap);
         return &_info;
     }
+
+    static const FastCallStatistics* statistics()
+    {
+        return V8FastCall::get();
+    }
 };
 
 template <typename Inc, typename Ret, typename... Args, Ret (Inc::*func)(Args...)>
 struct V8FastCall<Ret (Inc::*)(Args...), func,
-    typename std::enable_if<IsReturnSupportedHelper<Ret>::value && IsArgsSupportedHelper<std::tuple<Args...>>::value>::type>
+    typename std::enable_if<IsReturnSupportedHelper<Ret>::value && IsArgsSupportedHelper<std::tuple<Args...>>::value &&
+                            !is_uetype<Inc>::value>::type> : V8FastCallStatistics<Ret (Inc::*)(Args...), func>
 {
-    static Ret Wrap(v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args)
+    static typename FastCallReturn<Ret>::DeclType Wrap(
+        v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args, v8::FastApiCallbackOptions& options)
     {
-        auto self = FastCallArgument<Inc*>::Get(receiver_obj);
-        return (self->*func)(FastCallArgument<Args>::Get(args)...);
+        if (V8_UNLIKELY(!IsFastCallInstanceOf(StaticTypeId<Inc>::get(), receiver_obj)))
+        {
+            return FastCallReturn<Ret>::Fallback(options, "invalid receiver");
+        }
+        auto self = DataTransfer::GetPointerFast<Inc>(receiver_obj);
+        if (V8_UNLIKELY(!self || !internal::fastcallutil::AllOf(FastCallArgument<Args>::Accept(args)...)))
+        {
+            // let the slow path throw "access a null object"
+            return FastCallReturn<Ret>::Fallback(options, "access a null object or invalid arguments");
+        }
+        V8FastCall::recordFastCall();
+        return static_cast<typename FastCallReturn<Ret>::DeclType>((self->*func)(FastCallArgument<Args>::Get(args)...));
     }
 
     static const v8::CFunction* info()
     {
+#if V8_MAJOR_VERSION >= 12
+        return nullptr;
+#else
         static v8::CFunction _info = v8::CFunction::Make(Wrap);
         return &_info;
+#endif
+    }
+
+    static const FastCallStatistics* statistics()
+    {
+        return V8FastCall::get();
     }
 };
 
 template <typename Inc, typename Ret, typename... Args, Ret (Inc::*func)(Args...) const>
 struct V8FastCall<Ret (Inc::*)(Args...) const, func,
-    typename std::enable_if<IsReturnSupportedHelper<Ret>::value && IsArgsSupportedHelper<std::tuple<Args...>>::value>::type>
+    typename std::enable_if<IsReturnSupportedHelper<Ret>::value && IsArgsSupportedHelper<std::tuple<Args...>>::value &&
+                            !is_uetype<Inc>::value>::type> : V8FastCallStatistics<Ret (Inc::*)(Args...) const, func>
 {
-    static Ret Wrap(v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args)
+    static typename FastCallReturn<Ret>::DeclType Wrap(
+        v8::Local<v8::Object> receiver_obj, typename FastCallArgument<Args>::DeclType... args, v8::FastApiCallbackOptions& options)
     {
-        auto self = FastCallArgument<Inc*>::Get(receiver_obj);
-        return (self->*func)(FastCallArgument<Args>::Get(args)...);
+        if (V8_UNLIKELY(!IsFastCallInstanceOf(StaticTypeId<Inc>::get(), receiver_obj)))
+        {
+            return FastCallReturn<Ret>::Fallback(options, "invalid receiver");
+        }
+        auto self = DataTransfer::GetPointerFast<Inc>(receiver_obj);
+        if (V8_UNLIKELY(!self || !internal::fastcallutil::AllOf(FastCallArgument<Args>::Accept(args)...)))
+        {
+            return FastCallReturn<Ret>::Fallback(options, "access a null object or invalid arguments");
+        }
+        V8FastCall::recordFastCall();
+        return static_cast<typename FastCallReturn<Ret>::DeclType>((self->*func)(FastCallArgument<Args>::Get(args)...));
     }
 
     static const v8::CFunction* info()
     {
+#if V8_MAJOR_VERSION >= 12
+        return nullptr;
+#else
         static v8::CFunction _info = v8::CFunction::Make(Wrap);
         return &_info;
+#endif
+    }
+
+    static const FastCallStatistics* statistics()
+    {
+        return V8FastCall::get();
     }
 };
 
@@ -72,8 +72,16 @@ public:
         return DataTransfer::GetPointerFast<T>(Object, Index);
     }
 
+    // FJsEnvGroup并行模式的工作线程上为true。UObject只能在游戏线程读写，工作线程上的Job要经EnqueueSyncPointCommand交给游戏线程
+    static bool& IsJsEnvWorkerThread()
+    {
+        static thread_local bool Value = false;
+        return Value;
+    }
+
     FORCEINLINE static UObject* GetUObject(v8::Local<v8::Context>& Context, v8::Local<v8::Value> Value, int Index = 0)
     {
+        checkf(!IsJsEnvWorkerThread(), TEXT("UObject accessed from a FJsEnvGroup worker thread, use EnqueueSyncPointCommand"));
         auto UEObject = reinterpret_cast<UObject*>(GetPointer(Context, Value, Index));
         return (!UEObject || (UEObject != RELEASED_UOBJECT && UEObject->IsValidLowLevelFast() && !UEObjectIsPendingKill(UEObject)))
                    ? UEObject
@@ -82,6 +90,7 @@ public:
 
     FORCEINLINE static UObject* GetUObject(v8::Local<v8::Object> Object, int Index = 0)
     {
+        checkf(!IsJsEnvWorkerThread(), TEXT("UObject accessed from a FJsEnvGroup worker thread, use EnqueueSyncPointCommand"));
         auto UEObject = reinterpret_cast<UObject*>(GetPointer(Object, Index));
         return (!UEObject || (UEObject != RELEASED_UOBJECT && UEObject->IsValidLowLevelFast() && !UEObjectIsPendingKill(UEObject)))
                    ? UEObject
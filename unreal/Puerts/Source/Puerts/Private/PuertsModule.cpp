@@ -77,6 +77,11 @@ public:
         return Enabled && WatchEnabled;
     }
 
+    virtual double GetWatchDebounceSeconds() override
+    {
+        return GetDefault<UPuertsSetting>()->WatchDebounceSeconds;
+    }
+
     void ReloadModule(FName ModuleName, const FString& JsSource) override
     {
         if (Enabled)
@@ -216,6 +221,10 @@ public:
             }
 
             JsEnvGroup->RebindJs();
+            if (Settings.ParallelJsEnvGroup && JsEnvGroup->StartParallelExecution())
+            {
+                UE_LOG(PuertsModule, Log, TEXT("Group Mode runs in parallel, each JsEnv has its own worker thread"));
+            }
             UE_LOG(PuertsModule, Log, TEXT("Group Mode started! Number of JsEnv is %d"), NumberOfJsEnv);
         }
         else
@@ -387,6 +396,7 @@ void FPuertsModule::RegisterSettings()
             Settings.NumberOfJsEnv = 1;
         }
         GConfig->GetBool(SectionName, TEXT("WatchDisable"), Settings.WatchDisable, PuertsConfigIniPath);
+        GConfig->GetDouble(SectionName, TEXT("WatchDebounceSeconds"), Settings.WatchDebounceSeconds, PuertsConfigIniPath);
     }
 
     DebuggerPortFromCommandLine = GetDebuggerPortFromCommandLine();
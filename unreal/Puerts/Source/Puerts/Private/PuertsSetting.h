@@ -45,10 +45,20 @@ public:
         meta = (DisplayName = "Number of JavaScript Env", defaultValue = 1))
     int32 NumberOfJsEnv = 1;
 
+    // 每个JsEnv固定到自己的工作线程，需要JsEnv.Build.cs里打开ThreadSafe，见FJsEnvGroup::StartParallelExecution
+    UPROPERTY(config, EditAnywhere, Category = "Default JavaScript Environment",
+        meta = (DisplayName = "Run JavaScript Env Group In Parallel", defaultValue = false))
+    bool ParallelJsEnvGroup = false;
+
     UPROPERTY(config, EditAnywhere, Category = "Default JavaScript Environment",
         meta = (DisplayName = "Disable TypeScript Watch", defaultValue = false))
     bool WatchDisable = false;
 
+    // tsc --watch一次输出会连续改多个文件，这段时间内没有新改动才合并成一次重载
+    UPROPERTY(config, EditAnywhere, Category = "Default JavaScript Environment",
+        meta = (DisplayName = "TypeScript Watch Debounce Seconds", defaultValue = 0.3))
+    double WatchDebounceSeconds = 0.3;
+
     UPROPERTY(config, EditAnywhere, Category = "Declaration Generator", meta = (DisplayName = "D.ts Ignore Class Name List"))
     TArray<FString> IgnoreClassListOnDTS;
 
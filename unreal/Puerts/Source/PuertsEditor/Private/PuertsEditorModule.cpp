@@ -178,21 +178,25 @@ void FPuertsEditorModule::OnPostEngineInit()
         FKismetCompilerContext::RegisterCompilerForBP(UTypeScriptBlueprint::StaticClass(), &MakeCompiler);
 
         SourceFileWatcher = MakeShared<puerts::FSourceFileWatcher>(
-            [this](const FString& InPath)
+            [this](const TArray<FString>& InPaths)
             {
                 if (JsEnv.IsValid())
                 {
-                    TArray<uint8> Source;
-                    if (FFileHelper::LoadFileToArray(Source, *InPath))
-                    {
-                        JsEnv->ReloadSource(InPath, std::string((const char*) Source.GetData(), Source.Num()));
-                    }
-                    else
+                    for (const FString& InPath : InPaths)
                     {
-                        UE_LOG(Puerts, Error, TEXT("read file fail for %s"), *InPath);
+                        TArray<uint8> Source;
+                        if (FFileHelper::LoadFileToArray(Source, *InPath))
+                        {
+                            JsEnv->ReloadSource(InPath, std::string((const char*) Source.GetData(), Source.Num()));
+                        }
+                        else
+                        {
+                            UE_LOG(Puerts, Error, TEXT("read file fail for %s"), *InPath);
+                        }
                     }
                 }
-            });
+            },
+            static_cast<float>(IPuertsModule::Get().GetWatchDebounceSeconds()));
         JsEnv = MakeShared<puerts::FJsEnv>(
             std::make_shared<puerts::DefaultJSModuleLoader>(TEXT("JavaScript")), std::make_shared<puerts::FDefaultLogger>(), -1,
             [this](const FString& InPath)
@@ -16,17 +16,30 @@
 WasmModuleInstance::WasmModuleInstance(TArray<uint8>& InData)
 {
     Data = std::move(InData);
+    DataPtr = Data.GetData();
+    DataLength = Data.Num();
+}
+
+WasmModuleInstance::WasmModuleInstance(const uint8* InData, int InDataLength) : DataPtr(InData), DataLength(InDataLength)
+{
+}
+
+void WasmModuleInstance::ReleaseData()
+{
+    Data.Empty();
+    DataPtr = nullptr;
+    DataLength = 0;
 }
 
 bool WasmModuleInstance::ParseModule(WasmEnv* Env)
 {
     _Module = nullptr;
-    M3Result err = m3_ParseModule(Env->GetEnv(), &_Module, Data.GetData(), Data.Num());    // m3_FreeModule
+    M3Result err = m3_ParseModule(Env->GetEnv(), &_Module, DataPtr, DataLength);    // m3_FreeModule
     if (err)
     {
         _Module = nullptr;
         UE_LOG(LogTemp, Error, TEXT("m3_ParseModule:%s"), ANSI_TO_TCHAR(err));
-        Data.Empty();
+        ReleaseData();
         return false;
     }
     return true;
@@ -49,7 +62,7 @@ bool WasmModuleInstance::LoadModule(WasmRuntime* Runtime, int LinkCategory, Addi
         UE_LOG(LogTemp, Error, TEXT("m3_LoadModule:%s"), ANSI_TO_TCHAR(err));
         m3_FreeModule(_Module);
         _Module = nullptr;
-        Data.Empty();
+        ReleaseData();
         return false;
     }
 
@@ -57,7 +70,7 @@ bool WasmModuleInstance::LoadModule(WasmRuntime* Runtime, int LinkCategory, Addi
     {
         if (!WasmStaticLinkClass::Link(_Module, LinkCategory))
         {
-            Data.Empty();
+            ReleaseData();
             return false;
         }
     }
@@ -67,7 +80,7 @@ bool WasmModuleInstance::LoadModule(WasmRuntime* Runtime, int LinkCategory, Addi
         if (!_Func(_Module))
         {
             UE_LOG(LogTemp, Error, TEXT("wasm module addition link function error"));
-            Data.Empty();
+            ReleaseData();
             return false;
         }
     }
@@ -80,7 +93,7 @@ bool WasmModuleInstance::LoadModule(WasmRuntime* Runtime, int LinkCategory, Addi
     if (err)
     {
         UE_LOG(LogTemp, Error, TEXT("m3_CompileModule: %s"), ANSI_TO_TCHAR(err));
-        Data.Empty();
+        ReleaseData();
         return false;
     }
 
@@ -93,7 +106,7 @@ bool WasmModuleInstance::LoadModule(WasmRuntime* Runtime, int LinkCategory, Addi
         }
     }
     //清理下data,如果有crash就不清理了吧
-    Data.Empty();
+    ReleaseData();
     Runtime->OnModuleInstance(this);
     return true;
 
@@ -27,6 +27,7 @@ WasmRuntime::WasmRuntime(WasmEnv* Env, int MaxPage /*= 10*/, int InitPage /*= 1*
     _Runtime = m3_NewRuntime(_Env->GetEnv(), StackSizeInBytes, this);
     _Runtime->memory.maxPages = MaxPage;
     ResizeMemory(_Runtime, InitPage);
+    _Runtime->memoryResizeCallback = &WasmRuntime::StaticOnMemoryResize;
     _AllWasmRuntimes.Add(this);
 }
 
@@ -60,6 +61,15 @@ uint8* WasmRuntime::GetBuffer(int& Length)
     return base;
 }
 
+void WasmRuntime::StaticOnMemoryResize(IM3Runtime Runtime)
+{
+    WasmRuntime* Self = StaticGetWasmRuntime(Runtime);
+    if (Self && Self->MemoryResizeFunc)
+    {
+        Self->MemoryResizeFunc(Self);
+    }
+}
+
 WasmModuleInstance* WasmRuntime::OnModuleInstance(WasmModuleInstance* InModuleInstance)
 {
     _AllModuleInstances.Add(InModuleInstance);
@@ -24,9 +24,16 @@ private:
     IM3Module _Module;
     TMap<FName, WasmFunction*> _AllExportFunctions;
     TArray<uint8> Data;
+    // 指向Data或者调用者持有的字节码，只在ParseModule到LoadModule结束之间有效
+    const uint8* DataPtr = nullptr;
+    int DataLength = 0;
+
+    void ReleaseData();
 
 public:
     WasmModuleInstance(TArray<uint8>& InData);
+    // 不拷贝字节码，调用者需要保证InData在LoadModule返回之前一直有效
+    WasmModuleInstance(const uint8* InData, int InDataLength);
 
     int Index = -1;
 
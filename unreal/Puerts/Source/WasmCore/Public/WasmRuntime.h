@@ -10,10 +10,15 @@
 #include "CoreMinimal.h"
 #include "WasmCommonIncludes.h"
 #include "WasmEnv.h"
+#include <functional>
 
 class WasmModuleInstance;
 class WasmFunction;
 class WasmPointerSupport;
+class WasmRuntime;
+
+// 线性内存被realloc（grow或者wasm里的memory.grow）之后调用，之前通过GetBuffer拿到的地址都已经失效
+using WasmMemoryResizeFunc = std::function<void(WasmRuntime*)>;
 
 struct WASMCORE_API WasmStackAllocCacheInfo
 {
@@ -33,6 +38,10 @@ private:
     WasmStackAllocCacheInfo BaseStackAllocInfo;
     WASM_PTR MaxWasmStackAllocCount = 0;
 
+    WasmMemoryResizeFunc MemoryResizeFunc;
+
+    static void StaticOnMemoryResize(IM3Runtime Runtime);
+
 public:
     WasmEnv* GetEnv()
     {
@@ -65,6 +74,11 @@ public:
     int Grow(int number);
     uint8* GetBuffer(int& Length);
 
+    void SetMemoryResizeCallback(WasmMemoryResizeFunc Func)
+    {
+        MemoryResizeFunc = std::move(Func);
+    }
+
     uint16 GetRuntimeSeq() const
     {
         return _RuntimeSeq;
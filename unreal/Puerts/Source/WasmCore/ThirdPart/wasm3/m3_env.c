@@ -400,6 +400,9 @@ M3Result  ResizeMemory  (IM3Runtime io_runtime, u32 i_numPages)
         memory->mallocated->maxStack = (m3slot_t *) io_runtime->stack + io_runtime->numStackSlots;
 
         m3log (runtime, "resized old: %p; mem: %p; length: %zu; pages: %d", oldMallocated, memory->mallocated, memory->mallocated->length, memory->numPages);
+
+        if (io_runtime->memoryResizeCallback)
+            io_runtime->memoryResizeCallback (io_runtime);
     }
     else result = m3Err_wasmMemoryOverflow;
 
@@ -155,6 +155,9 @@ void                        Environment_AddFuncType     (IM3Environment i_enviro
 
 //---------------------------------------------------------------------------------------------------------------------------------
 
+// puerts: 每次ResizeMemory成功后调用，memory.mallocated可能已经被realloc挪走
+typedef void (* M3MemoryResizeCallback) (IM3Runtime i_runtime);
+
 typedef struct M3Runtime
 {
     M3Compilation           compilation;
@@ -193,6 +196,8 @@ typedef struct M3Runtime
 #endif
 
 	u32						newCodePageSequence;
+
+    M3MemoryResizeCallback  memoryResizeCallback;
 }
 M3Runtime;
 
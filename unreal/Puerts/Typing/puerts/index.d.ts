@@ -23,6 +23,18 @@ declare module "puerts" {
     function toCString(str:string) : ArrayBuffer;
 
     function toCPtrArray(...ab:ArrayBuffer[]) : ArrayBuffer;
+
+    interface CallStatisticsEntry {
+        name: string;
+        calls: number;
+        // extrapolated from the sampled calls
+        totalMs: number;
+        // histogram[i]: sampled calls that took [2^i, 2^(i+1)) ticks, only a random subset of the calls is timed
+        histogram: number[];
+    }
+
+    // only available when JsEnv is built with PUERTS_CALL_STATISTICS
+    function getCallStatistics(reset?: boolean) : { ticksPerSecond: number, entries: CallStatisticsEntry[] };
     
     function $ref<T>(x? : T) : $Ref<T>;
     
@@ -37,6 +49,18 @@ declare module "puerts" {
     
     function merge(des: {}, src: {}): void;
     
+    interface MessagePort {
+        // structured clone, UObjects are passed by reference; returns false when the queue is full or the port is closed
+        postMessage(message: any, transfer?: ArrayBuffer[]): boolean;
+        // bytes for native receivers without an isolate
+        postRaw(data: ArrayBuffer | ArrayBufferView): boolean;
+        close(): void;
+        onmessage: ((message: any) => void) | null;
+    }
+    
+    // ports are added by FJsEnv::AddMessagePort / FJsEnvGroup::ConnectMessagePorts, undefined if there is none with this name
+    function getMessagePort(name: string): MessagePort | undefined;
+    
     //function requestJitModuleMethod(moduleName: string, methodName: string, callback: (err: Error, result: any)=> void, ... args: any[]): void;
     
     /**
@@ -44,6 +44,12 @@ declare module "ue" {
         RemoveAt(Index: number): void;
         IsValidIndex(Index: number): boolean;
         Empty(): void;
+        ToArray(): T[];
+        FromArray(Values: ArrayLike<T>): void;  // 清空后整体填入，数值类型传同类型的TypedArray时整段拷贝
+        values(): IterableIterator<T>;
+        keys(): IterableIterator<number>;
+        entries(): IterableIterator<[number, T]>;
+        [Symbol.iterator](): IterableIterator<T>;
     }
     
     interface TSet<T> {
@@ -58,6 +64,12 @@ declare module "ue" {
         GetMaxIndex(): number;  // TODO - GetMaxIndex的返回值是InvalidIndex，合理吗？（GetMaxIndex的解释应该是：最大合法index+1），当调用Empty，返回值为0
         IsValidIndex(Index: number): boolean;
         Empty(): void;
+        ToArray(): T[];
+        ToJSSet(): Set<T>;
+        values(): IterableIterator<T>;
+        keys(): IterableIterator<T>;
+        entries(): IterableIterator<[T, T]>;
+        [Symbol.iterator](): IterableIterator<T>;
     }
     
     interface TMap<TKey, TValue> {
@@ -71,6 +83,11 @@ declare module "ue" {
         IsValidIndex(Index: number): boolean;
         GetKey(Index: number): TKey;            // TODO - 对于非法index，是否应该返回undefined
         Empty(): void;
+        ToJSMap(): Map<TKey, TValue>;
+        values(): IterableIterator<TValue>;
+        keys(): IterableIterator<TKey>;
+        entries(): IterableIterator<[TKey, TValue]>;
+        [Symbol.iterator](): IterableIterator<[TKey, TValue]>;
     }
 
     interface TSharedPtr<T> {